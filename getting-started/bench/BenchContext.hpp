@@ -0,0 +1,181 @@
+/*!
+ * \file  BenchContext.hpp
+ * \brief Helpers shared by the benchmarks
+ */
+
+#ifndef __BENCH_CONTEXT_HPP
+#define __BENCH_CONTEXT_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "HeadlessContext.hpp"
+#include "LogSink.hpp"
+
+//! BenchContext
+/*!
+ * BenchContext creates a small headless OpenGL 3.3 core context, so the
+ * benchmarks measure the driver without a window nor a display server
+ */
+class BenchContext
+{
+ private:
+    /*!
+     * The offscreen context
+     */
+    HeadlessContext context_;
+
+    /*!
+     * Get the options of the offscreen context
+     *
+     * \return The options
+     */
+    static RenderOptions getOptions ()
+    {
+        RenderOptions options;
+
+        options.headless = true;
+        options.width = 64;
+        options.height = 64;
+
+        return options;
+    }
+
+ public:
+    /*!
+     * BenchContext constructor
+     */
+    BenchContext ()
+        : context_(getOptions())
+    {
+    }
+
+    /*!
+     * Check if the context was created
+     *
+     * \return True if the context is current
+     */
+    bool isValid ()
+    {
+        return context_.isValid();
+    }
+
+    /*!
+     * Print the driver the benchmark runs on, the line the context logged
+     * when it was created is written before the results
+     *
+     * \return void
+     */
+    void report ()
+    {
+        LogSink::getInstance().flush();
+    }
+};
+
+//! BenchTimer
+/*!
+ * BenchTimer measures wall time in milliseconds
+ */
+class BenchTimer
+{
+ private:
+    /*!
+     * The time the timer was started
+     */
+    std::chrono::steady_clock::time_point start_;
+
+ public:
+    /*!
+     * BenchTimer constructor, starts the timer
+     */
+    BenchTimer ()
+        : start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    /*!
+     * Get the time elapsed since the timer was started
+     *
+     * \return The elapsed time, in milliseconds
+     */
+    double elapsed ()
+    {
+        std::chrono::duration<double, std::milli> tmp =
+            std::chrono::steady_clock::now() - start_;
+
+        return tmp.count();
+    }
+};
+
+/*!
+ * The rings and sides of the torus of 1M triangles the mesh benchmarks
+ * load, 1024 x 512 quads
+ */
+const int kTorusRings = 1024;
+const int kTorusSides = 512;
+
+/*!
+ * Write a torus as an OBJ file, the way exporters do: positions and texture
+ * coordinates indexed separately, the seam shares positions but not
+ * coordinates
+ *
+ * \param[in] path  The file to write
+ * \param[in] rings The quads around the torus
+ * \param[in] sides The quads around its tube
+ *
+ * \return True if the file was written
+ */
+inline bool writeTorus (const std::string& path, int rings, int sides)
+{
+    const float kPi = 3.14159265f;
+
+    FILE* file = std::fopen(path.c_str(), "w");
+
+    if (file == nullptr)
+        return false;
+
+    for (int i = 0; i < rings; ++i) {
+        float u = 2.0f * kPi * i / rings;
+
+        for (int j = 0; j < sides; ++j) {
+            float v = 2.0f * kPi * j / sides;
+            float radius = 1.0f + 0.3f * std::cos(v);
+
+            std::fprintf(
+                file, "v %.6f %.6f %.6f %.3f %.3f %.3f\n",
+                radius * std::cos(u), radius * std::sin(u), 0.3f * std::sin(v),
+                0.5f + 0.5f * std::cos(u), 0.5f + 0.5f * std::sin(v), 0.5f
+            );
+        }
+    }
+
+    for (int i = 0; i <= rings; ++i) {
+        for (int j = 0; j <= sides; ++j)
+            std::fprintf(file, "vt %.6f %.6f\n", float(i) / rings, float(j) / sides);
+    }
+
+    for (int i = 0; i < rings; ++i) {
+        for (int j = 0; j < sides; ++j) {
+            int corners[4][2] = {{i, j}, {i + 1, j}, {i + 1, j + 1}, {i, j + 1}};
+
+            std::fputc('f', file);
+
+            for (const int* corner : corners) {
+                std::fprintf(
+                    file, " %d/%d",
+                    (corner[0] % rings) * sides + (corner[1] % sides) + 1,
+                    corner[0] * (sides + 1) + corner[1] + 1
+                );
+            }
+
+            std::fputc('\n', file);
+        }
+    }
+
+    return std::fclose(file) == 0;
+}
+
+#endif // __BENCH_CONTEXT_HPP
@@ -0,0 +1,149 @@
+/*!
+ * \file  asset_io_bench.cpp
+ * \brief Compare the ifstream copy Shader used to do with the mmap views of
+ *        AssetFile, on many small files and on a few large ones
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "BenchContext.hpp"
+
+#include "AssetFile.hpp"
+
+namespace {
+
+const int kSmallFiles = 2000;
+const std::size_t kSmallSize = 2 * 1024;
+const int kLargeFiles = 4;
+const std::size_t kLargeSize = 64 * 1024 * 1024;
+const int kIterations = 5;
+
+// the loader Shader::readShaderFile used before AssetFile
+std::string readWithStream (const std::string& path)
+{
+    std::string code;
+    std::ifstream file;
+
+    file.exceptions(std::ifstream::badbit);
+    file.open(path);
+
+    file.seekg(0, std::ios::end);
+    code.reserve(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    code.assign(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+
+    return code;
+}
+
+// touch every byte, so both paths really read the content
+unsigned int checksum (const char* data, std::size_t size)
+{
+    unsigned int sum = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+        sum += static_cast<unsigned char>(data[i]);
+
+    return sum;
+}
+
+std::vector<std::string> createFiles (
+    const std::string& directory, const std::string& prefix,
+    int count, std::size_t size
+) {
+    std::vector<std::string> paths;
+    std::string content(size, '\0');
+
+    for (std::size_t i = 0; i < size; ++i)
+        content[i] = static_cast<char>('a' + (i % 26));
+
+    for (int i = 0; i < count; ++i) {
+        std::string path = directory + "/" + prefix + std::to_string(i);
+        std::ofstream file(path, std::ios::binary);
+
+        file.write(content.data(), content.size());
+        paths.push_back(path);
+    }
+
+    return paths;
+}
+
+void run (const std::string& name, const std::vector<std::string>& paths)
+{
+    double stream_ms = 0.0;
+    double mmap_ms = 0.0;
+    unsigned int stream_sum = 0;
+    unsigned int mmap_sum = 0;
+
+    for (int i = 0; i < kIterations; ++i) {
+        BenchTimer stream;
+
+        for (const std::string& path : paths) {
+            std::string code = readWithStream(path);
+            stream_sum += checksum(code.data(), code.size());
+        }
+
+        stream_ms += stream.elapsed();
+
+        BenchTimer mapped;
+
+        for (const std::string& path : paths) {
+            AssetFile file(path);
+            mmap_sum += checksum(file.getData(), file.getSize());
+        }
+
+        mmap_ms += mapped.elapsed();
+    }
+
+    std::cout << name << ": ifstream " << stream_ms / kIterations
+              << " ms, mmap " << mmap_ms / kIterations << " ms"
+              << ((stream_sum != mmap_sum) ? " (MISMATCH)" : "")
+              << std::endl;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    char pattern[] = "/tmp/asset_io_bench.XXXXXX";
+    std::string directory = (argc > 1) ? argv[1] : "";
+
+    if (directory.empty()) {
+        if (mkdtemp(pattern) == nullptr) {
+            std::cout << "Failed to create a temporary directory" << std::endl;
+            return -1;
+        }
+
+        directory = pattern;
+    }
+
+    std::vector<std::string> small = createFiles(
+        directory, "small", kSmallFiles, kSmallSize
+    );
+    std::vector<std::string> large = createFiles(
+        directory, "large", kLargeFiles, kLargeSize
+    );
+
+    // the files are in the page cache, this compares the copies only
+    run(std::to_string(kSmallFiles) + " x 2 KiB", small);
+    run(std::to_string(kLargeFiles) + " x 64 MiB", large);
+
+    for (const std::string& path : small)
+        std::remove(path.c_str());
+
+    for (const std::string& path : large)
+        std::remove(path.c_str());
+
+    if (argc <= 1)
+        rmdir(directory.c_str());
+
+    return 0;
+}
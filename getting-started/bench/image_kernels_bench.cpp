@@ -0,0 +1,174 @@
+/*!
+ * \file  image_kernels_bench.cpp
+ * \brief Compare the throughput of each ImageKernels version against the
+ *        scalar one on a 4K image
+ */
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+
+#include "BenchContext.hpp"
+
+#include "ImageKernels.hpp"
+
+namespace {
+
+const int kWidth = 3840;
+const int kHeight = 2160;
+const std::size_t kPixels = static_cast<std::size_t>(kWidth) * kHeight;
+const int kIterations = 10;
+
+//! Buffers
+/*!
+ * Buffers holds the inputs and the outputs of every kernel
+ */
+struct Buffers
+{
+    std::vector<unsigned char> rgb;
+    std::vector<unsigned char> rgba;
+    std::vector<float> linear;
+    std::vector<unsigned char> bytes;
+    std::vector<float> floats;
+};
+
+//! Kernel
+struct Kernel
+{
+    const char* name;
+    std::function<void (Buffers&)> run;
+
+    // compares the outputs against the scalar run
+    bool floats;
+};
+
+// the fastest iteration, the others are slowed down by whatever else the
+// machine runs and would hide the difference between the versions
+double measure (const Kernel& kernel, Buffers& buffers)
+{
+    // warm up the caches and the lookup tables
+    kernel.run(buffers);
+
+    double best_ms = 0.0;
+
+    for (int i = 0; i < kIterations; ++i) {
+        BenchTimer timer;
+
+        kernel.run(buffers);
+
+        double ms = timer.elapsed();
+
+        if ((i == 0) || (ms < best_ms))
+            best_ms = ms;
+    }
+
+    return best_ms;
+}
+
+} // namespace
+
+int main () {
+    Buffers buffers;
+
+    buffers.rgb.resize(kPixels * 3);
+    buffers.rgba.resize(kPixels * 4);
+    buffers.linear.resize(kPixels * 4);
+    buffers.bytes.resize(kPixels * 4);
+    buffers.floats.resize(kPixels * 4);
+
+    std::srand(1);
+
+    for (unsigned char& value : buffers.rgb)
+        value = std::rand();
+
+    for (unsigned char& value : buffers.rgba)
+        value = std::rand();
+
+    for (float& value : buffers.linear)
+        value = std::rand() / static_cast<float>(RAND_MAX);
+
+    std::vector<Kernel> kernels = {
+        {"expandRgbToRgba", [] (Buffers& b) {
+            ImageKernels::expandRgbToRgba(b.rgb.data(), b.bytes.data(), kPixels);
+        }, false},
+        {"flipVertical", [] (Buffers& b) {
+            // flipped twice, so every iteration sees the same input
+            ImageKernels::flipVertical(b.rgba.data(), kWidth * 4, kHeight);
+            ImageKernels::flipVertical(b.rgba.data(), kWidth * 4, kHeight);
+        }, false},
+        {"downsampleBox u8", [] (Buffers& b) {
+            ImageKernels::downsampleBox(b.rgba.data(), kWidth, kHeight, b.bytes.data());
+        }, false},
+        {"downsampleBox f32", [] (Buffers& b) {
+            ImageKernels::downsampleBox(b.linear.data(), kWidth, kHeight, b.floats.data());
+        }, true},
+        {"downsampleKaiser", [] (Buffers& b) {
+            ImageKernels::downsampleKaiser(b.linear.data(), kWidth, kHeight, b.floats.data());
+        }, true},
+        {"srgbToLinear", [] (Buffers& b) {
+            ImageKernels::srgbToLinear(b.rgba.data(), b.floats.data(), kPixels);
+        }, true},
+        {"linearToSrgb", [] (Buffers& b) {
+            ImageKernels::linearToSrgb(b.linear.data(), b.bytes.data(), kPixels);
+        }, false},
+        {"unormToFloat", [] (Buffers& b) {
+            ImageKernels::unormToFloat(b.rgba.data(), b.floats.data(), kPixels);
+        }, true},
+        {"floatToUnorm", [] (Buffers& b) {
+            ImageKernels::floatToUnorm(b.linear.data(), b.bytes.data(), kPixels);
+        }, false}
+    };
+
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+
+    if (ImageKernels::getSupportedLevel() >= SimdLevel::Sse2)
+        levels.push_back(SimdLevel::Sse2);
+
+    if (ImageKernels::getSupportedLevel() >= SimdLevel::Avx2)
+        levels.push_back(SimdLevel::Avx2);
+
+    std::cout << kWidth << "x" << kHeight << ", " << kIterations
+              << " iterations, fastest reported, supported: "
+              << ImageKernels::getLevelName(ImageKernels::getSupportedLevel())
+              << std::endl;
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (const Kernel& kernel : kernels) {
+        double scalar_ms = 0.0;
+        std::vector<unsigned char> expected_bytes;
+        std::vector<float> expected_floats;
+
+        std::cout << kernel.name << std::endl;
+
+        for (SimdLevel level : levels) {
+            ImageKernels::setLevel(level);
+
+            double ms = measure(kernel, buffers);
+            bool match = true;
+
+            if (level == SimdLevel::Scalar) {
+                scalar_ms = ms;
+                expected_bytes = buffers.bytes;
+                expected_floats = buffers.floats;
+            } else if (kernel.floats) {
+                match = (buffers.floats == expected_floats);
+            } else {
+                match = (buffers.bytes == expected_bytes);
+            }
+
+            std::cout << "    " << std::setw(6) << ImageKernels::getLevelName(level)
+                      << ": " << std::setw(8) << ms << " ms, "
+                      << std::setw(8) << kPixels / ms / 1000.0 << " Mpixel/s, x"
+                      << scalar_ms / ms << (match ? "" : " (MISMATCH)")
+                      << std::endl;
+        }
+    }
+
+    ImageKernels::setLevel(ImageKernels::getSupportedLevel());
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*!
+ * \file  log_burst_bench.cpp
+ * \brief Feed a burst of key events through the InputSystem at 60 frames per
+ *        second and log a line per event, with a flushed std::endl and
+ *        through the LogSink, and compare the frame time spent on input
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include "BenchContext.hpp"
+
+#include "InputSystem.hpp"
+#include "Log.hpp"
+
+namespace {
+
+const unsigned int kFrames = 120;
+
+// the frames [kBurstStart, kBurstEnd) get kBurstEvents key events each,
+// the others a key press and release every kQuietInterval frames
+const unsigned int kBurstStart = 40;
+const unsigned int kBurstEnd = 80;
+const unsigned int kBurstEvents = 96;
+const unsigned int kQuietInterval = 10;
+
+const std::chrono::microseconds kFrameInterval(16667);
+
+enum class Mode
+{
+    kEndl,
+    kSink,
+    kSinkLimited,
+    kDisabled
+};
+
+struct Result
+{
+    double total_ms;
+    double burst_ms;
+    double max_ms;
+    double drain_ms;
+};
+
+// the events of a frame press and release the letters in turn, no key is
+// held long enough to repeat
+int getKey (unsigned int i)
+{
+    return 65 + static_cast<int>((i / 2) % 26);
+}
+
+int getAction (unsigned int i)
+{
+    return ((i & 1) == 0) ? GLFW_PRESS : GLFW_RELEASE;
+}
+
+Result run (Mode mode, std::ostream& out)
+{
+    LogSink& sink = LogSink::getInstance();
+    InputSystem input;
+    InputFrame frame;
+    Result result = {0.0, 0.0, 0.0, 0.0};
+    float mix_ratio = 0.5f;
+
+    sink.setLevel((mode == Mode::kDisabled) ? LogLevel::kWarning : LogLevel::kDebug);
+
+    if (mode == Mode::kSinkLimited)
+        sink.setRate(20, 100);
+    else
+        sink.setRate(0, 1);
+
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+    for (unsigned int f = 0; f < kFrames; ++f) {
+        bool burst = (f >= kBurstStart) && (f < kBurstEnd);
+        unsigned int events = burst ? kBurstEvents : 0;
+
+        if (!burst && ((f % kQuietInterval) == 0))
+            events = 2;
+
+        // what the key callback queues between two frames, not timed
+        for (unsigned int i = 0; i < events; ++i)
+            input.push(getKey(i), getAction(i), 0);
+
+        BenchTimer timer;
+
+        input.poll(frame);
+
+        for (const KeyEvent& key : frame.keys) {
+            mix_ratio = std::min(1.0f, std::max(0.0f, mix_ratio + 0.01f));
+
+            if (mode == Mode::kEndl) {
+                out << "Key " << key.key << " action " << key.action
+                    << ", mix ratio " << mix_ratio << std::endl;
+            } else {
+                LOG_INFO(
+                    "Key " << key.key << " action " << key.action
+                    << ", mix ratio " << mix_ratio
+                );
+            }
+        }
+
+        double elapsed = timer.elapsed();
+
+        result.total_ms += elapsed;
+        result.max_ms = std::max(result.max_ms, elapsed);
+
+        if (burst)
+            result.burst_ms += elapsed;
+
+        next += kFrameInterval;
+        std::this_thread::sleep_until(next);
+    }
+
+    BenchTimer drain;
+
+    sink.flush();
+    result.drain_ms = drain.elapsed();
+
+    return result;
+}
+
+void print (const char* name, const Result& result, const LogSinkStats& before)
+{
+    LogSinkStats stats = LogSink::getInstance().getStats();
+
+    std::cout << name << ": " << result.total_ms / kFrames << " ms per frame, "
+              << result.burst_ms / (kBurstEnd - kBurstStart) << " ms per burst frame, "
+              << result.max_ms << " ms max, " << result.drain_ms << " ms final flush, "
+              << stats.written - before.written << " lines written, "
+              << stats.suppressed - before.suppressed << " suppressed, "
+              << stats.dropped - before.dropped << " dropped" << std::endl;
+}
+
+} // namespace
+
+int main () {
+    // a terminal would cost more than this, the flush still is a syscall
+    std::ofstream null("/dev/null");
+
+    if (!null) {
+        std::cout << "ERROR::BENCH::FAILED_TO_OPEN /dev/null" << std::endl;
+        return -1;
+    }
+
+    LogSink& sink = LogSink::getInstance();
+
+    sink.setStream(null);
+
+    std::cout << kFrames << " frames at 60 Hz, " << kBurstEvents
+              << " key events per frame during " << kBurstEnd - kBurstStart
+              << " of them, one line per event" << std::endl;
+
+    const struct
+    {
+        const char* name;
+        Mode mode;
+    } modes[] = {
+        {"std::endl", Mode::kEndl},
+        {"LogSink", Mode::kSink},
+        {"LogSink, 20 lines/s", Mode::kSinkLimited},
+        {"Level disabled", Mode::kDisabled}
+    };
+
+    for (const auto& mode : modes) {
+        LogSinkStats before = sink.getStats();
+        Result result = run(mode.mode, null);
+
+        print(mode.name, result, before);
+    }
+
+    sink.setStream(std::cout);
+
+    return 0;
+}
@@ -0,0 +1,452 @@
+/*!
+ * \file  math_kernels_bench.cpp
+ * \brief Compare the throughput of each MathKernels version against naive
+ *        scalar code on arrays of structures, and check their accuracy
+ *        against a double precision reference
+ */
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "BenchContext.hpp"
+
+#include "ImageKernels.hpp"
+#include "MathKernels.hpp"
+#include "MathTypes.hpp"
+
+namespace {
+
+const std::size_t kPoints = 1 << 20;
+const std::size_t kTransforms = 1 << 16;
+const int kIterations = 10;
+
+// relative to the magnitude of the value, a few float ulps
+const double kTolerance = 1e-5;
+
+//! Buffers
+/*!
+ * Buffers holds the inputs and the outputs of every kernel, in structures
+ * of arrays for the kernels and arrays of structures for the naive code
+ */
+struct Buffers
+{
+    std::vector<float> points[3];
+    std::vector<float> transformed[3];
+    std::vector<float> translations[3];
+    std::vector<float> rotations[4];
+    std::vector<float> scales[3];
+    std::vector<Mat4> models;
+    std::vector<Mat4> products;
+    Mat4 matrix;
+
+    std::vector<Vec4> point_structs;
+    std::vector<Vec4> transformed_structs;
+    std::vector<Vec3> translation_structs;
+    std::vector<Quat> rotation_structs;
+    std::vector<Vec3> scale_structs;
+
+    Vec3Arrays getPoints ()
+    {
+        return {points[0].data(), points[1].data(), points[2].data()};
+    }
+
+    Vec3Arrays getTransformed ()
+    {
+        return {transformed[0].data(), transformed[1].data(), transformed[2].data()};
+    }
+
+    Vec3Arrays getTranslations ()
+    {
+        return {translations[0].data(), translations[1].data(), translations[2].data()};
+    }
+
+    QuatArrays getRotations ()
+    {
+        return {
+            rotations[0].data(), rotations[1].data(), rotations[2].data(),
+            rotations[3].data()
+        };
+    }
+
+    Vec3Arrays getScales ()
+    {
+        return {scales[0].data(), scales[1].data(), scales[2].data()};
+    }
+};
+
+//! Kernel
+struct Kernel
+{
+    const char* name;
+    std::size_t count;
+    std::function<void (Buffers&)> naive;
+    std::function<void (Buffers&)> run;
+
+    // the outputs, as floats, and the largest relative error against the
+    // double precision reference
+    std::function<std::vector<float> (Buffers&)> outputs;
+    std::function<double (Buffers&)> error;
+};
+
+double measure (const std::function<void (Buffers&)>& run, Buffers& buffers)
+{
+    run(buffers);
+
+    BenchTimer timer;
+
+    for (int i = 0; i < kIterations; ++i)
+        run(buffers);
+
+    return timer.elapsed() / kIterations;
+}
+
+float random (float low, float high)
+{
+    return low + (high - low) * (std::rand() / static_cast<float>(RAND_MAX));
+}
+
+double getError (float value, double expected)
+{
+    return std::fabs(value - expected) / std::max(1.0, std::fabs(expected));
+}
+
+/*
+ * Naive scalar code, a generic matrix product per point and three matrices
+ * per transform, the way code without a math library is written
+ */
+
+Mat4 multiplyNaive (const Mat4& a, const Mat4& b)
+{
+    Mat4 result;
+
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+
+            for (int k = 0; k < 4; ++k)
+                sum += a.data[k * 4 + row] * b.data[column * 4 + k];
+
+            result.data[column * 4 + row] = sum;
+        }
+    }
+
+    return result;
+}
+
+void transformNaive (Buffers& b)
+{
+    for (std::size_t i = 0; i < kPoints; ++i) {
+        const float* in = &b.point_structs[i].x;
+        float* out = &b.transformed_structs[i].x;
+
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+
+            for (int k = 0; k < 4; ++k)
+                sum += b.matrix.data[k * 4 + row] * in[k];
+
+            out[row] = sum;
+        }
+    }
+}
+
+void composeNaive (Buffers& b)
+{
+    for (std::size_t i = 0; i < kTransforms; ++i) {
+        const Vec3& t = b.translation_structs[i];
+        const Vec3& s = b.scale_structs[i];
+        Mat4 translation = makeIdentity();
+        Mat4 rotation = makeTransform(
+            {0.0f, 0.0f, 0.0f}, b.rotation_structs[i], {1.0f, 1.0f, 1.0f}
+        );
+        Mat4 scale = makeIdentity();
+
+        translation.data[12] = t.x;
+        translation.data[13] = t.y;
+        translation.data[14] = t.z;
+        scale.data[0] = s.x;
+        scale.data[5] = s.y;
+        scale.data[10] = s.z;
+
+        b.models[i] = multiplyNaive(multiplyNaive(translation, rotation), scale);
+    }
+}
+
+void multiplyMatricesNaive (Buffers& b)
+{
+    for (std::size_t i = 0; i < kTransforms; ++i)
+        b.products[i] = multiplyNaive(b.matrix, b.models[i]);
+}
+
+/*
+ * Double precision references
+ */
+
+double transformError (Buffers& b)
+{
+    const float* m = b.matrix.data;
+    double error = 0.0;
+
+    for (std::size_t i = 0; i < kPoints; ++i) {
+        for (int row = 0; row < 3; ++row) {
+            double expected = double(m[row]) * b.points[0][i] +
+                double(m[4 + row]) * b.points[1][i] +
+                double(m[8 + row]) * b.points[2][i] + m[12 + row];
+
+            error = std::max(error, getError(b.transformed[row][i], expected));
+        }
+    }
+
+    return error;
+}
+
+double composeError (Buffers& b)
+{
+    double error = 0.0;
+
+    for (std::size_t i = 0; i < kTransforms; ++i) {
+        double x = b.rotations[0][i];
+        double y = b.rotations[1][i];
+        double z = b.rotations[2][i];
+        double w = b.rotations[3][i];
+        double sx = b.scales[0][i];
+        double sy = b.scales[1][i];
+        double sz = b.scales[2][i];
+        double expected[16] = {
+            (1.0 - 2.0 * (y * y + z * z)) * sx, 2.0 * (x * y + w * z) * sx,
+            2.0 * (x * z - w * y) * sx, 0.0,
+            2.0 * (x * y - w * z) * sy, (1.0 - 2.0 * (x * x + z * z)) * sy,
+            2.0 * (y * z + w * x) * sy, 0.0,
+            2.0 * (x * z + w * y) * sz, 2.0 * (y * z - w * x) * sz,
+            (1.0 - 2.0 * (x * x + y * y)) * sz, 0.0,
+            b.translations[0][i], b.translations[1][i], b.translations[2][i], 1.0
+        };
+
+        for (int k = 0; k < 16; ++k)
+            error = std::max(error, getError(b.models[i].data[k], expected[k]));
+    }
+
+    return error;
+}
+
+double multiplyError (Buffers& b)
+{
+    const float* a = b.matrix.data;
+    double error = 0.0;
+
+    for (std::size_t i = 0; i < kTransforms; ++i) {
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                double expected = 0.0;
+
+                for (int k = 0; k < 4; ++k)
+                    expected += double(a[k * 4 + row]) * b.models[i].data[column * 4 + k];
+
+                error = std::max(
+                    error, getError(b.products[i].data[column * 4 + row], expected)
+                );
+            }
+        }
+    }
+
+    return error;
+}
+
+std::vector<float> flatten (const std::vector<float>* arrays, int count)
+{
+    std::vector<float> values;
+
+    for (int i = 0; i < count; ++i)
+        values.insert(values.end(), arrays[i].begin(), arrays[i].end());
+
+    return values;
+}
+
+std::vector<float> flatten (const std::vector<Mat4>& matrices)
+{
+    return std::vector<float>(
+        matrices.front().data, matrices.front().data + matrices.size() * 16
+    );
+}
+
+// the types against each other: a quaternion and its matrix rotate alike,
+// composed rotations match composed matrices
+double checkTypes ()
+{
+    double error = 0.0;
+
+    for (int i = 0; i < 1000; ++i) {
+        Vec3 axis = normalize(Vec3{
+            random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f)
+        });
+        Quat a = makeRotation(axis, random(-3.14f, 3.14f));
+        Quat b = nlerp(a, makeRotation({0.0f, 1.0f, 0.0f}, random(-3.14f, 3.14f)), 0.5f);
+        Vec3 v = {random(-10.0f, 10.0f), random(-10.0f, 10.0f), random(-10.0f, 10.0f)};
+        Vec3 unit = {1.0f, 1.0f, 1.0f};
+        Vec3 zero = {0.0f, 0.0f, 0.0f};
+
+        Vec3 by_quat = rotate(a * b, v);
+        Mat4 matrix = makeTransform(zero, a, unit) * makeTransform(zero, b, unit);
+        Vec4 by_matrix = matrix * Vec4{v.x, v.y, v.z, 1.0f};
+
+        error = std::max(error, getError(by_quat.x, by_matrix.x) / 10.0);
+        error = std::max(error, getError(by_quat.y, by_matrix.y) / 10.0);
+        error = std::max(error, getError(by_quat.z, by_matrix.z) / 10.0);
+    }
+
+    return error;
+}
+
+} // namespace
+
+int main () {
+    Buffers buffers;
+
+    std::srand(1);
+
+    for (int k = 0; k < 3; ++k) {
+        buffers.points[k].resize(kPoints);
+        buffers.transformed[k].resize(kPoints);
+        buffers.translations[k].resize(kTransforms);
+        buffers.scales[k].resize(kTransforms);
+    }
+
+    for (int k = 0; k < 4; ++k)
+        buffers.rotations[k].resize(kTransforms);
+
+    buffers.point_structs.resize(kPoints);
+    buffers.transformed_structs.resize(kPoints);
+    buffers.models.resize(kTransforms);
+    buffers.products.resize(kTransforms);
+
+    for (std::size_t i = 0; i < kPoints; ++i) {
+        Vec4 point = {
+            random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f), 1.0f
+        };
+
+        buffers.point_structs[i] = point;
+        buffers.points[0][i] = point.x;
+        buffers.points[1][i] = point.y;
+        buffers.points[2][i] = point.z;
+    }
+
+    for (std::size_t i = 0; i < kTransforms; ++i) {
+        Vec3 translation = {
+            random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f)
+        };
+        Quat rotation = normalize(Quat{
+            random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f)
+        });
+        Vec3 scale = {random(0.5f, 2.0f), random(0.5f, 2.0f), random(0.5f, 2.0f)};
+
+        buffers.translation_structs.push_back(translation);
+        buffers.rotation_structs.push_back(rotation);
+        buffers.scale_structs.push_back(scale);
+
+        buffers.translations[0][i] = translation.x;
+        buffers.translations[1][i] = translation.y;
+        buffers.translations[2][i] = translation.z;
+        buffers.rotations[0][i] = rotation.x;
+        buffers.rotations[1][i] = rotation.y;
+        buffers.rotations[2][i] = rotation.z;
+        buffers.rotations[3][i] = rotation.w;
+        buffers.scales[0][i] = scale.x;
+        buffers.scales[1][i] = scale.y;
+        buffers.scales[2][i] = scale.z;
+    }
+
+    // a view projection, the matrix every kernel uses
+    buffers.matrix = makePerspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) * makeTransform(
+        {0.0f, -2.0f, -10.0f}, makeRotation({1.0f, 0.0f, 0.0f}, 0.3f), {1.0f, 1.0f, 1.0f}
+    );
+
+    // multiplyMatrices reads the models, composeTransforms runs first
+    std::vector<Kernel> kernels = {
+        {"transformPoints", kPoints, transformNaive, [] (Buffers& b) {
+            MathKernels::transformPoints(
+                b.matrix, b.getPoints(), b.getTransformed(), kPoints
+            );
+        }, [] (Buffers& b) {
+            return flatten(b.transformed, 3);
+        }, transformError},
+        {"composeTransforms", kTransforms, composeNaive, [] (Buffers& b) {
+            MathKernels::composeTransforms(
+                b.getTranslations(), b.getRotations(), b.getScales(),
+                b.models.data(), kTransforms
+            );
+        }, [] (Buffers& b) {
+            return flatten(b.models);
+        }, composeError},
+        {"multiplyMatrices", kTransforms, multiplyMatricesNaive, [] (Buffers& b) {
+            MathKernels::multiplyMatrices(
+                b.matrix, b.models.data(), b.products.data(), kTransforms
+            );
+        }, [] (Buffers& b) {
+            return flatten(b.products);
+        }, multiplyError}
+    };
+
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+
+    if (ImageKernels::getSupportedLevel() >= SimdLevel::Sse2)
+        levels.push_back(SimdLevel::Sse2);
+
+    if (ImageKernels::getSupportedLevel() >= SimdLevel::Avx2)
+        levels.push_back(SimdLevel::Avx2);
+
+    std::cout << kPoints << " points, " << kTransforms << " transforms, "
+              << kIterations << " iterations, supported: "
+              << ImageKernels::getLevelName(ImageKernels::getSupportedLevel())
+              << std::endl;
+
+    double types_error = checkTypes();
+
+    std::cout << "quaternions against matrices: max error " << types_error
+              << ((types_error > kTolerance) ? " (INACCURATE)" : "") << std::endl;
+
+    for (const Kernel& kernel : kernels) {
+        std::vector<float> expected;
+
+        std::cout << kernel.name << std::endl;
+
+        double naive_ms = measure(kernel.naive, buffers);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "    " << std::setw(6) << "naive" << ": " << std::setw(8)
+                  << naive_ms << " ms, " << std::setw(8)
+                  << kernel.count / naive_ms / 1000.0 << " M/s" << std::endl;
+
+        for (SimdLevel level : levels) {
+            MathKernels::setLevel(level);
+
+            double ms = measure(kernel.run, buffers);
+            std::vector<float> outputs = kernel.outputs(buffers);
+            double error = kernel.error(buffers);
+            bool match = true;
+
+            if (level == SimdLevel::Scalar)
+                expected = outputs;
+            else
+                match = (outputs == expected);
+
+            std::cout << std::fixed << std::setprecision(2)
+                      << "    " << std::setw(6) << ImageKernels::getLevelName(level)
+                      << ": " << std::setw(8) << ms << " ms, " << std::setw(8)
+                      << kernel.count / ms / 1000.0 << " M/s, x" << naive_ms / ms
+                      << std::scientific << std::setprecision(1)
+                      << ", max error " << error
+                      << ((error > kTolerance) ? " (INACCURATE)" : "")
+                      << (match ? "" : " (MISMATCH)") << std::endl;
+        }
+    }
+
+    MathKernels::setLevel(ImageKernels::getSupportedLevel());
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*!
+ * \file  mesh_cache_bench.cpp
+ * \brief Compare loading a 1M triangle mesh from OBJ text with loading it
+ *        from a mesh container, with the files in the page cache and after
+ *        evicting them
+ *
+ * usage: mesh_cache_bench [directory]
+ *
+ * Eviction uses posix_fadvise, it needs a file system backed by a disk;
+ * the resident share printed after evicting tells if it worked.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "BenchContext.hpp"
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "Mesh.hpp"
+#include "MeshContainer.hpp"
+#include "MeshLoader.hpp"
+
+namespace {
+
+const int kIterations = 3;
+
+// drop the file from the page cache, returns the share still resident
+double evict (const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+
+    if ((fd < 0) || fstat(fd, &info)) {
+        if (fd >= 0)
+            close(fd);
+
+        return 1.0;
+    }
+
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    std::size_t page = sysconf(_SC_PAGESIZE);
+    std::size_t pages = (info.st_size + page - 1) / page;
+    std::vector<unsigned char> resident(pages);
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    std::size_t count = 0;
+
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return 1.0;
+
+    if (mincore(data, info.st_size, resident.data()) == 0) {
+        for (unsigned char flags : resident)
+            count += flags & 1;
+    } else {
+        count = pages;
+    }
+
+    munmap(data, info.st_size);
+
+    return static_cast<double>(count) / pages;
+}
+
+std::size_t getFileSize (const std::string& path)
+{
+    struct stat info;
+
+    return stat(path.c_str(), &info) ? 0 : info.st_size;
+}
+
+GLsizei loadText (const std::string& path)
+{
+    MeshData data = MeshLoader::load(path);
+    Mesh mesh(data.vertices, data.indices);
+
+    glFinish();
+
+    return mesh.getCount();
+}
+
+GLsizei loadContainer (const std::string& path)
+{
+    MeshContainer container(path);
+    std::unique_ptr<Mesh> mesh = container.upload();
+
+    glFinish();
+
+    return mesh->getCount();
+}
+
+void run (const char* name, const std::string& path, GLsizei (*load)(const std::string&))
+{
+    double cold_ms = 0.0;
+    double warm_ms = 0.0;
+    double resident = 0.0;
+    GLsizei count = 0;
+
+    for (int i = 0; i < kIterations; ++i) {
+        resident += evict(path);
+
+        BenchTimer cold;
+        count = load(path);
+        cold_ms += cold.elapsed();
+
+        BenchTimer warm;
+        load(path);
+        warm_ms += warm.elapsed();
+    }
+
+    std::cout << name << ": " << getFileSize(path) / (1024 * 1024) << " MiB, "
+              << count / 3 << " triangles, cold " << cold_ms / kIterations
+              << " ms, warm " << warm_ms / kIterations << " ms ("
+              << 100.0 * resident / kIterations << "% resident after evicting)"
+              << std::endl;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    char pattern[] = "/var/tmp/mesh_cache_bench.XXXXXX";
+    std::string directory = (argc > 1) ? argv[1] : "";
+
+    if (directory.empty()) {
+        if (mkdtemp(pattern) == nullptr) {
+            std::cout << "Failed to create a temporary directory" << std::endl;
+            return -1;
+        }
+
+        directory = pattern;
+    }
+
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+
+    std::string obj = directory + "/torus.obj";
+    std::string baked = directory + "/torus.mesh";
+
+    if (!writeTorus(obj, kTorusRings, kTorusSides)) {
+        std::cout << "Failed to write " << obj << std::endl;
+        return -1;
+    }
+
+    MeshData mesh = MeshLoader::load(obj);
+
+    if (!MeshContainer::write(baked, mesh, MeshLoader::kCacheSize)) {
+        std::cout << "Failed to write " << baked << std::endl;
+        return -1;
+    }
+
+    // both end with the same mesh in GL buffers
+    run("OBJ text ", obj, loadText);
+    run("container", baked, loadContainer);
+
+    GLState::getInstance().invalidate();
+
+    std::remove(obj.c_str());
+    std::remove(baked.c_str());
+
+    if (argc <= 1)
+        rmdir(directory.c_str());
+
+    return 0;
+}
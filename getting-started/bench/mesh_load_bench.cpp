@@ -0,0 +1,151 @@
+/*!
+ * \file  mesh_load_bench.cpp
+ * \brief Time each step of MeshLoader on a large OBJ and report the vertex
+ *        cache miss ratios before and after reordering
+ *
+ * usage: mesh_load_bench [mesh.obj]
+ *
+ * Without a file, a torus of 1M triangles and a small one are generated.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "BenchContext.hpp"
+
+#include "AssetFile.hpp"
+#include "MeshLoader.hpp"
+
+namespace {
+
+const int kIterations = 3;
+
+const unsigned int kCacheSizes[] = {16, 32};
+
+// 128 x 64 quads, few enough vertices for 16 bit indices
+const int kSmallRings = 128;
+const int kSmallSides = 64;
+
+void printCache (const char* name, const MeshData& mesh)
+{
+    std::cout << "  " << name << ":";
+
+    for (unsigned int size : kCacheSizes) {
+        VertexCacheStats stats = MeshLoader::measureVertexCache(
+            mesh.indices, mesh.vertices.size(), size
+        );
+
+        std::cout << "  cache " << size << " ACMR " << stats.acmr
+                  << " ATVR " << stats.atvr;
+    }
+
+    std::cout << std::endl;
+}
+
+void run (const std::string& path)
+{
+    double parse_ms = 0.0;
+    double weld_ms = 0.0;
+    double cache_ms = 0.0;
+    double overdraw_ms = 0.0;
+    double fetch_ms = 0.0;
+    std::size_t corners = 0;
+    MeshData welded;
+    MeshData ordered;
+    MeshData mesh;
+
+    for (int i = 0; i < kIterations; ++i) {
+        BenchTimer parse;
+        AssetFile file(path);
+
+        mesh = MeshLoader::parseObj(file);
+        parse_ms += parse.elapsed();
+        corners = mesh.vertices.size();
+
+        BenchTimer weld;
+        MeshLoader::weld(mesh);
+        weld_ms += weld.elapsed();
+
+        welded = mesh;
+
+        BenchTimer cache;
+        MeshLoader::optimizeVertexCache(mesh);
+        cache_ms += cache.elapsed();
+
+        ordered = mesh;
+
+        BenchTimer overdraw;
+        MeshLoader::optimizeOverdraw(mesh);
+        overdraw_ms += overdraw.elapsed();
+
+        BenchTimer fetch;
+        MeshLoader::optimizeVertexFetch(mesh);
+        fetch_ms += fetch.elapsed();
+    }
+
+    std::size_t triangles = mesh.indices.size() / 3;
+    bool short_indices = mesh.vertices.size() <= 65536;
+
+    std::cout << path << ": " << triangles << " triangles, "
+              << corners << " corners welded to " << mesh.vertices.size()
+              << " vertices" << std::endl;
+
+    std::cout << "  parse " << parse_ms / kIterations
+              << " ms, weld " << weld_ms / kIterations
+              << " ms, vertex cache " << cache_ms / kIterations
+              << " ms, overdraw " << overdraw_ms / kIterations
+              << " ms, vertex fetch " << fetch_ms / kIterations
+              << " ms" << std::endl;
+
+    printCache("file order", welded);
+    printCache("tipsify   ", ordered);
+    printCache("overdraw  ", mesh);
+
+    std::cout << "  indices: " << (short_indices ? "GL_UNSIGNED_SHORT, " : "GL_UNSIGNED_INT, ")
+              << mesh.indices.size() * (short_indices ? 2 : 4) / 1024
+              << " KiB, vertices: " << mesh.vertices.size() * sizeof(MeshVertex) / 1024
+              << " KiB" << std::endl;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    if (argc > 1) {
+        run(argv[1]);
+        return 0;
+    }
+
+    char pattern[] = "/tmp/mesh_load_bench.XXXXXX";
+    int fd = mkstemp(pattern);
+
+    if (fd < 0) {
+        std::cout << "Failed to create a temporary file" << std::endl;
+        return -1;
+    }
+
+    close(fd);
+
+    std::string path = pattern;
+
+    if (!writeTorus(path, kSmallRings, kSmallSides)) {
+        std::cout << "Failed to write " << path << std::endl;
+        return -1;
+    }
+
+    run(path);
+
+    if (!writeTorus(path, kTorusRings, kTorusSides)) {
+        std::cout << "Failed to write " << path << std::endl;
+        return -1;
+    }
+
+    run(path);
+
+    std::remove(path.c_str());
+
+    return 0;
+}
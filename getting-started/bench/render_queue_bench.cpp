@@ -0,0 +1,250 @@
+/*!
+ * \file  render_queue_bench.cpp
+ * \brief Submit 100k randomly ordered draws immediately, through an unsorted
+ *        RenderQueue and through a sorted one, and compare the state
+ *        changes and CPU submit time
+ */
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "BenchContext.hpp"
+
+#include "FrameArena.hpp"
+#include "GLState.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "ShaderBuilder.hpp"
+
+namespace {
+
+const int kIterations = 5;
+const std::size_t kDraws = 100000;
+const unsigned int kPrograms = 16;
+const unsigned int kTextureSets = 32;
+const unsigned int kMeshes = 64;
+
+const char* const kVertexShader =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "void main ()\n"
+    "{\n"
+    "    gl_Position = vec4(position, 1.0);\n"
+    "}\n";
+
+// each program gets its own constant so the driver can't merge them
+std::string getFragmentShader (unsigned int variant)
+{
+    return "#version 330 core\n"
+           "uniform sampler2D texture0;\n"
+           "uniform sampler2D texture1;\n"
+           "out vec4 color;\n"
+           "void main ()\n"
+           "{\n"
+           "    color = texture(texture0, vec2(0.5)) * texture(texture1, vec2(0.5)) * " +
+           std::to_string(1.0 / (variant + 1)) + ";\n"
+           "}\n";
+}
+
+GLuint createTexture (unsigned char value)
+{
+    const unsigned char pixel[4] = {value, value, value, 255};
+    GLuint texture;
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    return texture;
+}
+
+struct Draw
+{
+    GLuint program;
+    unsigned int texture_set;
+    const Mesh* mesh;
+    float depth;
+};
+
+struct Result
+{
+    double record_ms;
+    double submit_ms;
+    GLStateStats state;
+    RenderQueueStats queue;
+};
+
+void print (const char* name, const Result& result)
+{
+    std::cout << name << ": record " << result.record_ms / kIterations
+              << " ms, submit " << result.submit_ms / kIterations << " ms, "
+              << result.state.issued / kIterations << " GL state calls ("
+              << result.state.filtered / kIterations << " dropped)";
+
+    if (result.queue.draws > 0) {
+        std::cout << ", " << result.queue.programs << " program / "
+                  << result.queue.texture_sets << " texture set / "
+                  << result.queue.vertex_arrays << " VAO changes";
+    }
+
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main () {
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+
+    std::vector<std::shared_ptr<Shader>> shaders;
+    std::vector<GLuint> programs;
+    ShaderBuilder builder;
+    std::vector<ShaderFuture> futures;
+
+    for (unsigned int i = 0; i < kPrograms; ++i)
+        futures.push_back(builder.submitSource(kVertexShader, getFragmentShader(i)));
+
+    for (ShaderFuture& future : futures) {
+        shaders.push_back(future.get());
+
+        GLuint program = shaders.back()->getProgram();
+
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "texture0"), 0);
+        glUniform1i(glGetUniformLocation(program, "texture1"), 1);
+        programs.push_back(program);
+    }
+
+    std::vector<TextureSet> texture_sets;
+
+    for (unsigned int i = 0; i < kTextureSets; ++i) {
+        TextureSet set = {{
+            createTexture(static_cast<unsigned char>(i * 8)),
+            createTexture(static_cast<unsigned char>(255 - i * 8)),
+            0, 0
+        }};
+
+        texture_sets.push_back(set);
+    }
+
+    // tiny triangles, the GPU work stays negligible next to the submission
+    std::vector<std::unique_ptr<Mesh>> meshes;
+
+    for (unsigned int i = 0; i < kMeshes; ++i) {
+        float x = -1.0f + (i % 8) * 0.25f;
+        float y = -1.0f + (i / 8) * 0.25f;
+
+        meshes.emplace_back(new Mesh(
+            {x, y, 0.0f, x + 0.01f, y, 0.0f, x, y + 0.01f, 0.0f},
+            {0, 1, 2},
+            {3}
+        ));
+    }
+
+    std::mt19937 random(42);
+    std::vector<Draw> draws(kDraws);
+
+    for (Draw& draw : draws) {
+        draw.program = programs[random() % kPrograms];
+        draw.texture_set = random() % kTextureSets;
+        draw.mesh = meshes[random() % kMeshes].get();
+        draw.depth = (random() % 1000) / 1000.0f;
+    }
+
+    std::cout << kDraws << " draws, " << kPrograms << " programs, "
+              << kTextureSets << " texture sets, " << kMeshes << " meshes, "
+              << kIterations << " iterations" << std::endl;
+
+    GLState& state = GLState::getInstance();
+    FrameArena arena;
+    RenderQueue queue(arena);
+    std::vector<std::uint16_t> set_ids;
+
+    for (const TextureSet& set : texture_sets)
+        set_ids.push_back(queue.addTextureSet(set));
+
+    // what the exercises did: every draw binds everything it uses
+    Result immediate = {0.0, 0.0, {0, 0}, {0, 0, 0, 0}};
+
+    for (int i = 0; i < kIterations; ++i) {
+        BenchTimer timer;
+
+        for (const Draw& draw : draws) {
+            const TextureSet& set = texture_sets[draw.texture_set];
+
+            glUseProgram(draw.program);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, set.textures[0]);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, set.textures[1]);
+            glBindVertexArray(draw.mesh->getVertexArray());
+            glDrawElements(
+                GL_TRIANGLES, draw.mesh->getCount(), draw.mesh->getIndexType(), 0
+            );
+        }
+
+        immediate.submit_ms += timer.elapsed();
+        immediate.state.issued += kDraws * 6;
+
+        glFinish();
+    }
+
+    state.invalidate();
+
+    Result results[2];
+
+    for (int sorted = 0; sorted < 2; ++sorted) {
+        Result& result = results[sorted];
+
+        result = {0.0, 0.0, {0, 0}, {0, 0, 0, 0}};
+        queue.setSorting(sorted != 0);
+
+        for (int i = 0; i < kIterations; ++i) {
+            arena.reset();
+
+            BenchTimer record;
+
+            for (const Draw& draw : draws) {
+                queue.push(
+                    draw.program, set_ids[draw.texture_set],
+                    draw.mesh->getVertexArray(), draw.mesh->getCount(),
+                    draw.mesh->getIndexType(), 0, draw.depth
+                );
+            }
+
+            result.record_ms += record.elapsed();
+            state.resetStats();
+
+            BenchTimer submit;
+
+            queue.submit();
+
+            result.submit_ms += submit.elapsed();
+
+            GLStateStats stats = state.resetStats();
+
+            result.state.issued += stats.issued;
+            result.state.filtered += stats.filtered;
+            result.queue = queue.getStats();
+
+            glFinish();
+        }
+    }
+
+    print("Immediate", immediate);
+    print("Queued   ", results[0]);
+    print("Sorted   ", results[1]);
+
+    std::cout << "Frame arena: " << arena.getCapacity() / 1024 << " KiB" << std::endl;
+
+    return 0;
+}
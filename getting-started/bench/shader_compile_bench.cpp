@@ -0,0 +1,217 @@
+/*!
+ * \file  shader_compile_bench.cpp
+ * \brief Compile every program under ./shader serially and in batch mode and
+ *        compare the wall time of both
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+#include <dirent.h>
+
+#include "BenchContext.hpp"
+
+#include "Shader.hpp"
+#include "ShaderBuilder.hpp"
+#include "ShaderCache.hpp"
+
+namespace {
+
+const int kIterations = 10;
+
+// collect the declarations ("vec3 name") following a storage qualifier
+// ("in", "out", ...)
+std::vector<std::string> findVariables (
+    const std::string& code, const std::string& qualifier
+) {
+    std::vector<std::string> declarations;
+    std::string::size_type pos = 0;
+
+    while ((pos = code.find(qualifier + " vec", pos)) != std::string::npos) {
+        if ((pos > 0) && (code[pos - 1] != '\n') && (code[pos - 1] != ' ')) {
+            ++pos;
+            continue;
+        }
+
+        std::string::size_type begin = pos + qualifier.size() + 1;
+        std::string::size_type end = code.find(';', begin);
+
+        declarations.push_back(code.substr(begin, end - begin));
+        pos = end;
+    }
+
+    return declarations;
+}
+
+// a fragment shader links with a vertex shader writing all of its inputs
+// with the same type
+bool isCompatible (const std::string& vertex, const std::string& fragment)
+{
+    std::vector<std::string> outputs = findVariables(vertex, "out");
+
+    for (const std::string& input : findVariables(fragment, "in")) {
+        bool found = false;
+
+        for (const std::string& output : outputs)
+            found = found || (output == input);
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+bool hasSuffix (const std::string& name, const std::string& suffix)
+{
+    return (name.size() > suffix.size()) &&
+        !name.compare(name.size() - suffix.size(), suffix.size(), suffix);
+}
+
+// the same sequence Shader follows, waiting on every status query
+GLuint compileSerial (const std::string& vertex, const std::string& fragment)
+{
+    const GLchar* code;
+    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint program = glCreateProgram();
+
+    code = vertex.c_str();
+    glShaderSource(vertex_shader, 1, &code, NULL);
+    glCompileShader(vertex_shader);
+    Shader::checkCompileStatus(vertex_shader, "VERTEX");
+
+    code = fragment.c_str();
+    glShaderSource(fragment_shader, 1, &code, NULL);
+    glCompileShader(fragment_shader);
+    Shader::checkCompileStatus(fragment_shader, "FRAGMENT");
+
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    Shader::checkLinkStatus(program);
+
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    return program;
+}
+
+bool isLinked (GLuint program)
+{
+    GLint success;
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    return success;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    std::string directory = (argc > 1) ? argv[1] : "./shader";
+    std::vector<std::string> vertex_files;
+    std::vector<std::string> fragment_files;
+    std::vector<std::pair<std::string, std::string> > programs;
+
+    // the driver must compile every program for real
+    setenv("MESA_SHADER_CACHE_DISABLE", "true", 1);
+
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+    ShaderCache::getInstance().setEnabled(false);
+
+    DIR* dir = opendir(directory.c_str());
+
+    if (dir == nullptr) {
+        std::cout << "Failed to open " << directory << std::endl;
+        return -1;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string path = directory + "/" + entry->d_name;
+
+        if (hasSuffix(path, ".vs"))
+            vertex_files.push_back(Shader::readShaderFile(path.c_str()));
+        else if (hasSuffix(path, ".frag"))
+            fragment_files.push_back(Shader::readShaderFile(path.c_str()));
+    }
+
+    closedir(dir);
+
+    for (const std::string& vertex : vertex_files) {
+        for (const std::string& fragment : fragment_files) {
+            if (isCompatible(vertex, fragment))
+                programs.push_back(std::make_pair(vertex, fragment));
+        }
+    }
+
+    std::cout << vertex_files.size() << " vertex shaders, "
+              << fragment_files.size() << " fragment shaders, "
+              << programs.size() << " programs, "
+              << kIterations << " iterations" << std::endl;
+
+    double serial_ms = 0.0;
+    double batch_ms = 0.0;
+    int failures = 0;
+
+    for (int i = 0; i < kIterations; ++i) {
+        // a different comment per pass keeps any driver cache from hitting
+        std::string salt = "\n// serial " + std::to_string(i) + "\n";
+        std::vector<GLuint> linked;
+        BenchTimer serial;
+
+        for (const auto& program : programs) {
+            linked.push_back(
+                compileSerial(program.first + salt, program.second + salt)
+            );
+        }
+
+        serial_ms += serial.elapsed();
+
+        for (GLuint program : linked) {
+            failures += !isLinked(program);
+            glDeleteProgram(program);
+        }
+
+        salt = "\n// batch " + std::to_string(i) + "\n";
+
+        ShaderBuilder builder;
+        std::vector<ShaderFuture> futures;
+        BenchTimer batch;
+
+        for (const auto& program : programs) {
+            futures.push_back(
+                builder.submitSource(program.first + salt, program.second + salt)
+            );
+        }
+
+        builder.wait();
+
+        batch_ms += batch.elapsed();
+
+        // the shaders delete their programs with the futures
+        for (ShaderFuture& future : futures)
+            failures += !isLinked(future.get()->getProgram());
+    }
+
+    std::cout << "Parallel compile: "
+              << (ShaderBuilder().isParallel() ? "yes" : "no") << std::endl;
+    std::cout << "Serial: " << serial_ms / kIterations << " ms" << std::endl;
+    std::cout << "Batch:  " << batch_ms / kIterations << " ms" << std::endl;
+
+    // a pair that doesn't link times a failure, not a compile
+    if (failures > 0) {
+        std::cout << failures << " programs failed to link" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
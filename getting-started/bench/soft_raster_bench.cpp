@@ -0,0 +1,198 @@
+/*!
+ * \file  soft_raster_bench.cpp
+ * \brief Measure the triangle and pixel throughput of SoftRasterizer for
+ *        each thread count, and check every count draws the same image
+ */
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+
+#include "BenchContext.hpp"
+
+#include "SoftRasterizer.hpp"
+
+namespace {
+
+const int kWidth = 1920;
+const int kHeight = 1080;
+const int kIterations = 5;
+
+const std::size_t kSmallTriangles = 1 << 18;
+const std::size_t kLargeTriangles = 16;
+
+//! Workload
+/*!
+ * Workload is a draw and the vertex and index data it points to
+ */
+struct Workload
+{
+    const char* name;
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    SoftDraw draw;
+};
+
+float random (float low, float high)
+{
+    return low + (high - low) * (std::rand() / static_cast<float>(RAND_MAX));
+}
+
+// position, color, texture coords
+void addVertex (Workload& workload, float x, float y, float u, float v)
+{
+    workload.vertices.insert(workload.vertices.end(), {
+        x, y, 0.0f, random(0.0f, 1.0f), random(0.0f, 1.0f), random(0.0f, 1.0f), u, v
+    });
+    workload.indices.push_back(static_cast<GLuint>(workload.indices.size()));
+}
+
+void makeDraw (Workload& workload, SoftEffect effect, const SoftTexture* texture)
+{
+    SoftDraw& draw = workload.draw;
+
+    draw.vertices = workload.vertices.data();
+    draw.stride = 8 * sizeof(GLfloat);
+    draw.attributes = getFloatAttributes({3, 3, 2});
+    draw.indices = workload.indices.data();
+    draw.count = static_cast<GLsizei>(workload.indices.size());
+    draw.index_type = GL_UNSIGNED_INT;
+    draw.transform = makeIdentity();
+    draw.effect = effect;
+    draw.uniforms = FrameData();
+    draw.uniforms.mix_ratio = 0.3f;
+    draw.textures[0] = texture;
+    draw.textures[1] = texture;
+}
+
+// a few pixels wide, the triangles of a dense mesh far from the camera
+void makeSmall (Workload& workload)
+{
+    const float size = 8.0f / kHeight;
+
+    for (std::size_t i = 0; i < kSmallTriangles; ++i) {
+        float x = random(-1.0f, 1.0f);
+        float y = random(-1.0f, 1.0f);
+
+        addVertex(workload, x, y, 0.0f, 0.0f);
+        addVertex(workload, x + random(-size, size), y + random(-size, size), 1.0f, 0.0f);
+        addVertex(workload, x + random(-size, size), y + random(-size, size), 0.0f, 1.0f);
+    }
+
+    makeDraw(workload, SoftEffect::VertexColor, nullptr);
+}
+
+// overlapping full screen triangles, fill rate bound
+void makeLarge (Workload& workload, const SoftTexture& texture)
+{
+    for (std::size_t i = 0; i < kLargeTriangles; ++i) {
+        addVertex(workload, random(-1.5f, -0.5f), random(-1.5f, -0.5f), 0.0f, 0.0f);
+        addVertex(workload, random(1.0f, 2.5f), random(-1.5f, -0.5f), 4.0f, 0.0f);
+        addVertex(workload, random(-1.5f, -0.5f), random(1.0f, 2.5f), 0.0f, 4.0f);
+    }
+
+    makeDraw(workload, SoftEffect::TextureMix, &texture);
+}
+
+SoftTexture makeTexture ()
+{
+    SoftTexture texture = {256, 256, {}, GL_REPEAT, GL_REPEAT, GL_LINEAR};
+
+    for (int y = 0; y < texture.height; ++y) {
+        for (int x = 0; x < texture.width; ++x) {
+            bool odd = ((x / 32) + (y / 32)) % 2;
+
+            texture.pixels.insert(texture.pixels.end(), {
+                static_cast<unsigned char>(x), static_cast<unsigned char>(y),
+                static_cast<unsigned char>(odd ? 255 : 0), 255
+            });
+        }
+    }
+
+    return texture;
+}
+
+// the draw runs the vertex stage and the binning, finish the tiles
+double measure (SoftRasterizer& rasterizer, const SoftDraw& draw)
+{
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(draw);
+    rasterizer.finish();
+    rasterizer.resetStats();
+
+    BenchTimer timer;
+
+    for (int i = 0; i < kIterations; ++i) {
+        rasterizer.draw(draw);
+        rasterizer.finish();
+    }
+
+    return timer.elapsed() / kIterations;
+}
+
+} // namespace
+
+int main () {
+    SoftTexture texture = makeTexture();
+    std::vector<Workload> workloads(2);
+
+    std::srand(1);
+
+    workloads[0].name = "small triangles";
+    makeSmall(workloads[0]);
+    workloads[1].name = "large triangles";
+    makeLarge(workloads[1], texture);
+
+    std::vector<unsigned int> counts = {1};
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int count = 2; count < cores; count *= 2)
+        counts.push_back(count);
+
+    if (cores > 1)
+        counts.push_back(cores);
+
+    std::cout << kWidth << "x" << kHeight << ", " << kIterations << " iterations, "
+              << cores << " cores" << std::endl;
+
+    for (const Workload& workload : workloads) {
+        std::vector<unsigned char> expected;
+        double single_ms = 0.0;
+
+        std::cout << workload.name << ", " << workload.draw.count / 3 << " per draw"
+                  << std::endl;
+
+        for (unsigned int count : counts) {
+            SoftRasterizer rasterizer(kWidth, kHeight, count);
+
+            double ms = measure(rasterizer, workload.draw);
+            const SoftStats& stats = rasterizer.getStats();
+            std::vector<unsigned char> pixels = rasterizer.readPixels();
+            bool match = true;
+
+            if (count == 1) {
+                expected = pixels;
+                single_ms = ms;
+            } else {
+                match = (pixels == expected);
+            }
+
+            double drawn = static_cast<double>(stats.triangles - stats.culled) / kIterations;
+            double fragments = static_cast<double>(stats.fragments) / kIterations;
+
+            std::cout << std::fixed << std::setprecision(2)
+                      << "    " << std::setw(2) << count << " threads: " << std::setw(8)
+                      << ms << " ms, " << std::setw(8) << drawn / ms
+                      << " Ktris/s, " << std::setw(8) << fragments / ms / 1000.0
+                      << " Mpixels/s, x" << single_ms / ms
+                      << (match ? "" : " (MISMATCH)") << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*!
+ * \file  texture_load_bench.cpp
+ * \brief Compare decoding images with SOIL and generating the mipmaps on the
+ *        driver against uploading containers baked by texbake
+ *
+ * Run 'make bake' first, the containers are read from ./res/tex
+ */
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <SOIL/SOIL.h>
+
+#include "BenchContext.hpp"
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "TextureContainer.hpp"
+
+namespace {
+
+const int kIterations = 20;
+
+// decode, upload level 0 and let the driver build the chain
+GLuint loadImage (const std::string& path)
+{
+    GLuint texture;
+    int width;
+    int height;
+
+    AssetFile file(path);
+    unsigned char* image = SOIL_load_image_from_memory(
+        file.getBytes(), file.getSize(), &width, &height, 0, SOIL_LOAD_RGB
+    );
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB, width, height, 0,
+        GL_RGB, GL_UNSIGNED_BYTE, image
+    );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+    SOIL_free_image_data(image);
+
+    return texture;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    std::string images = (argc > 1) ? argv[1] : "./res/img";
+    std::string baked = (argc > 2) ? argv[2] : "./res/tex";
+    std::vector<std::pair<std::string, std::string> > pairs;
+
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+
+    DIR* dir = opendir(images.c_str());
+
+    if (dir == nullptr) {
+        std::cout << "Failed to open " << images << std::endl;
+        return -1;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        std::string::size_type dot = name.rfind('.');
+
+        if ((dot == std::string::npos) || (name[0] == '.'))
+            continue;
+
+        std::string container = baked + "/" + name.substr(0, dot) + ".tex";
+
+        if (access(container.c_str(), R_OK) == 0)
+            pairs.push_back(std::make_pair(images + "/" + name, container));
+    }
+
+    closedir(dir);
+
+    if (pairs.empty()) {
+        std::cout << "No baked texture in " << baked
+                  << ", run 'make bake' first" << std::endl;
+        return -1;
+    }
+
+    TextureParams params = {
+        GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, 0, false
+    };
+
+    for (const auto& pair : pairs) {
+        double image_ms = 0.0;
+        double container_ms = 0.0;
+
+        for (int i = 0; i < kIterations; ++i) {
+            BenchTimer image;
+            GLuint texture = loadImage(pair.first);
+
+            glFinish();
+            image_ms += image.elapsed();
+            glDeleteTextures(1, &texture);
+
+            BenchTimer container;
+            texture = TextureContainer(pair.second).upload(params);
+
+            glFinish();
+            container_ms += container.elapsed();
+            glDeleteTextures(1, &texture);
+        }
+
+        std::cout << pair.first << ": SOIL + glGenerateMipmap "
+                  << image_ms / kIterations << " ms, container "
+                  << container_ms / kIterations << " ms" << std::endl;
+    }
+
+    return 0;
+}
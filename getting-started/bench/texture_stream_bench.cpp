@@ -0,0 +1,165 @@
+/*!
+ * \file  texture_stream_bench.cpp
+ * \brief Load a directory of images synchronously and through TextureManager
+ *        and report the time until the first frame and until every texture
+ *        is resident
+ */
+
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <dirent.h>
+
+#include <SOIL/SOIL.h>
+
+#include "BenchContext.hpp"
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "TextureManager.hpp"
+
+namespace {
+
+bool isImage (const std::string& name)
+{
+    std::string::size_type dot = name.rfind('.');
+
+    if (dot == std::string::npos)
+        return false;
+
+    std::string extension = name.substr(dot);
+
+    return (extension == ".jpg") || (extension == ".png") ||
+        (extension == ".bmp") || (extension == ".tga");
+}
+
+// the path the exercises used to follow, all on the render thread
+GLuint loadSync (const std::string& path)
+{
+    GLuint texture;
+    int width;
+    int height;
+
+    AssetFile file(path);
+    unsigned char* image = SOIL_load_image_from_memory(
+        file.getBytes(), file.getSize(), &width, &height, 0, SOIL_LOAD_RGB
+    );
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB, width, height, 0,
+        GL_RGB, GL_UNSIGNED_BYTE, image
+    );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+    SOIL_free_image_data(image);
+
+    return texture;
+}
+
+// what a frame costs the render thread besides the uploads
+void drawFrame ()
+{
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glFinish();
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    std::string directory = (argc > 1) ? argv[1] : "./res/img";
+    std::size_t count = (argc > 2) ? std::atoi(argv[2]) : 300;
+    std::vector<std::string> files;
+    std::vector<std::string> paths;
+
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+
+    DIR* dir = opendir(directory.c_str());
+
+    if (dir == nullptr) {
+        std::cout << "Failed to open " << directory << std::endl;
+        return -1;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        if (isImage(entry->d_name))
+            files.push_back(directory + "/" + entry->d_name);
+    }
+
+    closedir(dir);
+
+    if (files.empty()) {
+        std::cout << "No image in " << directory << std::endl;
+        return -1;
+    }
+
+    // small directories are repeated until the requested count
+    while (paths.size() < std::max(count, files.size()))
+        paths.push_back(files[paths.size() % files.size()]);
+
+    std::cout << paths.size() << " textures from " << files.size()
+              << " files" << std::endl;
+
+    std::vector<GLuint> textures;
+
+    // synchronous: nothing is drawn until every texture is resident
+    BenchTimer sync;
+
+    for (const std::string& path : paths)
+        textures.push_back(loadSync(path));
+
+    drawFrame();
+
+    double sync_ms = sync.elapsed();
+
+    glDeleteTextures(textures.size(), textures.data());
+    textures.clear();
+
+    // streamed: frames are drawn while the workers decode
+    TextureParams params = {
+        GL_REPEAT, GL_REPEAT, GL_NEAREST, GL_NEAREST, SOIL_LOAD_RGB, true
+    };
+    double first_frame_ms = 0.0;
+    unsigned int frames = 0;
+    TextureManager* manager = new TextureManager();
+    BenchTimer streamed;
+
+    for (const std::string& path : paths)
+        textures.push_back(manager->load(path, params));
+
+    do {
+        manager->update();
+        drawFrame();
+
+        if (frames++ == 0)
+            first_frame_ms = streamed.elapsed();
+    } while (manager->getPendingCount() > 0);
+
+    double resident_ms = streamed.elapsed();
+
+    delete manager;
+    glDeleteTextures(textures.size(), textures.data());
+
+    std::cout << "Synchronous: first frame " << sync_ms << " ms, resident "
+              << sync_ms << " ms" << std::endl;
+    std::cout << "Streamed:    first frame " << first_frame_ms
+              << " ms, resident " << resident_ms << " ms (" << frames
+              << " frames)" << std::endl;
+
+    return 0;
+}
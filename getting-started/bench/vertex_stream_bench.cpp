@@ -0,0 +1,195 @@
+/*!
+ * \file  vertex_stream_bench.cpp
+ * \brief Stream CPU generated vertices through glBufferData, glBufferSubData
+ *        and a VertexStream, and report the vertices per second each
+ *        sustains while the GPU draws them
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <iostream>
+
+#include "BenchContext.hpp"
+
+#include "GLState.hpp"
+#include "ShaderBuilder.hpp"
+#include "VertexStream.hpp"
+
+namespace {
+
+const int kFrames = 120;
+
+// 10M vertices per second at 60 frames per second
+const GLsizei kVerticesPerFrame = 10000000 / 60;
+
+// position, color
+const GLsizei kFloatsPerVertex = 6;
+
+// the draws only read the start of each frame, enough to make the buffer
+// busy without the software rasterizers spending the frame on vertices
+const GLsizei kDrawnPerFrame = 1024;
+
+const char* const kVertexShader =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "layout (location = 1) in vec3 color;\n"
+    "out vec3 custom_color;\n"
+    "void main ()\n"
+    "{\n"
+    "    gl_Position = vec4(position, 1.0);\n"
+    "    custom_color = color;\n"
+    "}\n";
+
+const char* const kFragmentShader =
+    "#version 330 core\n"
+    "in vec3 custom_color;\n"
+    "out vec4 color;\n"
+    "void main ()\n"
+    "{\n"
+    "    color = vec4(custom_color, 1.0);\n"
+    "}\n";
+
+// what a particle system would write, a different set every frame
+void generate (int frame, GLfloat* vertices)
+{
+    float shift = frame * 0.001f;
+
+    for (GLsizei i = 0; i < kVerticesPerFrame; ++i) {
+        GLfloat* vertex = vertices + i * kFloatsPerVertex;
+        float t = i * (1.0f / kVerticesPerFrame);
+
+        vertex[0] = t * 2.0f - 1.0f;
+        vertex[1] = shift;
+        vertex[2] = 0.0f;
+        vertex[3] = t;
+        vertex[4] = 1.0f - t;
+        vertex[5] = shift;
+    }
+}
+
+struct Result
+{
+    double total_ms;
+    double worst_ms;
+};
+
+// a buffer re-specified or updated by the driver every frame
+Result streamUpload (bool orphan)
+{
+    const GLsizeiptr size = kVerticesPerFrame * kFloatsPerVertex * sizeof(GLfloat);
+
+    GLState& state = GLState::getInstance();
+    std::vector<GLfloat> vertices(kVerticesPerFrame * kFloatsPerVertex);
+    GLuint vao;
+    GLuint vbo;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    state.bindVertexArray(vao);
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(GLfloat), 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+        1, 3, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(GLfloat),
+        reinterpret_cast<GLvoid*>(3 * sizeof(GLfloat))
+    );
+    glEnableVertexAttribArray(1);
+
+    Result result = {0.0, 0.0};
+    BenchTimer total;
+
+    for (int frame = 0; frame < kFrames; ++frame) {
+        BenchTimer timer;
+
+        generate(frame, vertices.data());
+
+        if (orphan) {
+            glBufferData(GL_ARRAY_BUFFER, size, vertices.data(), GL_STREAM_DRAW);
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+        }
+
+        glDrawArrays(GL_POINTS, 0, kDrawnPerFrame);
+
+        result.worst_ms = std::max(result.worst_ms, timer.elapsed());
+    }
+
+    glFinish();
+    result.total_ms = total.elapsed();
+
+    state.forgetVertexArray(vao);
+    state.forgetBuffer(vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+
+    return result;
+}
+
+// generated straight into the section of the ring the GPU is done with
+Result streamRing (VertexStream& stream)
+{
+    Result result = {0.0, 0.0};
+    BenchTimer total;
+
+    for (int frame = 0; frame < kFrames; ++frame) {
+        BenchTimer timer;
+        GLint first = 0;
+
+        stream.begin();
+        generate(frame, stream.allocate(kVerticesPerFrame, &first));
+        stream.end();
+
+        stream.draw(GL_POINTS, first, kDrawnPerFrame);
+        stream.fence();
+
+        result.worst_ms = std::max(result.worst_ms, timer.elapsed());
+    }
+
+    glFinish();
+    result.total_ms = total.elapsed();
+
+    return result;
+}
+
+void print (const char* name, const Result& result)
+{
+    double vertices_per_second = 1000.0 * kVerticesPerFrame * kFrames / result.total_ms;
+
+    std::cout << name << ": " << result.total_ms / kFrames << " ms per frame, "
+              << result.worst_ms << " ms worst, "
+              << vertices_per_second / 1000000.0 << "M vertices/s"
+              << (vertices_per_second >= 10000000.0 ? "" : " (below 10M)")
+              << std::endl;
+}
+
+} // namespace
+
+int main () {
+    BenchContext context;
+
+    if (!context.isValid())
+        return -1;
+
+    context.report();
+
+    ShaderBuilder builder;
+    std::shared_ptr<Shader> shader = builder.submitSource(kVertexShader, kFragmentShader).get();
+
+    shader->use();
+
+    VertexStream stream({3, 3}, kVerticesPerFrame);
+
+    std::cout << kVerticesPerFrame << " vertices per frame, " << kFrames << " frames, "
+              << (stream.isPersistent() ? "persistent" : "unsynchronized")
+              << " ring mapping" << std::endl;
+
+    print("glBufferData   ", streamUpload(true));
+    print("glBufferSubData", streamUpload(false));
+    print("VertexStream   ", streamRing(stream));
+
+    return 0;
+}
@@ -2,7 +2,12 @@
 
 out vec4 color;
 
-uniform vec4 dynamic_color;
+layout (std140) uniform FrameData
+{
+    vec4 dynamic_color;
+    float mix_ratio;
+    float offset_x;
+};
 
 void main()
 {
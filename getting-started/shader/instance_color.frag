@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec4 color_vs;
+in vec3 texture_coord_vs;
+
+out vec4 color;
+
+void main ()
+{
+    color = color_vs;
+}
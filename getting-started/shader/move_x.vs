@@ -5,7 +5,12 @@ layout (location = 1) in vec3 color;
 
 out vec3 custom_color;
 
-uniform float offset_x;
+layout (std140) uniform FrameData
+{
+    vec4 dynamic_color;
+    float mix_ratio;
+    float offset_x;
+};
 
 void main ()
 {
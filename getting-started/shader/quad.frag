@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec4 color_vs;
+in vec3 texture_coord_vs;
+
+out vec4 color;
+
+uniform sampler2DArray layers;
+
+void main ()
+{
+    color = texture(layers, texture_coord_vs) * color_vs;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec2 texture_coord;
+
+uniform mat4 model;
+uniform vec4 tint;
+uniform float layer;
+
+out vec4 color_vs;
+out vec3 texture_coord_vs;
+
+void main ()
+{
+    gl_Position = model * vec4(position, 1.0f);
+    color_vs = tint;
+    texture_coord_vs = vec3(texture_coord, layer);
+}
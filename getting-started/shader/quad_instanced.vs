@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec2 texture_coord;
+
+// per instance, see InstanceBuffer
+layout (location = 4) in mat4 instance_model;
+layout (location = 8) in vec4 instance_color;
+layout (location = 9) in float instance_layer;
+
+out vec4 color_vs;
+out vec3 texture_coord_vs;
+
+void main ()
+{
+    gl_Position = instance_model * vec4(position, 1.0f);
+    color_vs = instance_color;
+    texture_coord_vs = vec3(texture_coord, instance_layer);
+}
@@ -5,7 +5,12 @@ in vec2 texture_coord_vs;
 
 out vec4 color;
 
-uniform float mix_ratio;
+layout (std140) uniform FrameData
+{
+    vec4 dynamic_color;
+    float mix_ratio;
+    float offset_x;
+};
 
 uniform sampler2D texture0;
 uniform sampler2D texture1;
@@ -11,8 +11,6 @@ void main ()
 {
     gl_Position = vec4(position, 1.0f);
     color_vs = color;
-
-    // little hack to fix image y-axis
-    texture_coord_vs = vec2(texture_coord.x, 1.0f - texture_coord.y);
+    texture_coord_vs = texture_coord;
 }
 
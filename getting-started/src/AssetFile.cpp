@@ -0,0 +1,179 @@
+#include "AssetFile.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*!
+ * AssetError constructor
+ *
+ * \param[in] path  The path to the asset
+ * \param[in] error The errno value of the failed call
+ */
+AssetError::AssetError (const std::string& path, int error)
+    : std::runtime_error(
+        "ERROR::ASSET::FAILED_TO_OPEN_FILE " + path + ": " + std::strerror(error)
+    )
+{
+}
+
+/*!
+ * AssetError constructor
+ *
+ * \param[in] path    The path to the asset
+ * \param[in] message What is wrong with the asset
+ */
+AssetError::AssetError (const std::string& path, const std::string& message)
+    : std::runtime_error("ERROR::ASSET::INVALID_FILE " + path + ": " + message)
+{
+}
+
+/*!
+ * AssetFile constructor, throws AssetError if the file can't be mapped
+ *
+ * \param[in] path The path to the asset
+ */
+AssetFile::AssetFile (const std::string& path)
+    : path_(path),
+      data_(nullptr),
+      size_(0)
+{
+    struct stat info;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        throw AssetError(path, errno);
+
+    if (fstat(fd, &info)) {
+        int error = errno;
+
+        close(fd);
+        throw AssetError(path, error);
+    }
+
+    size_ = info.st_size;
+
+    // mmap refuses empty mappings, an empty file is a valid empty view
+    if (size_ > 0) {
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data_ == MAP_FAILED) {
+            int error = errno;
+
+            data_ = nullptr;
+            close(fd);
+            throw AssetError(path, error);
+        }
+
+        // assets are read front to back exactly once
+        madvise(data_, size_, MADV_SEQUENTIAL);
+        madvise(data_, size_, MADV_WILLNEED);
+    }
+
+    // the mapping keeps the file alive
+    close(fd);
+}
+
+/*!
+ * AssetFile move constructor
+ *
+ * \param[in] other The file to take the mapping from
+ */
+AssetFile::AssetFile (AssetFile&& other)
+    : path_(std::move(other.path_)),
+      data_(other.data_),
+      size_(other.size_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+/*!
+ * AssetFile move assignment
+ *
+ * \param[in] other The file to take the mapping from
+ *
+ * \return This file
+ */
+AssetFile& AssetFile::operator= (AssetFile&& other)
+{
+    if (this != &other) {
+        release();
+
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    return *this;
+}
+
+/*!
+ * AssetFile destructor, unmaps the file
+ */
+AssetFile::~AssetFile ()
+{
+    release();
+}
+
+/*!
+ * Unmap the file
+ *
+ * \return void
+ */
+void AssetFile::release ()
+{
+    if (data_ != nullptr)
+        munmap(data_, size_);
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+/*!
+ * Get the content as characters
+ *
+ * \return The mapped content
+ */
+const char* AssetFile::getData () const
+{
+    return static_cast<const char*>(data_);
+}
+
+/*!
+ * Get the content as bytes
+ *
+ * \return The mapped content
+ */
+const unsigned char* AssetFile::getBytes () const
+{
+    return static_cast<const unsigned char*>(data_);
+}
+
+/*!
+ * Get the size of the content
+ *
+ * \return The size, in bytes
+ */
+std::size_t AssetFile::getSize () const
+{
+    return size_;
+}
+
+/*!
+ * Get the path to the asset
+ *
+ * \return The path
+ */
+const std::string& AssetFile::getPath () const
+{
+    return path_;
+}
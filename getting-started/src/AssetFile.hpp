@@ -0,0 +1,130 @@
+/*!
+ * \file  AssetFile.hpp
+ * \brief Class definition to map asset files in memory and hand out read-only
+ *        views of their content
+ */
+
+#ifndef __ASSET_FILE_HPP
+#define __ASSET_FILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+//! AssetError
+/*!
+ * AssetError is thrown when an asset file can't be opened, mapped or parsed
+ */
+class AssetError : public std::runtime_error
+{
+ public:
+    /*!
+     * AssetError constructor
+     *
+     * \param[in] path  The path to the asset
+     * \param[in] error The errno value of the failed call
+     */
+    AssetError (const std::string& path, int error);
+
+    /*!
+     * AssetError constructor
+     *
+     * \param[in] path    The path to the asset
+     * \param[in] message What is wrong with the asset
+     */
+    AssetError (const std::string& path, const std::string& message);
+};
+
+//! AssetFile
+/*!
+ * AssetFile maps a whole file read-only with mmap. The content is never
+ * copied to the heap, callers get a pointer and a length that stay valid
+ * until the AssetFile is destroyed. The content is not NUL terminated.
+ */
+class AssetFile
+{
+ private:
+    /*!
+     * The path to the asset
+     */
+    std::string path_;
+
+    /*!
+     * The mapped content, nullptr for an empty file
+     */
+    void* data_;
+
+    /*!
+     * The size of the file, in bytes
+     */
+    std::size_t size_;
+
+    /*!
+     * Unmap the file
+     *
+     * \return void
+     */
+    void release ();
+
+ public:
+    /*!
+     * AssetFile constructor, throws AssetError if the file can't be mapped
+     *
+     * \param[in] path The path to the asset
+     */
+    explicit AssetFile (const std::string& path);
+
+    /*!
+     * AssetFile move constructor
+     *
+     * \param[in] other The file to take the mapping from
+     */
+    AssetFile (AssetFile&& other);
+
+    /*!
+     * AssetFile move assignment
+     *
+     * \param[in] other The file to take the mapping from
+     *
+     * \return This file
+     */
+    AssetFile& operator= (AssetFile&& other);
+
+    AssetFile (const AssetFile&) = delete;
+    AssetFile& operator= (const AssetFile&) = delete;
+
+    /*!
+     * AssetFile destructor, unmaps the file
+     */
+    ~AssetFile ();
+
+    /*!
+     * Get the content as characters
+     *
+     * \return The mapped content
+     */
+    const char* getData () const;
+
+    /*!
+     * Get the content as bytes
+     *
+     * \return The mapped content
+     */
+    const unsigned char* getBytes () const;
+
+    /*!
+     * Get the size of the content
+     *
+     * \return The size, in bytes
+     */
+    std::size_t getSize () const;
+
+    /*!
+     * Get the path to the asset
+     *
+     * \return The path
+     */
+    const std::string& getPath () const;
+};
+
+#endif // __ASSET_FILE_HPP
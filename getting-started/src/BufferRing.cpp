@@ -0,0 +1,190 @@
+#include "BufferRing.hpp"
+
+#include "GLState.hpp"
+
+/*!
+ * BufferRing constructor
+ *
+ * \param[in] target       The buffer target, GL_UNIFORM_BUFFER,
+ *                         GL_ARRAY_BUFFER, ...
+ * \param[in] section_size The number of bytes written per section
+ * \param[in] sections     The number of sections, 3 for triple buffering
+ * \param[in] alignment    The alignment of each section offset
+ */
+BufferRing::BufferRing (
+    GLenum target, GLsizeiptr section_size,
+    unsigned int sections, GLint alignment
+)
+    : target_(target),
+      buffer_(0),
+      section_size_(
+          ((section_size + alignment - 1) / alignment) * alignment
+      ),
+      current_(sections - 1),
+      fences_(sections, nullptr),
+      persistent_(nullptr),
+      mapped_(nullptr)
+{
+    GLsizeiptr size = section_size_ * sections;
+
+    glGenBuffers(1, &buffer_);
+    GLState::getInstance().bindBuffer(target_, buffer_);
+
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(target_, size, nullptr, flags);
+        persistent_ = static_cast<char*>(
+            glMapBufferRange(target_, 0, size, flags)
+        );
+    } else {
+        glBufferData(target_, size, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    GLState::getInstance().bindBuffer(target_, 0);
+}
+
+/*!
+ * BufferRing destructor
+ */
+BufferRing::~BufferRing ()
+{
+    for (GLsync sync : fences_) {
+        if (sync != nullptr)
+            glDeleteSync(sync);
+    }
+
+    if (persistent_ != nullptr) {
+        GLState::getInstance().bindBuffer(target_, buffer_);
+        glUnmapBuffer(target_);
+        GLState::getInstance().bindBuffer(target_, 0);
+    }
+
+    GLState::getInstance().forgetBuffer(buffer_);
+    glDeleteBuffers(1, &buffer_);
+}
+
+/*!
+ * Move to the next section and get a pointer to write it
+ *
+ * \return The first byte of the section
+ */
+void* BufferRing::acquire ()
+{
+    current_ = (current_ + 1) % fences_.size();
+
+    wait(current_);
+
+    if (persistent_ != nullptr)
+        return persistent_ + getOffset();
+
+    // the fence already guarantees the GPU is done with this range
+    GLState::getInstance().bindBuffer(target_, buffer_);
+    mapped_ = glMapBufferRange(
+        target_, getOffset(), section_size_,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+        GL_MAP_UNSYNCHRONIZED_BIT
+    );
+
+    return mapped_;
+}
+
+/*!
+ * Finish writing the current section, unmaps it in fallback mode
+ *
+ * \return void
+ */
+void BufferRing::release ()
+{
+    if (mapped_ == nullptr)
+        return;
+
+    glUnmapBuffer(target_);
+    GLState::getInstance().bindBuffer(target_, 0);
+
+    mapped_ = nullptr;
+}
+
+/*!
+ * Insert a fence after the commands reading the current section, called
+ * once the frame using it has been submitted
+ *
+ * \return void
+ */
+void BufferRing::fence ()
+{
+    if (fences_[current_] != nullptr)
+        glDeleteSync(fences_[current_]);
+
+    fences_[current_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/*!
+ * Get the buffer
+ *
+ * \return The buffer resource id
+ */
+GLuint BufferRing::getBuffer ()
+{
+    return buffer_;
+}
+
+/*!
+ * Get the offset of the current section in the buffer
+ *
+ * \return The offset, in bytes
+ */
+GLintptr BufferRing::getOffset ()
+{
+    return section_size_ * current_;
+}
+
+/*!
+ * Get the size of a section
+ *
+ * \return The size, in bytes
+ */
+GLsizeiptr BufferRing::getSectionSize ()
+{
+    return section_size_;
+}
+
+/*!
+ * Check if the buffer is mapped persistently
+ *
+ * \return True if GL_ARB_buffer_storage is used
+ */
+bool BufferRing::isPersistent ()
+{
+    return persistent_ != nullptr;
+}
+
+/*!
+ * Block until the GPU is done with a section
+ *
+ * \param[in] section The section index
+ *
+ * \return void
+ */
+void BufferRing::wait (unsigned int section)
+{
+    GLsync sync = fences_[section];
+
+    if (sync == nullptr)
+        return;
+
+    GLenum result = glClientWaitSync(sync, 0, 0);
+
+    // flush once, so the fence is guaranteed to signal, then keep waiting
+    if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED)) {
+        do {
+            result = glClientWaitSync(
+                sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000
+            );
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(sync);
+    fences_[section] = nullptr;
+}
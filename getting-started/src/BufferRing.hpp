@@ -0,0 +1,144 @@
+/*!
+ * \file  BufferRing.hpp
+ * \brief Class definition of a buffer split in sections that the CPU writes
+ *        in turn while the GPU reads the previous ones
+ */
+
+#ifndef __BUFFER_RING_HPP
+#define __BUFFER_RING_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+
+//! BufferRing
+/*!
+ * BufferRing allocates one buffer holding a number of equally sized
+ * sections. Each frame the CPU acquires the next section, waiting on the
+ * fence of the last frame that used it, so it never writes memory the GPU is
+ * still reading. With GL_ARB_buffer_storage the buffer is mapped once,
+ * persistently and coherently. Otherwise each section is mapped unsynchronized
+ * on acquire and unmapped on release.
+ */
+class BufferRing
+{
+ private:
+    /*!
+     * The target the buffer is bound to when it is created or mapped
+     */
+    GLenum target_;
+
+    /*!
+     * The buffer resource id
+     */
+    GLuint buffer_;
+
+    /*!
+     * The size of a section, rounded up to the alignment
+     */
+    GLsizeiptr section_size_;
+
+    /*!
+     * The section currently acquired
+     */
+    unsigned int current_;
+
+    /*!
+     * The fence of the last frame that used each section, 0 if none
+     */
+    std::vector<GLsync> fences_;
+
+    /*!
+     * The persistent mapping of the whole buffer, nullptr in fallback mode
+     */
+    char* persistent_;
+
+    /*!
+     * The mapping of the current section in fallback mode
+     */
+    void* mapped_;
+
+    /*!
+     * Block until the GPU is done with a section
+     *
+     * \param[in] section The section index
+     *
+     * \return void
+     */
+    void wait (unsigned int section);
+
+ public:
+    /*!
+     * BufferRing constructor
+     *
+     * \param[in] target       The buffer target, GL_UNIFORM_BUFFER,
+     *                         GL_ARRAY_BUFFER, ...
+     * \param[in] section_size The number of bytes written per section
+     * \param[in] sections     The number of sections, 3 for triple buffering
+     * \param[in] alignment    The alignment of each section offset
+     */
+    BufferRing (
+        GLenum target, GLsizeiptr section_size,
+        unsigned int sections = 3, GLint alignment = 16
+    );
+
+    BufferRing (const BufferRing&) = delete;
+    BufferRing& operator= (const BufferRing&) = delete;
+
+    /*!
+     * BufferRing destructor
+     */
+    ~BufferRing ();
+
+    /*!
+     * Move to the next section and get a pointer to write it
+     *
+     * \return The first byte of the section
+     */
+    void* acquire ();
+
+    /*!
+     * Finish writing the current section, unmaps it in fallback mode
+     *
+     * \return void
+     */
+    void release ();
+
+    /*!
+     * Insert a fence after the commands reading the current section, called
+     * once the frame using it has been submitted
+     *
+     * \return void
+     */
+    void fence ();
+
+    /*!
+     * Get the buffer
+     *
+     * \return The buffer resource id
+     */
+    GLuint getBuffer ();
+
+    /*!
+     * Get the offset of the current section in the buffer
+     *
+     * \return The offset, in bytes
+     */
+    GLintptr getOffset ();
+
+    /*!
+     * Get the size of a section
+     *
+     * \return The size, in bytes
+     */
+    GLsizeiptr getSectionSize ();
+
+    /*!
+     * Check if the buffer is mapped persistently
+     *
+     * \return True if GL_ARB_buffer_storage is used
+     */
+    bool isPersistent ();
+};
+
+#endif // __BUFFER_RING_HPP
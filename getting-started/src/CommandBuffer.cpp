@@ -0,0 +1,142 @@
+#include "CommandBuffer.hpp"
+
+#include <algorithm>
+
+#include "JobSystem.hpp"
+
+/*!
+ * Start a run, the draws pushed until the next begin() belong to it
+ *
+ * \param[in] key The key ordering the run among those of every buffer
+ *
+ * \return void
+ */
+void CommandBuffer::begin (std::uint32_t key)
+{
+    runs_.push_back({key, static_cast<std::uint32_t>(draws_.size()), 0});
+}
+
+/*!
+ * Record a draw of one instance in the current run
+ *
+ * \param[in] range The mesh
+ * \param[in] data  The per-draw data
+ *
+ * \return void
+ */
+void CommandBuffer::push (const MeshRange& range, const InstanceData& data)
+{
+    // draws pushed before any begin() get a run of their own, first
+    if (runs_.empty())
+        begin(0);
+
+    draws_.push_back({range, data});
+    ++runs_.back().count;
+}
+
+/*!
+ * Forget the draws and the runs
+ *
+ * \return void
+ */
+void CommandBuffer::clear ()
+{
+    draws_.clear();
+    runs_.clear();
+}
+
+/*!
+ * Get the draws recorded
+ *
+ * \return The draws
+ */
+const std::vector<RecordedDraw>& CommandBuffer::getDraws () const
+{
+    return draws_;
+}
+
+/*!
+ * Get the runs recorded
+ *
+ * \return The runs
+ */
+const std::vector<CommandRun>& CommandBuffer::getRuns () const
+{
+    return runs_;
+}
+
+/*!
+ * Empty every buffer, must not run while a thread records
+ *
+ * \param[in] threads The number of recording threads
+ *
+ * \return void
+ */
+void FrameCommands::reset (unsigned int threads)
+{
+    if (buffers_.size() < threads)
+        buffers_.resize(threads);
+
+    for (CommandBuffer& buffer : buffers_)
+        buffer.clear();
+}
+
+/*!
+ * Get the buffer of the calling JobSystem thread
+ *
+ * \return The buffer
+ */
+CommandBuffer& FrameCommands::getBuffer ()
+{
+    return buffers_[JobSystem::getThreadIndex()];
+}
+
+/*!
+ * Push the draws recorded into a batch, runs in key order, on the thread
+ * owning the context
+ *
+ * \param[in] batch The batch, cleared first
+ *
+ * \return void
+ */
+void FrameCommands::replay (MultiDrawBatch& batch) const
+{
+    order_.clear();
+
+    for (const CommandBuffer& buffer : buffers_) {
+        for (const CommandRun& run : buffer.getRuns())
+            order_.emplace_back(&buffer, run);
+    }
+
+    // a run per job, a few hundred at most, the draws aren't moved
+    std::sort(order_.begin(), order_.end(), [] (
+        const std::pair<const CommandBuffer*, CommandRun>& a,
+        const std::pair<const CommandBuffer*, CommandRun>& b
+    ) {
+        return a.second.key < b.second.key;
+    });
+
+    batch.clear();
+
+    for (const auto& entry : order_) {
+        const RecordedDraw* draws = entry.first->getDraws().data() + entry.second.first;
+
+        for (std::uint32_t i = 0; i < entry.second.count; ++i)
+            batch.push(draws[i].range, draws[i].data);
+    }
+}
+
+/*!
+ * Get the number of draws recorded
+ *
+ * \return The number of draws
+ */
+std::size_t FrameCommands::getSize () const
+{
+    std::size_t size = 0;
+
+    for (const CommandBuffer& buffer : buffers_)
+        size += buffer.getDraws().size();
+
+    return size;
+}
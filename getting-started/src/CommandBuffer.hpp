@@ -0,0 +1,159 @@
+/*!
+ * \file  CommandBuffer.hpp
+ * \brief Class definitions to record draws on the job threads and replay
+ *        them on the render thread
+ */
+
+#ifndef __COMMAND_BUFFER_HPP
+#define __COMMAND_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "InstanceBuffer.hpp"
+#include "MeshPool.hpp"
+#include "MultiDrawBatch.hpp"
+
+//! RecordedDraw
+/*!
+ * RecordedDraw is a MultiDrawBatch::push() call kept for later
+ */
+struct RecordedDraw
+{
+    MeshRange range;
+    InstanceData data;
+};
+
+//! CommandRun
+/*!
+ * CommandRun is a sequence of draws recorded in one go, usually by one job
+ */
+struct CommandRun
+{
+    /*!
+     * Orders the runs of every buffer at replay, typically the first item
+     * of the job's range
+     */
+    std::uint32_t key;
+
+    /*!
+     * The first draw of the run in CommandBuffer::draws_
+     */
+    std::uint32_t first;
+
+    /*!
+     * The number of draws
+     */
+    std::uint32_t count;
+};
+
+//! CommandBuffer
+/*!
+ * CommandBuffer records draws without touching GL, so any thread can fill
+ * one; a thread only writes to its own buffer. The vectors keep their
+ * capacity across frames, a steady scene records without allocating.
+ */
+class CommandBuffer
+{
+ private:
+    std::vector<RecordedDraw> draws_;
+    std::vector<CommandRun> runs_;
+
+ public:
+    /*!
+     * Start a run, the draws pushed until the next begin() belong to it
+     *
+     * \param[in] key The key ordering the run among those of every buffer
+     *
+     * \return void
+     */
+    void begin (std::uint32_t key);
+
+    /*!
+     * Record a draw of one instance in the current run
+     *
+     * \param[in] range The mesh
+     * \param[in] data  The per-draw data
+     *
+     * \return void
+     */
+    void push (const MeshRange& range, const InstanceData& data);
+
+    /*!
+     * Forget the draws and the runs
+     *
+     * \return void
+     */
+    void clear ();
+
+    /*!
+     * Get the draws recorded
+     *
+     * \return The draws
+     */
+    const std::vector<RecordedDraw>& getDraws () const;
+
+    /*!
+     * Get the runs recorded
+     *
+     * \return The runs
+     */
+    const std::vector<CommandRun>& getRuns () const;
+};
+
+//! FrameCommands
+/*!
+ * FrameCommands is a frame recorded by the job threads: one CommandBuffer
+ * per JobSystem thread, picked by JobSystem::getThreadIndex(), so the
+ * threads record without locks nor shared cache lines. replay() merges the
+ * runs by key: which thread ran which job changes from frame to frame, the
+ * order the draws reach GL doesn't.
+ */
+class FrameCommands
+{
+ private:
+    std::vector<CommandBuffer> buffers_;
+
+    /*!
+     * The runs of every buffer, sorted by replay()
+     */
+    mutable std::vector<std::pair<const CommandBuffer*, CommandRun>> order_;
+
+ public:
+    /*!
+     * Empty every buffer, must not run while a thread records
+     *
+     * \param[in] threads The number of recording threads
+     *
+     * \return void
+     */
+    void reset (unsigned int threads);
+
+    /*!
+     * Get the buffer of the calling JobSystem thread
+     *
+     * \return The buffer
+     */
+    CommandBuffer& getBuffer ();
+
+    /*!
+     * Push the draws recorded into a batch, runs in key order, on the thread
+     * owning the context
+     *
+     * \param[in] batch The batch, cleared first
+     *
+     * \return void
+     */
+    void replay (MultiDrawBatch& batch) const;
+
+    /*!
+     * Get the number of draws recorded
+     *
+     * \return The number of draws
+     */
+    std::size_t getSize () const;
+};
+
+#endif // __COMMAND_BUFFER_HPP
@@ -0,0 +1,98 @@
+#include "FrameArena.hpp"
+
+#include <cstdint>
+
+/*!
+ * FrameArena constructor
+ *
+ * \param[in] capacity The size of the main block, in bytes
+ */
+FrameArena::FrameArena (std::size_t capacity)
+    : block_(new unsigned char[capacity]),
+      capacity_(capacity),
+      used_(0),
+      overflow_bytes_(0),
+      generation_(0)
+{
+}
+
+/*!
+ * Allocate memory valid until the next reset
+ *
+ * \param[in] size      The number of bytes
+ * \param[in] alignment The alignment, a power of two
+ *
+ * \return The memory
+ */
+void* FrameArena::allocate (std::size_t size, std::size_t alignment)
+{
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block_.get());
+    std::size_t offset = ((base + used_ + alignment - 1) & ~(alignment - 1)) - base;
+
+    if (offset + size <= capacity_) {
+        used_ = offset + size;
+        return block_.get() + offset;
+    }
+
+    // the frame keeps this block until reset() folds it in the main block
+    overflow_.emplace_back(new unsigned char[size + alignment]);
+    overflow_bytes_ += size + alignment;
+
+    base = reinterpret_cast<std::uintptr_t>(overflow_.back().get());
+
+    return reinterpret_cast<void*>((base + alignment - 1) & ~(alignment - 1));
+}
+
+/*!
+ * Free every allocation, grows the main block if the frame overflowed
+ *
+ * \return void
+ */
+void FrameArena::reset ()
+{
+    if (!overflow_.empty()) {
+        std::size_t needed = used_ + overflow_bytes_;
+
+        while (capacity_ < needed)
+            capacity_ *= 2;
+
+        overflow_.clear();
+        block_.reset(new unsigned char[capacity_]);
+
+        overflow_bytes_ = 0;
+    }
+
+    used_ = 0;
+    ++generation_;
+}
+
+/*!
+ * Get the number of resets, a pointer obtained before the generation
+ * changed must not be used anymore
+ *
+ * \return The generation
+ */
+unsigned long FrameArena::getGeneration () const
+{
+    return generation_;
+}
+
+/*!
+ * Get the size of the main block
+ *
+ * \return The capacity, in bytes
+ */
+std::size_t FrameArena::getCapacity () const
+{
+    return capacity_;
+}
+
+/*!
+ * Get the bytes allocated since the last reset
+ *
+ * \return The bytes used
+ */
+std::size_t FrameArena::getUsed () const
+{
+    return used_ + overflow_bytes_;
+}
@@ -0,0 +1,127 @@
+/*!
+ * \file  FrameArena.hpp
+ * \brief Class definition of a linear allocator emptied at every frame
+ */
+
+#ifndef __FRAME_ARENA_HPP
+#define __FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//! FrameArena
+/*!
+ * FrameArena hands out memory by bumping an offset in one block and frees
+ * it all at once with reset(). Nothing is destroyed, only trivially
+ * destructible types can be allocated. When a frame needs more than the
+ * block, the extra requests get their own blocks and reset() replaces
+ * everything with a single block large enough for that frame, so once the
+ * high water mark is reached a frame does not touch the heap.
+ */
+class FrameArena
+{
+ private:
+    /*!
+     * The main block
+     */
+    std::unique_ptr<unsigned char[]> block_;
+
+    /*!
+     * The size of the main block, in bytes
+     */
+    std::size_t capacity_;
+
+    /*!
+     * The bytes used in the main block
+     */
+    std::size_t used_;
+
+    /*!
+     * The blocks allocated since the last reset because the main block was
+     * full
+     */
+    std::vector<std::unique_ptr<unsigned char[]>> overflow_;
+
+    /*!
+     * The bytes allocated in the overflow blocks
+     */
+    std::size_t overflow_bytes_;
+
+    /*!
+     * The number of resets, see getGeneration()
+     */
+    unsigned long generation_;
+
+ public:
+    /*!
+     * FrameArena constructor
+     *
+     * \param[in] capacity The size of the main block, in bytes
+     */
+    explicit FrameArena (std::size_t capacity = 1 << 20);
+
+    FrameArena (const FrameArena&) = delete;
+    FrameArena& operator= (const FrameArena&) = delete;
+
+    /*!
+     * Allocate memory valid until the next reset
+     *
+     * \param[in] size      The number of bytes
+     * \param[in] alignment The alignment, a power of two
+     *
+     * \return The memory
+     */
+    void* allocate (std::size_t size, std::size_t alignment);
+
+    /*!
+     * Allocate an array valid until the next reset, the elements are not
+     * initialized
+     *
+     * \param[in] count The number of elements
+     *
+     * \return The array
+     */
+    template <typename T>
+    T* allocate (std::size_t count)
+    {
+        static_assert(
+            std::is_trivially_destructible<T>::value,
+            "FrameArena never runs destructors"
+        );
+
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /*!
+     * Free every allocation, grows the main block if the frame overflowed
+     *
+     * \return void
+     */
+    void reset ();
+
+    /*!
+     * Get the number of resets, a pointer obtained before the generation
+     * changed must not be used anymore
+     *
+     * \return The generation
+     */
+    unsigned long getGeneration () const;
+
+    /*!
+     * Get the size of the main block
+     *
+     * \return The capacity, in bytes
+     */
+    std::size_t getCapacity () const;
+
+    /*!
+     * Get the bytes allocated since the last reset
+     *
+     * \return The bytes used
+     */
+    std::size_t getUsed () const;
+};
+
+#endif // __FRAME_ARENA_HPP
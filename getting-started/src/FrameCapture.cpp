@@ -0,0 +1,330 @@
+#include "FrameCapture.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#include <errno.h>
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "Log.hpp"
+
+namespace {
+
+// the time the fences are waited on before giving up, in nanoseconds
+const GLuint64 kFenceTimeout = 1000000000;
+
+std::string makePath (const std::string& directory, const std::string& name)
+{
+    return directory + "/" + name + ".ppm";
+}
+
+// parse the "P6 width height 255" header, return the offset of the pixels
+std::size_t parsePpmHeader (const char* data, std::size_t size, int* width, int* height)
+{
+    std::string header(data, std::min<std::size_t>(size, 64));
+    int max_value = 0;
+    int length = 0;
+
+    if (
+        (std::sscanf(header.c_str(), "P6 %d %d %d%n", width, height, &max_value, &length) != 3) ||
+        (max_value != 255)
+    ) {
+        return 0;
+    }
+
+    // a single whitespace separates the header from the pixels
+    return length + 1;
+}
+
+} // namespace
+
+/*!
+ * FrameCapture constructor, must be called with a current context
+ *
+ * \param[in] width     The frame width
+ * \param[in] height    The frame height
+ * \param[in] directory The directory the frames are written to, or empty
+ * \param[in] golden    The directory of the golden frames, or empty
+ * \param[in] tolerance The largest per channel difference accepted
+ * \param[in] buffers   The number of readbacks in flight
+ */
+FrameCapture::FrameCapture (
+    int width, int height,
+    const std::string& directory, const std::string& golden,
+    int tolerance, unsigned int buffers
+)
+    : width_(width),
+      height_(height),
+      directory_(directory),
+      golden_(golden),
+      tolerance_(tolerance),
+      pending_(buffers),
+      next_(0),
+      captured_(0),
+      mismatches_(0),
+      readback_ms_(0.0)
+{
+    if (!directory_.empty() && mkdir(directory_.c_str(), 0755) && (errno != EEXIST)) {
+        LOG_ERROR(
+            "ERROR::CAPTURE::FAILED_TO_CREATE_DIRECTORY " << directory_
+            << ": " << std::strerror(errno)
+        );
+    }
+
+    for (PendingCapture& capture : pending_) {
+        glGenBuffers(1, &capture.buffer);
+        GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, capture.buffer);
+        glBufferData(
+            GL_PIXEL_PACK_BUFFER, width_ * height_ * 4, nullptr, GL_STREAM_READ
+        );
+
+        capture.fence = 0;
+    }
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+/*!
+ * FrameCapture destructor, collects the readbacks in flight
+ */
+FrameCapture::~FrameCapture ()
+{
+    finish();
+
+    for (PendingCapture& capture : pending_) {
+        GLState::getInstance().forgetBuffer(capture.buffer);
+        glDeleteBuffers(1, &capture.buffer);
+    }
+}
+
+/*!
+ * Queue the readback of the bound read framebuffer
+ *
+ * \param[in] name The file name of the frame, without extension
+ *
+ * \return void
+ */
+void FrameCapture::capture (const std::string& name)
+{
+    PendingCapture& slot = pending_[next_];
+
+    // the ring is full, the oldest readback has had the most time to land
+    if (slot.fence != 0)
+        collect(slot);
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.name = name;
+
+    next_ = (next_ + 1) % pending_.size();
+}
+
+/*!
+ * Wait for every readback in flight and collect it
+ *
+ * \return void
+ */
+void FrameCapture::finish ()
+{
+    // oldest first, so the frames are written in order
+    for (std::size_t i = 0; i < pending_.size(); ++i) {
+        PendingCapture& capture = pending_[(next_ + i) % pending_.size()];
+
+        if (capture.fence != 0)
+            collect(capture);
+    }
+}
+
+/*!
+ * Get the number of frames that failed the golden comparison
+ *
+ * \return The number of mismatches
+ */
+unsigned int FrameCapture::getMismatches () const
+{
+    return mismatches_;
+}
+
+/*!
+ * Print the readback counters
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void FrameCapture::report (std::ostream& out) const
+{
+    double megabytes = captured_ * width_ * height_ * 4 / (1024.0 * 1024.0);
+
+    out << "Frame capture: " << captured_ << " frames, " << readback_ms_
+        << " ms in readback";
+
+    if (readback_ms_ > 0.0)
+        out << ", " << megabytes * 1000.0 / readback_ms_ << " MiB/s";
+
+    if (!golden_.empty())
+        out << ", " << mismatches_ << " golden mismatches";
+
+    out << std::endl;
+}
+
+/*!
+ * Map a readback, wait for it if needed, then write and compare it
+ *
+ * \param[in,out] capture The readback, freed on return
+ *
+ * \return void
+ */
+void FrameCapture::collect (PendingCapture& capture)
+{
+    auto start = std::chrono::steady_clock::now();
+    GLenum status = glClientWaitSync(
+        capture.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout
+    );
+
+    glDeleteSync(capture.fence);
+    capture.fence = 0;
+
+    if ((status == GL_TIMEOUT_EXPIRED) || (status == GL_WAIT_FAILED)) {
+        LOG_ERROR("ERROR::CAPTURE::READBACK_FAILED " << capture.name);
+        return;
+    }
+
+    // GL rows come bottom first with an alpha, PPM wants RGB top first
+    std::vector<unsigned char> pixels(width_ * height_ * 3);
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, capture.buffer);
+
+    const unsigned char* mapped = static_cast<const unsigned char*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, width_ * height_ * 4, GL_MAP_READ_BIT)
+    );
+
+    if (mapped != nullptr) {
+        for (int y = 0; y < height_; ++y) {
+            const unsigned char* source = mapped + (height_ - 1 - y) * width_ * 4;
+            unsigned char* target = &pixels[y * width_ * 3];
+
+            for (int x = 0; x < width_; ++x) {
+                target[x * 3 + 0] = source[x * 4 + 0];
+                target[x * 3 + 1] = source[x * 4 + 1];
+                target[x * 3 + 2] = source[x * 4 + 2];
+            }
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    GLState::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    readback_ms_ += elapsed.count();
+
+    if (mapped == nullptr) {
+        LOG_ERROR("ERROR::CAPTURE::MAP_FAILED " << capture.name);
+        return;
+    }
+
+    submit(capture.name, pixels);
+}
+
+/*!
+ * Write and compare a frame the CPU produced, a capture created with no
+ * buffers needs no context
+ *
+ * \param[in] name   The file name of the frame, without extension
+ * \param[in] pixels The frame, RGB rows top first
+ *
+ * \return void
+ */
+void FrameCapture::submit (const std::string& name, const std::vector<unsigned char>& pixels)
+{
+    ++captured_;
+
+    if (!directory_.empty()) {
+        std::string path = makePath(directory_, name);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        file << "P6\n" << width_ << " " << height_ << "\n255\n";
+        file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+
+        if (!file)
+            LOG_ERROR("ERROR::CAPTURE::FAILED_TO_WRITE " << path);
+    }
+
+    if (!golden_.empty() && !compare(name, pixels))
+        ++mismatches_;
+}
+
+/*!
+ * Compare a frame against its golden frame
+ *
+ * \param[in] name   The frame name
+ * \param[in] pixels The frame, RGB rows top first
+ *
+ * \return True if every channel is within the tolerance
+ */
+bool FrameCapture::compare (
+    const std::string& name, const std::vector<unsigned char>& pixels
+) {
+    std::string path = makePath(golden_, name);
+
+    try {
+        AssetFile file(path);
+        int width = 0;
+        int height = 0;
+        std::size_t offset = parsePpmHeader(
+            file.getData(), file.getSize(), &width, &height
+        );
+
+        if (
+            (offset == 0) || (width != width_) || (height != height_) ||
+            (file.getSize() < offset + pixels.size())
+        ) {
+            LOG_ERROR("ERROR::CAPTURE::INVALID_GOLDEN " << path);
+            return false;
+        }
+
+        const unsigned char* golden = file.getBytes() + offset;
+        unsigned int different = 0;
+        int largest = 0;
+
+        for (std::size_t i = 0; i < pixels.size(); i += 3) {
+            int difference = 0;
+
+            for (std::size_t c = 0; c < 3; ++c)
+                difference = std::max(difference, std::abs(pixels[i + c] - golden[i + c]));
+
+            if (difference > tolerance_)
+                ++different;
+
+            largest = std::max(largest, difference);
+        }
+
+        if (different > 0) {
+            LOG_ERROR(
+                "ERROR::CAPTURE::GOLDEN_MISMATCH " << name << ": "
+                << different << " pixels differ, by up to " << largest
+            );
+
+            return false;
+        }
+    } catch (const AssetError& e) {
+        LOG_ERROR(e.what());
+
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,188 @@
+/*!
+ * \file  FrameCapture.hpp
+ * \brief Class definition to read frames back through pixel pack buffers and
+ *        compare them against golden images
+ */
+
+#ifndef __FRAME_CAPTURE_HPP
+#define __FRAME_CAPTURE_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <GL/glew.h>
+
+//! PendingCapture
+/*!
+ * PendingCapture is a readback the GPU may still be writing
+ */
+struct PendingCapture
+{
+    /*!
+     * The pixel pack buffer the frame is read into
+     */
+    GLuint buffer;
+
+    /*!
+     * Signalled once the pixels are in the buffer, 0 if the slot is free
+     */
+    GLsync fence;
+
+    /*!
+     * The file name of the frame, without extension
+     */
+    std::string name;
+};
+
+//! FrameCapture
+/*!
+ * FrameCapture reads the bound read framebuffer into a ring of pixel pack
+ * buffers. glReadPixels returns as soon as the copy is queued, the buffer is
+ * mapped a few frames later when its fence has signalled, so capturing does
+ * not stall the frame loop. Each frame is written as a binary PPM and, when a
+ * golden directory is set, compared against the PPM of the same name there.
+ */
+class FrameCapture
+{
+ private:
+    /*!
+     * The frame width
+     */
+    int width_;
+
+    /*!
+     * The frame height
+     */
+    int height_;
+
+    /*!
+     * The directory the frames are written to, empty to skip writing
+     */
+    std::string directory_;
+
+    /*!
+     * The directory holding the golden frames, empty to skip the comparison
+     */
+    std::string golden_;
+
+    /*!
+     * The largest per channel difference accepted against a golden frame
+     */
+    int tolerance_;
+
+    /*!
+     * The readbacks in flight, used in turn
+     */
+    std::vector<PendingCapture> pending_;
+
+    /*!
+     * The next slot of pending_
+     */
+    std::size_t next_;
+
+    /*!
+     * The number of frames collected
+     */
+    unsigned int captured_;
+
+    /*!
+     * The number of frames that differ from their golden frame, or have none
+     */
+    unsigned int mismatches_;
+
+    /*!
+     * The time spent waiting on fences and copying out of the buffers, in ms
+     */
+    double readback_ms_;
+
+    /*!
+     * Map a readback, wait for it if needed, then write and compare it
+     *
+     * \param[in,out] capture The readback, freed on return
+     *
+     * \return void
+     */
+    void collect (PendingCapture& capture);
+
+    /*!
+     * Compare a frame against its golden frame
+     *
+     * \param[in] name   The frame name
+     * \param[in] pixels The frame, RGB rows top first
+     *
+     * \return True if every channel is within the tolerance
+     */
+    bool compare (const std::string& name, const std::vector<unsigned char>& pixels);
+
+ public:
+    /*!
+     * FrameCapture constructor, must be called with a current context
+     *
+     * \param[in] width     The frame width
+     * \param[in] height    The frame height
+     * \param[in] directory The directory the frames are written to, or empty
+     * \param[in] golden    The directory of the golden frames, or empty
+     * \param[in] tolerance The largest per channel difference accepted
+     * \param[in] buffers   The number of readbacks in flight, 0 to only
+     *                      submit() frames
+     */
+    FrameCapture (
+        int width, int height,
+        const std::string& directory, const std::string& golden,
+        int tolerance, unsigned int buffers = 3
+    );
+
+    FrameCapture (const FrameCapture&) = delete;
+    FrameCapture& operator= (const FrameCapture&) = delete;
+
+    /*!
+     * FrameCapture destructor, collects the readbacks in flight
+     */
+    ~FrameCapture ();
+
+    /*!
+     * Queue the readback of the bound read framebuffer
+     *
+     * \param[in] name The file name of the frame, without extension
+     *
+     * \return void
+     */
+    void capture (const std::string& name);
+
+    /*!
+     * Write and compare a frame the CPU produced, a capture created with no
+     * buffers needs no context
+     *
+     * \param[in] name   The file name of the frame, without extension
+     * \param[in] pixels The frame, RGB rows top first
+     *
+     * \return void
+     */
+    void submit (const std::string& name, const std::vector<unsigned char>& pixels);
+
+    /*!
+     * Wait for every readback in flight and collect it
+     *
+     * \return void
+     */
+    void finish ();
+
+    /*!
+     * Get the number of frames that failed the golden comparison
+     *
+     * \return The number of mismatches
+     */
+    unsigned int getMismatches () const;
+
+    /*!
+     * Print the readback counters
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out) const;
+};
+
+#endif // __FRAME_CAPTURE_HPP
@@ -0,0 +1,47 @@
+/*!
+ * \file  FrameData.hpp
+ * \brief Per-frame values shared by every program through the FrameData
+ *        uniform block
+ */
+
+#ifndef __FRAME_DATA_HPP
+#define __FRAME_DATA_HPP
+
+#include <GL/glew.h>
+
+#include "Std140.hpp"
+
+//! FrameData
+/*!
+ * FrameData mirrors this block, declared by the shaders that need it:
+ *
+ *     layout (std140) uniform FrameData
+ *     {
+ *         vec4 dynamic_color;
+ *         float mix_ratio;
+ *         float offset_x;
+ *     };
+ */
+struct FrameData
+{
+    /*!
+     * The color of fshader1.frag
+     */
+    Std140Vec4 dynamic_color;
+
+    /*!
+     * The blend between the two textures of texture.frag
+     */
+    GLfloat mix_ratio;
+
+    /*!
+     * The horizontal offset of move_x.vs
+     */
+    GLfloat offset_x;
+};
+
+STD140_ASSERT_OFFSET(FrameData, dynamic_color, 0);
+STD140_ASSERT_OFFSET(FrameData, mix_ratio, 16);
+STD140_ASSERT_OFFSET(FrameData, offset_x, 20);
+
+#endif // __FRAME_DATA_HPP
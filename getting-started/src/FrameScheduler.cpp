@@ -0,0 +1,198 @@
+#include "FrameScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// a frame time landing on an update, up to rounding, doesn't run one more
+const double kStepTolerance = 1e-6;
+
+double toMs (std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::chrono::steady_clock::duration toDuration (double seconds)
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds)
+    );
+}
+
+} // namespace
+
+/*!
+ * FrameScheduler constructor
+ *
+ * \param[in] update_rate The fixed updates per second, 0 to update once
+ *                        per frame
+ * \param[in] max_fps     The frame cap, 0 for no cap
+ * \param[in] spin_margin The time before a deadline spent spinning
+ *                        instead of sleeping, in seconds
+ */
+FrameScheduler::FrameScheduler (double update_rate, double max_fps, double spin_margin)
+    : step_((update_rate > 0.0) ? 1.0 / update_rate : 0.0),
+      updates_(0),
+      skipped_(0.0),
+      interval_(toDuration((max_fps > 0.0) ? 1.0 / max_fps : 0.0)),
+      spin_margin_(toDuration(spin_margin)),
+      interval_sum_(0.0),
+      interval_squares_(0.0),
+      stats_({0, 0.0, 0.0, 0.0, 0}),
+      sleep_ms_(0.0),
+      spin_ms_(0.0),
+      dropped_steps_(0)
+{
+    reset();
+}
+
+/*!
+ * Start over for a new scene
+ *
+ * \return void
+ */
+void FrameScheduler::reset ()
+{
+    updates_ = 0;
+    skipped_ = 0.0;
+
+    deadline_ = std::chrono::steady_clock::now();
+    last_frame_ = deadline_;
+
+    interval_sum_ = 0.0;
+    interval_squares_ = 0.0;
+    stats_ = {0, 0.0, 0.0, 0.0, 0};
+}
+
+/*!
+ * Get the updates of a frame
+ *
+ * \param[in] time  The seconds elapsed since the scene started
+ * \param[in] delta The seconds elapsed since the previous frame
+ *
+ * \return The updates to run
+ */
+FrameStep FrameScheduler::advance (double time, double delta)
+{
+    if (step_ <= 0.0)
+        return {1, time, delta, 1.0f};
+
+    double now = time - skipped_;
+
+    // the update k simulates the time k * step_, the last one must reach now
+    double last = std::ceil(now / step_ - kStepTolerance);
+    unsigned long long needed = static_cast<unsigned long long>(std::max(last, 0.0)) + 1;
+    unsigned long long steps = (needed > updates_) ? needed - updates_ : 0;
+
+    if (steps > kMaxSteps) {
+        unsigned long long dropped = steps - kMaxSteps;
+
+        dropped_steps_ += dropped;
+        skipped_ += dropped * step_;
+        now -= dropped * step_;
+        steps = kMaxSteps;
+    }
+
+    FrameStep step = {
+        static_cast<unsigned int>(steps), updates_ * step_, step_, 1.0f
+    };
+
+    updates_ += steps;
+
+    double behind = (updates_ - 1) * step_ - now;
+
+    step.alpha = static_cast<float>(std::min(std::max(1.0 - behind / step_, 0.0), 1.0));
+
+    return step;
+}
+
+/*!
+ * Hold the frame until its deadline, then measure the interval since
+ * the previous one; without a frame cap it only measures
+ *
+ * \return void
+ */
+void FrameScheduler::wait ()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if (interval_.count() > 0) {
+        deadline_ += interval_;
+
+        if (now >= deadline_) {
+            deadline_ = now;
+        } else {
+            // the OS wakes a sleeping thread late, the margin is spun
+            if (deadline_ - now > spin_margin_) {
+                std::this_thread::sleep_until(deadline_ - spin_margin_);
+
+                std::chrono::steady_clock::time_point woken = std::chrono::steady_clock::now();
+
+                sleep_ms_ += toMs(woken - now);
+                now = woken;
+            }
+
+            std::chrono::steady_clock::time_point spin_start = now;
+
+            while (now < deadline_) {
+                std::this_thread::yield();
+                now = std::chrono::steady_clock::now();
+            }
+
+            spin_ms_ += toMs(now - spin_start);
+        }
+    }
+
+    double interval = toMs(now - last_frame_);
+
+    last_frame_ = now;
+
+    ++stats_.intervals;
+    interval_sum_ += interval;
+    interval_squares_ += interval * interval;
+
+    stats_.average_ms = interval_sum_ / stats_.intervals;
+    stats_.jitter_ms = std::sqrt(std::max(
+        interval_squares_ / stats_.intervals - stats_.average_ms * stats_.average_ms, 0.0
+    ));
+    stats_.max_ms = std::max(stats_.max_ms, interval);
+
+    if ((interval_.count() > 0) && (interval >= toMs(interval_) + 1.0))
+        ++stats_.late;
+}
+
+/*!
+ * Get the pacing of the frames since the last reset()
+ *
+ * \return The pacing counters
+ */
+FramePacingStats FrameScheduler::getStats () const
+{
+    return stats_;
+}
+
+/*!
+ * Print the settings and the time spent waiting
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void FrameScheduler::report (std::ostream& out) const
+{
+    out << "Frame pacing: ";
+
+    if (step_ > 0.0)
+        out << 1.0 / step_ << " Hz fixed updates, " << dropped_steps_ << " dropped, ";
+    else
+        out << "one update per frame, ";
+
+    if (interval_.count() > 0)
+        out << 1000.0 / toMs(interval_) << " fps cap, ";
+    else
+        out << "no frame cap, ";
+
+    out << sleep_ms_ << " ms asleep, " << spin_ms_ << " ms spinning" << std::endl;
+}
@@ -0,0 +1,209 @@
+/*!
+ * \file  FrameScheduler.hpp
+ * \brief Class definition of the clock splitting the frame time in fixed
+ *        updates and pacing the frames to a cap
+ */
+
+#ifndef __FRAME_SCHEDULER_HPP
+#define __FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <ostream>
+
+//! FrameStep
+/*!
+ * FrameStep tells the frame loop how to advance the scene for a frame
+ */
+struct FrameStep
+{
+    /*!
+     * The number of update() calls, 0 when the frame is drawn between the
+     * same two updates as the previous one
+     */
+    unsigned int steps;
+
+    /*!
+     * The time passed to the first update(), in seconds since the scene
+     * started
+     */
+    double time;
+
+    /*!
+     * The time each update() advances the scene by, in seconds
+     */
+    double delta;
+
+    /*!
+     * Where the frame sits between the last two updates, 0 on the previous
+     * one and 1 on the last one
+     */
+    float alpha;
+};
+
+//! FramePacingStats
+/*!
+ * FramePacingStats describes the intervals between the frames of a scene,
+ * measured when FrameScheduler::wait() returns
+ */
+struct FramePacingStats
+{
+    /*!
+     * The number of intervals measured
+     */
+    unsigned int intervals;
+
+    /*!
+     * The average interval, in ms
+     */
+    double average_ms;
+
+    /*!
+     * The standard deviation of the interval, in ms
+     */
+    double jitter_ms;
+
+    /*!
+     * The longest interval, in ms
+     */
+    double max_ms;
+
+    /*!
+     * The intervals longer than the cap interval by 1 ms or more
+     */
+    unsigned int late;
+};
+
+//! FrameScheduler
+/*!
+ * FrameScheduler decouples the simulation from the frame rate, the way
+ * "Fix Your Timestep!" does. With an update rate set, advance() hands out
+ * the fixed updates needed for the last one to reach the frame time, so
+ * the frame lies between the last two states and alpha tells where: the
+ * scene interpolates, it never extrapolates nor lags a whole update behind.
+ * A slow frame runs at most kMaxSteps updates and the simulation drops the
+ * rest, so a stall doesn't snowball. Without an update rate, every frame
+ * runs one update() with the frame time, as the loop always did.
+ *
+ * With a frame cap set, wait() holds the frame until its deadline: it
+ * sleeps until a margin before it, since the OS wakes threads late, then
+ * yields until the deadline. A late frame restarts the deadlines from its
+ * end instead of rushing the next ones to catch up.
+ */
+class FrameScheduler
+{
+ private:
+    /*!
+     * The fixed updates of a frame, at most
+     */
+    static const unsigned int kMaxSteps = 5;
+
+    /*!
+     * The fixed update interval, 0 to update once per frame, in seconds
+     */
+    double step_;
+
+    /*!
+     * The fixed updates run since the scene started
+     */
+    unsigned long long updates_;
+
+    /*!
+     * The time dropped by slow frames since the scene started, the
+     * simulation lags the scene time by it
+     */
+    double skipped_;
+
+    /*!
+     * The frame cap interval, 0 for no cap
+     */
+    std::chrono::steady_clock::duration interval_;
+
+    /*!
+     * How long before the deadline wait() stops sleeping and spins
+     */
+    std::chrono::steady_clock::duration spin_margin_;
+
+    /*!
+     * The deadline of the current frame
+     */
+    std::chrono::steady_clock::time_point deadline_;
+
+    /*!
+     * When the previous wait() returned
+     */
+    std::chrono::steady_clock::time_point last_frame_;
+
+    /*!
+     * The sums of the intervals and of their squares, in ms
+     */
+    double interval_sum_;
+    double interval_squares_;
+
+    FramePacingStats stats_;
+
+    /*!
+     * The time spent sleeping and spinning in wait(), over every scene
+     */
+    double sleep_ms_;
+    double spin_ms_;
+
+    /*!
+     * The fixed updates dropped by slow frames, over every scene
+     */
+    unsigned long long dropped_steps_;
+
+ public:
+    /*!
+     * FrameScheduler constructor
+     *
+     * \param[in] update_rate The fixed updates per second, 0 to update once
+     *                        per frame
+     * \param[in] max_fps     The frame cap, 0 for no cap
+     * \param[in] spin_margin The time before a deadline spent spinning
+     *                        instead of sleeping, in seconds
+     */
+    FrameScheduler (double update_rate, double max_fps, double spin_margin = 0.001);
+
+    /*!
+     * Start over for a new scene
+     *
+     * \return void
+     */
+    void reset ();
+
+    /*!
+     * Get the updates of a frame
+     *
+     * \param[in] time  The seconds elapsed since the scene started
+     * \param[in] delta The seconds elapsed since the previous frame
+     *
+     * \return The updates to run
+     */
+    FrameStep advance (double time, double delta);
+
+    /*!
+     * Hold the frame until its deadline, then measure the interval since
+     * the previous one; without a frame cap it only measures
+     *
+     * \return void
+     */
+    void wait ();
+
+    /*!
+     * Get the pacing of the frames since the last reset()
+     *
+     * \return The pacing counters
+     */
+    FramePacingStats getStats () const;
+
+    /*!
+     * Print the settings and the time spent waiting
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out) const;
+};
+
+#endif // __FRAME_SCHEDULER_HPP
@@ -0,0 +1,417 @@
+#include "GLState.hpp"
+
+/*!
+ * GLState constructor, every binding is unknown
+ */
+GLState::GLState ()
+    : stats_({0, 0})
+{
+    invalidate();
+}
+
+/*!
+ * Get the state of the render thread context
+ *
+ * \return The state
+ */
+GLState& GLState::getInstance ()
+{
+    static GLState instance;
+
+    return instance;
+}
+
+/*!
+ * Forget every binding, for a new context or after raw GL calls
+ *
+ * \return void
+ */
+void GLState::invalidate ()
+{
+    program_ = kUnknown;
+    vertex_array_ = kUnknown;
+    active_unit_ = kUnknown;
+    polygon_mode_ = 0;
+    clear_color_known_ = false;
+
+    for (GLuint& buffer : buffers_)
+        buffer = kUnknown;
+
+    for (auto& range : uniform_ranges_)
+        range.buffer = kUnknown;
+
+    for (auto& unit : textures_) {
+        for (GLuint& texture : unit)
+            texture = kUnknown;
+    }
+}
+
+/*!
+ * glUseProgram
+ *
+ * \param[in] program The program
+ *
+ * \return void
+ */
+void GLState::useProgram (GLuint program)
+{
+    if (count(program_ != program)) {
+        glUseProgram(program);
+        program_ = program;
+    }
+}
+
+/*!
+ * glBindVertexArray
+ *
+ * \param[in] vertex_array The vertex array object
+ *
+ * \return void
+ */
+void GLState::bindVertexArray (GLuint vertex_array)
+{
+    if (count(vertex_array_ != vertex_array)) {
+        glBindVertexArray(vertex_array);
+        vertex_array_ = vertex_array;
+
+        // the element array binding comes with the vertex array
+        buffers_[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = kUnknown;
+    }
+}
+
+/*!
+ * glBindBuffer
+ *
+ * \param[in] target The buffer target
+ * \param[in] buffer The buffer
+ *
+ * \return void
+ */
+void GLState::bindBuffer (GLenum target, GLuint buffer)
+{
+    unsigned int slot = getBufferSlot(target);
+
+    if (slot == kBufferTargets) {
+        count(true);
+        glBindBuffer(target, buffer);
+    } else if (count(buffers_[slot] != buffer)) {
+        glBindBuffer(target, buffer);
+        buffers_[slot] = buffer;
+    }
+}
+
+/*!
+ * glBindBufferRange, also binds the buffer to the generic target
+ *
+ * \param[in] target The indexed buffer target
+ * \param[in] index  The binding point
+ * \param[in] buffer The buffer
+ * \param[in] offset The start of the range, in bytes
+ * \param[in] size   The length of the range, in bytes
+ *
+ * \return void
+ */
+void GLState::bindBufferRange (
+    GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size
+) {
+    unsigned int slot = getBufferSlot(target);
+
+    if ((target != GL_UNIFORM_BUFFER) || (index >= kUniformBindings)) {
+        count(true);
+        glBindBufferRange(target, index, buffer, offset, size);
+
+        if (slot != kBufferTargets)
+            buffers_[slot] = buffer;
+
+        return;
+    }
+
+    auto& range = uniform_ranges_[index];
+    bool changed = (range.buffer != buffer) || (range.offset != offset) ||
+        (range.size != size);
+
+    if (count(changed)) {
+        glBindBufferRange(target, index, buffer, offset, size);
+
+        range.buffer = buffer;
+        range.offset = offset;
+        range.size = size;
+        buffers_[slot] = buffer;
+    }
+}
+
+/*!
+ * glActiveTexture
+ *
+ * \param[in] unit The texture unit index, 0 for GL_TEXTURE0
+ *
+ * \return void
+ */
+void GLState::activeTexture (GLuint unit)
+{
+    if (count(active_unit_ != unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        active_unit_ = unit;
+    }
+}
+
+/*!
+ * glBindTexture on the active texture unit
+ *
+ * \param[in] target  The texture target
+ * \param[in] texture The texture
+ *
+ * \return void
+ */
+void GLState::bindTexture (GLenum target, GLuint texture)
+{
+    unsigned int slot = getTextureSlot(target);
+
+    if ((slot == kTextureTargets) || (active_unit_ >= kTextureUnits)) {
+        count(true);
+        glBindTexture(target, texture);
+    } else if (count(textures_[active_unit_][slot] != texture)) {
+        glBindTexture(target, texture);
+        textures_[active_unit_][slot] = texture;
+    }
+}
+
+/*!
+ * glActiveTexture then glBindTexture, both only if needed
+ *
+ * \param[in] unit    The texture unit index, 0 for GL_TEXTURE0
+ * \param[in] target  The texture target
+ * \param[in] texture The texture
+ *
+ * \return void
+ */
+void GLState::bindTextureUnit (GLuint unit, GLenum target, GLuint texture)
+{
+    unsigned int slot = getTextureSlot(target);
+
+    // the unit is only switched when the binding has to change
+    if ((unit < kTextureUnits) && (slot < kTextureTargets)) {
+        if (!count(textures_[unit][slot] != texture))
+            return;
+
+        // the call counted above is the glBindTexture
+        if (active_unit_ != unit) {
+            ++stats_.issued;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            active_unit_ = unit;
+        }
+
+        glBindTexture(target, texture);
+        textures_[unit][slot] = texture;
+
+        return;
+    }
+
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+/*!
+ * glPolygonMode of both faces
+ *
+ * \param[in] mode GL_FILL, GL_LINE or GL_POINT
+ *
+ * \return void
+ */
+void GLState::polygonMode (GLenum mode)
+{
+    if (count(polygon_mode_ != mode)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+        polygon_mode_ = mode;
+    }
+}
+
+/*!
+ * glClearColor
+ *
+ * \param[in] red   The red component
+ * \param[in] green The green component
+ * \param[in] blue  The blue component
+ * \param[in] alpha The alpha component
+ *
+ * \return void
+ */
+void GLState::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    bool changed = !clear_color_known_ ||
+        (clear_color_[0] != red) || (clear_color_[1] != green) ||
+        (clear_color_[2] != blue) || (clear_color_[3] != alpha);
+
+    if (count(changed)) {
+        glClearColor(red, green, blue, alpha);
+
+        clear_color_known_ = true;
+        clear_color_[0] = red;
+        clear_color_[1] = green;
+        clear_color_[2] = blue;
+        clear_color_[3] = alpha;
+    }
+}
+
+/*!
+ * Forget a program about to be deleted
+ *
+ * \param[in] program The program
+ *
+ * \return void
+ */
+void GLState::forgetProgram (GLuint program)
+{
+    // a program in use is only flagged for deletion, but its name may be
+    // returned by the next glCreateProgram
+    if (program_ == program)
+        program_ = kUnknown;
+}
+
+/*!
+ * Forget a vertex array object about to be deleted
+ *
+ * \param[in] vertex_array The vertex array object
+ *
+ * \return void
+ */
+void GLState::forgetVertexArray (GLuint vertex_array)
+{
+    if (vertex_array_ == vertex_array) {
+        vertex_array_ = kUnknown;
+        buffers_[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = kUnknown;
+    }
+}
+
+/*!
+ * Forget a buffer about to be deleted
+ *
+ * \param[in] buffer The buffer
+ *
+ * \return void
+ */
+void GLState::forgetBuffer (GLuint buffer)
+{
+    for (GLuint& bound : buffers_) {
+        if (bound == buffer)
+            bound = kUnknown;
+    }
+
+    for (auto& range : uniform_ranges_) {
+        if (range.buffer == buffer)
+            range.buffer = kUnknown;
+    }
+}
+
+/*!
+ * Forget a texture about to be deleted
+ *
+ * \param[in] texture The texture
+ *
+ * \return void
+ */
+void GLState::forgetTexture (GLuint texture)
+{
+    for (auto& unit : textures_) {
+        for (GLuint& bound : unit) {
+            if (bound == texture)
+                bound = kUnknown;
+        }
+    }
+}
+
+/*!
+ * Get the calls issued and filtered since the last reset
+ *
+ * \return The statistics
+ */
+GLStateStats GLState::getStats () const
+{
+    return stats_;
+}
+
+/*!
+ * Get the calls issued and filtered since the last reset and reset them
+ *
+ * \return The statistics before the reset
+ */
+GLStateStats GLState::resetStats ()
+{
+    GLStateStats stats = stats_;
+
+    stats_.issued = 0;
+    stats_.filtered = 0;
+
+    return stats;
+}
+
+/*!
+ * Get the shadow index of a buffer target
+ *
+ * \param[in] target The buffer target
+ *
+ * \return The index, kBufferTargets if the target is not shadowed
+ */
+unsigned int GLState::getBufferSlot (GLenum target)
+{
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            return 0;
+        case GL_ELEMENT_ARRAY_BUFFER:
+            return 1;
+        case GL_UNIFORM_BUFFER:
+            return 2;
+        case GL_PIXEL_PACK_BUFFER:
+            return 3;
+        case GL_PIXEL_UNPACK_BUFFER:
+            return 4;
+        case GL_COPY_READ_BUFFER:
+            return 5;
+        case GL_COPY_WRITE_BUFFER:
+            return 6;
+        case GL_DRAW_INDIRECT_BUFFER:
+            return 7;
+        default:
+            return kBufferTargets;
+    }
+}
+
+/*!
+ * Get the shadow index of a texture target
+ *
+ * \param[in] target The texture target
+ *
+ * \return The index, kTextureTargets if the target is not shadowed
+ */
+unsigned int GLState::getTextureSlot (GLenum target)
+{
+    switch (target) {
+        case GL_TEXTURE_2D:
+            return 0;
+        case GL_TEXTURE_2D_ARRAY:
+            return 1;
+        case GL_TEXTURE_CUBE_MAP:
+            return 2;
+        case GL_TEXTURE_3D:
+            return 3;
+        default:
+            return kTextureTargets;
+    }
+}
+
+/*!
+ * Count a call and tell if it must be issued
+ *
+ * \param[in] changed Whether the call changes the state
+ *
+ * \return changed
+ */
+bool GLState::count (bool changed)
+{
+    if (changed)
+        ++stats_.issued;
+    else
+        ++stats_.filtered;
+
+    return changed;
+}
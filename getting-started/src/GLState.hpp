@@ -0,0 +1,321 @@
+/*!
+ * \file  GLState.hpp
+ * \brief Class definition of a shadow copy of the GL bindings that drops the
+ *        calls which would not change anything
+ */
+
+#ifndef __GL_STATE_HPP
+#define __GL_STATE_HPP
+
+#include <GL/glew.h>
+
+//! GLStateStats
+/*!
+ * GLStateStats counts the state changes sent to the driver and filtered out
+ */
+struct GLStateStats
+{
+    /*!
+     * Number of GL calls issued
+     */
+    unsigned long issued;
+
+    /*!
+     * Number of GL calls dropped because the state already matched
+     */
+    unsigned long filtered;
+};
+
+//! GLState
+/*!
+ * GLState shadows the current program, vertex array, buffer bindings,
+ * texture units, polygon mode and clear color of the context. Every bind in
+ * the game goes through it, a call that would set the value already bound is
+ * dropped. A binding set behind its back, or by a new context, must be
+ * forgotten with invalidate(); a deleted object must be forgotten with the
+ * matching forget*() call, since GL unbinds it and may reuse its name.
+ *
+ * The element array binding belongs to the vertex array object, it is only
+ * shadowed until the next vertex array change. Texture targets other than
+ * the 2D, 2D array, cube map and 3D ones, and units or uniform bindings past
+ * the shadowed ones, are passed through.
+ */
+class GLState
+{
+ private:
+    /*!
+     * The value of a binding that is not known
+     */
+    static const GLuint kUnknown = ~0u;
+
+    /*!
+     * The number of shadowed buffer targets
+     */
+    static const unsigned int kBufferTargets = 8;
+
+    /*!
+     * The number of shadowed texture units
+     */
+    static const unsigned int kTextureUnits = 16;
+
+    /*!
+     * The number of shadowed texture targets per unit
+     */
+    static const unsigned int kTextureTargets = 4;
+
+    /*!
+     * The number of shadowed indexed uniform buffer bindings
+     */
+    static const unsigned int kUniformBindings = 16;
+
+    /*!
+     * The program in use
+     */
+    GLuint program_;
+
+    /*!
+     * The vertex array object bound
+     */
+    GLuint vertex_array_;
+
+    /*!
+     * The buffer bound to each target, see getBufferSlot()
+     */
+    GLuint buffers_[kBufferTargets];
+
+    /*!
+     * The range bound to each uniform buffer binding point
+     */
+    struct
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    } uniform_ranges_[kUniformBindings];
+
+    /*!
+     * The active texture unit, as an index
+     */
+    GLuint active_unit_;
+
+    /*!
+     * The texture bound to each target of each unit, see getTextureSlot()
+     */
+    GLuint textures_[kTextureUnits][kTextureTargets];
+
+    /*!
+     * The polygon mode of both faces, 0 when unknown
+     */
+    GLenum polygon_mode_;
+
+    /*!
+     * Whether clear_color_ holds the clear color
+     */
+    bool clear_color_known_;
+
+    /*!
+     * The clear color
+     */
+    GLfloat clear_color_[4];
+
+    /*!
+     * The calls issued and filtered since the last reset
+     */
+    GLStateStats stats_;
+
+    /*!
+     * GLState constructor, every binding is unknown
+     */
+    GLState ();
+
+    /*!
+     * Get the shadow index of a buffer target
+     *
+     * \param[in] target The buffer target
+     *
+     * \return The index, kBufferTargets if the target is not shadowed
+     */
+    static unsigned int getBufferSlot (GLenum target);
+
+    /*!
+     * Get the shadow index of a texture target
+     *
+     * \param[in] target The texture target
+     *
+     * \return The index, kTextureTargets if the target is not shadowed
+     */
+    static unsigned int getTextureSlot (GLenum target);
+
+    /*!
+     * Count a call and tell if it must be issued
+     *
+     * \param[in] changed Whether the call changes the state
+     *
+     * \return changed
+     */
+    bool count (bool changed);
+
+ public:
+    GLState (const GLState&) = delete;
+    GLState& operator= (const GLState&) = delete;
+
+    /*!
+     * Get the state of the render thread context
+     *
+     * \return The state
+     */
+    static GLState& getInstance ();
+
+    /*!
+     * Forget every binding, for a new context or after raw GL calls
+     *
+     * \return void
+     */
+    void invalidate ();
+
+    /*!
+     * glUseProgram
+     *
+     * \param[in] program The program
+     *
+     * \return void
+     */
+    void useProgram (GLuint program);
+
+    /*!
+     * glBindVertexArray
+     *
+     * \param[in] vertex_array The vertex array object
+     *
+     * \return void
+     */
+    void bindVertexArray (GLuint vertex_array);
+
+    /*!
+     * glBindBuffer
+     *
+     * \param[in] target The buffer target
+     * \param[in] buffer The buffer
+     *
+     * \return void
+     */
+    void bindBuffer (GLenum target, GLuint buffer);
+
+    /*!
+     * glBindBufferRange, also binds the buffer to the generic target
+     *
+     * \param[in] target The indexed buffer target
+     * \param[in] index  The binding point
+     * \param[in] buffer The buffer
+     * \param[in] offset The start of the range, in bytes
+     * \param[in] size   The length of the range, in bytes
+     *
+     * \return void
+     */
+    void bindBufferRange (
+        GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size
+    );
+
+    /*!
+     * glActiveTexture
+     *
+     * \param[in] unit The texture unit index, 0 for GL_TEXTURE0
+     *
+     * \return void
+     */
+    void activeTexture (GLuint unit);
+
+    /*!
+     * glBindTexture on the active texture unit
+     *
+     * \param[in] target  The texture target
+     * \param[in] texture The texture
+     *
+     * \return void
+     */
+    void bindTexture (GLenum target, GLuint texture);
+
+    /*!
+     * glActiveTexture then glBindTexture, both only if needed
+     *
+     * \param[in] unit    The texture unit index, 0 for GL_TEXTURE0
+     * \param[in] target  The texture target
+     * \param[in] texture The texture
+     *
+     * \return void
+     */
+    void bindTextureUnit (GLuint unit, GLenum target, GLuint texture);
+
+    /*!
+     * glPolygonMode of both faces
+     *
+     * \param[in] mode GL_FILL, GL_LINE or GL_POINT
+     *
+     * \return void
+     */
+    void polygonMode (GLenum mode);
+
+    /*!
+     * glClearColor
+     *
+     * \param[in] red   The red component
+     * \param[in] green The green component
+     * \param[in] blue  The blue component
+     * \param[in] alpha The alpha component
+     *
+     * \return void
+     */
+    void clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+    /*!
+     * Forget a program about to be deleted
+     *
+     * \param[in] program The program
+     *
+     * \return void
+     */
+    void forgetProgram (GLuint program);
+
+    /*!
+     * Forget a vertex array object about to be deleted
+     *
+     * \param[in] vertex_array The vertex array object
+     *
+     * \return void
+     */
+    void forgetVertexArray (GLuint vertex_array);
+
+    /*!
+     * Forget a buffer about to be deleted
+     *
+     * \param[in] buffer The buffer
+     *
+     * \return void
+     */
+    void forgetBuffer (GLuint buffer);
+
+    /*!
+     * Forget a texture about to be deleted
+     *
+     * \param[in] texture The texture
+     *
+     * \return void
+     */
+    void forgetTexture (GLuint texture);
+
+    /*!
+     * Get the calls issued and filtered since the last reset
+     *
+     * \return The statistics
+     */
+    GLStateStats getStats () const;
+
+    /*!
+     * Get the calls issued and filtered since the last reset and reset them
+     *
+     * \return The statistics before the reset
+     */
+    GLStateStats resetStats ();
+};
+
+#endif // __GL_STATE_HPP
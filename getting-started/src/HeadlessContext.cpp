@@ -0,0 +1,296 @@
+#include "HeadlessContext.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <EGL/eglext.h>
+
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace {
+
+const unsigned int kDefaultFrames = 100;
+const std::size_t kFramesInFlight = 2;
+const double kFrameTime = 1.0 / 60.0;
+
+// the error of the last EGL call, in hex like the EGL headers
+std::string getEglError ()
+{
+    char text[16];
+
+    std::snprintf(text, sizeof(text), "0x%x", static_cast<unsigned int>(eglGetError()));
+
+    return text;
+}
+
+bool hasExtension (EGLDisplay display, const char* name)
+{
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    std::size_t length = std::strlen(name);
+
+    for (const char* found = extensions; found != nullptr; found += length) {
+        found = std::strstr(found, name);
+
+        if (found == nullptr)
+            break;
+
+        // the names are separated by spaces, skip partial matches
+        bool starts = (found == extensions) || (found[-1] == ' ');
+        bool ends = (found[length] == ' ') || (found[length] == '\0');
+
+        if (starts && ends)
+            return true;
+    }
+
+    return false;
+}
+
+// the surfaceless platform needs no X nor Wayland, the default display is
+// tried when the client library does not know it
+EGLDisplay getDisplay ()
+{
+    if (hasExtension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT")
+            );
+
+        if (getPlatformDisplay != nullptr) {
+            return getPlatformDisplay(
+                EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr
+            );
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+} // namespace
+
+/*!
+ * HeadlessContext constructor, 0 frames in the options means 100
+ *
+ * \param[in] options The context options
+ */
+HeadlessContext::HeadlessContext (const RenderOptions& options)
+    : RenderContext(options),
+      display_(EGL_NO_DISPLAY),
+      context_(EGL_NO_CONTEXT),
+      framebuffer_(0),
+      color_(0),
+      depth_stencil_(0)
+{
+    if (options_.frames == 0)
+        options_.frames = kDefaultFrames;
+
+    LOG_DEBUG("Starting EGL surfaceless context, OpenGL 3.3");
+
+    display_ = getDisplay();
+
+    if ((display_ == EGL_NO_DISPLAY) || !eglInitialize(display_, nullptr, nullptr)) {
+        LOG_ERROR("ERROR::EGL::FAILED_TO_INITIALIZE " << getEglError());
+
+        display_ = EGL_NO_DISPLAY;
+        return;
+    }
+
+    if (
+        !hasExtension(display_, "EGL_KHR_surfaceless_context") ||
+        !eglBindAPI(EGL_OPENGL_API)
+    ) {
+        LOG_ERROR("ERROR::EGL::NO_SURFACELESS_OPENGL");
+        return;
+    }
+
+    // without EGL_KHR_no_config_context any config able to render GL will do,
+    // the context never draws to a surface
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+
+    if (!hasExtension(display_, "EGL_KHR_no_config_context")) {
+        const EGLint config_attributes[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        EGLint count = 0;
+
+        eglChooseConfig(display_, config_attributes, &config, 1, &count);
+
+        if (count == 0) {
+            LOG_ERROR("ERROR::EGL::NO_CONFIG");
+            return;
+        }
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attributes);
+
+    if (
+        (context_ == EGL_NO_CONTEXT) ||
+        !eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_)
+    ) {
+        LOG_ERROR("ERROR::EGL::FAILED_TO_CREATE_CONTEXT " << getEglError());
+        return;
+    }
+
+    glewExperimental = GL_TRUE;
+
+    // GLEW built for GLX reports the missing X display, the entry points are
+    // loaded all the same
+    GLenum status = glewInit();
+
+    if ((status != GLEW_OK) && (status != GLEW_ERROR_NO_GLX_DISPLAY)) {
+        LOG_ERROR("ERROR::GLEW::FAILED_TO_INITIALIZE");
+        return;
+    }
+
+    if (!createFramebuffer()) {
+        LOG_ERROR("ERROR::FRAMEBUFFER::INCOMPLETE");
+        return;
+    }
+
+    // the shadowed bindings belong to the previous context, if any
+    GLState::getInstance().invalidate();
+
+    LOG_INFO(
+        "Renderer: " << glGetString(GL_RENDERER) << " ("
+        << glGetString(GL_VERSION) << ")"
+    );
+
+    initCapture();
+}
+
+/*!
+ * HeadlessContext destructor
+ */
+HeadlessContext::~HeadlessContext ()
+{
+    if (framebuffer_ != 0) {
+        capture_.reset();
+
+        for (GLsync fence : in_flight_)
+            glDeleteSync(fence);
+
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &color_);
+        glDeleteRenderbuffers(1, &depth_stencil_);
+    }
+
+    if (context_ != EGL_NO_CONTEXT) {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display_, context_);
+    }
+
+    if (display_ != EGL_NO_DISPLAY)
+        eglTerminate(display_);
+}
+
+/*!
+ * Check if the context was created
+ *
+ * \return True if the context is current
+ */
+bool HeadlessContext::isValid () const
+{
+    return framebuffer_ != 0;
+}
+
+/*!
+ * Start a frame: bind the framebuffer object
+ *
+ * \return void
+ */
+void HeadlessContext::beginFrame ()
+{
+    startFrame();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, options_.width, options_.height);
+}
+
+/*!
+ * End a frame: capture it if due and wait for the oldest frame in flight
+ *
+ * \return void
+ */
+void HeadlessContext::endFrame ()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+
+    in_flight_.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    // throttle like a swap chain, the CPU never runs more than two frames
+    // ahead of the GPU
+    if (in_flight_.size() > kFramesInFlight) {
+        ProfileScope scope("frame_sync");
+
+        glClientWaitSync(in_flight_.front(), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(in_flight_.front());
+        in_flight_.erase(in_flight_.begin());
+    }
+
+    finishFrame();
+}
+
+/*!
+ * Get the time of the current frame, 1/60 s per frame
+ *
+ * \return The time, in seconds
+ */
+double HeadlessContext::getTime ()
+{
+    return frame_ * kFrameTime;
+}
+
+/*!
+ * Create the framebuffer object
+ *
+ * \return True if the framebuffer is complete
+ */
+bool HeadlessContext::createFramebuffer ()
+{
+    glGenFramebuffers(1, &framebuffer_);
+    glGenRenderbuffers(1, &color_);
+    glGenRenderbuffers(1, &depth_stencil_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options_.width, options_.height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, options_.width, options_.height
+    );
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_
+    );
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_stencil_
+    );
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (!complete) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &color_);
+        glDeleteRenderbuffers(1, &depth_stencil_);
+
+        framebuffer_ = 0;
+    }
+
+    glViewport(0, 0, options_.width, options_.height);
+
+    return complete;
+}
@@ -0,0 +1,106 @@
+/*!
+ * \file  HeadlessContext.hpp
+ * \brief Class definition of a RenderContext drawing offscreen through an
+ *        EGL surfaceless context
+ */
+
+#ifndef __HEADLESS_CONTEXT_HPP
+#define __HEADLESS_CONTEXT_HPP
+
+#include <vector>
+
+#include <EGL/egl.h>
+
+#include "RenderContext.hpp"
+
+//! HeadlessContext
+/*!
+ * HeadlessContext needs no display server nor GPU: it creates an OpenGL 3.3
+ * core context on the Mesa surfaceless platform, which falls back to
+ * llvmpipe, and renders into a framebuffer object. The frame loop always
+ * stops after a fixed number of frames. endFrame() keeps at most two frames
+ * in flight, as a swap chain would, so the frame times include the GPU work.
+ */
+class HeadlessContext : public RenderContext
+{
+ private:
+    /*!
+     * The EGL display
+     */
+    EGLDisplay display_;
+
+    /*!
+     * The EGL context
+     */
+    EGLContext context_;
+
+    /*!
+     * The framebuffer object the frames are drawn to
+     */
+    GLuint framebuffer_;
+
+    /*!
+     * The color renderbuffer
+     */
+    GLuint color_;
+
+    /*!
+     * The depth and stencil renderbuffer
+     */
+    GLuint depth_stencil_;
+
+    /*!
+     * The fences of the frames in flight, oldest first
+     */
+    std::vector<GLsync> in_flight_;
+
+    /*!
+     * Create the framebuffer object
+     *
+     * \return True if the framebuffer is complete
+     */
+    bool createFramebuffer ();
+
+ public:
+    /*!
+     * HeadlessContext constructor, 0 frames in the options means 100
+     *
+     * \param[in] options The context options
+     */
+    explicit HeadlessContext (const RenderOptions& options);
+
+    /*!
+     * HeadlessContext destructor
+     */
+    ~HeadlessContext ();
+
+    /*!
+     * Check if the context was created
+     *
+     * \return True if the context is current
+     */
+    bool isValid () const override;
+
+    /*!
+     * Start a frame: bind the framebuffer object
+     *
+     * \return void
+     */
+    void beginFrame () override;
+
+    /*!
+     * End a frame: capture it if due and wait for the oldest frame in flight
+     *
+     * \return void
+     */
+    void endFrame () override;
+
+    /*!
+     * Get the time of the current frame, 1/60 s per frame
+     *
+     * \return The time, in seconds
+     */
+    double getTime () override;
+};
+
+#endif // __HEADLESS_CONTEXT_HPP
@@ -0,0 +1,1309 @@
+#include "ImageKernels.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int kKaiserTaps = 8;
+const float kInv255 = 1.0f / 255.0f;
+
+// linear values are quantized to 12 bits before the sRGB lookup, the result
+// is at most one off the exact 8 bit encoding and round trips every byte
+const int kLinearSteps = 4096;
+
+// float outputs of this size or more don't fit in the caches, the
+// conversions write them around the caches instead of reading every line
+// in just to overwrite it
+const std::size_t kStreamBytes = 4 << 20;
+
+/*
+ * Lookup tables
+ */
+
+struct SrgbTables
+{
+    float to_linear[256];
+    int to_srgb[kLinearSteps];
+
+    SrgbTables ()
+    {
+        for (int i = 0; i < 256; ++i) {
+            double value = i / 255.0;
+
+            to_linear[i] = static_cast<float>(
+                (value <= 0.04045) ?
+                value / 12.92 :
+                std::pow((value + 0.055) / 1.055, 2.4)
+            );
+        }
+
+        for (int i = 0; i < kLinearSteps; ++i) {
+            double value = i / static_cast<double>(kLinearSteps - 1);
+
+            value = (value <= 0.0031308) ?
+                value * 12.92 :
+                1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+
+            to_srgb[i] = static_cast<int>(value * 255.0 + 0.5);
+        }
+    }
+};
+
+const SrgbTables& getSrgbTables ()
+{
+    static const SrgbTables tables;
+
+    return tables;
+}
+
+// 2x decimation filter, the taps sit at -3.5 .. 3.5 source pixels from the
+// center of the output pixel
+struct KaiserWeights
+{
+    float taps[kKaiserTaps];
+
+    KaiserWeights ()
+    {
+        const double pi = 3.14159265358979323846;
+        const double beta = 4.0;
+        const double radius = kKaiserTaps / 2;
+        double sum = 0.0;
+        double weights[kKaiserTaps];
+
+        for (int k = 0; k < kKaiserTaps; ++k) {
+            double distance = k - (kKaiserTaps / 2 - 0.5);
+            double x = distance / 2.0;
+            double sinc = std::sin(pi * x) / (pi * x);
+            double ratio = distance / radius;
+
+            weights[k] = sinc * bessel(beta * std::sqrt(1.0 - ratio * ratio)) /
+                bessel(beta);
+            sum += weights[k];
+        }
+
+        for (int k = 0; k < kKaiserTaps; ++k)
+            taps[k] = static_cast<float>(weights[k] / sum);
+    }
+
+    // modified Bessel function of the first kind, order 0
+    static double bessel (double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+};
+
+const KaiserWeights& getKaiserWeights ()
+{
+    static const KaiserWeights weights;
+
+    return weights;
+}
+
+// source offsets of the taps of each output pixel, clamped to the edges
+std::vector<int> makeKaiserOffsets (int size, int target_size, int stride)
+{
+    std::vector<int> offsets(target_size * kKaiserTaps);
+
+    for (int x = 0; x < target_size; ++x) {
+        for (int k = 0; k < kKaiserTaps; ++k) {
+            int source = std::min(
+                std::max(x * 2 - (kKaiserTaps / 2 - 1) + k, 0), size - 1
+            );
+
+            offsets[x * kKaiserTaps + k] = source * stride;
+        }
+    }
+
+    return offsets;
+}
+
+SimdLevel detectLevel ()
+{
+#ifdef IMAGE_KERNELS_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::Avx2;
+
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::Sse2;
+#endif
+
+    return SimdLevel::Scalar;
+}
+
+SimdLevel& getActiveLevel ()
+{
+    static SimdLevel level = ImageKernels::getSupportedLevel();
+
+    return level;
+}
+
+/*
+ * Scalar kernels, also used for the edges the vector kernels leave
+ */
+
+void expandScalar (const unsigned char* source, unsigned char* target, std::size_t pixels)
+{
+    for (std::size_t i = 0; i < pixels; ++i) {
+        target[i * 4 + 0] = source[i * 3 + 0];
+        target[i * 4 + 1] = source[i * 3 + 1];
+        target[i * 4 + 2] = source[i * 3 + 2];
+        target[i * 4 + 3] = 255;
+    }
+}
+
+void swapScalar (unsigned char* top, unsigned char* bottom, std::size_t bytes)
+{
+    for (std::size_t i = 0; i < bytes; ++i)
+        std::swap(top[i], bottom[i]);
+}
+
+void boxRowScalar (
+    const unsigned char* row0, const unsigned char* row1,
+    int width, int x, int target_width, unsigned char* target
+) {
+    for (; x < target_width; ++x) {
+        int x0 = std::min(x * 2, width - 1) * 4;
+        int x1 = std::min(x * 2 + 1, width - 1) * 4;
+
+        for (int c = 0; c < 4; ++c) {
+            int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+
+            target[x * 4 + c] = (sum + 2) >> 2;
+        }
+    }
+}
+
+void boxRowScalar (
+    const float* row0, const float* row1,
+    int width, int x, int target_width, float* target
+) {
+    for (; x < target_width; ++x) {
+        int x0 = std::min(x * 2, width - 1) * 4;
+        int x1 = std::min(x * 2 + 1, width - 1) * 4;
+
+        for (int c = 0; c < 4; ++c) {
+            target[x * 4 + c] =
+                ((row0[x0 + c] + row1[x0 + c]) + (row0[x1 + c] + row1[x1 + c])) *
+                0.25f;
+        }
+    }
+}
+
+void kaiserRowScalar (
+    const float* row, const int* offsets, int x, int target_width,
+    float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+
+    for (; x < target_width; ++x) {
+        for (int c = 0; c < 4; ++c) {
+            float sum = 0.0f;
+
+            for (int k = 0; k < kKaiserTaps; ++k)
+                sum += taps[k] * row[offsets[x * kKaiserTaps + k] + c];
+
+            target[x * 4 + c] = sum;
+        }
+    }
+}
+
+void kaiserColumnsScalar (
+    const float* const* rows, std::size_t i, std::size_t count, float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+
+    for (; i < count; ++i) {
+        float sum = 0.0f;
+
+        for (int k = 0; k < kKaiserTaps; ++k)
+            sum += taps[k] * rows[k][i];
+
+        target[i] = sum;
+    }
+}
+
+void srgbToLinearScalar (
+    const unsigned char* source, float* target, std::size_t i, std::size_t pixels
+) {
+    const float* table = getSrgbTables().to_linear;
+
+    for (; i < pixels; ++i) {
+        target[i * 4 + 0] = table[source[i * 4 + 0]];
+        target[i * 4 + 1] = table[source[i * 4 + 1]];
+        target[i * 4 + 2] = table[source[i * 4 + 2]];
+        target[i * 4 + 3] = source[i * 4 + 3] * kInv255;
+    }
+}
+
+int quantize (float value, float steps)
+{
+    value = std::min(std::max(value, 0.0f), 1.0f);
+
+    return static_cast<int>(value * steps + 0.5f);
+}
+
+void linearToSrgbScalar (
+    const float* source, unsigned char* target, std::size_t i, std::size_t pixels
+) {
+    const int* table = getSrgbTables().to_srgb;
+    const float steps = kLinearSteps - 1;
+
+    for (; i < pixels; ++i) {
+        target[i * 4 + 0] = table[quantize(source[i * 4 + 0], steps)];
+        target[i * 4 + 1] = table[quantize(source[i * 4 + 1], steps)];
+        target[i * 4 + 2] = table[quantize(source[i * 4 + 2], steps)];
+        target[i * 4 + 3] = quantize(source[i * 4 + 3], 255.0f);
+    }
+}
+
+void unormToFloatScalar (
+    const unsigned char* source, float* target, std::size_t i, std::size_t count
+) {
+    for (; i < count; ++i)
+        target[i] = source[i] * kInv255;
+}
+
+void floatToUnormScalar (
+    const float* source, unsigned char* target, std::size_t i, std::size_t count
+) {
+    for (; i < count; ++i)
+        target[i] = quantize(source[i], 255.0f);
+}
+
+#ifdef IMAGE_KERNELS_X86
+
+// the floats to write before target is aligned to alignment bytes
+std::size_t getAlignmentHead (const float* target, std::size_t alignment)
+{
+    std::size_t offset = reinterpret_cast<std::uintptr_t>(target) % alignment;
+
+    return (alignment - offset) % alignment / sizeof(float);
+}
+
+/*
+ * SSE2 kernels
+ */
+
+void expandSse2 (const unsigned char* source, unsigned char* target, std::size_t pixels)
+{
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    const __m128i mask0 = _mm_set_epi32(0, 0, 0, 0x00FFFFFF);
+    const __m128i mask1 = _mm_set_epi32(0, 0, 0x00FFFFFF, 0);
+    const __m128i mask2 = _mm_set_epi32(0, 0x00FFFFFF, 0, 0);
+    const __m128i mask3 = _mm_set_epi32(0x00FFFFFF, 0, 0, 0);
+    std::size_t i = 0;
+
+    // 4 pixels per step, the 16 byte load reads past the 12 it uses
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i rgb = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(source + i * 3)
+        );
+
+        // shift each pixel into its own 32 bit lane
+        __m128i rgba = _mm_or_si128(
+            _mm_or_si128(
+                _mm_and_si128(rgb, mask0),
+                _mm_and_si128(_mm_slli_si128(rgb, 1), mask1)
+            ),
+            _mm_or_si128(
+                _mm_and_si128(_mm_slli_si128(rgb, 2), mask2),
+                _mm_and_si128(_mm_slli_si128(rgb, 3), mask3)
+            )
+        );
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + i * 4),
+            _mm_or_si128(rgba, alpha)
+        );
+    }
+
+    expandScalar(source + i * 3, target + i * 4, pixels - i);
+}
+
+void swapSse2 (unsigned char* top, unsigned char* bottom, std::size_t bytes)
+{
+    std::size_t i = 0;
+
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(top + i), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + i), a);
+    }
+
+    swapScalar(top + i, bottom + i, bytes - i);
+}
+
+// sums 4 source pixels of two rows into 2 output pixels, 16 bits per channel
+__m128i boxPairSse2 (const unsigned char* row0, const unsigned char* row1)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+
+    // vertical sums of pixels 0, 1 and of pixels 2, 3
+    __m128i low = _mm_add_epi16(
+        _mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)
+    );
+    __m128i high = _mm_add_epi16(
+        _mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)
+    );
+
+    __m128i sum = _mm_add_epi16(
+        _mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high)
+    );
+
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+void boxRowSse2 (
+    const unsigned char* row0, const unsigned char* row1,
+    int width, int target_width, unsigned char* target
+) {
+    int x = 0;
+
+    for (; x + 4 <= target_width; x += 4) {
+        __m128i first = boxPairSse2(row0 + x * 8, row1 + x * 8);
+        __m128i second = boxPairSse2(row0 + x * 8 + 16, row1 + x * 8 + 16);
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + x * 4),
+            _mm_packus_epi16(first, second)
+        );
+    }
+
+    boxRowScalar(row0, row1, width, x, target_width, target);
+}
+
+void boxRowSse2 (
+    const float* row0, const float* row1,
+    int width, int target_width, float* target
+) {
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    int x = 0;
+
+    for (; x < width / 2; ++x) {
+        __m128 left = _mm_add_ps(
+            _mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row1 + x * 8)
+        );
+        __m128 right = _mm_add_ps(
+            _mm_loadu_ps(row0 + x * 8 + 4), _mm_loadu_ps(row1 + x * 8 + 4)
+        );
+
+        _mm_storeu_ps(target + x * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+    }
+
+    boxRowScalar(row0, row1, width, x, target_width, target);
+}
+
+void kaiserRowSse2 (
+    const float* row, const int* offsets, int target_width, float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+    __m128 weights[kKaiserTaps];
+
+    for (int k = 0; k < kKaiserTaps; ++k)
+        weights[k] = _mm_set1_ps(taps[k]);
+
+    for (int x = 0; x < target_width; ++x) {
+        const int* tap = offsets + x * kKaiserTaps;
+        __m128 sum = _mm_setzero_ps();
+
+        for (int k = 0; k < kKaiserTaps; ++k)
+            sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(row + tap[k])));
+
+        _mm_storeu_ps(target + x * 4, sum);
+    }
+}
+
+void kaiserColumnsSse2 (
+    const float* const* rows, std::size_t count, float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+    __m128 weights[kKaiserTaps];
+    std::size_t i = 0;
+
+    for (int k = 0; k < kKaiserTaps; ++k)
+        weights[k] = _mm_set1_ps(taps[k]);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_setzero_ps();
+
+        for (int k = 0; k < kKaiserTaps; ++k)
+            sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(rows[k] + i)));
+
+        _mm_storeu_ps(target + i, sum);
+    }
+
+    kaiserColumnsScalar(rows, i, count, target);
+}
+
+// SSE2 has no gather, the channels are looked up one by one and stored as
+// a pixel
+void srgbToLinearSse2 (const unsigned char* source, float* target, std::size_t pixels)
+{
+    const float* table = getSrgbTables().to_linear;
+    bool stream = (pixels * 4 * sizeof(float) >= kStreamBytes) &&
+        (getAlignmentHead(target, 16) == 0);
+
+    for (std::size_t i = 0; i < pixels; ++i) {
+        const unsigned char* pixel = source + i * 4;
+        __m128 value = _mm_setr_ps(
+            table[pixel[0]], table[pixel[1]], table[pixel[2]], pixel[3] * kInv255
+        );
+
+        if (stream)
+            _mm_stream_ps(target + i * 4, value);
+        else
+            _mm_storeu_ps(target + i * 4, value);
+    }
+
+    _mm_sfence();
+}
+
+// SSE2 has no gather, only the quantization and the alpha are vectorized
+void linearToSrgbSse2 (const float* source, unsigned char* target, std::size_t pixels)
+{
+    const int* table = getSrgbTables().to_srgb;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 steps = _mm_set_ps(
+        255.0f, kLinearSteps - 1, kLinearSteps - 1, kLinearSteps - 1
+    );
+    alignas(16) int indices[4];
+
+    for (std::size_t i = 0; i < pixels; ++i) {
+        __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i * 4), zero), one);
+
+        _mm_store_si128(
+            reinterpret_cast<__m128i*>(indices),
+            _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, steps), half))
+        );
+
+        target[i * 4 + 0] = table[indices[0]];
+        target[i * 4 + 1] = table[indices[1]];
+        target[i * 4 + 2] = table[indices[2]];
+        target[i * 4 + 3] = indices[3];
+    }
+}
+
+void unormToFloatSse2 (const unsigned char* source, float* target, std::size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(kInv255);
+    bool stream = count * sizeof(float) >= kStreamBytes;
+    std::size_t i = 0;
+
+    if (stream) {
+        i = getAlignmentHead(target, 16);
+        unormToFloatScalar(source, target, 0, i);
+    }
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        __m128i words[4] = {
+            _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+            _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero)
+        };
+
+        for (int j = 0; j < 4; ++j) {
+            __m128 value = _mm_mul_ps(_mm_cvtepi32_ps(words[j]), scale);
+
+            if (stream)
+                _mm_stream_ps(target + i + j * 4, value);
+            else
+                _mm_storeu_ps(target + i + j * 4, value);
+        }
+    }
+
+    _mm_sfence();
+    unormToFloatScalar(source, target, i, count);
+}
+
+__m128i quantizeSse2 (const float* source)
+{
+    __m128 value = _mm_min_ps(
+        _mm_max_ps(_mm_loadu_ps(source), _mm_setzero_ps()), _mm_set1_ps(1.0f)
+    );
+
+    return _mm_cvttps_epi32(
+        _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f))
+    );
+}
+
+void floatToUnormSse2 (const float* source, unsigned char* target, std::size_t count)
+{
+    std::size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i low = _mm_packs_epi32(
+            quantizeSse2(source + i), quantizeSse2(source + i + 4)
+        );
+        __m128i high = _mm_packs_epi32(
+            quantizeSse2(source + i + 8), quantizeSse2(source + i + 12)
+        );
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(target + i), _mm_packus_epi16(low, high)
+        );
+    }
+
+    floatToUnormScalar(source, target, i, count);
+}
+
+/*
+ * AVX2 kernels, compiled for AVX2 only and called after the CPU check
+ */
+
+#define AVX2_KERNEL __attribute__((target("avx2")))
+
+AVX2_KERNEL
+void expandAvx2 (const unsigned char* source, unsigned char* target, std::size_t pixels)
+{
+    // bytes 0-11 to the low lane and 12-23 to the high lane, then each lane
+    // spreads its 4 pixels over 16 bytes
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+    const __m256i spread = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+    std::size_t i = 0;
+
+    // 8 pixels per step, the 32 byte load reads past the 24 it uses
+    for (; i + 11 <= pixels; i += 8) {
+        __m256i rgb = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(source + i * 3)
+        );
+
+        rgb = _mm256_permutevar8x32_epi32(rgb, lanes);
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(target + i * 4),
+            _mm256_or_si256(_mm256_shuffle_epi8(rgb, spread), alpha)
+        );
+    }
+
+    expandSse2(source + i * 3, target + i * 4, pixels - i);
+}
+
+AVX2_KERNEL
+void swapAvx2 (unsigned char* top, unsigned char* bottom, std::size_t bytes)
+{
+    std::size_t i = 0;
+
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(top + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom + i));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(top + i), b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bottom + i), a);
+    }
+
+    swapSse2(top + i, bottom + i, bytes - i);
+}
+
+// sums 8 source pixels of two rows into 4 output pixels, 16 bits per
+// channel, ordered 0, 1 in the low lane and 2, 3 in the high lane
+AVX2_KERNEL
+__m256i boxQuadAvx2 (const unsigned char* row0, const unsigned char* row1)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1));
+
+    __m256i low = _mm256_add_epi16(
+        _mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero)
+    );
+    __m256i high = _mm256_add_epi16(
+        _mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero)
+    );
+
+    __m256i sum = _mm256_add_epi16(
+        _mm256_unpacklo_epi64(low, high), _mm256_unpackhi_epi64(low, high)
+    );
+
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+}
+
+AVX2_KERNEL
+void boxRowAvx2 (
+    const unsigned char* row0, const unsigned char* row1,
+    int width, int target_width, unsigned char* target
+) {
+    int x = 0;
+
+    for (; x + 8 <= target_width; x += 8) {
+        __m256i first = boxQuadAvx2(row0 + x * 8, row1 + x * 8);
+        __m256i second = boxQuadAvx2(row0 + x * 8 + 32, row1 + x * 8 + 32);
+
+        // the packed quads come out as 0 1 4 5 2 3 6 7
+        __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(first, second), _MM_SHUFFLE(3, 1, 2, 0)
+        );
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x * 4), packed);
+    }
+
+    boxRowScalar(row0, row1, width, x, target_width, target);
+}
+
+AVX2_KERNEL
+void boxRowAvx2 (
+    const float* row0, const float* row1,
+    int width, int target_width, float* target
+) {
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    int x = 0;
+
+    for (; x + 2 <= width / 2; x += 2) {
+        __m256 first = _mm256_add_ps(
+            _mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8)
+        );
+        __m256 second = _mm256_add_ps(
+            _mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8)
+        );
+
+        // left pixels of both outputs against right pixels of both outputs
+        __m256 left = _mm256_permute2f128_ps(first, second, 0x20);
+        __m256 right = _mm256_permute2f128_ps(first, second, 0x31);
+
+        _mm256_storeu_ps(
+            target + x * 4, _mm256_mul_ps(_mm256_add_ps(left, right), quarter)
+        );
+    }
+
+    boxRowScalar(row0, row1, width, x, target_width, target);
+}
+
+AVX2_KERNEL
+void kaiserRowAvx2 (
+    const float* row, const int* offsets, int target_width, float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+    __m256 weights[kKaiserTaps];
+    int x = 0;
+
+    for (int k = 0; k < kKaiserTaps; ++k)
+        weights[k] = _mm256_set1_ps(taps[k]);
+
+    // two output pixels per step, one per lane
+    for (; x + 2 <= target_width; x += 2) {
+        const int* first = offsets + x * kKaiserTaps;
+        const int* second = first + kKaiserTaps;
+        __m256 sum = _mm256_setzero_ps();
+
+        for (int k = 0; k < kKaiserTaps; ++k) {
+            __m256 pixels = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(row + first[k])),
+                _mm_loadu_ps(row + second[k]),
+                1
+            );
+
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(weights[k], pixels));
+        }
+
+        _mm256_storeu_ps(target + x * 4, sum);
+    }
+
+    kaiserRowScalar(row, offsets, x, target_width, target);
+}
+
+AVX2_KERNEL
+void kaiserColumnsAvx2 (
+    const float* const* rows, std::size_t count, float* target
+) {
+    const float* taps = getKaiserWeights().taps;
+    __m256 weights[kKaiserTaps];
+    std::size_t i = 0;
+
+    for (int k = 0; k < kKaiserTaps; ++k)
+        weights[k] = _mm256_set1_ps(taps[k]);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+
+        for (int k = 0; k < kKaiserTaps; ++k) {
+            sum = _mm256_add_ps(
+                sum, _mm256_mul_ps(weights[k], _mm256_loadu_ps(rows[k] + i))
+            );
+        }
+
+        _mm256_storeu_ps(target + i, sum);
+    }
+
+    kaiserColumnsScalar(rows, i, count, target);
+}
+
+AVX2_KERNEL
+void srgbToLinearAvx2 (const unsigned char* source, float* target, std::size_t pixels)
+{
+    const float* table = getSrgbTables().to_linear;
+    const __m256 scale = _mm256_set1_ps(kInv255);
+    bool stream = (pixels * 4 * sizeof(float) >= kStreamBytes) &&
+        (getAlignmentHead(target, 16) == 0);
+    std::size_t i = 0;
+
+    // the pairs of pixels start on a 32 byte boundary
+    if (stream) {
+        i = getAlignmentHead(target, 32) / 4;
+        srgbToLinearScalar(source, target, 0, i);
+    }
+
+    // two pixels per step, the color channels are gathered from the table
+    for (; i + 2 <= pixels; i += 2) {
+        __m256i bytes = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i * 4))
+        );
+        __m256 color = _mm256_i32gather_ps(table, bytes, 4);
+        __m256 alpha = _mm256_mul_ps(_mm256_cvtepi32_ps(bytes), scale);
+
+        __m256 value = _mm256_blend_ps(color, alpha, 0x88);
+
+        if (stream)
+            _mm256_stream_ps(target + i * 4, value);
+        else
+            _mm256_storeu_ps(target + i * 4, value);
+    }
+
+    _mm_sfence();
+    srgbToLinearScalar(source, target, i, pixels);
+}
+
+// quantizes two pixels, the color to the table steps and the alpha to 8 bits
+AVX2_KERNEL
+__m256i quantizeSrgbAvx2 (const float* source)
+{
+    const __m256 steps = _mm256_setr_ps(
+        kLinearSteps - 1, kLinearSteps - 1, kLinearSteps - 1, 255.0f,
+        kLinearSteps - 1, kLinearSteps - 1, kLinearSteps - 1, 255.0f
+    );
+    __m256 value = _mm256_min_ps(
+        _mm256_max_ps(_mm256_loadu_ps(source), _mm256_setzero_ps()),
+        _mm256_set1_ps(1.0f)
+    );
+
+    return _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(value, steps), _mm256_set1_ps(0.5f))
+    );
+}
+
+AVX2_KERNEL
+__m256i quantizeUnormAvx2 (const float* source)
+{
+    __m256 value = _mm256_min_ps(
+        _mm256_max_ps(_mm256_loadu_ps(source), _mm256_setzero_ps()),
+        _mm256_set1_ps(1.0f)
+    );
+
+    return _mm256_cvttps_epi32(
+        _mm256_add_ps(
+            _mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)
+        )
+    );
+}
+
+// packs 32 integers in [0, 255] to bytes, keeping their order
+AVX2_KERNEL
+__m256i packBytesAvx2 (__m256i a, __m256i b, __m256i c, __m256i d)
+{
+    __m256i packed = _mm256_packus_epi16(
+        _mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d)
+    );
+
+    return _mm256_permutevar8x32_epi32(
+        packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)
+    );
+}
+
+AVX2_KERNEL
+void linearToSrgbAvx2 (const float* source, unsigned char* target, std::size_t pixels)
+{
+    const int* table = getSrgbTables().to_srgb;
+    std::size_t i = 0;
+
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i encoded[4];
+
+        for (int j = 0; j < 4; ++j) {
+            __m256i indices = quantizeSrgbAvx2(source + (i + j * 2) * 4);
+            __m256i color = _mm256_i32gather_epi32(table, indices, 4);
+
+            encoded[j] = _mm256_blend_epi32(color, indices, 0x88);
+        }
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(target + i * 4),
+            packBytesAvx2(encoded[0], encoded[1], encoded[2], encoded[3])
+        );
+    }
+
+    linearToSrgbScalar(source, target, i, pixels);
+}
+
+AVX2_KERNEL
+void unormToFloatAvx2 (const unsigned char* source, float* target, std::size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(kInv255);
+    bool stream = count * sizeof(float) >= kStreamBytes;
+    std::size_t i = 0;
+
+    if (stream) {
+        i = getAlignmentHead(target, 32);
+        unormToFloatScalar(source, target, 0, i);
+    }
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i words = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i))
+        );
+        __m256 value = _mm256_mul_ps(_mm256_cvtepi32_ps(words), scale);
+
+        if (stream)
+            _mm256_stream_ps(target + i, value);
+        else
+            _mm256_storeu_ps(target + i, value);
+    }
+
+    _mm_sfence();
+    unormToFloatScalar(source, target, i, count);
+}
+
+AVX2_KERNEL
+void floatToUnormAvx2 (const float* source, unsigned char* target, std::size_t count)
+{
+    std::size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(target + i),
+            packBytesAvx2(
+                quantizeUnormAvx2(source + i),
+                quantizeUnormAvx2(source + i + 8),
+                quantizeUnormAvx2(source + i + 16),
+                quantizeUnormAvx2(source + i + 24)
+            )
+        );
+    }
+
+    floatToUnormScalar(source, target, i, count);
+}
+
+#undef AVX2_KERNEL
+
+#endif // IMAGE_KERNELS_X86
+
+} // namespace
+
+/*!
+ * Get the best level the CPU supports
+ *
+ * \return The supported level
+ */
+SimdLevel ImageKernels::getSupportedLevel ()
+{
+    static const SimdLevel level = detectLevel();
+
+    return level;
+}
+
+/*!
+ * Get the level the kernels run with
+ *
+ * \return The active level
+ */
+SimdLevel ImageKernels::getLevel ()
+{
+    return getActiveLevel();
+}
+
+/*!
+ * Force a level, used to compare the versions. Not thread safe, call it
+ * before any kernel runs on another thread.
+ *
+ * \param[in] level The level, clamped to the supported one
+ *
+ * \return The level actually set
+ */
+SimdLevel ImageKernels::setLevel (SimdLevel level)
+{
+    getActiveLevel() = std::min(level, getSupportedLevel());
+
+    return getActiveLevel();
+}
+
+/*!
+ * Get the name of a level
+ *
+ * \param[in] level The level
+ *
+ * \return "scalar", "sse2" or "avx2"
+ */
+const char* ImageKernels::getLevelName (SimdLevel level)
+{
+    switch (level) {
+        case SimdLevel::Avx2:
+            return "avx2";
+        case SimdLevel::Sse2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+/*!
+ * Expand RGB pixels to RGBA, the alpha is set to 255
+ *
+ * \param[in]  source The RGB pixels
+ * \param[out] target The RGBA pixels, must not overlap source
+ * \param[in]  pixels The number of pixels
+ *
+ * \return void
+ */
+void ImageKernels::expandRgbToRgba (
+    const unsigned char* source, unsigned char* target, std::size_t pixels
+) {
+    switch (getLevel()) {
+#ifdef IMAGE_KERNELS_X86
+        case SimdLevel::Avx2:
+            expandAvx2(source, target, pixels);
+            break;
+        case SimdLevel::Sse2:
+            expandSse2(source, target, pixels);
+            break;
+#endif
+        default:
+            expandScalar(source, target, pixels);
+    }
+}
+
+/*!
+ * Flip an image upside down, in place
+ *
+ * \param[in,out] image     The pixels
+ * \param[in]     row_bytes The size of a row, in bytes
+ * \param[in]     height    The number of rows
+ *
+ * \return void
+ */
+void ImageKernels::flipVertical (
+    unsigned char* image, std::size_t row_bytes, int height
+) {
+    SimdLevel level = getLevel();
+
+    for (int y = 0; y < height / 2; ++y) {
+        unsigned char* top = image + y * row_bytes;
+        unsigned char* bottom = image + (height - 1 - y) * row_bytes;
+
+        switch (level) {
+#ifdef IMAGE_KERNELS_X86
+            case SimdLevel::Avx2:
+                swapAvx2(top, bottom, row_bytes);
+                break;
+            case SimdLevel::Sse2:
+                swapSse2(top, bottom, row_bytes);
+                break;
+#endif
+            default:
+                swapScalar(top, bottom, row_bytes);
+        }
+    }
+}
+
+/*!
+ * Downsample a byte image with a 2x2 box filter
+ *
+ * \param[in]  source The source image
+ * \param[in]  width  The source width
+ * \param[in]  height The source height
+ * \param[out] target The downsampled image
+ *
+ * \return void
+ */
+void ImageKernels::downsampleBox (
+    const unsigned char* source, int width, int height, unsigned char* target
+) {
+    int target_width = getLevelSize(width, 1);
+    int target_height = getLevelSize(height, 1);
+    SimdLevel level = getLevel();
+
+    for (int y = 0; y < target_height; ++y) {
+        const unsigned char* row0 = source + std::min(y * 2, height - 1) * width * 4;
+        const unsigned char* row1 = source + std::min(y * 2 + 1, height - 1) * width * 4;
+        unsigned char* row = target + y * target_width * 4;
+
+        switch (level) {
+#ifdef IMAGE_KERNELS_X86
+            case SimdLevel::Avx2:
+                boxRowAvx2(row0, row1, width, target_width, row);
+                break;
+            case SimdLevel::Sse2:
+                boxRowSse2(row0, row1, width, target_width, row);
+                break;
+#endif
+            default:
+                boxRowScalar(row0, row1, width, 0, target_width, row);
+        }
+    }
+}
+
+/*!
+ * Downsample a float image with a 2x2 box filter
+ *
+ * \param[in]  source The source image
+ * \param[in]  width  The source width
+ * \param[in]  height The source height
+ * \param[out] target The downsampled image
+ *
+ * \return void
+ */
+void ImageKernels::downsampleBox (
+    const float* source, int width, int height, float* target
+) {
+    int target_width = getLevelSize(width, 1);
+    int target_height = getLevelSize(height, 1);
+    SimdLevel level = getLevel();
+
+    for (int y = 0; y < target_height; ++y) {
+        const float* row0 = source + std::min(y * 2, height - 1) * width * 4;
+        const float* row1 = source + std::min(y * 2 + 1, height - 1) * width * 4;
+        float* row = target + y * target_width * 4;
+
+        switch (level) {
+#ifdef IMAGE_KERNELS_X86
+            case SimdLevel::Avx2:
+                boxRowAvx2(row0, row1, width, target_width, row);
+                break;
+            case SimdLevel::Sse2:
+                boxRowSse2(row0, row1, width, target_width, row);
+                break;
+#endif
+            default:
+                boxRowScalar(row0, row1, width, 0, target_width, row);
+        }
+    }
+}
+
+/*!
+ * Downsample a float image with an 8 tap Kaiser windowed sinc, sharper
+ * than the box filter with less aliasing. The result is not clamped, the
+ * negative lobes can push it slightly out of [0, 1].
+ *
+ * \param[in]  source The source image
+ * \param[in]  width  The source width
+ * \param[in]  height The source height
+ * \param[out] target The downsampled image
+ *
+ * \return void
+ */
+void ImageKernels::downsampleKaiser (
+    const float* source, int width, int height, float* target
+) {
+    int target_width = getLevelSize(width, 1);
+    int target_height = getLevelSize(height, 1);
+    std::size_t row_floats = target_width * 4;
+    std::vector<int> columns = makeKaiserOffsets(width, target_width, 4);
+    std::vector<int> rows = makeKaiserOffsets(height, target_height, row_floats);
+    std::vector<float> filtered(row_floats * height);
+    SimdLevel level = getLevel();
+
+    // horizontal pass over every source row
+    for (int y = 0; y < height; ++y) {
+        const float* row = source + y * width * 4;
+        float* output = &filtered[y * row_floats];
+
+        switch (level) {
+#ifdef IMAGE_KERNELS_X86
+            case SimdLevel::Avx2:
+                kaiserRowAvx2(row, columns.data(), target_width, output);
+                break;
+            case SimdLevel::Sse2:
+                kaiserRowSse2(row, columns.data(), target_width, output);
+                break;
+#endif
+            default:
+                kaiserRowScalar(row, columns.data(), 0, target_width, output);
+        }
+    }
+
+    // vertical pass, each output row blends 8 filtered rows
+    for (int y = 0; y < target_height; ++y) {
+        const float* taps[kKaiserTaps];
+        float* output = target + y * row_floats;
+
+        for (int k = 0; k < kKaiserTaps; ++k)
+            taps[k] = &filtered[rows[y * kKaiserTaps + k]];
+
+        switch (level) {
+#ifdef IMAGE_KERNELS_X86
+            case SimdLevel::Avx2:
+                kaiserColumnsAvx2(taps, row_floats, output);
+                break;
+            case SimdLevel::Sse2:
+                kaiserColumnsSse2(taps, row_floats, output);
+                break;
+#endif
+            default:
+                kaiserColumnsScalar(taps, 0, row_floats, output);
+        }
+    }
+}
+
+/*!
+ * Convert sRGB encoded bytes to linear floats, the alpha is kept linear
+ *
+ * \param[in]  source The byte pixels
+ * \param[out] target The float pixels
+ * \param[in]  pixels The number of pixels
+ *
+ * \return void
+ */
+void ImageKernels::srgbToLinear (
+    const unsigned char* source, float* target, std::size_t pixels
+) {
+    switch (getLevel()) {
+#ifdef IMAGE_KERNELS_X86
+        case SimdLevel::Avx2:
+            srgbToLinearAvx2(source, target, pixels);
+            break;
+        case SimdLevel::Sse2:
+            srgbToLinearSse2(source, target, pixels);
+            break;
+#endif
+        default:
+            srgbToLinearScalar(source, target, 0, pixels);
+    }
+}
+
+/*!
+ * Convert linear floats to sRGB encoded bytes, the alpha is kept linear.
+ * The values are clamped to [0, 1].
+ *
+ * \param[in]  source The float pixels
+ * \param[out] target The byte pixels
+ * \param[in]  pixels The number of pixels
+ *
+ * \return void
+ */
+void ImageKernels::linearToSrgb (
+    const float* source, unsigned char* target, std::size_t pixels
+) {
+    switch (getLevel()) {
+#ifdef IMAGE_KERNELS_X86
+        case SimdLevel::Avx2:
+            linearToSrgbAvx2(source, target, pixels);
+            break;
+        case SimdLevel::Sse2:
+            linearToSrgbSse2(source, target, pixels);
+            break;
+#endif
+        default:
+            linearToSrgbScalar(source, target, 0, pixels);
+    }
+}
+
+/*!
+ * Convert bytes to floats, without any transfer function
+ *
+ * \param[in]  source The byte pixels
+ * \param[out] target The float pixels
+ * \param[in]  pixels The number of pixels
+ *
+ * \return void
+ */
+void ImageKernels::unormToFloat (
+    const unsigned char* source, float* target, std::size_t pixels
+) {
+    switch (getLevel()) {
+#ifdef IMAGE_KERNELS_X86
+        case SimdLevel::Avx2:
+            unormToFloatAvx2(source, target, pixels * 4);
+            break;
+        case SimdLevel::Sse2:
+            unormToFloatSse2(source, target, pixels * 4);
+            break;
+#endif
+        default:
+            unormToFloatScalar(source, target, 0, pixels * 4);
+    }
+}
+
+/*!
+ * Convert floats to bytes, without any transfer function. The values are
+ * clamped to [0, 1].
+ *
+ * \param[in]  source The float pixels
+ * \param[out] target The byte pixels
+ * \param[in]  pixels The number of pixels
+ *
+ * \return void
+ */
+void ImageKernels::floatToUnorm (
+    const float* source, unsigned char* target, std::size_t pixels
+) {
+    switch (getLevel()) {
+#ifdef IMAGE_KERNELS_X86
+        case SimdLevel::Avx2:
+            floatToUnormAvx2(source, target, pixels * 4);
+            break;
+        case SimdLevel::Sse2:
+            floatToUnormSse2(source, target, pixels * 4);
+            break;
+#endif
+        default:
+            floatToUnormScalar(source, target, 0, pixels * 4);
+    }
+}
+
+/*!
+ * Get the size of a level of a chain built by halving each dimension
+ *
+ * \param[in] size  The size of level 0
+ * \param[in] level The level
+ *
+ * \return The size of the level, at least 1
+ */
+int ImageKernels::getLevelSize (int size, int level)
+{
+    return std::max(1, size >> level);
+}
+
+/*!
+ * Get the number of levels down to 1x1
+ *
+ * \param[in] width  The width of level 0
+ * \param[in] height The height of level 0
+ *
+ * \return The number of levels, level 0 included
+ */
+int ImageKernels::getLevelCount (int width, int height)
+{
+    int levels = 1;
+
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+        ++levels;
+
+    return levels;
+}
@@ -0,0 +1,220 @@
+/*!
+ * \file  ImageKernels.hpp
+ * \brief Vectorized CPU image kernels used to prepare textures: channel
+ *        expansion, vertical flip, mipmap downsampling and sRGB conversion
+ */
+
+#ifndef __IMAGE_KERNELS_HPP
+#define __IMAGE_KERNELS_HPP
+
+#include <cstddef>
+
+//! SimdLevel
+/*!
+ * The instruction sets the kernels can run with, in increasing order
+ */
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+//! ImageKernels
+/*!
+ * ImageKernels holds the image processing kernels shared by TextureManager
+ * and texbake. Each kernel has a scalar version and SSE2 and AVX2 versions,
+ * the best one the CPU supports is picked at run time, so the build needs no
+ * special flags.
+ *
+ * Unless stated otherwise the images are RGBA, tightly packed, rows stored
+ * from top to bottom. Byte images are 8 bits per channel, float images hold
+ * one float per channel in [0, 1]. Downsampling halves each dimension,
+ * rounding down but never below 1, and repeats the edge pixels.
+ *
+ * The conversions to floats are bound by the memory bandwidth, the vector
+ * versions write outputs larger than the caches around them.
+ */
+class ImageKernels
+{
+ public:
+    /*!
+     * Get the best level the CPU supports
+     *
+     * \return The supported level
+     */
+    static SimdLevel getSupportedLevel ();
+
+    /*!
+     * Get the level the kernels run with
+     *
+     * \return The active level
+     */
+    static SimdLevel getLevel ();
+
+    /*!
+     * Force a level, used to compare the versions. Not thread safe, call it
+     * before any kernel runs on another thread.
+     *
+     * \param[in] level The level, clamped to the supported one
+     *
+     * \return The level actually set
+     */
+    static SimdLevel setLevel (SimdLevel level);
+
+    /*!
+     * Get the name of a level
+     *
+     * \param[in] level The level
+     *
+     * \return "scalar", "sse2" or "avx2"
+     */
+    static const char* getLevelName (SimdLevel level);
+
+    /*!
+     * Expand RGB pixels to RGBA, the alpha is set to 255
+     *
+     * \param[in]  source The RGB pixels
+     * \param[out] target The RGBA pixels, must not overlap source
+     * \param[in]  pixels The number of pixels
+     *
+     * \return void
+     */
+    static void expandRgbToRgba (
+        const unsigned char* source, unsigned char* target, std::size_t pixels
+    );
+
+    /*!
+     * Flip an image upside down, in place
+     *
+     * \param[in,out] image     The pixels
+     * \param[in]     row_bytes The size of a row, in bytes
+     * \param[in]     height    The number of rows
+     *
+     * \return void
+     */
+    static void flipVertical (
+        unsigned char* image, std::size_t row_bytes, int height
+    );
+
+    /*!
+     * Downsample a byte image with a 2x2 box filter
+     *
+     * \param[in]  source The source image
+     * \param[in]  width  The source width
+     * \param[in]  height The source height
+     * \param[out] target The downsampled image
+     *
+     * \return void
+     */
+    static void downsampleBox (
+        const unsigned char* source, int width, int height,
+        unsigned char* target
+    );
+
+    /*!
+     * Downsample a float image with a 2x2 box filter
+     *
+     * \param[in]  source The source image
+     * \param[in]  width  The source width
+     * \param[in]  height The source height
+     * \param[out] target The downsampled image
+     *
+     * \return void
+     */
+    static void downsampleBox (
+        const float* source, int width, int height, float* target
+    );
+
+    /*!
+     * Downsample a float image with an 8 tap Kaiser windowed sinc, sharper
+     * than the box filter with less aliasing. The result is not clamped, the
+     * negative lobes can push it slightly out of [0, 1].
+     *
+     * \param[in]  source The source image
+     * \param[in]  width  The source width
+     * \param[in]  height The source height
+     * \param[out] target The downsampled image
+     *
+     * \return void
+     */
+    static void downsampleKaiser (
+        const float* source, int width, int height, float* target
+    );
+
+    /*!
+     * Convert sRGB encoded bytes to linear floats, the alpha is kept linear
+     *
+     * \param[in]  source The byte pixels
+     * \param[out] target The float pixels
+     * \param[in]  pixels The number of pixels
+     *
+     * \return void
+     */
+    static void srgbToLinear (
+        const unsigned char* source, float* target, std::size_t pixels
+    );
+
+    /*!
+     * Convert linear floats to sRGB encoded bytes, the alpha is kept linear.
+     * The values are clamped to [0, 1].
+     *
+     * \param[in]  source The float pixels
+     * \param[out] target The byte pixels
+     * \param[in]  pixels The number of pixels
+     *
+     * \return void
+     */
+    static void linearToSrgb (
+        const float* source, unsigned char* target, std::size_t pixels
+    );
+
+    /*!
+     * Convert bytes to floats, without any transfer function
+     *
+     * \param[in]  source The byte pixels
+     * \param[out] target The float pixels
+     * \param[in]  pixels The number of pixels
+     *
+     * \return void
+     */
+    static void unormToFloat (
+        const unsigned char* source, float* target, std::size_t pixels
+    );
+
+    /*!
+     * Convert floats to bytes, without any transfer function. The values are
+     * clamped to [0, 1].
+     *
+     * \param[in]  source The float pixels
+     * \param[out] target The byte pixels
+     * \param[in]  pixels The number of pixels
+     *
+     * \return void
+     */
+    static void floatToUnorm (
+        const float* source, unsigned char* target, std::size_t pixels
+    );
+
+    /*!
+     * Get the size of a level of a chain built by halving each dimension
+     *
+     * \param[in] size  The size of level 0
+     * \param[in] level The level
+     *
+     * \return The size of the level, at least 1
+     */
+    static int getLevelSize (int size, int level);
+
+    /*!
+     * Get the number of levels down to 1x1
+     *
+     * \param[in] width  The width of level 0
+     * \param[in] height The height of level 0
+     *
+     * \return The number of levels, level 0 included
+     */
+    static int getLevelCount (int width, int height);
+};
+
+#endif // __IMAGE_KERNELS_HPP
@@ -0,0 +1,264 @@
+#include "InputSystem.hpp"
+
+#include <algorithm>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+namespace {
+
+// the repeats synthesized for a key in one poll, a stalled frame doesn't
+// turn into a flood of them
+const unsigned int kMaxRepeats = 4;
+
+// whether the time a is at or after b, across the wrap of the time stamps
+bool isDue (std::uint32_t a, std::uint32_t b)
+{
+    return static_cast<std::int32_t>(a - b) >= 0;
+}
+
+std::uint32_t toMicroseconds (double seconds)
+{
+    return static_cast<std::uint32_t>(std::max(seconds, 0.0) * 1e6);
+}
+
+} // namespace
+
+/*!
+ * InputSystem constructor, repeats keys held for 0.4 s every 0.05 s
+ */
+InputSystem::InputSystem ()
+    : epoch_(std::chrono::steady_clock::now()),
+      repeat_delay_us_(toMicroseconds(0.4)),
+      repeat_interval_us_(toMicroseconds(0.05)),
+      held_actions_(0),
+      dropped_(0),
+      stats_({0, 0, 0, 0, 0.0, 0.0})
+{
+}
+
+/*!
+ * Queue a key event, from the window callback
+ *
+ * \param[in] key    The GLFW key code
+ * \param[in] action GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+ * \param[in] mods   The modifier keys held down
+ *
+ * \return False if the queue is full, the event is dropped
+ */
+bool InputSystem::push (int key, int action, int mods)
+{
+    InputEvent event = {
+        getTime(),
+        static_cast<std::int16_t>(key),
+        static_cast<std::uint8_t>(action),
+        static_cast<std::uint8_t>(mods)
+    };
+
+    if (events_.push(event))
+        return true;
+
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+
+    return false;
+}
+
+/*!
+ * Drain the events queued since the previous poll
+ *
+ * \param[out] frame The frame's input
+ *
+ * \return void
+ */
+void InputSystem::poll (InputFrame& frame)
+{
+    std::uint32_t now = getTime();
+    InputEvent event;
+
+    frame.keys.clear();
+    frame.pressed = 0;
+    frame.released = 0;
+
+    while (events_.pop(event)) {
+        double latency_ms = static_cast<std::uint32_t>(now - event.time_us) / 1000.0;
+        unsigned int action = 0;
+        int key = event.key;
+
+        ++stats_.events;
+        stats_.total_latency_ms += latency_ms;
+        stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+
+        if (event.action == GLFW_REPEAT) {
+            ++stats_.os_repeats;
+            continue;
+        }
+
+        if (findAction(key, action)) {
+            std::uint32_t bit = 1u << action;
+
+            if (event.action == GLFW_PRESS) {
+                frame.pressed |= bit;
+                held_actions_ |= bit;
+            } else {
+                frame.released |= bit;
+                held_actions_ &= ~bit;
+            }
+
+            continue;
+        }
+
+        auto held = std::find_if(held_.begin(), held_.end(), [key] (const HeldKey& k) {
+            return k.key == key;
+        });
+
+        if (event.action == GLFW_PRESS) {
+            // repeats count from the press, not from the poll
+            if (held == held_.end())
+                held_.push_back({key, event.time_us + repeat_delay_us_});
+        } else if (held != held_.end()) {
+            held_.erase(held);
+        }
+
+        frame.keys.push_back({key, event.action});
+    }
+
+    if (repeat_interval_us_ > 0) {
+        for (HeldKey& held : held_) {
+            unsigned int repeats = 0;
+
+            while (isDue(now, held.next_repeat_us) && (repeats < kMaxRepeats)) {
+                frame.keys.push_back({held.key, GLFW_REPEAT});
+                held.next_repeat_us += repeat_interval_us_;
+                ++repeats;
+            }
+
+            // the repeats missed by a stall are skipped
+            if (isDue(now, held.next_repeat_us))
+                held.next_repeat_us = now + repeat_interval_us_;
+
+            stats_.repeats += repeats;
+        }
+    }
+
+    frame.held = held_actions_;
+}
+
+/*!
+ * Bind a key to an action, the key no longer reaches the scene
+ *
+ * \param[in] key    The GLFW key code
+ * \param[in] action The action, below 32
+ *
+ * \return void
+ */
+void InputSystem::bind (int key, unsigned int action)
+{
+    for (Binding& binding : bindings_) {
+        if (binding.key == key) {
+            binding.action = action;
+            return;
+        }
+    }
+
+    bindings_.push_back({key, action});
+}
+
+/*!
+ * Change the key repeat
+ *
+ * \param[in] delay    The seconds before the first repeat
+ * \param[in] interval The seconds between repeats, 0 for no repeat
+ *
+ * \return void
+ */
+void InputSystem::setRepeat (double delay, double interval)
+{
+    repeat_delay_us_ = toMicroseconds(delay);
+    repeat_interval_us_ = toMicroseconds(interval);
+}
+
+/*!
+ * Drop the queued events and forget the keys held down, for a new scene
+ *
+ * \return void
+ */
+void InputSystem::reset ()
+{
+    InputEvent event;
+
+    while (events_.pop(event))
+        continue;
+
+    held_.clear();
+    held_actions_ = 0;
+}
+
+/*!
+ * Get the counters
+ *
+ * \return The counters
+ */
+InputStats InputSystem::getStats () const
+{
+    InputStats stats = stats_;
+
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+/*!
+ * Print the counters
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void InputSystem::report (std::ostream& out) const
+{
+    InputStats stats = getStats();
+
+    out << "Input events: " << stats.events;
+
+    if (stats.events > 0) {
+        out << ", " << stats.total_latency_ms / stats.events << " ms average latency, "
+            << stats.max_latency_ms << " ms max";
+    }
+
+    out << ", " << stats.dropped << " dropped, " << stats.os_repeats
+        << " system repeats replaced by " << stats.repeats << std::endl;
+}
+
+/*!
+ * Get the time since the epoch
+ *
+ * \return The time, in us
+ */
+std::uint32_t InputSystem::getTime () const
+{
+    return static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - epoch_
+        ).count()
+    );
+}
+
+/*!
+ * Get the action bound to a key
+ *
+ * \param[in]  key    The GLFW key code
+ * \param[out] action The action
+ *
+ * \return True if the key is bound
+ */
+bool InputSystem::findAction (int key, unsigned int& action) const
+{
+    for (const Binding& binding : bindings_) {
+        if (binding.key == key) {
+            action = binding.action;
+            return true;
+        }
+    }
+
+    return false;
+}
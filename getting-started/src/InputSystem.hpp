@@ -0,0 +1,310 @@
+/*!
+ * \file  InputSystem.hpp
+ * \brief Class definition of the input queue the window callbacks fill and
+ *        the frame loop drains once per frame
+ */
+
+#ifndef __INPUT_SYSTEM_HPP
+#define __INPUT_SYSTEM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "SpscQueue.hpp"
+
+//! InputEvent
+/*!
+ * InputEvent is a key event as the callback queues it, 8 bytes so a burst
+ * fills a few cache lines
+ */
+struct InputEvent
+{
+    /*!
+     * When the callback ran, in us since the InputSystem was created,
+     * wrapping after 71 minutes
+     */
+    std::uint32_t time_us;
+
+    /*!
+     * The GLFW key code
+     */
+    std::int16_t key;
+
+    /*!
+     * GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+     */
+    std::uint8_t action;
+
+    /*!
+     * The modifier keys held down
+     */
+    std::uint8_t mods;
+};
+
+//! KeyEvent
+/*!
+ * KeyEvent is a key handed from the frame loop to the scene
+ */
+struct KeyEvent
+{
+    int key;
+    int action;
+};
+
+//! InputFrame
+/*!
+ * InputFrame is the input of one frame: the key events for the scene, in
+ * the order they happened, and the bound actions as bit masks, bit N for
+ * the action N
+ */
+struct InputFrame
+{
+    /*!
+     * The unbound keys, repeats included
+     */
+    std::vector<KeyEvent> keys;
+
+    /*!
+     * The actions whose key went down this frame
+     */
+    std::uint32_t pressed;
+
+    /*!
+     * The actions whose key went up this frame
+     */
+    std::uint32_t released;
+
+    /*!
+     * The actions whose key is down at the end of the frame
+     */
+    std::uint32_t held;
+
+    /*!
+     * Check if an action's key went down this frame
+     *
+     * \param[in] action The action
+     *
+     * \return True if it went down
+     */
+    bool isPressed (unsigned int action) const
+    {
+        return (pressed & (1u << action)) != 0;
+    }
+
+    /*!
+     * Check if an action's key is down
+     *
+     * \param[in] action The action
+     *
+     * \return True if it is down
+     */
+    bool isHeld (unsigned int action) const
+    {
+        return (held & (1u << action)) != 0;
+    }
+};
+
+//! InputStats
+/*!
+ * InputStats counts what went through an InputSystem
+ */
+struct InputStats
+{
+    /*!
+     * The events the callbacks queued
+     */
+    unsigned long events;
+
+    /*!
+     * The events lost to a full queue
+     */
+    unsigned long dropped;
+
+    /*!
+     * The repeats of the window system, replaced by the synthesized ones
+     */
+    unsigned long os_repeats;
+
+    /*!
+     * The repeats synthesized for the keys held down
+     */
+    unsigned long repeats;
+
+    /*!
+     * The sum of the time between a callback and the poll seeing it, in ms
+     */
+    double total_latency_ms;
+
+    /*!
+     * The longest time between a callback and the poll seeing it, in ms
+     */
+    double max_latency_ms;
+};
+
+//! InputSystem
+/*!
+ * InputSystem decouples the window callbacks from the frame. A callback
+ * only stamps the event and pushes it into a lock-free ring, nothing
+ * prints, allocates or touches GL there; the frame loop calls poll() once
+ * per frame and gets the frame's input as an InputFrame, which it may hand
+ * to a job.
+ *
+ * The window system's key repeat depends on the platform settings, so its
+ * repeats are dropped and poll() synthesizes GLFW_REPEAT events for the
+ * keys held down at a fixed delay and interval instead. Keys bound to an
+ * action, up to 32 of them, show up in the frame's masks instead of its
+ * key list.
+ *
+ * The time from the callback to the poll is the latency the frame loop
+ * adds to the input, its average and maximum are reported.
+ */
+class InputSystem
+{
+ private:
+    //! Binding
+    /*!
+     * Binding maps a key to an action
+     */
+    struct Binding
+    {
+        int key;
+        unsigned int action;
+    };
+
+    //! HeldKey
+    /*!
+     * HeldKey is a key down, with the time its next repeat is due
+     */
+    struct HeldKey
+    {
+        int key;
+        std::uint32_t next_repeat_us;
+    };
+
+    /*!
+     * The events from the callbacks, GLFW calls them from glfwPollEvents()
+     * but nothing here relies on it
+     */
+    SpscQueue<InputEvent, 256> events_;
+
+    /*!
+     * The time stamps are relative to this
+     */
+    std::chrono::steady_clock::time_point epoch_;
+
+    std::vector<Binding> bindings_;
+
+    std::vector<HeldKey> held_;
+
+    /*!
+     * The time before the first repeat, and between repeats, in us
+     */
+    std::uint32_t repeat_delay_us_;
+    std::uint32_t repeat_interval_us_;
+
+    /*!
+     * The actions whose key is down
+     */
+    std::uint32_t held_actions_;
+
+    /*!
+     * The events lost to a full queue, written by the callbacks
+     */
+    std::atomic<unsigned long> dropped_;
+
+    InputStats stats_;
+
+    /*!
+     * Get the time since the epoch
+     *
+     * \return The time, in us
+     */
+    std::uint32_t getTime () const;
+
+    /*!
+     * Get the action bound to a key
+     *
+     * \param[in]  key    The GLFW key code
+     * \param[out] action The action
+     *
+     * \return True if the key is bound
+     */
+    bool findAction (int key, unsigned int& action) const;
+
+ public:
+    /*!
+     * InputSystem constructor, repeats keys held for 0.4 s every 0.05 s
+     */
+    InputSystem ();
+
+    InputSystem (const InputSystem&) = delete;
+    InputSystem& operator= (const InputSystem&) = delete;
+
+    /*!
+     * Queue a key event, from the window callback
+     *
+     * \param[in] key    The GLFW key code
+     * \param[in] action GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+     * \param[in] mods   The modifier keys held down
+     *
+     * \return False if the queue is full, the event is dropped
+     */
+    bool push (int key, int action, int mods);
+
+    /*!
+     * Drain the events queued since the previous poll
+     *
+     * \param[out] frame The frame's input
+     *
+     * \return void
+     */
+    void poll (InputFrame& frame);
+
+    /*!
+     * Bind a key to an action, the key no longer reaches the scene
+     *
+     * \param[in] key    The GLFW key code
+     * \param[in] action The action, below 32
+     *
+     * \return void
+     */
+    void bind (int key, unsigned int action);
+
+    /*!
+     * Change the key repeat
+     *
+     * \param[in] delay    The seconds before the first repeat
+     * \param[in] interval The seconds between repeats, 0 for no repeat
+     *
+     * \return void
+     */
+    void setRepeat (double delay, double interval);
+
+    /*!
+     * Drop the queued events and forget the keys held down, for a new scene
+     *
+     * \return void
+     */
+    void reset ();
+
+    /*!
+     * Get the counters
+     *
+     * \return The counters
+     */
+    InputStats getStats () const;
+
+    /*!
+     * Print the counters
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out) const;
+};
+
+#endif // __INPUT_SYSTEM_HPP
@@ -0,0 +1,257 @@
+#include "InstanceBuffer.hpp"
+
+#include <cstddef>
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+
+/*!
+ * InstanceBuffer constructor, must be called with a current context
+ *
+ * \param[in] capacity The number of instances allocated up front
+ */
+InstanceBuffer::InstanceBuffer (GLsizei capacity)
+    : vbo_(0),
+      capacity_(capacity),
+      size_(0)
+{
+    GLState& state = GLState::getInstance();
+
+    glGenBuffers(1, &vbo_);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(
+        GL_ARRAY_BUFFER, capacity_ * sizeof(InstanceData), nullptr, GL_STREAM_DRAW
+    );
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/*!
+ * InstanceBuffer destructor
+ */
+InstanceBuffer::~InstanceBuffer ()
+{
+    GLState::getInstance().forgetBuffer(vbo_);
+
+    glDeleteBuffers(1, &vbo_);
+}
+
+/*!
+ * Add the instance attributes to the vertex array of a mesh, once
+ *
+ * \param[in] mesh The mesh
+ *
+ * \return void
+ */
+void InstanceBuffer::attach (const Mesh& mesh)
+{
+    attach(mesh.getVertexArray());
+}
+
+/*!
+ * Add the instance attributes to a vertex array, or move them when the
+ * vertex array already has them
+ *
+ * \param[in] vertex_array   The vertex array object
+ * \param[in] first_instance The instance read by the first instance of
+ *                           a draw, for drivers without base instances
+ *
+ * \return void
+ */
+void InstanceBuffer::attach (GLuint vertex_array, GLuint first_instance)
+{
+    struct Attribute
+    {
+        GLint size;
+        std::size_t offset;
+    };
+
+    // a mat4 attribute takes a location per column
+    const Attribute attributes[] = {
+        {4, offsetof(InstanceData, model)},
+        {4, offsetof(InstanceData, model) + 4 * sizeof(GLfloat)},
+        {4, offsetof(InstanceData, model) + 8 * sizeof(GLfloat)},
+        {4, offsetof(InstanceData, model) + 12 * sizeof(GLfloat)},
+        {4, offsetof(InstanceData, color)},
+        {1, offsetof(InstanceData, layer)}
+    };
+
+    GLState& state = GLState::getInstance();
+
+    state.bindVertexArray(vertex_array);
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+
+    std::size_t base = first_instance * sizeof(InstanceData);
+    GLuint location = kFirstLocation;
+
+    for (const Attribute& attribute : attributes) {
+        glVertexAttribPointer(
+            location,
+            attribute.size,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(InstanceData),
+            reinterpret_cast<GLvoid*>(base + attribute.offset)
+        );
+        glEnableVertexAttribArray(location);
+
+        // one value per instance instead of one per vertex
+        glVertexAttribDivisor(location, 1);
+
+        ++location;
+    }
+
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+    state.bindVertexArray(0);
+}
+
+/*!
+ * Replace the instances, the previous storage is orphaned so the draws
+ * still reading it do not stall the upload
+ *
+ * \param[in] instances The instances
+ * \param[in] count     The number of instances
+ *
+ * \return void
+ */
+void InstanceBuffer::update (const InstanceData* instances, GLsizei count)
+{
+    ProfileScope scope("instance_upload");
+
+    if (count > capacity_)
+        capacity_ = count;
+
+    // the attribute pointers refer to the buffer name, reallocating the
+    // storage keeps the attached vertex arrays valid
+    GLState& state = GLState::getInstance();
+
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(
+        GL_ARRAY_BUFFER, capacity_ * sizeof(InstanceData), nullptr, GL_STREAM_DRAW
+    );
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), instances);
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    size_ = count;
+}
+
+/*!
+ * Draw every instance of a mesh attached to the buffer with the current
+ * program
+ *
+ * \param[in] mesh The mesh
+ *
+ * \return void
+ */
+void InstanceBuffer::draw (const Mesh& mesh)
+{
+    ProfileScope scope("draw_instanced", true);
+
+    GLState::getInstance().bindVertexArray(mesh.getVertexArray());
+    glDrawElementsInstanced(
+        GL_TRIANGLES, mesh.getCount(), mesh.getIndexType(), 0, size_
+    );
+}
+
+/*!
+ * Get the number of instances uploaded
+ *
+ * \return The number of instances
+ */
+GLsizei InstanceBuffer::getSize () const
+{
+    return size_;
+}
+
+/*!
+ * InstanceTransforms constructor
+ */
+InstanceTransforms::InstanceTransforms ()
+    : size_(0)
+{
+}
+
+/*!
+ * Add a transform, the batch must not be full
+ *
+ * \param[in] translation The translation
+ * \param[in] rotation    The rotation, unit length
+ * \param[in] scale       The scale along each axis
+ *
+ * \return The index of its matrix
+ */
+std::size_t InstanceTransforms::add (
+    const Vec3& translation, const Quat& rotation, const Vec3& scale
+) {
+    translations_[0][size_] = translation.x;
+    translations_[1][size_] = translation.y;
+    translations_[2][size_] = translation.z;
+
+    rotations_[0][size_] = rotation.x;
+    rotations_[1][size_] = rotation.y;
+    rotations_[2][size_] = rotation.z;
+    rotations_[3][size_] = rotation.w;
+
+    scales_[0][size_] = scale.x;
+    scales_[1][size_] = scale.y;
+    scales_[2][size_] = scale.z;
+
+    return size_++;
+}
+
+/*!
+ * Build the matrices of the transforms added
+ *
+ * \return void
+ */
+void InstanceTransforms::compose ()
+{
+    MathKernels::composeTransforms(
+        {translations_[0], translations_[1], translations_[2]},
+        {rotations_[0], rotations_[1], rotations_[2], rotations_[3]},
+        {scales_[0], scales_[1], scales_[2]},
+        models_, size_
+    );
+}
+
+/*!
+ * Get a matrix built by compose()
+ *
+ * \param[in] index The index add() returned
+ *
+ * \return The model matrix
+ */
+const Mat4& InstanceTransforms::getModel (std::size_t index) const
+{
+    return models_[index];
+}
+
+/*!
+ * Forget the transforms added
+ *
+ * \return void
+ */
+void InstanceTransforms::clear ()
+{
+    size_ = 0;
+}
+
+/*!
+ * Get the number of transforms added
+ *
+ * \return The number of transforms
+ */
+std::size_t InstanceTransforms::getSize () const
+{
+    return size_;
+}
+
+/*!
+ * Check if the batch is full
+ *
+ * \return True once kCapacity transforms were added
+ */
+bool InstanceTransforms::isFull () const
+{
+    return size_ == kCapacity;
+}
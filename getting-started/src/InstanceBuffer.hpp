@@ -0,0 +1,231 @@
+/*!
+ * \file  InstanceBuffer.hpp
+ * \brief Class definition of the per-instance attributes of instanced draws
+ */
+
+#ifndef __INSTANCE_BUFFER_HPP
+#define __INSTANCE_BUFFER_HPP
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "MathKernels.hpp"
+#include "MathTypes.hpp"
+#include "Mesh.hpp"
+
+//! InstanceData
+/*!
+ * InstanceData is what an instanced vertex shader reads for each copy of a
+ * mesh, in place of the uniforms a draw per copy would set
+ */
+struct InstanceData
+{
+    /*!
+     * The model matrix, usually built by InstanceTransforms
+     */
+    Mat4 model;
+
+    /*!
+     * The color multiplied with the texture
+     */
+    GLfloat color[4];
+
+    /*!
+     * The layer of the texture array
+     */
+    GLfloat layer;
+};
+
+//! InstanceBuffer
+/*!
+ * InstanceBuffer holds an InstanceData array in a vertex buffer. attach()
+ * adds its attributes, with a divisor of 1, to the vertex array of a mesh
+ * from kFirstLocation onwards:
+ *
+ *     layout (location = 4) in mat4 instance_model;
+ *     layout (location = 8) in vec4 instance_color;
+ *     layout (location = 9) in float instance_layer;
+ *
+ * so a single glDrawElementsInstanced() draws every copy. The mesh keeps
+ * its own attributes below kFirstLocation and can still be drawn alone.
+ */
+class InstanceBuffer
+{
+ private:
+    /*!
+     * The vertex buffer object
+     */
+    GLuint vbo_;
+
+    /*!
+     * The number of instances the buffer can hold
+     */
+    GLsizei capacity_;
+
+    /*!
+     * The number of instances uploaded
+     */
+    GLsizei size_;
+
+ public:
+    /*!
+     * The location of the first instance attribute
+     */
+    static const GLuint kFirstLocation = 4;
+
+    /*!
+     * InstanceBuffer constructor, must be called with a current context
+     *
+     * \param[in] capacity The number of instances allocated up front
+     */
+    explicit InstanceBuffer (GLsizei capacity = 1024);
+
+    InstanceBuffer (const InstanceBuffer&) = delete;
+    InstanceBuffer& operator= (const InstanceBuffer&) = delete;
+
+    /*!
+     * InstanceBuffer destructor
+     */
+    ~InstanceBuffer ();
+
+    /*!
+     * Add the instance attributes to the vertex array of a mesh, once
+     *
+     * \param[in] mesh The mesh
+     *
+     * \return void
+     */
+    void attach (const Mesh& mesh);
+
+    /*!
+     * Add the instance attributes to a vertex array, or move them when the
+     * vertex array already has them
+     *
+     * \param[in] vertex_array   The vertex array object
+     * \param[in] first_instance The instance read by the first instance of
+     *                           a draw, for drivers without base instances
+     *
+     * \return void
+     */
+    void attach (GLuint vertex_array, GLuint first_instance = 0);
+
+    /*!
+     * Replace the instances, the previous storage is orphaned so the draws
+     * still reading it do not stall the upload
+     *
+     * \param[in] instances The instances
+     * \param[in] count     The number of instances
+     *
+     * \return void
+     */
+    void update (const InstanceData* instances, GLsizei count);
+
+    /*!
+     * Draw every instance of a mesh attached to the buffer with the current
+     * program
+     *
+     * \param[in] mesh The mesh
+     *
+     * \return void
+     */
+    void draw (const Mesh& mesh);
+
+    /*!
+     * Get the number of instances uploaded
+     *
+     * \return The number of instances
+     */
+    GLsizei getSize () const;
+};
+
+//! InstanceTransforms
+/*!
+ * InstanceTransforms builds the model matrices of up to kCapacity instances
+ * at once: add() stores the translations, rotations and scales as
+ * structures of arrays, compose() turns them into matrices with
+ * MathKernels::composeTransforms. It is small enough to live on the stack
+ * of the thread filling the instances, several threads each use their own.
+ */
+class InstanceTransforms
+{
+ public:
+    /*!
+     * The number of transforms composed at once
+     */
+    static const std::size_t kCapacity = 64;
+
+ private:
+    /*!
+     * The components of the transforms added, one array per component
+     */
+    float translations_[3][kCapacity];
+    float rotations_[4][kCapacity];
+    float scales_[3][kCapacity];
+
+    /*!
+     * The matrices built by compose()
+     */
+    Mat4 models_[kCapacity];
+
+    /*!
+     * The number of transforms added
+     */
+    std::size_t size_;
+
+ public:
+    /*!
+     * InstanceTransforms constructor
+     */
+    InstanceTransforms ();
+
+    /*!
+     * Add a transform, the batch must not be full
+     *
+     * \param[in] translation The translation
+     * \param[in] rotation    The rotation, unit length
+     * \param[in] scale       The scale along each axis
+     *
+     * \return The index of its matrix
+     */
+    std::size_t add (const Vec3& translation, const Quat& rotation, const Vec3& scale);
+
+    /*!
+     * Build the matrices of the transforms added
+     *
+     * \return void
+     */
+    void compose ();
+
+    /*!
+     * Get a matrix built by compose()
+     *
+     * \param[in] index The index add() returned
+     *
+     * \return The model matrix
+     */
+    const Mat4& getModel (std::size_t index) const;
+
+    /*!
+     * Forget the transforms added
+     *
+     * \return void
+     */
+    void clear ();
+
+    /*!
+     * Get the number of transforms added
+     *
+     * \return The number of transforms
+     */
+    std::size_t getSize () const;
+
+    /*!
+     * Check if the batch is full
+     *
+     * \return True once kCapacity transforms were added
+     */
+    bool isFull () const;
+};
+
+#endif // __INSTANCE_BUFFER_HPP
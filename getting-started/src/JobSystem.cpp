@@ -0,0 +1,274 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// the index of the calling thread in the job system it works for
+thread_local unsigned int thread_index = 0;
+
+} // namespace
+
+/*!
+ * JobSystem constructor, the calling thread becomes the owner
+ *
+ * \param[in] workers  The number of workers, 0 for one less than the
+ *                     cores, the owner works as well when it waits
+ * \param[in] capacity The number of jobs a deque holds, a power of two
+ */
+JobSystem::JobSystem (unsigned int workers, std::size_t capacity)
+    : queued_(0),
+      sleeping_(0),
+      stopping_(false),
+      jobs_run_(0),
+      steals_(0),
+      inline_runs_(0)
+{
+    if (workers == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+
+        workers = (cores > 1) ? cores - 1 : 1;
+    }
+
+    thread_index = 0;
+
+    // every deque exists before a worker can steal from it
+    for (unsigned int i = 0; i <= workers; ++i)
+        deques_.emplace_back(new WorkStealingDeque<Job*>(capacity));
+
+    for (unsigned int i = 1; i <= workers; ++i)
+        workers_.emplace_back(&JobSystem::work, this, i);
+}
+
+/*!
+ * JobSystem destructor, joins the workers; every counter must have been
+ * waited for
+ */
+JobSystem::~JobSystem ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    wake_.notify_all();
+
+    for (std::thread& worker : workers_)
+        worker.join();
+}
+
+/*!
+ * Submit a job, from the owner or from a job
+ *
+ * \param[in] job     The job
+ * \param[in] counter The counter of its group
+ *
+ * \return void
+ */
+void JobSystem::submit (std::function<void ()> job, JobCounter& counter)
+{
+    Job* entry = new Job{std::move(job), &counter};
+
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+    // a full deque runs the job now, the submitter was going to wait anyway
+    if (!deques_[thread_index]->push(entry)) {
+        inline_runs_.fetch_add(1, std::memory_order_relaxed);
+        execute(entry);
+        return;
+    }
+
+    // pairs with the worker raising sleeping_ before it checks queued_, one
+    // of the two sees the other
+    queued_.fetch_add(1, std::memory_order_seq_cst);
+
+    if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+/*!
+ * Split [0, count) into ranges of at most grain items and submit a job
+ * per range
+ *
+ * \param[in] count    The number of items
+ * \param[in] grain    The items per job, at least 1
+ * \param[in] function Called with the first item and the item after the
+ *                     last of each range, the jobs share a copy of it
+ * \param[in] counter  The counter of the jobs
+ *
+ * \return void
+ */
+void JobSystem::parallelFor (
+    std::size_t count, std::size_t grain,
+    std::function<void (std::size_t, std::size_t)> function,
+    JobCounter& counter
+) {
+    grain = std::max<std::size_t>(grain, 1);
+
+    // the jobs may outlive the caller's callable, they share one copy of it
+    auto shared = std::make_shared<
+        std::function<void (std::size_t, std::size_t)>
+    >(std::move(function));
+
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+        std::size_t end = std::min(begin + grain, count);
+
+        submit([shared, begin, end] { (*shared)(begin, end); }, counter);
+    }
+}
+
+/*!
+ * Run jobs until every job of a group has finished
+ *
+ * \param[in] counter The counter of the group
+ *
+ * \return void
+ */
+void JobSystem::wait (JobCounter& counter)
+{
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        Job* job = findJob(thread_index);
+
+        // the last jobs of the group run on other threads
+        if (job == nullptr)
+            std::this_thread::yield();
+        else
+            execute(job);
+    }
+}
+
+/*!
+ * Get the number of threads running jobs, the owner included
+ *
+ * \return The number of threads
+ */
+unsigned int JobSystem::getThreadCount () const
+{
+    return static_cast<unsigned int>(deques_.size());
+}
+
+/*!
+ * Get the index of the calling thread, to pick its per-thread data
+ *
+ * \return 0 on the owner, 1 to getThreadCount() - 1 on the workers
+ */
+unsigned int JobSystem::getThreadIndex ()
+{
+    return thread_index;
+}
+
+/*!
+ * Get the counters
+ *
+ * \return The counters since the last resetStats()
+ */
+JobStats JobSystem::getStats () const
+{
+    return {
+        jobs_run_.load(std::memory_order_relaxed),
+        steals_.load(std::memory_order_relaxed),
+        inline_runs_.load(std::memory_order_relaxed)
+    };
+}
+
+/*!
+ * Reset the counters
+ *
+ * \return The counters before the reset
+ */
+JobStats JobSystem::resetStats ()
+{
+    return {
+        jobs_run_.exchange(0, std::memory_order_relaxed),
+        steals_.exchange(0, std::memory_order_relaxed),
+        inline_runs_.exchange(0, std::memory_order_relaxed)
+    };
+}
+
+/*!
+ * Take a job from the thread's deque, or steal one
+ *
+ * \param[in] index The thread index
+ *
+ * \return The job, nullptr if every deque looked empty
+ */
+JobSystem::Job* JobSystem::findJob (unsigned int index)
+{
+    Job* job = nullptr;
+
+    if (deques_[index]->pop(job)) {
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    // start after the thread so the thieves spread over the victims
+    std::size_t count = deques_.size();
+
+    for (std::size_t i = 1; i < count; ++i) {
+        if (deques_[(index + i) % count]->steal(job)) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+/*!
+ * Run a job, count it down and free it
+ *
+ * \param[in] job The job
+ *
+ * \return void
+ */
+void JobSystem::execute (Job* job)
+{
+    job->function();
+
+    jobs_run_.fetch_add(1, std::memory_order_relaxed);
+
+    // the waiter reads what the job wrote once it sees the count drop
+    job->counter->pending.fetch_sub(1, std::memory_order_release);
+
+    delete job;
+}
+
+/*!
+ * The loop run by each worker
+ *
+ * \param[in] index The thread index
+ *
+ * \return void
+ */
+void JobSystem::work (unsigned int index)
+{
+    thread_index = index;
+
+    while (true) {
+        Job* job = findJob(index);
+
+        if (job != nullptr) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        sleeping_.fetch_add(1, std::memory_order_seq_cst);
+
+        // a steal can fail on a race with jobs still queued, so the count
+        // is what decides to sleep
+        wake_.wait(lock, [this] {
+            return stopping_ || (queued_.load(std::memory_order_seq_cst) > 0);
+        });
+
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (stopping_ && (queued_.load(std::memory_order_relaxed) <= 0))
+            return;
+    }
+}
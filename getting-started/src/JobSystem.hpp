@@ -0,0 +1,229 @@
+/*!
+ * \file  JobSystem.hpp
+ * \brief Class definition of a work-stealing job system running the per-frame
+ *        work of the scenes across the cores
+ */
+
+#ifndef __JOB_SYSTEM_HPP
+#define __JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.hpp"
+
+//! JobCounter
+/*!
+ * JobCounter counts the jobs of a group that have not finished yet,
+ * JobSystem::wait() returns once it drops to 0
+ */
+struct JobCounter
+{
+    std::atomic<unsigned int> pending{0};
+};
+
+//! JobStats
+/*!
+ * JobStats counts the jobs since the last JobSystem::resetStats()
+ */
+struct JobStats
+{
+    /*!
+     * The jobs run
+     */
+    unsigned long jobs;
+
+    /*!
+     * The jobs taken from another thread's deque
+     */
+    unsigned long steals;
+
+    /*!
+     * The jobs run by the submitting thread because its deque was full
+     */
+    unsigned long inline_runs;
+};
+
+//! JobSystem
+/*!
+ * JobSystem runs jobs on one worker per core besides the thread that
+ * created it, its owner. Every thread, the owner included, has a
+ * WorkStealingDeque: a job submitted from a thread goes to the bottom of
+ * that thread's deque, and a thread out of jobs steals from the top of the
+ * others. There is no shared queue nor lock on the job path, workers only
+ * take the mutex to sleep once every deque looks empty.
+ *
+ * wait() doesn't block while there is work: the waiting thread runs jobs,
+ * its own first, until the counter drops to 0, so a job can fan out and
+ * wait for its children without tying up a thread. Jobs may only be
+ * submitted from the owner and from jobs. Like ThreadPool jobs, they must
+ * not touch the OpenGL context, nor throw.
+ */
+class JobSystem
+{
+ private:
+    //! Job
+    /*!
+     * Job is a function and the counter of its group
+     */
+    struct Job
+    {
+        std::function<void ()> function;
+        JobCounter* counter;
+    };
+
+    /*!
+     * The deques, index 0 is the owner's, then one per worker
+     */
+    std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> deques_;
+
+    std::vector<std::thread> workers_;
+
+    /*!
+     * The jobs pushed to a deque and not taken yet, the workers sleep at 0
+     */
+    std::atomic<long> queued_;
+
+    /*!
+     * The workers waiting on wake_
+     */
+    std::atomic<unsigned int> sleeping_;
+
+    /*!
+     * Protects stopping_, held by workers going to sleep
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Signalled when a job is pushed while workers sleep, or at shutdown
+     */
+    std::condition_variable wake_;
+
+    bool stopping_;
+
+    /*!
+     * The counters, updated with relaxed atomics
+     */
+    std::atomic<unsigned long> jobs_run_;
+    std::atomic<unsigned long> steals_;
+    std::atomic<unsigned long> inline_runs_;
+
+    /*!
+     * Take a job from the thread's deque, or steal one
+     *
+     * \param[in] index The thread index
+     *
+     * \return The job, nullptr if every deque looked empty
+     */
+    Job* findJob (unsigned int index);
+
+    /*!
+     * Run a job, count it down and free it
+     *
+     * \param[in] job The job
+     *
+     * \return void
+     */
+    void execute (Job* job);
+
+    /*!
+     * The loop run by each worker
+     *
+     * \param[in] index The thread index
+     *
+     * \return void
+     */
+    void work (unsigned int index);
+
+ public:
+    /*!
+     * JobSystem constructor, the calling thread becomes the owner
+     *
+     * \param[in] workers  The number of workers, 0 for one less than the
+     *                     cores, the owner works as well when it waits
+     * \param[in] capacity The number of jobs a deque holds, a power of two
+     */
+    explicit JobSystem (unsigned int workers = 0, std::size_t capacity = 4096);
+
+    JobSystem (const JobSystem&) = delete;
+    JobSystem& operator= (const JobSystem&) = delete;
+
+    /*!
+     * JobSystem destructor, joins the workers; every counter must have been
+     * waited for
+     */
+    ~JobSystem ();
+
+    /*!
+     * Submit a job, from the owner or from a job
+     *
+     * \param[in] job     The job
+     * \param[in] counter The counter of its group
+     *
+     * \return void
+     */
+    void submit (std::function<void ()> job, JobCounter& counter);
+
+    /*!
+     * Split [0, count) into ranges of at most grain items and submit a job
+     * per range
+     *
+     * \param[in] count    The number of items
+     * \param[in] grain    The items per job, at least 1
+     * \param[in] function Called with the first item and the item after the
+     *                     last of each range, the jobs share a copy of it
+     * \param[in] counter  The counter of the jobs
+     *
+     * \return void
+     */
+    void parallelFor (
+        std::size_t count, std::size_t grain,
+        std::function<void (std::size_t, std::size_t)> function,
+        JobCounter& counter
+    );
+
+    /*!
+     * Run jobs until every job of a group has finished
+     *
+     * \param[in] counter The counter of the group
+     *
+     * \return void
+     */
+    void wait (JobCounter& counter);
+
+    /*!
+     * Get the number of threads running jobs, the owner included
+     *
+     * \return The number of threads
+     */
+    unsigned int getThreadCount () const;
+
+    /*!
+     * Get the index of the calling thread, to pick its per-thread data
+     *
+     * \return 0 on the owner, 1 to getThreadCount() - 1 on the workers
+     */
+    static unsigned int getThreadIndex ();
+
+    /*!
+     * Get the counters
+     *
+     * \return The counters since the last resetStats()
+     */
+    JobStats getStats () const;
+
+    /*!
+     * Reset the counters
+     *
+     * \return The counters before the reset
+     */
+    JobStats resetStats ();
+};
+
+#endif // __JOB_SYSTEM_HPP
@@ -0,0 +1,230 @@
+/*!
+ * \file  Log.hpp
+ * \brief The LOG_ macros and the class formatting their lines
+ */
+
+#ifndef __LOG_HPP
+#define __LOG_HPP
+
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+#include "LogSink.hpp"
+
+// the lowest level compiled in: 0 debug, 1 info, 2 warning, 3 error; the
+// Makefile passes 1 to RELEASE builds
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 0
+#endif
+
+//! LogMessage
+/*!
+ * LogMessage formats a line with operator<< into a buffer of the calling
+ * thread, which keeps its capacity from line to line, and queues it on the
+ * LogSink when destroyed. Only strings, characters and numbers are
+ * formatted, the way std::ostream does by default.
+ *
+ * A LogMessage built while another formats, by a function called from the
+ * outer line, appends after it and takes its part back when done.
+ */
+class LogMessage
+{
+ private:
+    LogLevel level_;
+
+    /*!
+     * Where the line starts in the thread's buffer
+     */
+    std::size_t start_;
+
+    /*!
+     * Get the buffer of the calling thread
+     *
+     * \return The buffer
+     */
+    static std::string& getBuffer ()
+    {
+        static thread_local std::string buffer;
+
+        return buffer;
+    }
+
+    /*!
+     * Append a number formatted with snprintf
+     *
+     * \param[in] format The snprintf format
+     * \param[in] value  The number
+     *
+     * \return The message
+     */
+    template <typename T>
+    LogMessage& appendNumber (const char* format, T value)
+    {
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), format, value);
+
+        getBuffer().append(text, static_cast<std::size_t>(length));
+
+        return *this;
+    }
+
+ public:
+    /*!
+     * LogMessage constructor
+     *
+     * \param[in] level The line severity
+     */
+    explicit LogMessage (LogLevel level)
+        : level_(level),
+          start_(getBuffer().size())
+    {
+    }
+
+    LogMessage (const LogMessage&) = delete;
+    LogMessage& operator= (const LogMessage&) = delete;
+
+    /*!
+     * LogMessage destructor, queues the line
+     */
+    ~LogMessage ()
+    {
+        std::string& buffer = getBuffer();
+
+        LogSink::getInstance().write(
+            level_, buffer.data() + start_, buffer.size() - start_
+        );
+
+        buffer.resize(start_);
+    }
+
+    /*!
+     * Append a string
+     *
+     * \param[in] text The string
+     *
+     * \return The message
+     */
+    LogMessage& operator<< (const char* text)
+    {
+        getBuffer().append((text != nullptr) ? text : "(null)");
+
+        return *this;
+    }
+
+    /*!
+     * Append a string returned by GL
+     *
+     * \param[in] text The string
+     *
+     * \return The message
+     */
+    LogMessage& operator<< (const unsigned char* text)
+    {
+        return *this << reinterpret_cast<const char*>(text);
+    }
+
+    /*!
+     * Append a string
+     *
+     * \param[in] text The string
+     *
+     * \return The message
+     */
+    LogMessage& operator<< (const std::string& text)
+    {
+        getBuffer().append(text);
+
+        return *this;
+    }
+
+    /*!
+     * Append a character
+     *
+     * \param[in] value The character
+     *
+     * \return The message
+     */
+    LogMessage& operator<< (char value)
+    {
+        getBuffer().push_back(value);
+
+        return *this;
+    }
+
+    /*!
+     * Append a signed integer
+     *
+     * \param[in] value The integer
+     *
+     * \return The message
+     */
+    template <typename T>
+    typename std::enable_if<
+        std::is_integral<T>::value && std::is_signed<T>::value, LogMessage&
+    >::type operator<< (T value)
+    {
+        return appendNumber("%lld", static_cast<long long>(value));
+    }
+
+    /*!
+     * Append an unsigned integer
+     *
+     * \param[in] value The integer
+     *
+     * \return The message
+     */
+    template <typename T>
+    typename std::enable_if<
+        std::is_integral<T>::value && std::is_unsigned<T>::value, LogMessage&
+    >::type operator<< (T value)
+    {
+        return appendNumber("%llu", static_cast<unsigned long long>(value));
+    }
+
+    /*!
+     * Append a floating point number, with 6 significant digits
+     *
+     * \param[in] value The number
+     *
+     * \return The message
+     */
+    LogMessage& operator<< (double value)
+    {
+        return appendNumber("%g", value);
+    }
+};
+
+// the message is an operator<< chain, it is not evaluated when the level is
+// disabled at run time, and not compiled when it's below LOG_LEVEL
+#define LOG_AT(level, message)                                  \
+    do {                                                        \
+        if (LogSink::getInstance().isEnabled(level)) {          \
+            LogMessage log_message(level);                      \
+            log_message << message;                             \
+        }                                                       \
+    } while (0)
+
+#define LOG_DISABLED(message) do {} while (0)
+
+#if LOG_LEVEL <= 0
+#define LOG_DEBUG(message) LOG_AT(LogLevel::kDebug, message)
+#else
+#define LOG_DEBUG(message) LOG_DISABLED(message)
+#endif
+
+#if LOG_LEVEL <= 1
+#define LOG_INFO(message) LOG_AT(LogLevel::kInfo, message)
+#else
+#define LOG_INFO(message) LOG_DISABLED(message)
+#endif
+
+#if LOG_LEVEL <= 2
+#define LOG_WARNING(message) LOG_AT(LogLevel::kWarning, message)
+#else
+#define LOG_WARNING(message) LOG_DISABLED(message)
+#endif
+
+#define LOG_ERROR(message) LOG_AT(LogLevel::kError, message)
+
+#endif // __LOG_HPP
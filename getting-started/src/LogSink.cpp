@@ -0,0 +1,350 @@
+#include "LogSink.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "Log.hpp"
+
+namespace {
+
+// how long the sink thread sleeps when nobody flushes
+const std::chrono::milliseconds kDrainInterval(10);
+
+} // namespace
+
+// std::min takes it by reference
+const std::size_t LogSink::kRecordText;
+
+/*!
+ * LogSink constructor, starts the sink thread writing to std::cout at 20
+ * lines per second after a burst of 100
+ */
+LogSink::LogSink ()
+    : out_(&std::cout),
+      level_(LOG_LEVEL),
+      rate_(20),
+      burst_(100),
+      tokens_(100.0),
+      refilled_(std::chrono::steady_clock::now()),
+      pending_suppressed_(0),
+      stats_({0, 0, 0, 0}),
+      dropped_(0),
+      flush_requested_(0),
+      flush_done_(0),
+      stopping_(false)
+{
+    thread_ = std::thread(&LogSink::run, this);
+}
+
+/*!
+ * LogSink destructor, writes what is left and stops the sink thread
+ */
+LogSink::~LogSink ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        stopping_ = true;
+    }
+
+    wake_.notify_one();
+    thread_.join();
+}
+
+/*!
+ * Get the sink
+ *
+ * \return The sink
+ */
+LogSink& LogSink::getInstance ()
+{
+    static LogSink instance;
+
+    return instance;
+}
+
+/*!
+ * Queue a line on the calling thread's ring, never blocks
+ *
+ * \param[in] level  The line severity
+ * \param[in] text   The line, without the newline
+ * \param[in] length The line length
+ *
+ * \return False if the ring was full and the line was cut short
+ */
+bool LogSink::write (LogLevel level, const char* text, std::size_t length)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::size_t offset = 0;
+
+    do {
+        LogRecord record;
+        std::size_t size = std::min(length - offset, kRecordText);
+
+        std::memcpy(record.text, text + offset, size);
+        record.length = static_cast<std::uint16_t>(size);
+        record.level = level;
+        record.flags = (offset == 0) ? kFirst : 0;
+
+        if (offset + size == length)
+            record.flags |= kLast;
+
+        // the sink thread ends the line at the next first record
+        if (!buffer.records.push(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        offset += size;
+    } while (offset < length);
+
+    return true;
+}
+
+/*!
+ * Queue a line on the calling thread's ring, never blocks
+ *
+ * \param[in] level The line severity
+ * \param[in] line  The line, without the newline
+ *
+ * \return False if the ring was full and the line was cut short
+ */
+bool LogSink::write (LogLevel level, const std::string& line)
+{
+    return write(level, line.data(), line.size());
+}
+
+/*!
+ * Wait for the sink thread to write every line queued before the call
+ *
+ * \return void
+ */
+void LogSink::flush ()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // the sink thread is gone, the destructor of a static is logging
+    if (stopping_) {
+        drain();
+        return;
+    }
+
+    unsigned long target = ++flush_requested_;
+
+    wake_.notify_one();
+    drained_.wait(lock, [this, target] {
+        return flush_done_ >= target;
+    });
+}
+
+/*!
+ * Change the lowest level written
+ *
+ * \param[in] level The level
+ *
+ * \return void
+ */
+void LogSink::setLevel (LogLevel level)
+{
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+/*!
+ * Change the rate limit, the bucket starts full
+ *
+ * \param[in] rate  The lines per second, 0 for no limit
+ * \param[in] burst The lines going through at once
+ *
+ * \return void
+ */
+void LogSink::setRate (unsigned int rate, unsigned int burst)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    rate_ = rate;
+    burst_ = std::max(burst, 1u);
+    tokens_ = burst_;
+    refilled_ = std::chrono::steady_clock::now();
+}
+
+/*!
+ * Change the stream, after writing the lines queued for the previous one
+ *
+ * \param[in] out The stream
+ *
+ * \return void
+ */
+void LogSink::setStream (std::ostream& out)
+{
+    flush();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out_ = &out;
+}
+
+/*!
+ * Get the counters
+ *
+ * \return The counters
+ */
+LogSinkStats LogSink::getStats ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    LogSinkStats stats = stats_;
+
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+/*!
+ * ThreadHandle destructor, retires the ring of the exiting thread
+ */
+LogSink::ThreadHandle::~ThreadHandle ()
+{
+    if (buffer != nullptr)
+        buffer->retired.store(true, std::memory_order_release);
+}
+
+/*!
+ * Get the ring of the calling thread, created on its first line
+ *
+ * \return The ring
+ */
+LogSink::ThreadBuffer& LogSink::getThreadBuffer ()
+{
+    static thread_local ThreadHandle handle;
+
+    if (handle.buffer == nullptr) {
+        handle.buffer = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        buffers_.push_back(handle.buffer);
+    }
+
+    return *handle.buffer;
+}
+
+/*!
+ * The sink thread, drains the rings until the sink is destroyed
+ *
+ * \return void
+ */
+void LogSink::run ()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        wake_.wait_for(lock, kDrainInterval, [this] {
+            return stopping_ || (flush_requested_ != flush_done_);
+        });
+
+        unsigned long requested = flush_requested_;
+
+        drain();
+
+        flush_done_ = requested;
+        drained_.notify_all();
+    }
+
+    drain();
+}
+
+/*!
+ * Move the records of every ring to the stream, mutex_ must be held
+ *
+ * \return void
+ */
+void LogSink::drain ()
+{
+    auto buffer = buffers_.begin();
+
+    while (buffer != buffers_.end()) {
+        ThreadBuffer& thread = **buffer;
+
+        // read before draining, so a retired ring is known to be empty after
+        bool retired = thread.retired.load(std::memory_order_acquire);
+        LogRecord record;
+
+        while (thread.records.pop(record)) {
+            if ((record.flags & kFirst) != 0) {
+                // a line cut short by a full ring
+                if (!thread.partial.empty()) {
+                    append(thread.level, thread.partial);
+                    thread.partial.clear();
+                }
+
+                thread.level = record.level;
+            }
+
+            thread.partial.append(record.text, record.length);
+
+            if ((record.flags & kLast) != 0) {
+                append(thread.level, thread.partial);
+                thread.partial.clear();
+            }
+        }
+
+        if (!retired) {
+            ++buffer;
+            continue;
+        }
+
+        if (!thread.partial.empty())
+            append(thread.level, thread.partial);
+
+        buffer = buffers_.erase(buffer);
+    }
+
+    if (pending_.empty())
+        return;
+
+    out_->write(pending_.data(), pending_.size());
+    out_->flush();
+
+    // the capacity stays for the next drain
+    pending_.clear();
+    ++stats_.flushes;
+}
+
+/*!
+ * Append a whole line to the pending text, unless the rate limit drops
+ * it, mutex_ must be held
+ *
+ * \param[in] level The line severity
+ * \param[in] line  The line, without the newline
+ *
+ * \return void
+ */
+void LogSink::append (LogLevel level, const std::string& line)
+{
+    if ((rate_ > 0) && (level < LogLevel::kWarning)) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - refilled_;
+
+        tokens_ = std::min(
+            static_cast<double>(burst_), tokens_ + elapsed.count() * rate_
+        );
+        refilled_ = now;
+
+        if (tokens_ < 1.0) {
+            ++pending_suppressed_;
+            ++stats_.suppressed;
+            return;
+        }
+
+        tokens_ -= 1.0;
+    }
+
+    if (pending_suppressed_ > 0) {
+        pending_ += "(" + std::to_string(pending_suppressed_) + " lines suppressed)\n";
+        pending_suppressed_ = 0;
+    }
+
+    pending_ += line;
+    pending_ += '\n';
+    ++stats_.written;
+}
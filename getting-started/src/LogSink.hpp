@@ -0,0 +1,357 @@
+/*!
+ * \file  LogSink.hpp
+ * \brief Class definition of the log the threads write to without locking
+ *        and a background thread writes out
+ */
+
+#ifndef __LOG_SINK_HPP
+#define __LOG_SINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SpscQueue.hpp"
+
+//! LogLevel
+/*!
+ * LogLevel is the severity of a line, the LOG_ macros of Log.hpp compile
+ * out the levels below LOG_LEVEL
+ */
+enum class LogLevel : std::uint8_t
+{
+    kDebug,
+    kInfo,
+    kWarning,
+    kError
+};
+
+//! LogSinkStats
+/*!
+ * LogSinkStats counts the lines given to the sink
+ */
+struct LogSinkStats
+{
+    /*!
+     * The lines written to the stream
+     */
+    unsigned long written;
+
+    /*!
+     * The lines dropped by the rate limit
+     */
+    unsigned long suppressed;
+
+    /*!
+     * The lines cut short or lost because their thread's ring was full
+     */
+    unsigned long dropped;
+
+    /*!
+     * The writes to the stream, one per drain with something to write
+     */
+    unsigned long flushes;
+};
+
+//! LogSink
+/*!
+ * LogSink takes the console I/O off the threads that log. Each thread
+ * writing to it gets its own SpscQueue of fixed size records, write() cuts
+ * the line into records and pushes them without locking nor allocating, a
+ * full ring drops the rest of the line. A background thread drains the
+ * rings every few ms, or when flush() asks, and writes what they held to
+ * the stream in one call.
+ *
+ * The lines of one thread keep their order, the lines of different threads
+ * are ordered per drain only. flush() waits for everything written before
+ * it, call it before printing anything else to the stream.
+ *
+ * A token bucket limits the debug and info lines: up to burst lines go
+ * through at once, then rate per second. The lines over the limit are
+ * dropped and counted, the next line through says how many were. Warnings
+ * and errors are never limited.
+ */
+class LogSink
+{
+ private:
+    /*!
+     * The bytes of text a record holds
+     */
+    static const std::size_t kRecordText = 250;
+
+    //! LogRecord
+    /*!
+     * LogRecord is a piece of a line, a line longer than kRecordText takes
+     * several
+     */
+    struct LogRecord
+    {
+        char text[kRecordText];
+        std::uint16_t length;
+        LogLevel level;
+
+        /*!
+         * kFirst and kLast, a line fitting one record has both
+         */
+        std::uint8_t flags;
+
+        std::uint8_t unused[2];
+    };
+
+    //! ThreadBuffer
+    /*!
+     * ThreadBuffer is the ring of a thread writing to the sink
+     */
+    struct ThreadBuffer
+    {
+        SpscQueue<LogRecord, 256> records;
+
+        /*!
+         * The line being put back together by the sink thread
+         */
+        std::string partial;
+        LogLevel level;
+
+        /*!
+         * Set when the thread exits, the sink thread frees the ring once
+         * it's empty
+         */
+        std::atomic<bool> retired;
+
+        ThreadBuffer ()
+            : level(LogLevel::kInfo),
+              retired(false)
+        {
+        }
+    };
+
+    //! ThreadHandle
+    /*!
+     * ThreadHandle retires the ring of its thread when the thread exits
+     */
+    struct ThreadHandle
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        /*!
+         * ThreadHandle destructor, retires the ring of the exiting thread
+         */
+        ~ThreadHandle ();
+    };
+
+    static const std::uint8_t kFirst = 1;
+    static const std::uint8_t kLast = 2;
+
+    /*!
+     * The rings of the threads that wrote, guarded by mutex_
+     */
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    /*!
+     * The stream the lines are written to
+     */
+    std::ostream* out_;
+
+    /*!
+     * The lines drained and not written yet, owned by the sink thread
+     */
+    std::string pending_;
+
+    /*!
+     * The lowest level written, below it the LOG_ macros skip the
+     * formatting
+     */
+    std::atomic<int> level_;
+
+    /*!
+     * The lines per second, 0 for no limit
+     */
+    unsigned int rate_;
+
+    /*!
+     * The lines the bucket holds
+     */
+    unsigned int burst_;
+
+    /*!
+     * The lines the bucket allows now
+     */
+    double tokens_;
+
+    /*!
+     * When the bucket was last refilled
+     */
+    std::chrono::steady_clock::time_point refilled_;
+
+    /*!
+     * The lines dropped since the last line written
+     */
+    unsigned long pending_suppressed_;
+
+    LogSinkStats stats_;
+
+    /*!
+     * The lines cut short by a full ring, written by the logging threads
+     */
+    std::atomic<unsigned long> dropped_;
+
+    /*!
+     * The drains asked for by flush(), and the last one done
+     */
+    unsigned long flush_requested_;
+    unsigned long flush_done_;
+
+    bool stopping_;
+
+    /*!
+     * Protects every member but the rings, which only the sink thread pops
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Wakes the sink thread for a flush, and the flushing thread once done
+     */
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+
+    std::thread thread_;
+
+    /*!
+     * LogSink constructor, starts the sink thread writing to std::cout at 20
+     * lines per second after a burst of 100
+     */
+    LogSink ();
+
+    /*!
+     * Get the ring of the calling thread, created on its first line
+     *
+     * \return The ring
+     */
+    ThreadBuffer& getThreadBuffer ();
+
+    /*!
+     * The sink thread, drains the rings until the sink is destroyed
+     *
+     * \return void
+     */
+    void run ();
+
+    /*!
+     * Move the records of every ring to the stream, mutex_ must be held
+     *
+     * \return void
+     */
+    void drain ();
+
+    /*!
+     * Append a whole line to the pending text, unless the rate limit drops
+     * it, mutex_ must be held
+     *
+     * \param[in] level The line severity
+     * \param[in] line  The line, without the newline
+     *
+     * \return void
+     */
+    void append (LogLevel level, const std::string& line);
+
+ public:
+    LogSink (const LogSink&) = delete;
+    LogSink& operator= (const LogSink&) = delete;
+
+    /*!
+     * LogSink destructor, writes what is left and stops the sink thread
+     */
+    ~LogSink ();
+
+    /*!
+     * Get the sink
+     *
+     * \return The sink
+     */
+    static LogSink& getInstance ();
+
+    /*!
+     * Check if a level is written
+     *
+     * \param[in] level The level
+     *
+     * \return True if the lines of this level are written
+     */
+    bool isEnabled (LogLevel level) const
+    {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * Queue a line on the calling thread's ring, never blocks
+     *
+     * \param[in] level  The line severity
+     * \param[in] text   The line, without the newline
+     * \param[in] length The line length
+     *
+     * \return False if the ring was full and the line was cut short
+     */
+    bool write (LogLevel level, const char* text, std::size_t length);
+
+    /*!
+     * Queue a line on the calling thread's ring, never blocks
+     *
+     * \param[in] level The line severity
+     * \param[in] line  The line, without the newline
+     *
+     * \return False if the ring was full and the line was cut short
+     */
+    bool write (LogLevel level, const std::string& line);
+
+    /*!
+     * Wait for the sink thread to write every line queued before the call
+     *
+     * \return void
+     */
+    void flush ();
+
+    /*!
+     * Change the lowest level written
+     *
+     * \param[in] level The level
+     *
+     * \return void
+     */
+    void setLevel (LogLevel level);
+
+    /*!
+     * Change the rate limit, the bucket starts full
+     *
+     * \param[in] rate  The lines per second, 0 for no limit
+     * \param[in] burst The lines going through at once
+     *
+     * \return void
+     */
+    void setRate (unsigned int rate, unsigned int burst);
+
+    /*!
+     * Change the stream, after writing the lines queued for the previous one
+     *
+     * \param[in] out The stream
+     *
+     * \return void
+     */
+    void setStream (std::ostream& out);
+
+    /*!
+     * Get the counters
+     *
+     * \return The counters
+     */
+    LogSinkStats getStats ();
+};
+
+#endif // __LOG_SINK_HPP
@@ -0,0 +1,488 @@
+#include "MathKernels.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATH_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+SimdLevel& getActiveLevel ()
+{
+    static SimdLevel level = ImageKernels::getSupportedLevel();
+
+    return level;
+}
+
+/*
+ * Scalar kernels, also used for the elements the vector kernels leave
+ */
+
+void transformScalar (
+    const Mat4& matrix, const Vec3Arrays& points, const Vec3Arrays& target,
+    std::size_t first, std::size_t count
+) {
+    for (std::size_t i = first; i < count; ++i) {
+        Vec3 point = transformPoint(matrix, {points.x[i], points.y[i], points.z[i]});
+
+        target.x[i] = point.x;
+        target.y[i] = point.y;
+        target.z[i] = point.z;
+    }
+}
+
+void composeScalar (
+    const Vec3Arrays& translations, const QuatArrays& rotations,
+    const Vec3Arrays& scales, Mat4* target, std::size_t first, std::size_t count
+) {
+    for (std::size_t i = first; i < count; ++i) {
+        target[i] = makeTransform(
+            {translations.x[i], translations.y[i], translations.z[i]},
+            {rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]},
+            {scales.x[i], scales.y[i], scales.z[i]}
+        );
+    }
+}
+
+// not operator*, which is SSE2 where the target has it
+void multiplyScalar (
+    const Mat4& left, const Mat4* right, Mat4* target, std::size_t first, std::size_t count
+) {
+    const float* a = left.data;
+
+    for (std::size_t i = first; i < count; ++i) {
+        Mat4 result;
+
+        for (int column = 0; column < 4; ++column) {
+            const float* weights = right[i].data + column * 4;
+
+            for (int row = 0; row < 4; ++row) {
+                result.data[column * 4 + row] =
+                    (a[row] * weights[0] + a[4 + row] * weights[1]) +
+                    (a[8 + row] * weights[2] + a[12 + row] * weights[3]);
+            }
+        }
+
+        target[i] = result;
+    }
+}
+
+#ifdef MATH_KERNELS_X86
+
+/*
+ * SSE2 kernels, x86-64 always has SSE2
+ */
+
+void transformSse2 (
+    const Mat4& matrix, const Vec3Arrays& points, const Vec3Arrays& target,
+    std::size_t count
+) {
+    const float* d = matrix.data;
+    __m128 m[12];
+    std::size_t i = 0;
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 4; ++column)
+            m[row * 4 + column] = _mm_set1_ps(d[column * 4 + row]);
+    }
+
+    // 4 points per step, in the order of transformPoint()
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(points.x + i);
+        __m128 y = _mm_loadu_ps(points.y + i);
+        __m128 z = _mm_loadu_ps(points.z + i);
+        float* outputs[3] = {target.x + i, target.y + i, target.z + i};
+
+        for (int row = 0; row < 3; ++row) {
+            const __m128* r = m + row * 4;
+
+            _mm_storeu_ps(
+                outputs[row],
+                _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(r[0], x), _mm_mul_ps(r[1], y)),
+                    _mm_add_ps(_mm_mul_ps(r[2], z), r[3])
+                )
+            );
+        }
+    }
+
+    transformScalar(matrix, points, target, i, count);
+}
+
+void composeSse2 (
+    const Vec3Arrays& translations, const QuatArrays& rotations,
+    const Vec3Arrays& scales, Mat4* target, std::size_t count
+) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    std::size_t i = 0;
+
+    // 4 matrices per step, the terms in the order of makeTransform()
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(rotations.x + i);
+        __m128 y = _mm_loadu_ps(rotations.y + i);
+        __m128 z = _mm_loadu_ps(rotations.z + i);
+        __m128 w = _mm_loadu_ps(rotations.w + i);
+        __m128 sx = _mm_loadu_ps(scales.x + i);
+        __m128 sy = _mm_loadu_ps(scales.y + i);
+        __m128 sz = _mm_loadu_ps(scales.z + i);
+
+        __m128 xx = _mm_mul_ps(x, x);
+        __m128 yy = _mm_mul_ps(y, y);
+        __m128 zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y);
+        __m128 xz = _mm_mul_ps(x, z);
+        __m128 yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x);
+        __m128 wy = _mm_mul_ps(w, y);
+        __m128 wz = _mm_mul_ps(w, z);
+
+        // one register per element, each lane a different matrix
+        __m128 columns[16] = {
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+            _mm_setzero_ps(),
+
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+            _mm_setzero_ps(),
+
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+            _mm_setzero_ps(),
+
+            _mm_loadu_ps(translations.x + i),
+            _mm_loadu_ps(translations.y + i),
+            _mm_loadu_ps(translations.z + i),
+            one
+        };
+
+        // the transpose turns the lanes of a column into the columns of the
+        // 4 matrices
+        for (int column = 0; column < 4; ++column) {
+            __m128 r0 = columns[column * 4 + 0];
+            __m128 r1 = columns[column * 4 + 1];
+            __m128 r2 = columns[column * 4 + 2];
+            __m128 r3 = columns[column * 4 + 3];
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_storeu_ps(target[i + 0].data + column * 4, r0);
+            _mm_storeu_ps(target[i + 1].data + column * 4, r1);
+            _mm_storeu_ps(target[i + 2].data + column * 4, r2);
+            _mm_storeu_ps(target[i + 3].data + column * 4, r3);
+        }
+    }
+
+    composeScalar(translations, rotations, scales, target, i, count);
+}
+
+void multiplySse2 (const Mat4& left, const Mat4* right, Mat4* target, std::size_t count)
+{
+    __m128 c0 = _mm_loadu_ps(left.data);
+    __m128 c1 = _mm_loadu_ps(left.data + 4);
+    __m128 c2 = _mm_loadu_ps(left.data + 8);
+    __m128 c3 = _mm_loadu_ps(left.data + 12);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        __m128 result[4];
+
+        // each column of the product combines the columns of left; all of
+        // right is read before target is written, they may be the same
+        for (int column = 0; column < 4; ++column) {
+            const float* weights = right[i].data + column * 4;
+
+            result[column] = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(c0, _mm_set1_ps(weights[0])),
+                    _mm_mul_ps(c1, _mm_set1_ps(weights[1]))
+                ),
+                _mm_add_ps(
+                    _mm_mul_ps(c2, _mm_set1_ps(weights[2])),
+                    _mm_mul_ps(c3, _mm_set1_ps(weights[3]))
+                )
+            );
+        }
+
+        for (int column = 0; column < 4; ++column)
+            _mm_storeu_ps(target[i].data + column * 4, result[column]);
+    }
+}
+
+/*
+ * AVX2 kernels, compiled for AVX2 only and called after the CPU check. They
+ * don't use FMA, fused products round differently from the other versions.
+ */
+
+#define AVX2_KERNEL __attribute__((target("avx2")))
+
+AVX2_KERNEL
+void transformAvx2 (
+    const Mat4& matrix, const Vec3Arrays& points, const Vec3Arrays& target,
+    std::size_t count
+) {
+    const float* d = matrix.data;
+    __m256 m[12];
+    std::size_t i = 0;
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 4; ++column)
+            m[row * 4 + column] = _mm256_set1_ps(d[column * 4 + row]);
+    }
+
+    // 8 points per step
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(points.x + i);
+        __m256 y = _mm256_loadu_ps(points.y + i);
+        __m256 z = _mm256_loadu_ps(points.z + i);
+        float* outputs[3] = {target.x + i, target.y + i, target.z + i};
+
+        for (int row = 0; row < 3; ++row) {
+            const __m256* r = m + row * 4;
+
+            _mm256_storeu_ps(
+                outputs[row],
+                _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(r[0], x), _mm256_mul_ps(r[1], y)),
+                    _mm256_add_ps(_mm256_mul_ps(r[2], z), r[3])
+                )
+            );
+        }
+    }
+
+    transformScalar(matrix, points, target, i, count);
+}
+
+AVX2_KERNEL
+void composeAvx2 (
+    const Vec3Arrays& translations, const QuatArrays& rotations,
+    const Vec3Arrays& scales, Mat4* target, std::size_t count
+) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    std::size_t i = 0;
+
+    // 8 matrices per step, the same terms as composeSse2()
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(rotations.x + i);
+        __m256 y = _mm256_loadu_ps(rotations.y + i);
+        __m256 z = _mm256_loadu_ps(rotations.z + i);
+        __m256 w = _mm256_loadu_ps(rotations.w + i);
+        __m256 sx = _mm256_loadu_ps(scales.x + i);
+        __m256 sy = _mm256_loadu_ps(scales.y + i);
+        __m256 sz = _mm256_loadu_ps(scales.z + i);
+
+        __m256 xx = _mm256_mul_ps(x, x);
+        __m256 yy = _mm256_mul_ps(y, y);
+        __m256 zz = _mm256_mul_ps(z, z);
+        __m256 xy = _mm256_mul_ps(x, y);
+        __m256 xz = _mm256_mul_ps(x, z);
+        __m256 yz = _mm256_mul_ps(y, z);
+        __m256 wx = _mm256_mul_ps(w, x);
+        __m256 wy = _mm256_mul_ps(w, y);
+        __m256 wz = _mm256_mul_ps(w, z);
+
+        __m256 columns[16] = {
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+            _mm256_setzero_ps(),
+
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+            _mm256_setzero_ps(),
+
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+            _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+            _mm256_setzero_ps(),
+
+            _mm256_loadu_ps(translations.x + i),
+            _mm256_loadu_ps(translations.y + i),
+            _mm256_loadu_ps(translations.z + i),
+            one
+        };
+
+        // a 4x4 transpose in each 128 bit half: the low half holds the
+        // column of matrices i to i + 3, the high half of i + 4 to i + 7
+        for (int column = 0; column < 4; ++column) {
+            const __m256* r = columns + column * 4;
+            __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+            __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+            __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+            __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            __m256 lanes[4] = {
+                _mm256_shuffle_ps(t0, t2, 0x44),
+                _mm256_shuffle_ps(t0, t2, 0xEE),
+                _mm256_shuffle_ps(t1, t3, 0x44),
+                _mm256_shuffle_ps(t1, t3, 0xEE)
+            };
+
+            for (int k = 0; k < 4; ++k) {
+                _mm_storeu_ps(
+                    target[i + k].data + column * 4, _mm256_castps256_ps128(lanes[k])
+                );
+                _mm_storeu_ps(
+                    target[i + k + 4].data + column * 4, _mm256_extractf128_ps(lanes[k], 1)
+                );
+            }
+        }
+    }
+
+    composeScalar(translations, rotations, scales, target, i, count);
+}
+
+AVX2_KERNEL
+void multiplyAvx2 (const Mat4& left, const Mat4* right, Mat4* target, std::size_t count)
+{
+    // the columns of left in both halves, two columns of right per register
+    __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(left.data));
+    __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(left.data + 4));
+    __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(left.data + 8));
+    __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(left.data + 12));
+
+    for (std::size_t i = 0; i < count; ++i) {
+        __m256 weights[2] = {
+            _mm256_loadu_ps(right[i].data),
+            _mm256_loadu_ps(right[i].data + 8)
+        };
+        __m256 result[2];
+
+        for (int k = 0; k < 2; ++k) {
+            result[k] = _mm256_add_ps(
+                _mm256_add_ps(
+                    _mm256_mul_ps(c0, _mm256_permute_ps(weights[k], 0x00)),
+                    _mm256_mul_ps(c1, _mm256_permute_ps(weights[k], 0x55))
+                ),
+                _mm256_add_ps(
+                    _mm256_mul_ps(c2, _mm256_permute_ps(weights[k], 0xAA)),
+                    _mm256_mul_ps(c3, _mm256_permute_ps(weights[k], 0xFF))
+                )
+            );
+        }
+
+        _mm256_storeu_ps(target[i].data, result[0]);
+        _mm256_storeu_ps(target[i].data + 8, result[1]);
+    }
+}
+
+#endif // MATH_KERNELS_X86
+
+} // namespace
+
+/*!
+ * Get the level the kernels run with
+ *
+ * \return The active level
+ */
+SimdLevel MathKernels::getLevel ()
+{
+    return getActiveLevel();
+}
+
+/*!
+ * Force a level, used to compare the versions. Not thread safe, call it
+ * before any kernel runs on another thread.
+ *
+ * \param[in] level The level, clamped to the supported one
+ *
+ * \return The level actually set
+ */
+SimdLevel MathKernels::setLevel (SimdLevel level)
+{
+    getActiveLevel() = std::min(level, ImageKernels::getSupportedLevel());
+
+    return getActiveLevel();
+}
+
+/*!
+ * Transform points by an affine matrix, w is 1 and the last row of the
+ * matrix is ignored
+ *
+ * \param[in]  matrix The matrix
+ * \param[in]  points The points
+ * \param[out] target The transformed points, may be points itself
+ * \param[in]  count  The number of points
+ *
+ * \return void
+ */
+void MathKernels::transformPoints (
+    const Mat4& matrix, const Vec3Arrays& points, const Vec3Arrays& target,
+    std::size_t count
+) {
+    switch (getLevel()) {
+#ifdef MATH_KERNELS_X86
+        case SimdLevel::Avx2:
+            transformAvx2(matrix, points, target, count);
+            break;
+        case SimdLevel::Sse2:
+            transformSse2(matrix, points, target, count);
+            break;
+#endif
+        default:
+            transformScalar(matrix, points, target, 0, count);
+    }
+}
+
+/*!
+ * Build model matrices, T * R * S, see makeTransform()
+ *
+ * \param[in]  translations The translations
+ * \param[in]  rotations    The rotations, unit length
+ * \param[in]  scales       The scales along each axis
+ * \param[out] target       The matrices
+ * \param[in]  count        The number of matrices
+ *
+ * \return void
+ */
+void MathKernels::composeTransforms (
+    const Vec3Arrays& translations, const QuatArrays& rotations,
+    const Vec3Arrays& scales, Mat4* target, std::size_t count
+) {
+    switch (getLevel()) {
+#ifdef MATH_KERNELS_X86
+        case SimdLevel::Avx2:
+            composeAvx2(translations, rotations, scales, target, count);
+            break;
+        case SimdLevel::Sse2:
+            composeSse2(translations, rotations, scales, target, count);
+            break;
+#endif
+        default:
+            composeScalar(translations, rotations, scales, target, 0, count);
+    }
+}
+
+/*!
+ * Multiply matrices by the same matrix on their left, a view projection
+ * by model matrices for instance
+ *
+ * \param[in]  left   The left matrix
+ * \param[in]  right  The right matrices
+ * \param[out] target The products, may be right itself
+ * \param[in]  count  The number of matrices
+ *
+ * \return void
+ */
+void MathKernels::multiplyMatrices (
+    const Mat4& left, const Mat4* right, Mat4* target, std::size_t count
+) {
+    switch (getLevel()) {
+#ifdef MATH_KERNELS_X86
+        case SimdLevel::Avx2:
+            multiplyAvx2(left, right, target, count);
+            break;
+        case SimdLevel::Sse2:
+            multiplySse2(left, right, target, count);
+            break;
+#endif
+        default:
+            multiplyScalar(left, right, target, 0, count);
+    }
+}
@@ -0,0 +1,119 @@
+/*!
+ * \file  MathKernels.hpp
+ * \brief Vectorized batch transforms on structure of arrays inputs: points
+ *        by a matrix, translation, rotation and scale to matrices, matrix
+ *        products
+ */
+
+#ifndef __MATH_KERNELS_HPP
+#define __MATH_KERNELS_HPP
+
+#include <cstddef>
+
+#include "ImageKernels.hpp"
+#include "MathTypes.hpp"
+
+//! Vec3Arrays
+/*!
+ * Vec3Arrays is a structure of arrays of Vec3, one array per component
+ */
+struct Vec3Arrays
+{
+    float* x;
+    float* y;
+    float* z;
+};
+
+//! QuatArrays
+/*!
+ * QuatArrays is a structure of arrays of Quat, one array per component
+ */
+struct QuatArrays
+{
+    float* x;
+    float* y;
+    float* z;
+    float* w;
+};
+
+//! MathKernels
+/*!
+ * MathKernels holds the batch transforms that feed the instancing and
+ * uniform buffer paths. Like ImageKernels, each kernel has a scalar
+ * version and SSE2 and AVX2 versions, the best one the CPU supports is
+ * picked at run time, so the build needs no special flags.
+ *
+ * The inputs are structures of arrays: a SIMD register then holds the same
+ * component of 4 or 8 elements and no shuffling is needed to compute; the
+ * matrices produced are stored as arrays of Mat4, what the GL reads. All
+ * the versions round the same way, their results are identical.
+ */
+class MathKernels
+{
+ public:
+    /*!
+     * Get the level the kernels run with
+     *
+     * \return The active level
+     */
+    static SimdLevel getLevel ();
+
+    /*!
+     * Force a level, used to compare the versions. Not thread safe, call it
+     * before any kernel runs on another thread.
+     *
+     * \param[in] level The level, clamped to the supported one
+     *
+     * \return The level actually set
+     */
+    static SimdLevel setLevel (SimdLevel level);
+
+    /*!
+     * Transform points by an affine matrix, w is 1 and the last row of the
+     * matrix is ignored
+     *
+     * \param[in]  matrix The matrix
+     * \param[in]  points The points
+     * \param[out] target The transformed points, may be points itself
+     * \param[in]  count  The number of points
+     *
+     * \return void
+     */
+    static void transformPoints (
+        const Mat4& matrix, const Vec3Arrays& points, const Vec3Arrays& target,
+        std::size_t count
+    );
+
+    /*!
+     * Build model matrices, T * R * S, see makeTransform()
+     *
+     * \param[in]  translations The translations
+     * \param[in]  rotations    The rotations, unit length
+     * \param[in]  scales       The scales along each axis
+     * \param[out] target       The matrices
+     * \param[in]  count        The number of matrices
+     *
+     * \return void
+     */
+    static void composeTransforms (
+        const Vec3Arrays& translations, const QuatArrays& rotations,
+        const Vec3Arrays& scales, Mat4* target, std::size_t count
+    );
+
+    /*!
+     * Multiply matrices by the same matrix on their left, a view projection
+     * by model matrices for instance
+     *
+     * \param[in]  left   The left matrix
+     * \param[in]  right  The right matrices
+     * \param[out] target The products, may be right itself
+     * \param[in]  count  The number of matrices
+     *
+     * \return void
+     */
+    static void multiplyMatrices (
+        const Mat4& left, const Mat4* right, Mat4* target, std::size_t count
+    );
+};
+
+#endif // __MATH_KERNELS_HPP
@@ -0,0 +1,540 @@
+/*!
+ * \file  MathTypes.hpp
+ * \brief Vector, matrix and quaternion types for CPU side transforms, using
+ *        SSE2 where the target has it
+ */
+
+#ifndef __MATH_TYPES_HPP
+#define __MATH_TYPES_HPP
+
+#include <cmath>
+
+#ifdef __SSE2__
+#define MATH_TYPES_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * The conventions are GLSL's: vectors are columns, matrices are column
+ * major and multiply vectors on their left, M * v. Mat4 has the memory
+ * layout of a std140 mat4 and of glUniformMatrix4fv with transpose false,
+ * it can be copied as is into a uniform block or an instance buffer.
+ *
+ * SSE2 is part of x86-64, the types use it without any build flag; other
+ * targets get the scalar code. The batch versions of the heavy operations,
+ * with AVX2, are in MathKernels.
+ */
+
+//! Vec3
+struct Vec3
+{
+    float x;
+    float y;
+    float z;
+};
+
+//! Vec4
+struct alignas(16) Vec4
+{
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+//! Quat
+/*!
+ * A rotation, x, y and z are the vector part; only unit quaternions are
+ * rotations
+ */
+struct alignas(16) Quat
+{
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+//! Mat4
+/*!
+ * A column major 4x4 matrix, data[column * 4 + row]
+ */
+struct alignas(16) Mat4
+{
+    float data[16];
+};
+
+/*
+ * Vec3
+ */
+
+inline Vec3 operator+ (const Vec3& a, const Vec3& b)
+{
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline Vec3 operator- (const Vec3& a, const Vec3& b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline Vec3 operator* (const Vec3& v, float s)
+{
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+/*!
+ * Get the dot product of two vectors
+ *
+ * \param[in] a The first vector
+ * \param[in] b The second vector
+ *
+ * \return a . b
+ */
+inline float dot (const Vec3& a, const Vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/*!
+ * Get the cross product of two vectors
+ *
+ * \param[in] a The first vector
+ * \param[in] b The second vector
+ *
+ * \return a x b
+ */
+inline Vec3 cross (const Vec3& a, const Vec3& b)
+{
+    return {
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x
+    };
+}
+
+/*!
+ * Get the length of a vector
+ *
+ * \param[in] v The vector
+ *
+ * \return |v|
+ */
+inline float length (const Vec3& v)
+{
+    return std::sqrt(dot(v, v));
+}
+
+/*!
+ * Scale a vector to length 1
+ *
+ * \param[in] v The vector, not null
+ *
+ * \return v / |v|
+ */
+inline Vec3 normalize (const Vec3& v)
+{
+    return v * (1.0f / length(v));
+}
+
+/*
+ * Vec4
+ */
+
+#ifdef MATH_TYPES_SSE2
+
+inline __m128 loadVec4 (const Vec4& v)
+{
+    return _mm_load_ps(&v.x);
+}
+
+inline Vec4 storeVec4 (__m128 v)
+{
+    Vec4 result;
+
+    _mm_store_ps(&result.x, v);
+
+    return result;
+}
+
+inline Vec4 operator+ (const Vec4& a, const Vec4& b)
+{
+    return storeVec4(_mm_add_ps(loadVec4(a), loadVec4(b)));
+}
+
+inline Vec4 operator- (const Vec4& a, const Vec4& b)
+{
+    return storeVec4(_mm_sub_ps(loadVec4(a), loadVec4(b)));
+}
+
+inline Vec4 operator* (const Vec4& v, float s)
+{
+    return storeVec4(_mm_mul_ps(loadVec4(v), _mm_set1_ps(s)));
+}
+
+#else
+
+inline Vec4 operator+ (const Vec4& a, const Vec4& b)
+{
+    return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+
+inline Vec4 operator- (const Vec4& a, const Vec4& b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+}
+
+inline Vec4 operator* (const Vec4& v, float s)
+{
+    return {v.x * s, v.y * s, v.z * s, v.w * s};
+}
+
+#endif // MATH_TYPES_SSE2
+
+/*!
+ * Get the dot product of two vectors
+ *
+ * \param[in] a The first vector
+ * \param[in] b The second vector
+ *
+ * \return a . b
+ */
+inline float dot (const Vec4& a, const Vec4& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/*
+ * Quat
+ */
+
+/*!
+ * Build a rotation around an axis
+ *
+ * \param[in] axis  The axis, unit length
+ * \param[in] angle The angle, in radians, counterclockwise looking down the
+ *                  axis
+ *
+ * \return The rotation
+ */
+inline Quat makeRotation (const Vec3& axis, float angle)
+{
+    float s = std::sin(angle * 0.5f);
+
+    return {axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f)};
+}
+
+/*!
+ * Compose two rotations
+ *
+ * \param[in] a The rotation applied second
+ * \param[in] b The rotation applied first
+ *
+ * \return The rotation by b then a
+ */
+inline Quat operator* (const Quat& a, const Quat& b)
+{
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+}
+
+/*!
+ * Scale a quaternion to length 1
+ *
+ * \param[in] q The quaternion, not null
+ *
+ * \return q / |q|
+ */
+inline Quat normalize (const Quat& q)
+{
+    float s = 1.0f / std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+
+    return {q.x * s, q.y * s, q.z * s, q.w * s};
+}
+
+/*!
+ * Rotate a vector
+ *
+ * \param[in] q The rotation
+ * \param[in] v The vector
+ *
+ * \return The rotated vector
+ */
+inline Vec3 rotate (const Quat& q, const Vec3& v)
+{
+    // v + 2w (u x v) + 2 u x (u x v), u the vector part
+    Vec3 u = {q.x, q.y, q.z};
+    Vec3 t = cross(u, v) * 2.0f;
+
+    return v + t * q.w + cross(u, t);
+}
+
+/*!
+ * Interpolate two rotations along the shorter arc, normalized linear
+ * interpolation: the speed is not constant, which is fine between
+ * animation keys close to each other
+ *
+ * \param[in] a The rotation at 0
+ * \param[in] b The rotation at 1
+ * \param[in] t The parameter, in [0, 1]
+ *
+ * \return The rotation
+ */
+inline Quat nlerp (const Quat& a, const Quat& b, float t)
+{
+    float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f) ? -1.0f : 1.0f;
+    float u = 1.0f - t;
+    float v = t * sign;
+
+    return normalize({
+        a.x * u + b.x * v, a.y * u + b.y * v, a.z * u + b.z * v, a.w * u + b.w * v
+    });
+}
+
+/*
+ * Mat4
+ */
+
+/*!
+ * Get the identity matrix
+ *
+ * \return The identity
+ */
+inline Mat4 makeIdentity ()
+{
+    return {{
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    }};
+}
+
+/*!
+ * Build the matrix scaling, then rotating, then translating a point: the
+ * model matrix of an object, T * R * S
+ *
+ * \param[in] translation The translation
+ * \param[in] rotation    The rotation, unit length
+ * \param[in] scale       The scale along each axis
+ *
+ * \return The matrix
+ */
+inline Mat4 makeTransform (const Vec3& translation, const Quat& rotation, const Vec3& scale)
+{
+    float x = rotation.x;
+    float y = rotation.y;
+    float z = rotation.z;
+    float w = rotation.w;
+
+    return {{
+        (1.0f - 2.0f * (y * y + z * z)) * scale.x,
+        2.0f * (x * y + w * z) * scale.x,
+        2.0f * (x * z - w * y) * scale.x,
+        0.0f,
+
+        2.0f * (x * y - w * z) * scale.y,
+        (1.0f - 2.0f * (x * x + z * z)) * scale.y,
+        2.0f * (y * z + w * x) * scale.y,
+        0.0f,
+
+        2.0f * (x * z + w * y) * scale.z,
+        2.0f * (y * z - w * x) * scale.z,
+        (1.0f - 2.0f * (x * x + y * y)) * scale.z,
+        0.0f,
+
+        translation.x, translation.y, translation.z, 1.0f
+    }};
+}
+
+/*!
+ * Build an orthographic projection, glOrtho
+ *
+ * \param[in] left   The x mapped to -1
+ * \param[in] right  The x mapped to 1
+ * \param[in] bottom The y mapped to -1
+ * \param[in] top    The y mapped to 1
+ * \param[in] near   The distance mapped to -1
+ * \param[in] far    The distance mapped to 1
+ *
+ * \return The projection
+ */
+inline Mat4 makeOrthographic (
+    float left, float right, float bottom, float top, float near, float far
+) {
+    Mat4 m = makeIdentity();
+
+    m.data[0] = 2.0f / (right - left);
+    m.data[5] = 2.0f / (top - bottom);
+    m.data[10] = -2.0f / (far - near);
+    m.data[12] = -(right + left) / (right - left);
+    m.data[13] = -(top + bottom) / (top - bottom);
+    m.data[14] = -(far + near) / (far - near);
+
+    return m;
+}
+
+/*!
+ * Build a perspective projection, gluPerspective
+ *
+ * \param[in] fovy   The vertical field of view, in radians
+ * \param[in] aspect The width divided by the height
+ * \param[in] near   The distance to the near plane, positive
+ * \param[in] far    The distance to the far plane
+ *
+ * \return The projection
+ */
+inline Mat4 makePerspective (float fovy, float aspect, float near, float far)
+{
+    float f = 1.0f / std::tan(fovy * 0.5f);
+    Mat4 m = {{0.0f}};
+
+    m.data[0] = f / aspect;
+    m.data[5] = f;
+    m.data[10] = (far + near) / (near - far);
+    m.data[11] = -1.0f;
+    m.data[14] = 2.0f * far * near / (near - far);
+
+    return m;
+}
+
+/*!
+ * Swap the rows and the columns of a matrix
+ *
+ * \param[in] m The matrix
+ *
+ * \return The transpose
+ */
+inline Mat4 transpose (const Mat4& m)
+{
+    Mat4 result;
+
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row)
+            result.data[column * 4 + row] = m.data[row * 4 + column];
+    }
+
+    return result;
+}
+
+#ifdef MATH_TYPES_SSE2
+
+/*!
+ * Multiply two matrices
+ *
+ * \param[in] a The left matrix
+ * \param[in] b The right matrix
+ *
+ * \return a * b
+ */
+inline Mat4 operator* (const Mat4& a, const Mat4& b)
+{
+    __m128 c0 = _mm_load_ps(a.data);
+    __m128 c1 = _mm_load_ps(a.data + 4);
+    __m128 c2 = _mm_load_ps(a.data + 8);
+    __m128 c3 = _mm_load_ps(a.data + 12);
+    Mat4 result;
+
+    // each column of the result combines the columns of a
+    for (int column = 0; column < 4; ++column) {
+        const float* weights = b.data + column * 4;
+
+        _mm_store_ps(
+            result.data + column * 4,
+            _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(c0, _mm_set1_ps(weights[0])),
+                    _mm_mul_ps(c1, _mm_set1_ps(weights[1]))
+                ),
+                _mm_add_ps(
+                    _mm_mul_ps(c2, _mm_set1_ps(weights[2])),
+                    _mm_mul_ps(c3, _mm_set1_ps(weights[3]))
+                )
+            )
+        );
+    }
+
+    return result;
+}
+
+/*!
+ * Transform a vector
+ *
+ * \param[in] m The matrix
+ * \param[in] v The vector
+ *
+ * \return m * v
+ */
+inline Vec4 operator* (const Mat4& m, const Vec4& v)
+{
+    return storeVec4(
+        _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_load_ps(m.data), _mm_set1_ps(v.x)),
+                _mm_mul_ps(_mm_load_ps(m.data + 4), _mm_set1_ps(v.y))
+            ),
+            _mm_add_ps(
+                _mm_mul_ps(_mm_load_ps(m.data + 8), _mm_set1_ps(v.z)),
+                _mm_mul_ps(_mm_load_ps(m.data + 12), _mm_set1_ps(v.w))
+            )
+        )
+    );
+}
+
+#else
+
+inline Mat4 operator* (const Mat4& a, const Mat4& b)
+{
+    Mat4 result;
+
+    for (int column = 0; column < 4; ++column) {
+        const float* weights = b.data + column * 4;
+
+        for (int row = 0; row < 4; ++row) {
+            result.data[column * 4 + row] =
+                (a.data[row] * weights[0] + a.data[4 + row] * weights[1]) +
+                (a.data[8 + row] * weights[2] + a.data[12 + row] * weights[3]);
+        }
+    }
+
+    return result;
+}
+
+inline Vec4 operator* (const Mat4& m, const Vec4& v)
+{
+    const float* d = m.data;
+
+    return {
+        (d[0] * v.x + d[4] * v.y) + (d[8] * v.z + d[12] * v.w),
+        (d[1] * v.x + d[5] * v.y) + (d[9] * v.z + d[13] * v.w),
+        (d[2] * v.x + d[6] * v.y) + (d[10] * v.z + d[14] * v.w),
+        (d[3] * v.x + d[7] * v.y) + (d[11] * v.z + d[15] * v.w)
+    };
+}
+
+#endif // MATH_TYPES_SSE2
+
+/*!
+ * Transform a point by an affine matrix, w is 1 and the last row is ignored
+ *
+ * \param[in] m The matrix
+ * \param[in] p The point
+ *
+ * \return The transformed point
+ */
+inline Vec3 transformPoint (const Mat4& m, const Vec3& p)
+{
+    const float* d = m.data;
+
+    return {
+        (d[0] * p.x + d[4] * p.y) + (d[8] * p.z + d[12]),
+        (d[1] * p.x + d[5] * p.y) + (d[9] * p.z + d[13]),
+        (d[2] * p.x + d[6] * p.y) + (d[10] * p.z + d[14])
+    };
+}
+
+#endif // __MATH_TYPES_HPP
@@ -0,0 +1,190 @@
+#include "Mesh.hpp"
+
+#include <limits>
+#include <numeric>
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+
+/*!
+ * Mesh constructor, must be called with a current context
+ *
+ * \param[in] vertices   The interleaved vertices
+ * \param[in] indices    The indices of the triangles
+ * \param[in] attributes The number of components of each attribute
+ */
+Mesh::Mesh (
+    const std::vector<GLfloat>& vertices,
+    const std::vector<GLuint>& indices,
+    const std::vector<GLint>& attributes
+)
+    : Mesh(
+          vertices.data(), vertices.size() * sizeof(GLfloat), indices,
+          getFloatAttributes(attributes),
+          std::accumulate(attributes.begin(), attributes.end(), 0) * sizeof(GLfloat)
+      )
+{
+}
+
+/*!
+ * Mesh constructor, must be called with a current context
+ *
+ * \param[in] vertices   The interleaved vertices
+ * \param[in] size       The size of the vertices, in bytes
+ * \param[in] indices    The indices of the triangles
+ * \param[in] attributes The layout of a vertex, one attribute per location
+ * \param[in] stride     The size of a vertex, in bytes
+ */
+Mesh::Mesh (
+    const void* vertices,
+    GLsizeiptr size,
+    const std::vector<GLuint>& indices,
+    const std::vector<VertexAttribute>& attributes,
+    GLsizei stride
+)
+    : vao_(0),
+      vbo_(0),
+      ebo_(0),
+      count_(static_cast<GLsizei>(indices.size())),
+      index_type_(GL_UNSIGNED_INT)
+{
+    if (size / stride <= std::numeric_limits<GLushort>::max() + 1) {
+        std::vector<GLushort> short_indices(indices.begin(), indices.end());
+
+        index_type_ = GL_UNSIGNED_SHORT;
+        create(vertices, size, short_indices.data(), attributes, stride);
+    } else {
+        create(vertices, size, indices.data(), attributes, stride);
+    }
+}
+
+/*!
+ * Mesh constructor, must be called with a current context; the indices are
+ * uploaded as they are, from a MeshContainer for instance
+ *
+ * \param[in] vertices   The interleaved vertices
+ * \param[in] size       The size of the vertices, in bytes
+ * \param[in] indices    The indices of the triangles
+ * \param[in] count      The number of indices
+ * \param[in] index_type GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+ * \param[in] attributes The layout of a vertex, one attribute per location
+ * \param[in] stride     The size of a vertex, in bytes
+ */
+Mesh::Mesh (
+    const void* vertices,
+    GLsizeiptr size,
+    const void* indices,
+    GLsizei count,
+    GLenum index_type,
+    const std::vector<VertexAttribute>& attributes,
+    GLsizei stride
+)
+    : vao_(0),
+      vbo_(0),
+      ebo_(0),
+      count_(count),
+      index_type_(index_type)
+{
+    create(vertices, size, indices, attributes, stride);
+}
+
+/*!
+ * Mesh destructor
+ */
+Mesh::~Mesh ()
+{
+    GLState& state = GLState::getInstance();
+
+    state.forgetVertexArray(vao_);
+    state.forgetBuffer(vbo_);
+    state.forgetBuffer(ebo_);
+
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteBuffers(1, &ebo_);
+}
+
+/*!
+ * Draw every triangle of the mesh with the current program
+ *
+ * \return void
+ */
+void Mesh::draw ()
+{
+    ProfileScope scope("draw", true);
+
+    // the VAO stays bound, drawing the same mesh again binds nothing
+    GLState::getInstance().bindVertexArray(vao_);
+    glDrawElements(GL_TRIANGLES, count_, index_type_, 0);
+}
+
+/*!
+ * Get the vertex array object, to record draws in a RenderQueue
+ *
+ * \return The vertex array object
+ */
+GLuint Mesh::getVertexArray () const
+{
+    return vao_;
+}
+
+/*!
+ * Get the number of indices
+ *
+ * \return The number of indices
+ */
+GLsizei Mesh::getCount () const
+{
+    return count_;
+}
+
+/*!
+ * Get the type of the indices
+ *
+ * \return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+ */
+GLenum Mesh::getIndexType () const
+{
+    return index_type_;
+}
+
+/*!
+ * Create the buffers and record the layout, called by the constructors
+ *
+ * \param[in] vertices   The interleaved vertices
+ * \param[in] size       The size of the vertices, in bytes
+ * \param[in] indices    The indices of the triangles
+ * \param[in] attributes The layout of a vertex, one attribute per location
+ * \param[in] stride     The size of a vertex, in bytes
+ *
+ * \return void
+ */
+void Mesh::create (
+    const void* vertices,
+    GLsizeiptr size,
+    const void* indices,
+    const std::vector<VertexAttribute>& attributes,
+    GLsizei stride
+) {
+    GLState& state = GLState::getInstance();
+    GLsizeiptr index_size =
+        (index_type_ == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ebo_);
+
+    state.bindVertexArray(vao_);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+
+    // the element buffer binding is part of the VAO state
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count_ * index_size, indices, GL_STATIC_DRAW);
+
+    setVertexAttributes(attributes, stride);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+    state.bindVertexArray(0);
+}
@@ -0,0 +1,182 @@
+/*!
+ * \file  Mesh.hpp
+ * \brief Class definition of an indexed mesh stored in its own VAO
+ */
+
+#ifndef __MESH_HPP
+#define __MESH_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "VertexFormat.hpp"
+
+//! Mesh
+/*!
+ * Mesh uploads interleaved vertices and their indices once and records the
+ * attribute layout in a vertex array object. Float vertices give their
+ * attributes by number of components: {3, 3, 2} puts a vec3 at location 0,
+ * a vec3 at location 1 and a vec2 at location 2, 8 floats per vertex.
+ * PackedVertex vertices carry their own layout, packed types included.
+ *
+ * The indices are given as GLuint and stored as GLushort when every vertex
+ * can be reached with 16 bits, halving the element buffer; the draws use
+ * getIndexType().
+ */
+class Mesh
+{
+ private:
+    /*!
+     * The vertex array object
+     */
+    GLuint vao_;
+
+    /*!
+     * The vertex buffer object
+     */
+    GLuint vbo_;
+
+    /*!
+     * The element buffer object
+     */
+    GLuint ebo_;
+
+    /*!
+     * The number of indices
+     */
+    GLsizei count_;
+
+    /*!
+     * The type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GLenum index_type_;
+
+    /*!
+     * Create the buffers and record the layout, called by the constructors
+     *
+     * \param[in] vertices   The interleaved vertices
+     * \param[in] size       The size of the vertices, in bytes
+     * \param[in] indices    The indices of the triangles
+     * \param[in] attributes The layout of a vertex, one attribute per location
+     * \param[in] stride     The size of a vertex, in bytes
+     *
+     * \return void
+     */
+    void create (
+        const void* vertices,
+        GLsizeiptr size,
+        const void* indices,
+        const std::vector<VertexAttribute>& attributes,
+        GLsizei stride
+    );
+
+ public:
+    /*!
+     * Mesh constructor, must be called with a current context
+     *
+     * \param[in] vertices   The interleaved vertices
+     * \param[in] indices    The indices of the triangles
+     * \param[in] attributes The number of components of each attribute
+     */
+    Mesh (
+        const std::vector<GLfloat>& vertices,
+        const std::vector<GLuint>& indices,
+        const std::vector<GLint>& attributes
+    );
+
+    /*!
+     * Mesh constructor, must be called with a current context
+     *
+     * \param[in] vertices   The interleaved vertices
+     * \param[in] size       The size of the vertices, in bytes
+     * \param[in] indices    The indices of the triangles
+     * \param[in] attributes The layout of a vertex, one attribute per location
+     * \param[in] stride     The size of a vertex, in bytes
+     */
+    Mesh (
+        const void* vertices,
+        GLsizeiptr size,
+        const std::vector<GLuint>& indices,
+        const std::vector<VertexAttribute>& attributes,
+        GLsizei stride
+    );
+
+    /*!
+     * Mesh constructor, must be called with a current context; the indices
+     * are uploaded as they are, from a MeshContainer for instance
+     *
+     * \param[in] vertices   The interleaved vertices
+     * \param[in] size       The size of the vertices, in bytes
+     * \param[in] indices    The indices of the triangles
+     * \param[in] count      The number of indices
+     * \param[in] index_type GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     * \param[in] attributes The layout of a vertex, one attribute per location
+     * \param[in] stride     The size of a vertex, in bytes
+     */
+    Mesh (
+        const void* vertices,
+        GLsizeiptr size,
+        const void* indices,
+        GLsizei count,
+        GLenum index_type,
+        const std::vector<VertexAttribute>& attributes,
+        GLsizei stride
+    );
+
+    /*!
+     * Mesh constructor, must be called with a current context
+     *
+     * \param[in] vertices The vertices, a PackedVertex type
+     * \param[in] indices  The indices of the triangles
+     */
+    template <typename Vertex>
+    Mesh (
+        const std::vector<Vertex>& vertices,
+        const std::vector<GLuint>& indices
+    )
+        : Mesh(
+              vertices.data(), vertices.size() * sizeof(Vertex), indices,
+              Vertex::getAttributes(), sizeof(Vertex)
+          )
+    {
+    }
+
+    Mesh (const Mesh&) = delete;
+    Mesh& operator= (const Mesh&) = delete;
+
+    /*!
+     * Mesh destructor
+     */
+    ~Mesh ();
+
+    /*!
+     * Draw every triangle of the mesh with the current program
+     *
+     * \return void
+     */
+    void draw ();
+
+    /*!
+     * Get the vertex array object, to record draws in a RenderQueue
+     *
+     * \return The vertex array object
+     */
+    GLuint getVertexArray () const;
+
+    /*!
+     * Get the number of indices
+     *
+     * \return The number of indices
+     */
+    GLsizei getCount () const;
+
+    /*!
+     * Get the type of the indices
+     *
+     * \return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GLenum getIndexType () const;
+};
+
+#endif // __MESH_HPP
@@ -0,0 +1,267 @@
+#include "MeshContainer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+std::uint64_t alignOffset (std::uint64_t offset)
+{
+    return (offset + kMeshContainerAlignment - 1) & ~(kMeshContainerAlignment - 1);
+}
+
+std::uint64_t getIndexSize (std::uint32_t index_type)
+{
+    switch (index_type) {
+        case GL_UNSIGNED_SHORT:
+            return sizeof(GLushort);
+        case GL_UNSIGNED_INT:
+            return sizeof(GLuint);
+        default:
+            return 0;
+    }
+}
+
+// the box, then the sphere around its center reaching the farthest vertex
+void computeBounds (const MeshData& mesh, MeshContainerHeader& header)
+{
+    float start = mesh.vertices.empty() ? 0.0f : std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 3; ++i) {
+        header.bounds_min[i] = start;
+        header.bounds_max[i] = -start;
+    }
+
+    for (const MeshVertex& vertex : mesh.vertices) {
+        for (int i = 0; i < 3; ++i) {
+            header.bounds_min[i] = std::min(header.bounds_min[i], vertex.first[i]);
+            header.bounds_max[i] = std::max(header.bounds_max[i], vertex.first[i]);
+        }
+    }
+
+    float radius = 0.0f;
+
+    for (int i = 0; i < 3; ++i)
+        header.sphere[i] = (header.bounds_min[i] + header.bounds_max[i]) * 0.5f;
+
+    for (const MeshVertex& vertex : mesh.vertices) {
+        float distance = 0.0f;
+
+        for (int i = 0; i < 3; ++i) {
+            float delta = vertex.first[i] - header.sphere[i];
+            distance += delta * delta;
+        }
+
+        radius = std::max(radius, distance);
+    }
+
+    header.sphere[3] = std::sqrt(radius);
+}
+
+} // namespace
+
+/*!
+ * MeshContainer constructor, throws AssetError if the file can't be mapped
+ * or is not a valid container
+ *
+ * \param[in] path The path to the container
+ */
+MeshContainer::MeshContainer (const std::string& path)
+    : file_(path),
+      header_(nullptr),
+      attributes_(nullptr)
+{
+    std::size_t size = file_.getSize();
+
+    if (size < sizeof(MeshContainerHeader))
+        throw AssetError(path, "truncated header");
+
+    header_ = reinterpret_cast<const MeshContainerHeader*>(file_.getData());
+
+    if (std::memcmp(header_->magic, kMeshContainerMagic, 4))
+        throw AssetError(path, "not a mesh container");
+
+    if (header_->version != kMeshContainerVersion)
+        throw AssetError(path, "unsupported container version");
+
+    std::size_t table_end = sizeof(MeshContainerHeader) +
+        header_->attributes * sizeof(MeshContainerAttribute);
+
+    if ((header_->attributes == 0) || (size < table_end))
+        throw AssetError(path, "truncated attribute table");
+
+    attributes_ = reinterpret_cast<const MeshContainerAttribute*>(
+        file_.getData() + sizeof(MeshContainerHeader)
+    );
+
+    for (std::uint32_t i = 0; i < header_->attributes; ++i) {
+        if (attributes_[i].offset >= header_->stride)
+            throw AssetError(path, "attribute out of the vertex");
+    }
+
+    std::uint64_t index_size = getIndexSize(header_->index_type);
+
+    if (index_size == 0)
+        throw AssetError(path, "unsupported index type");
+
+    if (
+        (header_->vertex_size != std::uint64_t(header_->vertex_count) * header_->stride) ||
+        (header_->index_size != header_->index_count * index_size)
+    ) {
+        throw AssetError(path, "stream sizes don't match the counts");
+    }
+
+    if (
+        (header_->vertex_offset < table_end) ||
+        (header_->vertex_offset + header_->vertex_size > size) ||
+        (header_->index_offset < table_end) ||
+        (header_->index_offset + header_->index_size > size)
+    ) {
+        throw AssetError(path, "stream data out of bounds");
+    }
+}
+
+/*!
+ * Write a mesh into a container, its vertices must be in first use order,
+ * see MeshLoader::optimizeVertexFetch()
+ *
+ * \param[in] path       The path to the container
+ * \param[in] mesh       The mesh
+ * \param[in] cache_size The cache size the mesh was optimized for
+ *
+ * \return True if the file was written
+ */
+bool MeshContainer::write (
+    const std::string& path, const MeshData& mesh, unsigned int cache_size
+) {
+    std::vector<VertexAttribute> layout = MeshVertex::getAttributes();
+    std::vector<MeshContainerAttribute> attributes;
+
+    for (const VertexAttribute& attribute : layout) {
+        attributes.push_back({
+            static_cast<std::uint32_t>(attribute.size),
+            attribute.type,
+            attribute.normalized,
+            static_cast<std::uint32_t>(attribute.offset)
+        });
+    }
+
+    MeshContainerHeader header;
+
+    std::memcpy(header.magic, kMeshContainerMagic, 4);
+    header.version = kMeshContainerVersion;
+    header.vertex_count = mesh.vertices.size();
+    header.stride = sizeof(MeshVertex);
+    header.index_count = mesh.indices.size();
+    header.attributes = attributes.size();
+    header.cache_size = cache_size;
+
+    // the same rule as Mesh, 16 bits whenever every vertex fits
+    header.index_type =
+        (mesh.vertices.size() <= std::numeric_limits<GLushort>::max() + 1u) ?
+        GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    computeBounds(mesh, header);
+
+    header.vertex_size = mesh.vertices.size() * sizeof(MeshVertex);
+    header.vertex_offset = alignOffset(
+        sizeof(header) + attributes.size() * sizeof(MeshContainerAttribute)
+    );
+    header.index_size = mesh.indices.size() * getIndexSize(header.index_type);
+    header.index_offset = alignOffset(header.vertex_offset + header.vertex_size);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    const char padding[kMeshContainerAlignment] = {0};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(attributes.data()),
+        attributes.size() * sizeof(MeshContainerAttribute)
+    );
+
+    file.write(padding, header.vertex_offset - file.tellp());
+    file.write(reinterpret_cast<const char*>(mesh.vertices.data()), header.vertex_size);
+
+    file.write(padding, header.index_offset - file.tellp());
+
+    if (header.index_type == GL_UNSIGNED_SHORT) {
+        std::vector<GLushort> indices(mesh.indices.begin(), mesh.indices.end());
+
+        file.write(reinterpret_cast<const char*>(indices.data()), header.index_size);
+    } else {
+        file.write(reinterpret_cast<const char*>(mesh.indices.data()), header.index_size);
+    }
+
+    file.close();
+
+    return !file.fail();
+}
+
+/*!
+ * Get the header
+ *
+ * \return The header
+ */
+const MeshContainerHeader& MeshContainer::getHeader () const
+{
+    return *header_;
+}
+
+/*!
+ * Get the layout of a vertex
+ *
+ * \return The layout, one attribute per location
+ */
+std::vector<VertexAttribute> MeshContainer::getAttributes () const
+{
+    std::vector<VertexAttribute> attributes;
+
+    for (std::uint32_t i = 0; i < header_->attributes; ++i) {
+        attributes.push_back({
+            static_cast<GLint>(attributes_[i].size),
+            attributes_[i].type,
+            static_cast<GLboolean>(attributes_[i].normalized),
+            static_cast<GLsizei>(attributes_[i].offset)
+        });
+    }
+
+    return attributes;
+}
+
+/*!
+ * Get the vertex data
+ *
+ * \return The vertices, inside the mapping
+ */
+const void* MeshContainer::getVertices () const
+{
+    return file_.getData() + header_->vertex_offset;
+}
+
+/*!
+ * Get the index data
+ *
+ * \return The indices, inside the mapping
+ */
+const void* MeshContainer::getIndices () const
+{
+    return file_.getData() + header_->index_offset;
+}
+
+/*!
+ * Create a mesh straight from the mapping, must be called with a current
+ * context
+ *
+ * \return The mesh
+ */
+std::unique_ptr<Mesh> MeshContainer::upload () const
+{
+    return std::unique_ptr<Mesh>(new Mesh(
+        getVertices(), header_->vertex_size,
+        getIndices(), header_->index_count, header_->index_type,
+        getAttributes(), header_->stride
+    ));
+}
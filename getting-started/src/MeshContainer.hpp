@@ -0,0 +1,226 @@
+/*!
+ * \file  MeshContainer.hpp
+ * \brief Binary mesh container holding optimized vertex and index streams,
+ *        written by meshbake and uploaded without any parsing
+ */
+
+#ifndef __MESH_CONTAINER_HPP
+#define __MESH_CONTAINER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "AssetFile.hpp"
+#include "Mesh.hpp"
+#include "MeshLoader.hpp"
+#include "VertexFormat.hpp"
+
+/*
+ * File layout, little endian:
+ *
+ *     MeshContainerHeader
+ *     MeshContainerAttribute[attributes], location 0 first
+ *     vertex data, starting on a 64 byte boundary
+ *     index data, starting on a 64 byte boundary
+ *
+ * 64 bytes is the GL_MIN_MAP_BUFFER_ALIGNMENT every GL guarantees, the
+ * streams can be copied into a mapped buffer as well as given to
+ * glBufferData.
+ */
+
+//! MeshContainerHeader
+struct MeshContainerHeader
+{
+    /*!
+     * "LMSH"
+     */
+    char magic[4];
+
+    /*!
+     * The format version, kMeshContainerVersion
+     */
+    std::uint32_t version;
+
+    /*!
+     * The number of vertices
+     */
+    std::uint32_t vertex_count;
+
+    /*!
+     * The size of a vertex, in bytes
+     */
+    std::uint32_t stride;
+
+    /*!
+     * The number of indices, three per triangle
+     */
+    std::uint32_t index_count;
+
+    /*!
+     * The GL index type, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    std::uint32_t index_type;
+
+    /*!
+     * The number of entries of the attribute table
+     */
+    std::uint32_t attributes;
+
+    /*!
+     * The post-transform cache size the triangle order was optimized for
+     */
+    std::uint32_t cache_size;
+
+    /*!
+     * The corner of the bounding box with the smallest coordinates
+     */
+    float bounds_min[3];
+
+    /*!
+     * The corner of the bounding box with the largest coordinates
+     */
+    float bounds_max[3];
+
+    /*!
+     * The bounding sphere, center then radius
+     */
+    float sphere[4];
+
+    /*!
+     * The offset of the vertex data from the start of the file
+     */
+    std::uint64_t vertex_offset;
+
+    /*!
+     * The size of the vertex data
+     */
+    std::uint64_t vertex_size;
+
+    /*!
+     * The offset of the index data from the start of the file
+     */
+    std::uint64_t index_offset;
+
+    /*!
+     * The size of the index data
+     */
+    std::uint64_t index_size;
+};
+
+//! MeshContainerAttribute
+struct MeshContainerAttribute
+{
+    /*!
+     * The number of components
+     */
+    std::uint32_t size;
+
+    /*!
+     * The GL component type
+     */
+    std::uint32_t type;
+
+    /*!
+     * 1 if integers are normalized
+     */
+    std::uint32_t normalized;
+
+    /*!
+     * The offset in the vertex, in bytes
+     */
+    std::uint32_t offset;
+};
+
+const char kMeshContainerMagic[4] = {'L', 'M', 'S', 'H'};
+const std::uint32_t kMeshContainerVersion = 1;
+const std::uint64_t kMeshContainerAlignment = 64;
+
+//! MeshContainer
+/*!
+ * MeshContainer maps a container with a single mmap. The header, the
+ * attribute table and both streams are read in place, the only work done
+ * at load time is checking the offsets.
+ */
+class MeshContainer
+{
+ private:
+    /*!
+     * The mapped file
+     */
+    AssetFile file_;
+
+    /*!
+     * The header, inside the mapping
+     */
+    const MeshContainerHeader* header_;
+
+    /*!
+     * The attribute table, inside the mapping
+     */
+    const MeshContainerAttribute* attributes_;
+
+ public:
+    /*!
+     * MeshContainer constructor, throws AssetError if the file can't be
+     * mapped or is not a valid container
+     *
+     * \param[in] path The path to the container
+     */
+    explicit MeshContainer (const std::string& path);
+
+    /*!
+     * Write a mesh into a container, its vertices must be in first use
+     * order, see MeshLoader::optimizeVertexFetch()
+     *
+     * \param[in] path       The path to the container
+     * \param[in] mesh       The mesh
+     * \param[in] cache_size The cache size the mesh was optimized for
+     *
+     * \return True if the file was written
+     */
+    static bool write (
+        const std::string& path, const MeshData& mesh, unsigned int cache_size
+    );
+
+    /*!
+     * Get the header
+     *
+     * \return The header
+     */
+    const MeshContainerHeader& getHeader () const;
+
+    /*!
+     * Get the layout of a vertex
+     *
+     * \return The layout, one attribute per location
+     */
+    std::vector<VertexAttribute> getAttributes () const;
+
+    /*!
+     * Get the vertex data
+     *
+     * \return The vertices, inside the mapping
+     */
+    const void* getVertices () const;
+
+    /*!
+     * Get the index data
+     *
+     * \return The indices, inside the mapping
+     */
+    const void* getIndices () const;
+
+    /*!
+     * Create a mesh straight from the mapping, must be called with a
+     * current context
+     *
+     * \return The mesh
+     */
+    std::unique_ptr<Mesh> upload () const;
+};
+
+#endif // __MESH_CONTAINER_HPP
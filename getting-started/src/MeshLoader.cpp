@@ -0,0 +1,767 @@
+#include "MeshLoader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+static_assert(
+    sizeof(MeshVertex) == 20,
+    "MeshVertex must have no padding, it is hashed and compared as bytes"
+);
+
+const GLuint kNone = ~0u;
+
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//! FifoCache
+/*!
+ * FifoCache simulates a post-transform vertex cache with time stamps: a
+ * vertex is cached while fewer than size misses happened since its own
+ */
+class FifoCache
+{
+ private:
+    std::vector<unsigned int> stamps_;
+    unsigned int size_;
+    unsigned int time_;
+
+ public:
+    FifoCache (std::size_t vertex_count, unsigned int size)
+        : stamps_(vertex_count, 0),
+          size_(size),
+          time_(size + 1)
+    {
+    }
+
+    // true on a hit, a miss inserts the vertex
+    bool access (GLuint vertex)
+    {
+        if (time_ - stamps_[vertex] <= size_)
+            return true;
+
+        stamps_[vertex] = time_++;
+
+        return false;
+    }
+
+    unsigned int accessTriangle (const GLuint* triangle)
+    {
+        return !access(triangle[0]) + !access(triangle[1]) + !access(triangle[2]);
+    }
+
+    // the number of misses since the vertex was inserted
+    unsigned int getAge (GLuint vertex) const
+    {
+        return time_ - stamps_[vertex];
+    }
+
+    unsigned int getSize () const
+    {
+        return size_;
+    }
+
+    void flush ()
+    {
+        time_ += size_ + 1;
+    }
+};
+
+bool isDigit (char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+bool isSpace (char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+const char* skipSpaces (const char* p, const char* end)
+{
+    while ((p < end) && isSpace(*p))
+        ++p;
+
+    return p;
+}
+
+// strtof wants a NUL terminated string and honours the locale, the mapped
+// file is neither; 18 significant digits are plenty for a float
+const char* parseFloat (const char* p, const char* end, GLfloat* value)
+{
+    p = skipSpaces(p, end);
+
+    bool negative = false;
+
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+        negative = (*p++ == '-');
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    const char* start = p;
+
+    for (; (p < end) && isDigit(*p); ++p) {
+        if (digits < 18) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa != 0);
+        } else {
+            ++exponent;
+        }
+    }
+
+    if ((p < end) && (*p == '.')) {
+        for (++p; (p < end) && isDigit(*p); ++p) {
+            if (digits < 18) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            }
+        }
+    }
+
+    // a sign or a dot alone is not a number
+    if ((p == start) || ((p == start + 1) && (*start == '.')))
+        return nullptr;
+
+    if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+        bool negative_exponent = false;
+        int power = 0;
+
+        ++p;
+
+        if ((p < end) && ((*p == '-') || (*p == '+')))
+            negative_exponent = (*p++ == '-');
+
+        if ((p == end) || !isDigit(*p))
+            return nullptr;
+
+        for (; (p < end) && isDigit(*p); ++p)
+            power = std::min(power * 10 + (*p - '0'), 1000);
+
+        exponent += negative_exponent ? -power : power;
+    }
+
+    double result = static_cast<double>(mantissa);
+
+    if (exponent < 0)
+        result /= (exponent >= -22) ? kPowersOfTen[-exponent] : std::pow(10.0, -exponent);
+    else if (exponent > 0)
+        result *= (exponent <= 22) ? kPowersOfTen[exponent] : std::pow(10.0, exponent);
+
+    *value = static_cast<GLfloat>(negative ? -result : result);
+
+    return p;
+}
+
+const char* parseIndex (const char* p, const char* end, long* value)
+{
+    bool negative = false;
+
+    if ((p < end) && (*p == '-')) {
+        negative = true;
+        ++p;
+    }
+
+    if ((p == end) || !isDigit(*p))
+        return nullptr;
+
+    long result = 0;
+
+    for (; (p < end) && isDigit(*p); ++p)
+        result = std::min(result * 10 + (*p - '0'), 1L << 40);
+
+    *value = negative ? -result : result;
+
+    return p;
+}
+
+// OBJ indices start at 1, negative ones count back from the last element
+bool resolveIndex (long index, std::size_t count, std::size_t* resolved)
+{
+    long size = static_cast<long>(count);
+
+    if (index < 0)
+        index += size;
+    else
+        index -= 1;
+
+    if ((index < 0) || (index >= size))
+        return false;
+
+    *resolved = static_cast<std::size_t>(index);
+
+    return true;
+}
+
+std::uint32_t hashVertex (const MeshVertex& vertex)
+{
+    std::uint32_t words[sizeof(MeshVertex) / 4];
+    std::uint32_t hash = 0;
+
+    std::memcpy(words, &vertex, sizeof(words));
+
+    for (std::uint32_t word : words)
+        hash = (hash ^ word) * 0x9e3779b1u;
+
+    return hash ^ (hash >> 15);
+}
+
+// the centroid and normal of a triangle, returns twice its area
+double getTriangle (const MeshData& mesh, std::size_t triangle, double* centroid, double* normal)
+{
+    const Float3& a = mesh.vertices[mesh.indices[triangle * 3]].first;
+    const Float3& b = mesh.vertices[mesh.indices[triangle * 3 + 1]].first;
+    const Float3& c = mesh.vertices[mesh.indices[triangle * 3 + 2]].first;
+
+    double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+    normal[0] = u[1] * v[2] - u[2] * v[1];
+    normal[1] = u[2] * v[0] - u[0] * v[2];
+    normal[2] = u[0] * v[1] - u[1] * v[0];
+
+    for (int i = 0; i < 3; ++i)
+        centroid[i] = (a[i] + b[i] + c[i]) / 3.0;
+
+    return std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+}
+
+//! ClusterKey
+/*!
+ * ClusterKey is a run of triangles drawn together and how much it faces
+ * away from the center of the mesh
+ */
+struct ClusterKey
+{
+    std::size_t first;
+    std::size_t last;
+    double facing;
+};
+
+} // namespace
+
+/*!
+ * Load, weld and optimize an OBJ file, throws AssetError if the file can't
+ * be read or parsed
+ *
+ * \param[in] path The path to the file
+ *
+ * \return The mesh
+ */
+MeshData MeshLoader::load (const std::string& path)
+{
+    AssetFile file(path);
+    MeshData mesh = parseObj(file);
+
+    weld(mesh);
+    optimizeVertexCache(mesh);
+    optimizeOverdraw(mesh);
+    optimizeVertexFetch(mesh);
+
+    return mesh;
+}
+
+/*!
+ * Parse an OBJ file into a triangle list holding one vertex per corner,
+ * throws AssetError if the file is malformed
+ *
+ * \param[in] file The file
+ *
+ * \return The triangles, not welded
+ */
+MeshData MeshLoader::parseObj (const AssetFile& file)
+{
+    const Color4ub white = {{255, 255, 255, 255}};
+    const Half2 origin = packHalf2(0.0f, 0.0f);
+
+    std::vector<Float3> positions;
+    std::vector<Color4ub> colors;
+    std::vector<Half2> coordinates;
+    MeshData mesh;
+
+    const char* p = file.getData();
+    const char* end = p + file.getSize();
+    unsigned long line = 0;
+
+    auto fail = [&file, &line] (const char* message) {
+        return AssetError(file.getPath(), "line " + std::to_string(line) + ": " + message);
+    };
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+
+        if (eol == nullptr)
+            eol = end;
+
+        ++line;
+        p = skipSpaces(p, eol);
+
+        if ((eol - p >= 2) && (p[0] == 'v') && isSpace(p[1])) {
+            Float3 position;
+            GLfloat color[3];
+
+            p += 2;
+
+            for (GLfloat& component : position) {
+                if ((p = parseFloat(p, eol, &component)) == nullptr)
+                    throw fail("invalid position");
+            }
+
+            positions.push_back(position);
+
+            // the color extension, a single value is a w, ignored
+            const char* q = parseFloat(p, eol, &color[0]);
+
+            if ((q != nullptr) && ((q = parseFloat(q, eol, &color[1])) != nullptr)) {
+                if (parseFloat(q, eol, &color[2]) == nullptr)
+                    throw fail("invalid color");
+
+                colors.push_back(packColor(color[0], color[1], color[2]));
+            } else {
+                colors.push_back(white);
+            }
+        } else if ((eol - p >= 3) && (p[0] == 'v') && (p[1] == 't') && isSpace(p[2])) {
+            GLfloat u;
+            GLfloat v = 0.0f;
+
+            if ((p = parseFloat(p + 3, eol, &u)) == nullptr)
+                throw fail("invalid texture coordinates");
+
+            parseFloat(p, eol, &v);
+            coordinates.push_back(packHalf2(u, v));
+        } else if ((eol - p >= 2) && (p[0] == 'f') && isSpace(p[1])) {
+            MeshVertex first;
+            MeshVertex previous;
+            int corners = 0;
+
+            for (p = skipSpaces(p + 2, eol); p < eol; p = skipSpaces(p, eol)) {
+                long position_index;
+                long coordinate_index = 0;
+                long normal_index;
+                std::size_t position;
+                std::size_t coordinate = 0;
+
+                // v, v/vt, v//vn or v/vt/vn
+                if ((p = parseIndex(p, eol, &position_index)) == nullptr)
+                    throw fail("invalid face");
+
+                if ((p < eol) && (*p == '/') && (++p < eol) && (*p != '/')) {
+                    if ((p = parseIndex(p, eol, &coordinate_index)) == nullptr)
+                        throw fail("invalid face");
+                }
+
+                if ((p < eol) && (*p == '/')) {
+                    if ((p = parseIndex(p + 1, eol, &normal_index)) == nullptr)
+                        throw fail("invalid face");
+                }
+
+                if ((p < eol) && !isSpace(*p))
+                    throw fail("invalid face");
+
+                if (!resolveIndex(position_index, positions.size(), &position))
+                    throw fail("position index out of range");
+
+                if ((coordinate_index != 0) &&
+                    !resolveIndex(coordinate_index, coordinates.size(), &coordinate))
+                    throw fail("texture coordinates index out of range");
+
+                MeshVertex vertex = MeshVertex::make(
+                    positions[position],
+                    colors[position],
+                    (coordinate_index != 0) ? coordinates[coordinate] : origin
+                );
+
+                // a fan around the first corner
+                if (corners >= 2) {
+                    GLuint base = static_cast<GLuint>(mesh.vertices.size());
+
+                    mesh.vertices.push_back(first);
+                    mesh.vertices.push_back(previous);
+                    mesh.vertices.push_back(vertex);
+
+                    mesh.indices.push_back(base);
+                    mesh.indices.push_back(base + 1);
+                    mesh.indices.push_back(base + 2);
+                } else if (corners == 0) {
+                    first = vertex;
+                }
+
+                previous = vertex;
+                ++corners;
+            }
+
+            if (corners < 3)
+                throw fail("face with less than 3 corners");
+        }
+
+        // comments, normals, groups, materials and the rest are skipped
+        p = eol + 1;
+    }
+
+    return mesh;
+}
+
+/*!
+ * Merge the vertices that are bitwise identical and update the indices
+ *
+ * \param[in] mesh The mesh, modified
+ *
+ * \return void
+ */
+void MeshLoader::weld (MeshData& mesh)
+{
+    std::size_t count = mesh.vertices.size();
+    std::size_t capacity = 16;
+
+    // at most half full, the probe sequences stay short
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    std::vector<GLuint> table(capacity, kNone);
+    std::vector<GLuint> remap(count);
+    std::size_t mask = capacity - 1;
+    GLuint unique = 0;
+
+    // the unique vertices are compacted in place, never past the one read
+    for (std::size_t i = 0; i < count; ++i) {
+        const MeshVertex& vertex = mesh.vertices[i];
+        std::size_t slot = hashVertex(vertex) & mask;
+
+        while ((table[slot] != kNone) &&
+               std::memcmp(&mesh.vertices[table[slot]], &vertex, sizeof(MeshVertex)))
+            slot = (slot + 1) & mask;
+
+        if (table[slot] == kNone) {
+            table[slot] = unique;
+            mesh.vertices[unique++] = vertex;
+        }
+
+        remap[i] = table[slot];
+    }
+
+    mesh.vertices.resize(unique);
+
+    for (GLuint& index : mesh.indices)
+        index = remap[index];
+}
+
+/*!
+ * Reorder the triangles for a post-transform vertex cache with Tipsify
+ *
+ * \param[in] mesh       The mesh, modified
+ * \param[in] cache_size The number of vertices the cache holds
+ *
+ * \return void
+ */
+void MeshLoader::optimizeVertexCache (MeshData& mesh, unsigned int cache_size)
+{
+    const std::vector<GLuint>& indices = mesh.indices;
+    std::size_t vertex_count = mesh.vertices.size();
+    std::size_t triangle_count = indices.size() / 3;
+
+    if (triangle_count == 0)
+        return;
+
+    // the triangles of each vertex, packed one vertex after the other
+    std::vector<GLuint> live(vertex_count, 0);
+    std::vector<GLuint> offsets(vertex_count + 1, 0);
+    std::vector<GLuint> adjacency(triangle_count * 3);
+
+    for (std::size_t i = 0; i < triangle_count * 3; ++i)
+        ++live[indices[i]];
+
+    for (std::size_t v = 0; v < vertex_count; ++v)
+        offsets[v + 1] = offsets[v] + live[v];
+
+    std::vector<GLuint> fill(offsets.begin(), offsets.end() - 1);
+
+    for (std::size_t i = 0; i < triangle_count * 3; ++i)
+        adjacency[fill[indices[i]]++] = static_cast<GLuint>(i / 3);
+
+    std::vector<unsigned char> emitted(triangle_count, 0);
+    std::vector<GLuint> dead_ends;
+    std::vector<GLuint> candidates;
+    std::vector<GLuint> output;
+    FifoCache cache(vertex_count, cache_size);
+    std::size_t cursor = 0;
+    long fanning = indices[0];
+
+    output.reserve(triangle_count * 3);
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        // emit every triangle left around the fanning vertex
+        for (GLuint i = offsets[fanning]; i < offsets[fanning + 1]; ++i) {
+            GLuint triangle = adjacency[i];
+
+            if (emitted[triangle])
+                continue;
+
+            for (int corner = 0; corner < 3; ++corner) {
+                GLuint vertex = indices[triangle * 3 + corner];
+
+                output.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                --live[vertex];
+                cache.access(vertex);
+            }
+
+            emitted[triangle] = 1;
+        }
+
+        // the candidate that will still be cached after its fan and is the
+        // oldest, so its fan ends before it is evicted
+        fanning = -1;
+        long best = -1;
+
+        for (GLuint vertex : candidates) {
+            if (live[vertex] == 0)
+                continue;
+
+            long priority = 0;
+
+            if (cache.getAge(vertex) + 2 * live[vertex] <= cache.getSize())
+                priority = cache.getAge(vertex);
+
+            if (priority > best) {
+                best = priority;
+                fanning = vertex;
+            }
+        }
+
+        if (fanning >= 0)
+            continue;
+
+        // a dead end, go back to a recent vertex with triangles left
+        while (!dead_ends.empty()) {
+            GLuint vertex = dead_ends.back();
+
+            dead_ends.pop_back();
+
+            if (live[vertex] > 0) {
+                fanning = vertex;
+                break;
+            }
+        }
+
+        // or to the next one in input order
+        for (; (fanning < 0) && (cursor < vertex_count); ++cursor) {
+            if (live[cursor] > 0)
+                fanning = static_cast<long>(cursor);
+        }
+    }
+
+    mesh.indices.swap(output);
+}
+
+/*!
+ * Reorder clusters of triangles to reduce overdraw, after
+ * optimizeVertexCache(). A cluster ends where the cache is cold anyway or
+ * where its miss ratio is already within threshold of its whole run, so the
+ * ACMR grows by threshold at most.
+ *
+ * \param[in] mesh       The mesh, modified
+ * \param[in] cache_size The number of vertices the cache holds
+ * \param[in] threshold  The ACMR increase allowed, 1.05 is 5%
+ *
+ * \return void
+ */
+void MeshLoader::optimizeOverdraw (MeshData& mesh, unsigned int cache_size, double threshold)
+{
+    const std::vector<GLuint>& indices = mesh.indices;
+    std::size_t triangle_count = indices.size() / 3;
+
+    if (triangle_count == 0)
+        return;
+
+    // the hard boundaries, where the three vertices of a triangle miss
+    std::vector<std::size_t> hard;
+    FifoCache cache(mesh.vertices.size(), cache_size);
+
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        if ((cache.accessTriangle(&indices[t * 3]) == 3) || (t == 0))
+            hard.push_back(t);
+    }
+
+    hard.push_back(triangle_count);
+
+    // the soft boundaries, each piece restarts from a cold cache
+    std::vector<std::size_t> firsts;
+
+    for (std::size_t c = 0; c + 1 < hard.size(); ++c) {
+        std::size_t start = hard[c];
+        std::size_t stop = hard[c + 1];
+        unsigned long misses = 0;
+
+        cache.flush();
+
+        for (std::size_t t = start; t < stop; ++t)
+            misses += cache.accessTriangle(&indices[t * 3]);
+
+        double limit = threshold * misses / (stop - start);
+        std::size_t first = start;
+
+        misses = 0;
+        cache.flush();
+        firsts.push_back(start);
+
+        for (std::size_t t = start; t + 1 < stop; ++t) {
+            misses += cache.accessTriangle(&indices[t * 3]);
+
+            if (misses <= limit * (t + 1 - first)) {
+                first = t + 1;
+                misses = 0;
+                cache.flush();
+                firsts.push_back(first);
+            }
+        }
+    }
+
+    firsts.push_back(triangle_count);
+
+    // the clusters facing away from the mesh center go first
+    double center[3] = {0.0, 0.0, 0.0};
+    double total_area = 0.0;
+
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        double centroid[3];
+        double normal[3];
+        double area = getTriangle(mesh, t, centroid, normal);
+
+        for (int i = 0; i < 3; ++i)
+            center[i] += area * centroid[i];
+
+        total_area += area;
+    }
+
+    if (total_area > 0.0) {
+        for (double& component : center)
+            component /= total_area;
+    }
+
+    std::vector<ClusterKey> clusters;
+
+    for (std::size_t c = 0; c + 1 < firsts.size(); ++c) {
+        double cluster_centroid[3] = {0.0, 0.0, 0.0};
+        double cluster_normal[3] = {0.0, 0.0, 0.0};
+        double cluster_area = 0.0;
+
+        for (std::size_t t = firsts[c]; t < firsts[c + 1]; ++t) {
+            double centroid[3];
+            double normal[3];
+            double area = getTriangle(mesh, t, centroid, normal);
+
+            for (int i = 0; i < 3; ++i) {
+                cluster_centroid[i] += area * centroid[i];
+                cluster_normal[i] += normal[i];
+            }
+
+            cluster_area += area;
+        }
+
+        double facing = 0.0;
+
+        if (cluster_area > 0.0) {
+            double length = std::sqrt(
+                cluster_normal[0] * cluster_normal[0] +
+                cluster_normal[1] * cluster_normal[1] +
+                cluster_normal[2] * cluster_normal[2]
+            );
+
+            for (int i = 0; i < 3; ++i) {
+                double offset = cluster_centroid[i] / cluster_area - center[i];
+
+                facing += offset * cluster_normal[i] / std::max(length, 1e-30);
+            }
+        }
+
+        clusters.push_back({firsts[c], firsts[c + 1], facing});
+    }
+
+    std::stable_sort(
+        clusters.begin(), clusters.end(),
+        [] (const ClusterKey& a, const ClusterKey& b) {
+            return a.facing > b.facing;
+        }
+    );
+
+    std::vector<GLuint> output;
+
+    output.reserve(indices.size());
+
+    for (const ClusterKey& cluster : clusters) {
+        output.insert(
+            output.end(),
+            indices.begin() + cluster.first * 3,
+            indices.begin() + cluster.last * 3
+        );
+    }
+
+    mesh.indices.swap(output);
+}
+
+/*!
+ * Renumber the vertices in the order the triangles first use them and drop
+ * the vertices no triangle uses
+ *
+ * \param[in] mesh The mesh, modified
+ *
+ * \return void
+ */
+void MeshLoader::optimizeVertexFetch (MeshData& mesh)
+{
+    std::vector<GLuint> remap(mesh.vertices.size(), kNone);
+    std::vector<MeshVertex> vertices;
+
+    vertices.reserve(mesh.vertices.size());
+
+    for (GLuint& index : mesh.indices) {
+        if (remap[index] == kNone) {
+            remap[index] = static_cast<GLuint>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(vertices);
+}
+
+/*!
+ * Simulate a FIFO post-transform cache over an index list
+ *
+ * \param[in] indices      The indices, three per triangle
+ * \param[in] vertex_count The number of vertices
+ * \param[in] cache_size   The number of vertices the cache holds
+ *
+ * \return The miss ratios
+ */
+VertexCacheStats MeshLoader::measureVertexCache (
+    const std::vector<GLuint>& indices,
+    std::size_t vertex_count,
+    unsigned int cache_size
+) {
+    FifoCache cache(vertex_count, cache_size);
+    unsigned long misses = 0;
+
+    for (GLuint index : indices)
+        misses += !cache.access(index);
+
+    VertexCacheStats stats = {0.0, 0.0};
+
+    if (indices.size() >= 3)
+        stats.acmr = static_cast<double>(misses) / (indices.size() / 3);
+
+    if (vertex_count > 0)
+        stats.atvr = static_cast<double>(misses) / vertex_count;
+
+    return stats;
+}
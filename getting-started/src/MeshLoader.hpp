@@ -0,0 +1,169 @@
+/*!
+ * \file  MeshLoader.hpp
+ * \brief Load Wavefront OBJ meshes into the position, color and texture
+ *        coordinates layout, weld their vertices and reorder their triangles
+ *        for the post-transform vertex cache and for overdraw
+ */
+
+#ifndef __MESH_LOADER_HPP
+#define __MESH_LOADER_HPP
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "AssetFile.hpp"
+#include "VertexFormat.hpp"
+
+/*!
+ * The vertex of loaded meshes, the layout of the texture exercises: a
+ * position at location 0, a color at location 1 and texture coordinates at
+ * location 2
+ */
+typedef PackedVertex<Float3, Color4ub, Half2> MeshVertex;
+
+//! MeshData
+/*!
+ * MeshData is an indexed triangle list on the CPU, what Mesh uploads
+ */
+struct MeshData
+{
+    /*!
+     * The vertices
+     */
+    std::vector<MeshVertex> vertices;
+
+    /*!
+     * The indices, three per triangle
+     */
+    std::vector<GLuint> indices;
+};
+
+//! VertexCacheStats
+/*!
+ * VertexCacheStats is how often a FIFO post-transform cache misses while
+ * drawing a mesh, every miss runs the vertex shader once
+ */
+struct VertexCacheStats
+{
+    /*!
+     * The average cache miss ratio, misses per triangle, 0.5 at best on a
+     * large regular grid and 3 at worst
+     */
+    double acmr;
+
+    /*!
+     * The average transform to vertex ratio, misses per vertex, 1 at best
+     */
+    double atvr;
+};
+
+//! MeshLoader
+/*!
+ * MeshLoader turns OBJ files into MeshData. The reader handles the v, vt
+ * and f statements, with the common "v x y z r g b" color extension;
+ * polygons are split into triangle fans, normals, groups and materials are
+ * ignored. Vertices without a color are white, without texture coordinates
+ * they get (0, 0).
+ *
+ * parseObj() emits one vertex per face corner, weld() merges the corners
+ * whose packed vertex is the same through an open addressing hash table.
+ * The triangles are then ordered with Tipsify (Sander, Nehab and Barczak,
+ * "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"),
+ * split into clusters that each start on a cold cache, and the clusters
+ * sorted so the ones facing away from the mesh center, which are likely to
+ * hide the others, are drawn first. The vertices are finally renumbered in
+ * the order the triangles use them, so the vertex fetches walk forward.
+ */
+class MeshLoader
+{
+ public:
+    /*!
+     * The cache size the orders are optimized for, most GPUs since 2010
+     * reuse at least this many vertices
+     */
+    static const unsigned int kCacheSize = 16;
+
+    /*!
+     * Load, weld and optimize an OBJ file, throws AssetError if the file
+     * can't be read or parsed
+     *
+     * \param[in] path The path to the file
+     *
+     * \return The mesh
+     */
+    static MeshData load (const std::string& path);
+
+    /*!
+     * Parse an OBJ file into a triangle list holding one vertex per corner,
+     * throws AssetError if the file is malformed
+     *
+     * \param[in] file The file
+     *
+     * \return The triangles, not welded
+     */
+    static MeshData parseObj (const AssetFile& file);
+
+    /*!
+     * Merge the vertices that are bitwise identical and update the indices
+     *
+     * \param[in] mesh The mesh, modified
+     *
+     * \return void
+     */
+    static void weld (MeshData& mesh);
+
+    /*!
+     * Reorder the triangles for a post-transform vertex cache with Tipsify
+     *
+     * \param[in] mesh       The mesh, modified
+     * \param[in] cache_size The number of vertices the cache holds
+     *
+     * \return void
+     */
+    static void optimizeVertexCache (MeshData& mesh, unsigned int cache_size = kCacheSize);
+
+    /*!
+     * Reorder clusters of triangles to reduce overdraw, after
+     * optimizeVertexCache(). A cluster ends where the cache is cold anyway
+     * or where its miss ratio is already within threshold of its whole
+     * run, so the ACMR grows by threshold at most.
+     *
+     * \param[in] mesh       The mesh, modified
+     * \param[in] cache_size The number of vertices the cache holds
+     * \param[in] threshold  The ACMR increase allowed, 1.05 is 5%
+     *
+     * \return void
+     */
+    static void optimizeOverdraw (
+        MeshData& mesh, unsigned int cache_size = kCacheSize, double threshold = 1.05
+    );
+
+    /*!
+     * Renumber the vertices in the order the triangles first use them and
+     * drop the vertices no triangle uses
+     *
+     * \param[in] mesh The mesh, modified
+     *
+     * \return void
+     */
+    static void optimizeVertexFetch (MeshData& mesh);
+
+    /*!
+     * Simulate a FIFO post-transform cache over an index list
+     *
+     * \param[in] indices      The indices, three per triangle
+     * \param[in] vertex_count The number of vertices
+     * \param[in] cache_size   The number of vertices the cache holds
+     *
+     * \return The miss ratios
+     */
+    static VertexCacheStats measureVertexCache (
+        const std::vector<GLuint>& indices,
+        std::size_t vertex_count,
+        unsigned int cache_size = kCacheSize
+    );
+};
+
+#endif // __MESH_LOADER_HPP
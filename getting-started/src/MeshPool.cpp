@@ -0,0 +1,228 @@
+#include "MeshPool.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+
+/*!
+ * MeshPool constructor, must be called with a current context
+ *
+ * \param[in] attributes      The number of components of each attribute
+ * \param[in] vertex_capacity The number of vertices allocated up front
+ * \param[in] index_capacity  The number of indices allocated up front
+ */
+MeshPool::MeshPool (
+    const std::vector<GLint>& attributes,
+    GLsizei vertex_capacity,
+    GLsizei index_capacity
+)
+    : vao_(0),
+      vbo_(0),
+      ebo_(0),
+      attributes_(getFloatAttributes(attributes)),
+      stride_(std::accumulate(attributes.begin(), attributes.end(), 0) * sizeof(GLfloat)),
+      vertex_capacity_(vertex_capacity),
+      vertex_count_(0),
+      index_capacity_(index_capacity),
+      index_count_(0)
+{
+    GLState& state = GLState::getInstance();
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ebo_);
+
+    state.bindVertexArray(vao_);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(
+        GL_ARRAY_BUFFER, vertex_capacity_ * stride_, nullptr, GL_STATIC_DRAW
+    );
+
+    // the element buffer binding is part of the VAO state
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER, index_capacity_ * sizeof(GLuint), nullptr, GL_STATIC_DRAW
+    );
+
+    setAttributes();
+
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+    state.bindVertexArray(0);
+}
+
+/*!
+ * MeshPool destructor
+ */
+MeshPool::~MeshPool ()
+{
+    GLState& state = GLState::getInstance();
+
+    state.forgetVertexArray(vao_);
+    state.forgetBuffer(vbo_);
+    state.forgetBuffer(ebo_);
+
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteBuffers(1, &ebo_);
+}
+
+/*!
+ * Copy a mesh into the pool
+ *
+ * \param[in] vertices The interleaved vertices, in the pool format
+ * \param[in] indices  The indices of the triangles, from 0
+ *
+ * \return Where the mesh was stored
+ */
+MeshRange MeshPool::add (
+    const std::vector<GLfloat>& vertices,
+    const std::vector<GLuint>& indices
+) {
+    GLsizei vertex_count = static_cast<GLsizei>(vertices.size() * sizeof(GLfloat) / stride_);
+    GLsizei index_count = static_cast<GLsizei>(indices.size());
+
+    GLState& state = GLState::getInstance();
+
+    state.bindVertexArray(vao_);
+
+    if (vertex_count_ + vertex_count > vertex_capacity_) {
+        GLsizei capacity = std::max(vertex_capacity_ * 2, vertex_count_ + vertex_count);
+
+        grow(vbo_, GL_ARRAY_BUFFER, vertex_count_ * stride_, capacity * stride_);
+        vertex_capacity_ = capacity;
+
+        // the attributes point to the old buffer until they are recorded again
+        state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+        setAttributes();
+    }
+
+    if (index_count_ + index_count > index_capacity_) {
+        GLsizei capacity = std::max(index_capacity_ * 2, index_count_ + index_count);
+
+        grow(
+            ebo_, GL_ELEMENT_ARRAY_BUFFER,
+            index_count_ * sizeof(GLuint), capacity * sizeof(GLuint)
+        );
+        index_capacity_ = capacity;
+    }
+
+    state.bindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferSubData(
+        GL_ARRAY_BUFFER, vertex_count_ * stride_,
+        vertex_count * stride_, vertices.data()
+    );
+    glBufferSubData(
+        GL_ELEMENT_ARRAY_BUFFER, index_count_ * sizeof(GLuint),
+        index_count * sizeof(GLuint), indices.data()
+    );
+
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+    state.bindVertexArray(0);
+
+    MeshRange range = {
+        static_cast<GLuint>(index_count_), index_count, vertex_count_
+    };
+
+    vertex_count_ += vertex_count;
+    index_count_ += index_count;
+
+    return range;
+}
+
+/*!
+ * Draw every triangle of a mesh with the current program
+ *
+ * \param[in] range The mesh
+ *
+ * \return void
+ */
+void MeshPool::draw (const MeshRange& range)
+{
+    ProfileScope scope("draw", true);
+
+    GLState::getInstance().bindVertexArray(vao_);
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES, range.count, GL_UNSIGNED_INT,
+        reinterpret_cast<GLvoid*>(range.first_index * sizeof(GLuint)),
+        range.base_vertex
+    );
+}
+
+/*!
+ * Get the vertex array object
+ *
+ * \return The vertex array object
+ */
+GLuint MeshPool::getVertexArray () const
+{
+    return vao_;
+}
+
+/*!
+ * Get the number of vertices stored
+ *
+ * \return The number of vertices
+ */
+GLsizei MeshPool::getVertexCount () const
+{
+    return vertex_count_;
+}
+
+/*!
+ * Get the number of indices stored
+ *
+ * \return The number of indices
+ */
+GLsizei MeshPool::getIndexCount () const
+{
+    return index_count_;
+}
+
+/*!
+ * Replace a buffer with a larger one holding the same first bytes
+ *
+ * \param[in] buffer   The buffer, replaced
+ * \param[in] target   The target it is bound to in the vertex array
+ * \param[in] used     The bytes to keep
+ * \param[in] capacity The new size, in bytes
+ *
+ * \return void
+ */
+void MeshPool::grow (
+    GLuint& buffer, GLenum target, GLsizeiptr used, GLsizeiptr capacity
+) {
+    GLState& state = GLState::getInstance();
+    GLuint larger;
+
+    glGenBuffers(1, &larger);
+
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, larger);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+
+    // the copy stays on the GPU
+    if (used > 0) {
+        state.bindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+    }
+
+    state.forgetBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+
+    buffer = larger;
+
+    // the pool vertex array is bound, this records the new element buffer
+    state.bindBuffer(target, buffer);
+}
+
+/*!
+ * Record the vertex attributes of the vertex buffer in the vertex array
+ *
+ * \return void
+ */
+void MeshPool::setAttributes ()
+{
+    setVertexAttributes(attributes_, stride_);
+}
@@ -0,0 +1,185 @@
+/*!
+ * \file  MeshPool.hpp
+ * \brief Class definition of shared vertex and index buffers holding many
+ *        meshes of the same vertex format
+ */
+
+#ifndef __MESH_POOL_HPP
+#define __MESH_POOL_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "VertexFormat.hpp"
+
+//! MeshRange
+/*!
+ * MeshRange is where a mesh lives in a MeshPool, what an indexed draw
+ * needs to find it
+ */
+struct MeshRange
+{
+    /*!
+     * The first index, counted in indices
+     */
+    GLuint first_index;
+
+    /*!
+     * The number of indices
+     */
+    GLsizei count;
+
+    /*!
+     * The value added to each index, the first vertex of the mesh
+     */
+    GLint base_vertex;
+};
+
+//! MeshPool
+/*!
+ * MeshPool packs the vertices and indices of many meshes into one vertex
+ * buffer and one element buffer, recorded in a single vertex array. The
+ * attributes are given as for Mesh, {3, 2} is a vec3 at location 0 and a
+ * vec2 at location 1. The indices of a mesh stay relative to its first
+ * vertex, the draws add MeshRange::base_vertex.
+ *
+ * Space is handed out linearly and never given back; when a pool is full,
+ * its buffers are doubled and copied on the GPU, the ranges stay valid.
+ * Drawing meshes of one pool never changes the vertex array, which is
+ * what lets MultiDrawBatch issue them in a single call.
+ */
+class MeshPool
+{
+ private:
+    /*!
+     * The vertex array object
+     */
+    GLuint vao_;
+
+    /*!
+     * The vertex buffer object
+     */
+    GLuint vbo_;
+
+    /*!
+     * The element buffer object
+     */
+    GLuint ebo_;
+
+    /*!
+     * The layout of a vertex
+     */
+    std::vector<VertexAttribute> attributes_;
+
+    /*!
+     * The size of a vertex, in bytes
+     */
+    GLsizei stride_;
+
+    /*!
+     * The number of vertices the vertex buffer can hold
+     */
+    GLsizei vertex_capacity_;
+
+    /*!
+     * The number of vertices used
+     */
+    GLsizei vertex_count_;
+
+    /*!
+     * The number of indices the element buffer can hold
+     */
+    GLsizei index_capacity_;
+
+    /*!
+     * The number of indices used
+     */
+    GLsizei index_count_;
+
+    /*!
+     * Replace a buffer with a larger one holding the same first bytes
+     *
+     * \param[in] buffer   The buffer, replaced
+     * \param[in] target   The target it is bound to in the vertex array
+     * \param[in] used     The bytes to keep
+     * \param[in] capacity The new size, in bytes
+     *
+     * \return void
+     */
+    void grow (GLuint& buffer, GLenum target, GLsizeiptr used, GLsizeiptr capacity);
+
+    /*!
+     * Record the vertex attributes of the vertex buffer in the vertex array
+     *
+     * \return void
+     */
+    void setAttributes ();
+
+ public:
+    /*!
+     * MeshPool constructor, must be called with a current context
+     *
+     * \param[in] attributes      The number of components of each attribute
+     * \param[in] vertex_capacity The number of vertices allocated up front
+     * \param[in] index_capacity  The number of indices allocated up front
+     */
+    MeshPool (
+        const std::vector<GLint>& attributes,
+        GLsizei vertex_capacity = 1 << 16,
+        GLsizei index_capacity = 1 << 18
+    );
+
+    MeshPool (const MeshPool&) = delete;
+    MeshPool& operator= (const MeshPool&) = delete;
+
+    /*!
+     * MeshPool destructor
+     */
+    ~MeshPool ();
+
+    /*!
+     * Copy a mesh into the pool
+     *
+     * \param[in] vertices The interleaved vertices, in the pool format
+     * \param[in] indices  The indices of the triangles, from 0
+     *
+     * \return Where the mesh was stored
+     */
+    MeshRange add (
+        const std::vector<GLfloat>& vertices,
+        const std::vector<GLuint>& indices
+    );
+
+    /*!
+     * Draw every triangle of a mesh with the current program
+     *
+     * \param[in] range The mesh
+     *
+     * \return void
+     */
+    void draw (const MeshRange& range);
+
+    /*!
+     * Get the vertex array object
+     *
+     * \return The vertex array object
+     */
+    GLuint getVertexArray () const;
+
+    /*!
+     * Get the number of vertices stored
+     *
+     * \return The number of vertices
+     */
+    GLsizei getVertexCount () const;
+
+    /*!
+     * Get the number of indices stored
+     *
+     * \return The number of indices
+     */
+    GLsizei getIndexCount () const;
+};
+
+#endif // __MESH_POOL_HPP
@@ -0,0 +1,221 @@
+#include "MultiDrawBatch.hpp"
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+
+/*!
+ * MultiDrawBatch constructor, must be called with a current context
+ *
+ * \param[in] pool The pool holding every mesh the batch draws
+ */
+MultiDrawBatch::MultiDrawBatch (MeshPool& pool)
+    : pool_(pool),
+      instances_(),
+      command_buffer_(0),
+      path_(getSupportedPath())
+{
+    glGenBuffers(1, &command_buffer_);
+
+    instances_.attach(pool_.getVertexArray());
+}
+
+/*!
+ * MultiDrawBatch destructor
+ */
+MultiDrawBatch::~MultiDrawBatch ()
+{
+    GLState::getInstance().forgetBuffer(command_buffer_);
+
+    glDeleteBuffers(1, &command_buffer_);
+}
+
+/*!
+ * Get the best path the driver supports
+ *
+ * \return The path
+ */
+MultiDrawPath MultiDrawBatch::getSupportedPath ()
+{
+    if (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect)
+        return MultiDrawPath::kIndirect;
+
+    if (GLEW_VERSION_4_2 || GLEW_ARB_base_instance)
+        return MultiDrawPath::kBaseInstance;
+
+    return MultiDrawPath::kAttributes;
+}
+
+/*!
+ * Record a draw of one instance
+ *
+ * \param[in] range The mesh, from the batch pool
+ * \param[in] data  The per-draw data
+ *
+ * \return void
+ */
+void MultiDrawBatch::push (const MeshRange& range, const InstanceData& data)
+{
+    push(range, &data, 1);
+}
+
+/*!
+ * Record a draw of several instances
+ *
+ * \param[in] range     The mesh, from the batch pool
+ * \param[in] data      The data of each instance
+ * \param[in] instances The number of instances
+ *
+ * \return void
+ */
+void MultiDrawBatch::push (
+    const MeshRange& range, const InstanceData* data, GLuint instances
+) {
+    DrawElementsIndirectCommand command = {
+        static_cast<GLuint>(range.count),
+        instances,
+        range.first_index,
+        range.base_vertex,
+        static_cast<GLuint>(data_.size())
+    };
+
+    commands_.push_back(command);
+    data_.insert(data_.end(), data, data + instances);
+}
+
+/*!
+ * Upload the commands recorded and their per-draw data, the commands
+ * are kept until clear()
+ *
+ * \return void
+ */
+void MultiDrawBatch::upload ()
+{
+    if (commands_.empty())
+        return;
+
+    instances_.update(data_.data(), static_cast<GLsizei>(data_.size()));
+
+    // orphaned like the instances, the previous frame may still read it
+    GLState& state = GLState::getInstance();
+
+    state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_);
+    glBufferData(
+        GL_DRAW_INDIRECT_BUFFER,
+        commands_.size() * sizeof(DrawElementsIndirectCommand),
+        commands_.data(),
+        GL_STREAM_DRAW
+    );
+}
+
+/*!
+ * Draw the commands uploaded last with the current program
+ *
+ * \return void
+ */
+void MultiDrawBatch::draw ()
+{
+    ProfileScope scope("multi_draw", true);
+
+    GLState& state = GLState::getInstance();
+    GLsizei count = static_cast<GLsizei>(commands_.size());
+
+    state.bindVertexArray(pool_.getVertexArray());
+
+    switch (path_) {
+        case MultiDrawPath::kIndirect:
+            state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, count, 0);
+            break;
+
+        case MultiDrawPath::kBaseInstance:
+            for (const DrawElementsIndirectCommand& command : commands_) {
+                glDrawElementsInstancedBaseVertexBaseInstance(
+                    GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                    reinterpret_cast<GLvoid*>(command.first_index * sizeof(GLuint)),
+                    command.instance_count, command.base_vertex, command.base_instance
+                );
+            }
+            break;
+
+        case MultiDrawPath::kAttributes:
+            for (const DrawElementsIndirectCommand& command : commands_) {
+                instances_.attach(pool_.getVertexArray(), command.base_instance);
+                state.bindVertexArray(pool_.getVertexArray());
+
+                glDrawElementsInstancedBaseVertex(
+                    GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                    reinterpret_cast<GLvoid*>(command.first_index * sizeof(GLuint)),
+                    command.instance_count, command.base_vertex
+                );
+            }
+
+            // the next batch starts from the first instance again
+            instances_.attach(pool_.getVertexArray());
+            break;
+    }
+}
+
+/*!
+ * upload() then draw(), for commands recorded every frame
+ *
+ * \return void
+ */
+void MultiDrawBatch::submit ()
+{
+    upload();
+    draw();
+}
+
+/*!
+ * Forget the commands recorded
+ *
+ * \return void
+ */
+void MultiDrawBatch::clear ()
+{
+    commands_.clear();
+    data_.clear();
+}
+
+/*!
+ * Force a path, to compare them or work around a driver, the path must
+ * be supported
+ *
+ * \param[in] path The path
+ *
+ * \return void
+ */
+void MultiDrawBatch::setPath (MultiDrawPath path)
+{
+    path_ = path;
+}
+
+/*!
+ * Get the path used
+ *
+ * \return The path
+ */
+MultiDrawPath MultiDrawBatch::getPath () const
+{
+    return path_;
+}
+
+/*!
+ * Get the number of commands recorded
+ *
+ * \return The number of commands
+ */
+std::size_t MultiDrawBatch::getSize () const
+{
+    return commands_.size();
+}
+
+/*!
+ * Get the indirect buffer, holding DrawElementsIndirectCommand
+ *
+ * \return The buffer
+ */
+GLuint MultiDrawBatch::getCommandBuffer () const
+{
+    return command_buffer_;
+}
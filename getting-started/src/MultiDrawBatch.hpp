@@ -0,0 +1,221 @@
+/*!
+ * \file  MultiDrawBatch.hpp
+ * \brief Class definition of indirect draw commands submitted in one call
+ */
+
+#ifndef __MULTI_DRAW_BATCH_HPP
+#define __MULTI_DRAW_BATCH_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "InstanceBuffer.hpp"
+#include "MeshPool.hpp"
+
+//! DrawElementsIndirectCommand
+/*!
+ * DrawElementsIndirectCommand is the layout glMultiDrawElementsIndirect
+ * reads from GL_DRAW_INDIRECT_BUFFER, a compute shader writing commands
+ * must produce the same 20 bytes
+ */
+struct DrawElementsIndirectCommand
+{
+    /*!
+     * The number of indices
+     */
+    GLuint count;
+
+    /*!
+     * The number of instances
+     */
+    GLuint instance_count;
+
+    /*!
+     * The first index, counted in indices
+     */
+    GLuint first_index;
+
+    /*!
+     * The value added to each index
+     */
+    GLint base_vertex;
+
+    /*!
+     * The first instance, offsets the instanced attributes
+     */
+    GLuint base_instance;
+};
+
+//! MultiDrawPath
+/*!
+ * MultiDrawPath is how a MultiDrawBatch reaches the GPU, the first one the
+ * driver supports is used
+ */
+enum class MultiDrawPath
+{
+    // one glMultiDrawElementsIndirect, GL 4.3 or ARB_multi_draw_indirect
+    kIndirect,
+
+    // one glDrawElementsInstancedBaseVertexBaseInstance per command, GL 4.2
+    // or ARB_base_instance
+    kBaseInstance,
+
+    // one draw per command, the instanced attributes are moved to the
+    // command's base instance before each draw
+    kAttributes
+};
+
+//! MultiDrawBatch
+/*!
+ * MultiDrawBatch draws many distinct meshes of one MeshPool with a single
+ * glMultiDrawElementsIndirect. Each command gets its own InstanceData:
+ * the command's base instance indexes the instance buffer, so the
+ * instanced attributes at InstanceBuffer::kFirstLocation are the
+ * per-draw data, fetched by the vertex puller as gl_BaseInstance +
+ * gl_InstanceID without the shader needing ARB_shader_draw_parameters.
+ * quad_instanced.vs works unchanged.
+ *
+ * The commands are built on the CPU by push() and uploaded by upload(),
+ * static batches are uploaded once and drawn every frame with draw().
+ * getCommandBuffer() exposes the indirect buffer to GPU-side producers.
+ */
+class MultiDrawBatch
+{
+ private:
+    /*!
+     * The pool holding the meshes
+     */
+    MeshPool& pool_;
+
+    /*!
+     * The per-draw data, attached to the pool vertex array
+     */
+    InstanceBuffer instances_;
+
+    /*!
+     * The indirect buffer
+     */
+    GLuint command_buffer_;
+
+    /*!
+     * The commands recorded
+     */
+    std::vector<DrawElementsIndirectCommand> commands_;
+
+    /*!
+     * The per-draw data recorded, one per instance of every command
+     */
+    std::vector<InstanceData> data_;
+
+    /*!
+     * How the commands are issued
+     */
+    MultiDrawPath path_;
+
+ public:
+    /*!
+     * MultiDrawBatch constructor, must be called with a current context
+     *
+     * \param[in] pool The pool holding every mesh the batch draws
+     */
+    explicit MultiDrawBatch (MeshPool& pool);
+
+    MultiDrawBatch (const MultiDrawBatch&) = delete;
+    MultiDrawBatch& operator= (const MultiDrawBatch&) = delete;
+
+    /*!
+     * MultiDrawBatch destructor
+     */
+    ~MultiDrawBatch ();
+
+    /*!
+     * Get the best path the driver supports
+     *
+     * \return The path
+     */
+    static MultiDrawPath getSupportedPath ();
+
+    /*!
+     * Record a draw of one instance
+     *
+     * \param[in] range The mesh, from the batch pool
+     * \param[in] data  The per-draw data
+     *
+     * \return void
+     */
+    void push (const MeshRange& range, const InstanceData& data);
+
+    /*!
+     * Record a draw of several instances
+     *
+     * \param[in] range     The mesh, from the batch pool
+     * \param[in] data      The data of each instance
+     * \param[in] instances The number of instances
+     *
+     * \return void
+     */
+    void push (const MeshRange& range, const InstanceData* data, GLuint instances);
+
+    /*!
+     * Upload the commands recorded and their per-draw data, the commands
+     * are kept until clear()
+     *
+     * \return void
+     */
+    void upload ();
+
+    /*!
+     * Draw the commands uploaded last with the current program
+     *
+     * \return void
+     */
+    void draw ();
+
+    /*!
+     * upload() then draw(), for commands recorded every frame
+     *
+     * \return void
+     */
+    void submit ();
+
+    /*!
+     * Forget the commands recorded
+     *
+     * \return void
+     */
+    void clear ();
+
+    /*!
+     * Force a path, to compare them or work around a driver, the path must
+     * be supported
+     *
+     * \param[in] path The path
+     *
+     * \return void
+     */
+    void setPath (MultiDrawPath path);
+
+    /*!
+     * Get the path used
+     *
+     * \return The path
+     */
+    MultiDrawPath getPath () const;
+
+    /*!
+     * Get the number of commands recorded
+     *
+     * \return The number of commands
+     */
+    std::size_t getSize () const;
+
+    /*!
+     * Get the indirect buffer, holding DrawElementsIndirectCommand
+     *
+     * \return The buffer
+     */
+    GLuint getCommandBuffer () const;
+};
+
+#endif // __MULTI_DRAW_BATCH_HPP
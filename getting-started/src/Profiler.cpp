@@ -0,0 +1,465 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include "Log.hpp"
+
+namespace {
+
+// bounds the memory of a long traced run, about 40 MiB
+const std::size_t kMaxTraceEvents = 1 << 20;
+
+// the name of the scope wrapping each frame
+const char* const kFrameScope = "frame";
+
+// nearest rank percentile of sorted samples
+float getPercentile (const std::vector<float>& sorted, double percentile)
+{
+    std::size_t rank = static_cast<std::size_t>(percentile * sorted.size() / 100.0);
+
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void writeJsonString (std::ostream& out, const char* text)
+{
+    out << '"';
+
+    for (const char* c = text; *c != '\0'; ++c) {
+        if ((*c == '"') || (*c == '\\'))
+            out << '\\';
+
+        out << *c;
+    }
+
+    out << '"';
+}
+
+} // namespace
+
+/*!
+ * Profiler constructor, disabled
+ */
+Profiler::Profiler ()
+    : enabled_(false),
+      gpu_enabled_(false),
+      tracing_(false),
+      cpu_epoch_(std::chrono::steady_clock::now()),
+      gpu_epoch_(0),
+      frame_(0),
+      trace_dropped_(0),
+      gpu_dropped_(0)
+{
+}
+
+/*!
+ * Get the profiler of the render thread
+ *
+ * \return The profiler
+ */
+Profiler& Profiler::getInstance ()
+{
+    static Profiler instance;
+
+    return instance;
+}
+
+/*!
+ * Start timing the scopes, must be called with a current context
+ *
+ * \param[in] trace Whether to keep every event for writeTrace()
+ *
+ * \return void
+ */
+void Profiler::enable (bool trace)
+{
+    enabled_ = true;
+    tracing_ = trace;
+
+    // timer queries are core since OpenGL 3.3, the check keeps the profiler
+    // usable on the CPU side with older drivers
+    gpu_enabled_ = GLEW_ARB_timer_query;
+
+    // both clocks are sampled together so GPU events line up with the CPU
+    // events in the trace, drift over a run is ignored
+    cpu_epoch_ = std::chrono::steady_clock::now();
+
+    if (gpu_enabled_)
+        glGetInteger64v(GL_TIMESTAMP, &gpu_epoch_);
+}
+
+/*!
+ * Start a frame, reads back the GPU queries of the oldest frame in
+ * flight if they are available
+ *
+ * \return void
+ */
+void Profiler::beginFrame ()
+{
+    if (!enabled_)
+        return;
+
+    if (gpu_enabled_)
+        collect(gpu_frames_[frame_ % kGpuFrames], false);
+
+    push(kFrameScope, true);
+}
+
+/*!
+ * End a frame, the scopes still open are closed
+ *
+ * \return void
+ */
+void Profiler::endFrame ()
+{
+    if (!enabled_)
+        return;
+
+    while (!stack_.empty())
+        pop();
+
+    for (const ProfileEvent& event : events_)
+        record(event);
+
+    events_.clear();
+    closeFrame(false);
+
+    ++frame_;
+}
+
+/*!
+ * Open a scope
+ *
+ * \param[in] name The scope name, a string literal
+ * \param[in] gpu  Whether to time the GL commands issued in the scope
+ *
+ * \return void
+ */
+void Profiler::push (const char* name, bool gpu)
+{
+    if (!enabled_)
+        return;
+
+    unsigned int depth = static_cast<unsigned int>(stack_.size());
+    long gpu_index = -1;
+
+    if (gpu && gpu_enabled_) {
+        GpuFrame& frame = gpu_frames_[frame_ % kGpuFrames];
+
+        if (frame.used + 2 > frame.queries.size()) {
+            std::size_t count = std::max<std::size_t>(32, frame.queries.size());
+
+            frame.queries.resize(frame.queries.size() + count);
+            glGenQueries(count, &frame.queries[frame.queries.size() - count]);
+        }
+
+        GpuScope scope = {name, depth, frame.used, frame.used + 1};
+
+        frame.used += 2;
+        glQueryCounter(frame.queries[scope.begin], GL_TIMESTAMP);
+
+        gpu_index = static_cast<long>(frame.scopes.size());
+        frame.scopes.push_back(scope);
+    }
+
+    stack_.emplace_back(events_.size(), gpu_index);
+    events_.push_back({name, depth, false, now(), 0.0});
+}
+
+/*!
+ * Close the innermost scope
+ *
+ * \return void
+ */
+void Profiler::pop ()
+{
+    if (!enabled_ || stack_.empty())
+        return;
+
+    ProfileEvent& event = events_[stack_.back().first];
+
+    event.duration_us = now() - event.start_us;
+
+    if (stack_.back().second >= 0) {
+        GpuFrame& frame = gpu_frames_[frame_ % kGpuFrames];
+        const GpuScope& scope = frame.scopes[stack_.back().second];
+
+        glQueryCounter(frame.queries[scope.end], GL_TIMESTAMP);
+    }
+
+    stack_.pop_back();
+}
+
+/*!
+ * Wait for the GPU queries in flight and read them back
+ *
+ * \return void
+ */
+void Profiler::finish ()
+{
+    if (!gpu_enabled_)
+        return;
+
+    // oldest frame first, so the trace stays ordered
+    for (std::size_t i = 0; i < kGpuFrames; ++i)
+        collect(gpu_frames_[(frame_ + i) % kGpuFrames], true);
+}
+
+/*!
+ * Forget the per frame times, the trace is kept
+ *
+ * \return void
+ */
+void Profiler::clearHistory ()
+{
+    histories_.clear();
+    gpu_dropped_ = 0;
+}
+
+/*!
+ * Delete the query objects, must be called before the context is
+ * destroyed
+ *
+ * \return void
+ */
+void Profiler::release ()
+{
+    for (GpuFrame& frame : gpu_frames_) {
+        if (!frame.queries.empty())
+            glDeleteQueries(frame.queries.size(), frame.queries.data());
+
+        frame.queries.clear();
+        frame.scopes.clear();
+        frame.used = 0;
+    }
+
+    gpu_enabled_ = false;
+}
+
+/*!
+ * Print the percentiles of the per frame time of every scope
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void Profiler::report (std::ostream& out)
+{
+    if (!enabled_)
+        return;
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::left << std::setw(20) << "Scope" << std::right
+        << std::setw(5) << "Lane"
+        << std::setw(8) << "Frames"
+        << std::setw(8) << "Calls"
+        << std::setw(9) << "p50 ms"
+        << std::setw(9) << "p95 ms"
+        << std::setw(9) << "p99 ms"
+        << std::setw(9) << "Max ms" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+
+    for (const ProfileHistory& history : histories_) {
+        if (history.samples.empty())
+            continue;
+
+        std::vector<float> sorted(history.samples);
+
+        std::sort(sorted.begin(), sorted.end());
+
+        out << std::left << std::setw(20) << history.name << std::right
+            << std::setw(5) << (history.gpu ? "GPU" : "CPU")
+            << std::setw(8) << sorted.size()
+            << std::setw(8) << std::setprecision(1)
+            << static_cast<double>(history.calls) / sorted.size()
+            << std::setprecision(3)
+            << std::setw(9) << getPercentile(sorted, 50.0)
+            << std::setw(9) << getPercentile(sorted, 95.0)
+            << std::setw(9) << getPercentile(sorted, 99.0)
+            << std::setw(9) << sorted.back() << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+
+    if (gpu_dropped_ > 0) {
+        out << gpu_dropped_ << " frames left out of the GPU times, their "
+            << "queries were not ready" << std::endl;
+    }
+}
+
+/*!
+ * Write the events in the Chrome trace event format, to be opened with
+ * chrome://tracing or Perfetto
+ *
+ * \param[in] path The path of the JSON file
+ *
+ * \return True if the file was written
+ */
+bool Profiler::writeTrace (const std::string& path)
+{
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+
+    if (!out) {
+        LOG_ERROR("ERROR::PROFILER::FAILED_TO_WRITE_TRACE " << path);
+        return false;
+    }
+
+    out << std::fixed << std::setprecision(3);
+
+    // name the two lanes, the GPU events go below the CPU events
+    out << "{\"traceEvents\":[\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+        << "\"args\":{\"name\":\"CPU\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+        << "\"args\":{\"name\":\"GPU\"}}";
+
+    for (const ProfileEvent& event : trace_) {
+        out << ",\n{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"cat\":\"" << (event.gpu ? "gpu" : "cpu")
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+            << ",\"ts\":" << event.start_us
+            << ",\"dur\":" << event.duration_us << "}";
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (trace_dropped_ > 0)
+        LOG_WARNING("Trace full, " << trace_dropped_ << " events dropped");
+
+    return static_cast<bool>(out);
+}
+
+/*!
+ * Get the time elapsed since the profiler was enabled
+ *
+ * \return The time, in us
+ */
+double Profiler::now () const
+{
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - cpu_epoch_;
+
+    return elapsed.count();
+}
+
+/*!
+ * Find the history of a scope, creating it the first time
+ *
+ * \param[in] name The scope name
+ * \param[in] gpu  Whether the scope was timed on the GPU
+ *
+ * \return The history
+ */
+ProfileHistory& Profiler::getHistory (const char* name, bool gpu)
+{
+    // a frame has a handful of distinct scopes, a linear search on the
+    // literal addresses beats hashing the names
+    for (ProfileHistory& history : histories_) {
+        if ((history.name == name) && (history.gpu == gpu))
+            return history;
+    }
+
+    histories_.push_back({name, gpu, 0, 0.0, false, std::vector<float>()});
+
+    return histories_.back();
+}
+
+/*!
+ * Add an event to the history of its scope and to the trace
+ *
+ * \param[in] event The event
+ *
+ * \return void
+ */
+void Profiler::record (const ProfileEvent& event)
+{
+    ProfileHistory& history = getHistory(event.name, event.gpu);
+
+    ++history.calls;
+    history.frame_ms += event.duration_us / 1000.0;
+    history.touched = true;
+
+    if (!tracing_)
+        return;
+
+    if (trace_.size() < kMaxTraceEvents)
+        trace_.push_back(event);
+    else
+        ++trace_dropped_;
+}
+
+/*!
+ * Append the frame sums of the scopes recorded since the last call to
+ * their histories
+ *
+ * \param[in] gpu Whether the GPU or the CPU histories are summed
+ *
+ * \return void
+ */
+void Profiler::closeFrame (bool gpu)
+{
+    for (ProfileHistory& history : histories_) {
+        if ((history.gpu != gpu) || !history.touched)
+            continue;
+
+        history.samples.push_back(static_cast<float>(history.frame_ms));
+        history.frame_ms = 0.0;
+        history.touched = false;
+    }
+}
+
+/*!
+ * Read the results of a frame of queries
+ *
+ * \param[in] frame The frame
+ * \param[in] wait  Whether to block until the GPU is done with the frame
+ *
+ * \return void
+ */
+void Profiler::collect (GpuFrame& frame, bool wait)
+{
+    if (frame.scopes.empty())
+        return;
+
+    // the queries complete in order, the last one tells for the whole frame
+    GLuint available = GL_TRUE;
+
+    if (!wait) {
+        glGetQueryObjectuiv(
+            frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available
+        );
+    }
+
+    if (available) {
+        for (const GpuScope& scope : frame.scopes) {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+
+            glGetQueryObjectui64v(frame.queries[scope.begin], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.queries[scope.end], GL_QUERY_RESULT, &end);
+
+            ProfileEvent event = {
+                scope.name,
+                scope.depth,
+                true,
+                (static_cast<GLint64>(begin) - gpu_epoch_) / 1000.0,
+                (end - begin) / 1000.0
+            };
+
+            record(event);
+        }
+
+        closeFrame(true);
+    } else {
+        ++gpu_dropped_;
+    }
+
+    frame.scopes.clear();
+    frame.used = 0;
+}
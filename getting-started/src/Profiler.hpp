@@ -0,0 +1,419 @@
+/*!
+ * \file  Profiler.hpp
+ * \brief Class definitions to time nested CPU and GPU scopes of the frame
+ *        loop, summarize them per frame and export a Chrome trace
+ */
+
+#ifndef __PROFILER_HPP
+#define __PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+//! ProfileEvent
+/*!
+ * ProfileEvent is a scope that has been timed, on the CPU or on the GPU
+ */
+struct ProfileEvent
+{
+    /*!
+     * The scope name, a string literal
+     */
+    const char* name;
+
+    /*!
+     * The number of scopes the event is nested in
+     */
+    unsigned int depth;
+
+    /*!
+     * Whether the event was timed on the GPU
+     */
+    bool gpu;
+
+    /*!
+     * The start of the event since the profiler was enabled, in us
+     */
+    double start_us;
+
+    /*!
+     * The duration of the event, in us
+     */
+    double duration_us;
+};
+
+//! ProfileHistory
+/*!
+ * ProfileHistory holds the time a scope took in every frame it appeared in.
+ * A scope entered several times in a frame, like a draw call, contributes
+ * the sum of its durations.
+ */
+struct ProfileHistory
+{
+    /*!
+     * The scope name, a string literal
+     */
+    const char* name;
+
+    /*!
+     * Whether the scope was timed on the GPU
+     */
+    bool gpu;
+
+    /*!
+     * The number of times the scope was entered
+     */
+    std::uint64_t calls;
+
+    /*!
+     * The time accumulated in the frame being summed, in ms
+     */
+    double frame_ms;
+
+    /*!
+     * Whether the scope was entered in the frame being summed
+     */
+    bool touched;
+
+    /*!
+     * The time of each frame, in ms
+     */
+    std::vector<float> samples;
+};
+
+//! GpuScope
+/*!
+ * GpuScope is a scope whose timestamps have been requested from the GPU
+ */
+struct GpuScope
+{
+    /*!
+     * The scope name, a string literal
+     */
+    const char* name;
+
+    /*!
+     * The number of scopes the scope is nested in
+     */
+    unsigned int depth;
+
+    /*!
+     * The index of the query written when the scope started
+     */
+    std::size_t begin;
+
+    /*!
+     * The index of the query written when the scope ended
+     */
+    std::size_t end;
+};
+
+//! GpuFrame
+/*!
+ * GpuFrame holds the timestamp queries issued in a frame until they are
+ * read back
+ */
+struct GpuFrame
+{
+    /*!
+     * The query objects, reused from one frame to the next
+     */
+    std::vector<GLuint> queries;
+
+    /*!
+     * The number of queries issued in the frame
+     */
+    std::size_t used;
+
+    /*!
+     * The scopes timed in the frame
+     */
+    std::vector<GpuScope> scopes;
+};
+
+//! Profiler
+/*!
+ * Profiler times the scopes pushed and popped on the render thread. CPU
+ * scopes use the steady clock. GPU scopes write GL_TIMESTAMP queries, which
+ * unlike GL_TIME_ELAPSED queries can be nested; the queries of a frame are
+ * read back two frames later, and only if the GPU has finished with them,
+ * so profiling never stalls the pipeline. A frame whose results are not
+ * ready by then is dropped from the GPU statistics.
+ *
+ * Every scope name must be a string literal, it is stored as a pointer.
+ * The profiler does nothing until enable() is called.
+ */
+class Profiler
+{
+ private:
+    /*!
+     * The number of frames whose GPU queries are in flight
+     */
+    static const std::size_t kGpuFrames = 2;
+
+    /*!
+     * Whether the scopes are timed
+     */
+    bool enabled_;
+
+    /*!
+     * Whether the GPU scopes are timed
+     */
+    bool gpu_enabled_;
+
+    /*!
+     * Whether the events are kept for writeTrace()
+     */
+    bool tracing_;
+
+    /*!
+     * The CPU time the profiler was enabled
+     */
+    std::chrono::steady_clock::time_point cpu_epoch_;
+
+    /*!
+     * The GPU time the profiler was enabled, in ns
+     */
+    GLint64 gpu_epoch_;
+
+    /*!
+     * The number of frames started
+     */
+    std::uint64_t frame_;
+
+    /*!
+     * The CPU events of the current frame
+     */
+    std::vector<ProfileEvent> events_;
+
+    /*!
+     * The open scopes: their event index and GPU scope index, or -1
+     */
+    std::vector<std::pair<std::size_t, long>> stack_;
+
+    /*!
+     * The queries of the frames in flight
+     */
+    GpuFrame gpu_frames_[kGpuFrames];
+
+    /*!
+     * The per frame times of every scope
+     */
+    std::vector<ProfileHistory> histories_;
+
+    /*!
+     * The events kept for the trace
+     */
+    std::vector<ProfileEvent> trace_;
+
+    /*!
+     * The number of events that did not fit in the trace
+     */
+    std::uint64_t trace_dropped_;
+
+    /*!
+     * The number of frames whose GPU results were not ready in time
+     */
+    std::uint64_t gpu_dropped_;
+
+    /*!
+     * Profiler constructor, disabled
+     */
+    Profiler ();
+
+    /*!
+     * Get the time elapsed since the profiler was enabled
+     *
+     * \return The time, in us
+     */
+    double now () const;
+
+    /*!
+     * Find the history of a scope, creating it the first time
+     *
+     * \param[in] name The scope name
+     * \param[in] gpu  Whether the scope was timed on the GPU
+     *
+     * \return The history
+     */
+    ProfileHistory& getHistory (const char* name, bool gpu);
+
+    /*!
+     * Add an event to the history of its scope and to the trace
+     *
+     * \param[in] event The event
+     *
+     * \return void
+     */
+    void record (const ProfileEvent& event);
+
+    /*!
+     * Append the frame sums of the scopes recorded since the last call to
+     * their histories
+     *
+     * \param[in] gpu Whether the GPU or the CPU histories are summed
+     *
+     * \return void
+     */
+    void closeFrame (bool gpu);
+
+    /*!
+     * Read the results of a frame of queries
+     *
+     * \param[in] frame The frame
+     * \param[in] wait  Whether to block until the GPU is done with the frame
+     *
+     * \return void
+     */
+    void collect (GpuFrame& frame, bool wait);
+
+ public:
+    Profiler (const Profiler&) = delete;
+    Profiler& operator= (const Profiler&) = delete;
+
+    /*!
+     * Get the profiler of the render thread
+     *
+     * \return The profiler
+     */
+    static Profiler& getInstance ();
+
+    /*!
+     * Start timing the scopes, must be called with a current context
+     *
+     * \param[in] trace Whether to keep every event for writeTrace()
+     *
+     * \return void
+     */
+    void enable (bool trace);
+
+    /*!
+     * Check if the scopes are timed
+     *
+     * \return True once enable() has been called
+     */
+    bool isEnabled () const
+    {
+        return enabled_;
+    }
+
+    /*!
+     * Start a frame, reads back the GPU queries of the oldest frame in
+     * flight if they are available
+     *
+     * \return void
+     */
+    void beginFrame ();
+
+    /*!
+     * End a frame, the scopes still open are closed
+     *
+     * \return void
+     */
+    void endFrame ();
+
+    /*!
+     * Open a scope
+     *
+     * \param[in] name The scope name, a string literal
+     * \param[in] gpu  Whether to time the GL commands issued in the scope
+     *
+     * \return void
+     */
+    void push (const char* name, bool gpu);
+
+    /*!
+     * Close the innermost scope
+     *
+     * \return void
+     */
+    void pop ();
+
+    /*!
+     * Wait for the GPU queries in flight and read them back
+     *
+     * \return void
+     */
+    void finish ();
+
+    /*!
+     * Forget the per frame times, the trace is kept
+     *
+     * \return void
+     */
+    void clearHistory ();
+
+    /*!
+     * Delete the query objects, must be called before the context is
+     * destroyed
+     *
+     * \return void
+     */
+    void release ();
+
+    /*!
+     * Print the percentiles of the per frame time of every scope
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out);
+
+    /*!
+     * Write the events in the Chrome trace event format, to be opened with
+     * chrome://tracing or Perfetto
+     *
+     * \param[in] path The path of the JSON file
+     *
+     * \return True if the file was written
+     */
+    bool writeTrace (const std::string& path);
+};
+
+//! ProfileScope
+/*!
+ * ProfileScope times the block it is declared in. It costs a branch when
+ * the profiler is disabled.
+ */
+class ProfileScope
+{
+ private:
+    /*!
+     * Whether the scope was pushed
+     */
+    bool active_;
+
+ public:
+    /*!
+     * ProfileScope constructor, opens the scope
+     *
+     * \param[in] name The scope name, a string literal
+     * \param[in] gpu  Whether to time the GL commands issued in the scope
+     */
+    explicit ProfileScope (const char* name, bool gpu = false)
+        : active_(Profiler::getInstance().isEnabled())
+    {
+        if (active_)
+            Profiler::getInstance().push(name, gpu);
+    }
+
+    ProfileScope (const ProfileScope&) = delete;
+    ProfileScope& operator= (const ProfileScope&) = delete;
+
+    /*!
+     * ProfileScope destructor, closes the scope
+     */
+    ~ProfileScope ()
+    {
+        if (active_)
+            Profiler::getInstance().pop();
+    }
+};
+
+#endif // __PROFILER_HPP
@@ -0,0 +1,243 @@
+#include "RenderContext.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+#include "Profiler.hpp"
+#include "WindowContext.hpp"
+#include "HeadlessContext.hpp"
+
+/*!
+ * RenderContext constructor
+ *
+ * \param[in] options The context options
+ */
+RenderContext::RenderContext (const RenderOptions& options)
+    : frame_start_(std::chrono::steady_clock::now()),
+      frame_ms_(0.0),
+      max_frame_ms_(0.0),
+      options_(options),
+      frame_(0),
+      name_("frame")
+{
+}
+
+/*!
+ * RenderContext destructor
+ */
+RenderContext::~RenderContext ()
+{
+}
+
+/*!
+ * Create the context the options ask for
+ *
+ * \param[in] options The context options
+ *
+ * \return The context, check isValid() before using it
+ */
+std::unique_ptr<RenderContext> RenderContext::create (const RenderOptions& options)
+{
+    if (options.headless)
+        return std::unique_ptr<RenderContext>(new HeadlessContext(options));
+
+    return std::unique_ptr<RenderContext>(new WindowContext(options));
+}
+
+/*!
+ * Check if the frame loop must stop
+ *
+ * \return True once the frame count is reached
+ */
+bool RenderContext::shouldClose ()
+{
+    return (options_.frames > 0) && (frame_ >= options_.frames);
+}
+
+/*!
+ * Get the window, to install input callbacks
+ *
+ * \return The window, nullptr when headless
+ */
+GLFWwindow* RenderContext::getWindow ()
+{
+    return nullptr;
+}
+
+/*!
+ * Start a new frame loop on the same context: the frame count and the
+ * timings start over and the captured frames get a new prefix
+ *
+ * \param[in] name The prefix of the captured frame names, usually the
+ *                 scene name
+ *
+ * \return void
+ */
+void RenderContext::restart (const std::string& name)
+{
+    name_ = name;
+    frame_ = 0;
+    frame_ms_ = 0.0;
+    max_frame_ms_ = 0.0;
+}
+
+/*!
+ * Get the framebuffer width
+ *
+ * \return The width
+ */
+int RenderContext::getWidth () const
+{
+    return options_.width;
+}
+
+/*!
+ * Get the framebuffer height
+ *
+ * \return The height
+ */
+int RenderContext::getHeight () const
+{
+    return options_.height;
+}
+
+/*!
+ * Get the number of frames ended
+ *
+ * \return The frame count
+ */
+unsigned int RenderContext::getFrame () const
+{
+    return frame_;
+}
+
+/*!
+ * Get the arena of the current frame, emptied by beginFrame()
+ *
+ * \return The arena
+ */
+FrameArena& RenderContext::getFrameArena ()
+{
+    return frame_arena_;
+}
+
+/*!
+ * Get the average frame time since the last restart
+ *
+ * \return The average frame time, in ms
+ */
+double RenderContext::getAverageFrameTime () const
+{
+    return (frame_ > 0) ? frame_ms_ / frame_ : 0.0;
+}
+
+/*!
+ * Get the longest frame time since the last restart
+ *
+ * \return The longest frame time, in ms
+ */
+double RenderContext::getMaxFrameTime () const
+{
+    return max_frame_ms_;
+}
+
+/*!
+ * Get the number of frames that failed the golden comparison
+ *
+ * \return The number of mismatches
+ */
+unsigned int RenderContext::getMismatches () const
+{
+    return (capture_ != nullptr) ? capture_->getMismatches() : 0;
+}
+
+/*!
+ * Print the frame timings and the capture counters, the readbacks in
+ * flight are collected first
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void RenderContext::report (std::ostream& out)
+{
+    out << "Frames: " << frame_;
+
+    if (frame_ > 0) {
+        out << ", " << getAverageFrameTime() << " ms average, "
+            << max_frame_ms_ << " ms max";
+    }
+
+    out << std::endl;
+
+    if (capture_ != nullptr) {
+        capture_->finish();
+        capture_->report(out);
+    }
+}
+
+/*!
+ * Create the frame capture if the options ask for it, must be called
+ * once the context is current
+ *
+ * \return void
+ */
+void RenderContext::initCapture ()
+{
+    bool capturing = !options_.capture_directory.empty() ||
+        !options_.golden_directory.empty();
+
+    if (!capturing)
+        return;
+
+    capture_.reset(new FrameCapture(
+        options_.width,
+        options_.height,
+        options_.capture_directory,
+        options_.golden_directory,
+        options_.tolerance
+    ));
+}
+
+/*!
+ * Start timing a frame and empty the frame arena, must be called at the
+ * beginning of each frame
+ *
+ * \return void
+ */
+void RenderContext::startFrame ()
+{
+    frame_start_ = std::chrono::steady_clock::now();
+    frame_arena_.reset();
+}
+
+/*!
+ * Capture the frame if it is due and update the frame timings, must be
+ * called at the end of each frame with the frame bound for reading
+ *
+ * \return void
+ */
+void RenderContext::finishFrame ()
+{
+    if (capture_ != nullptr) {
+        bool last = (options_.frames > 0) && (frame_ + 1 == options_.frames);
+        bool due = (options_.capture_interval > 0) &&
+            (frame_ % options_.capture_interval == 0);
+
+        if (last || due) {
+            ProfileScope scope("capture", true);
+            char suffix[16];
+
+            std::snprintf(suffix, sizeof(suffix), "_%05u", frame_);
+            capture_->capture(name_ + suffix);
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - frame_start_;
+
+    frame_ms_ += elapsed.count();
+    max_frame_ms_ = std::max(max_frame_ms_, elapsed.count());
+
+    ++frame_;
+}
@@ -0,0 +1,305 @@
+/*!
+ * \file  RenderContext.hpp
+ * \brief Class definition of the OpenGL context and frame loop the exercises
+ *        render with, on screen or headless
+ */
+
+#ifndef __RENDER_CONTEXT_HPP
+#define __RENDER_CONTEXT_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <ostream>
+
+#include <GL/glew.h>
+
+#include <GLFW/glfw3.h>
+
+#include "FrameArena.hpp"
+#include "FrameCapture.hpp"
+
+//! RenderOptions
+/*!
+ * RenderOptions selects the context and the frame loop, see main.cpp for the
+ * matching command line switches
+ */
+struct RenderOptions
+{
+    /*!
+     * Render offscreen through EGL instead of in a window
+     */
+    bool headless = false;
+
+    /*!
+     * The framebuffer width
+     */
+    int width = 800;
+
+    /*!
+     * The framebuffer height
+     */
+    int height = 600;
+
+    /*!
+     * The number of frames to render, 0 to run until the window is closed
+     */
+    unsigned int frames = 0;
+
+    /*!
+     * The directory the captured frames are written to, empty to skip
+     * writing them
+     */
+    std::string capture_directory;
+
+    /*!
+     * The directory of the golden frames to compare against, empty to skip
+     * the comparison
+     */
+    std::string golden_directory;
+
+    /*!
+     * Capture every nth frame, 0 to capture only the last one
+     */
+    unsigned int capture_interval = 0;
+
+    /*!
+     * The largest per channel difference accepted against a golden frame
+     */
+    int tolerance = 2;
+
+    /*!
+     * The frame cap, in frames per second, 0 for no cap
+     */
+    double max_fps = 0.0;
+
+    /*!
+     * The fixed updates per second, 0 to update the scene once per frame
+     * with the frame time
+     */
+    double update_rate = 0.0;
+
+    /*!
+     * The vertical syncs a buffer swap waits for, negative to keep the
+     * driver default; headless contexts ignore it
+     */
+    int swap_interval = -1;
+};
+
+//! RenderContext
+/*!
+ * RenderContext owns the OpenGL context and paces the frame loop. The
+ * scenes draw between beginFrame() and endFrame() until shouldClose()
+ * returns true. When a frame count is set, the loop stops after that many
+ * frames and the last frame, or every nth one, is read back through
+ * FrameCapture to be written and compared against golden frames.
+ */
+class RenderContext
+{
+ private:
+    /*!
+     * The time the current frame started
+     */
+    std::chrono::steady_clock::time_point frame_start_;
+
+    /*!
+     * The sum of the frame times, in ms
+     */
+    double frame_ms_;
+
+    /*!
+     * The longest frame time, in ms
+     */
+    double max_frame_ms_;
+
+    /*!
+     * The memory of the current frame
+     */
+    FrameArena frame_arena_;
+
+ protected:
+    /*!
+     * The options the context was created with
+     */
+    RenderOptions options_;
+
+    /*!
+     * The number of frames ended
+     */
+    unsigned int frame_;
+
+    /*!
+     * The prefix of the captured frame names
+     */
+    std::string name_;
+
+    /*!
+     * The readbacks, nullptr when nothing is captured
+     */
+    std::unique_ptr<FrameCapture> capture_;
+
+    /*!
+     * RenderContext constructor
+     *
+     * \param[in] options The context options
+     */
+    explicit RenderContext (const RenderOptions& options);
+
+    /*!
+     * Create the frame capture if the options ask for it, must be called
+     * once the context is current
+     *
+     * \return void
+     */
+    void initCapture ();
+
+    /*!
+     * Start timing a frame and empty the frame arena, must be called at the
+     * beginning of each frame
+     *
+     * \return void
+     */
+    void startFrame ();
+
+    /*!
+     * Capture the frame if it is due and update the frame timings, must be
+     * called at the end of each frame with the frame bound for reading
+     *
+     * \return void
+     */
+    void finishFrame ();
+
+ public:
+    /*!
+     * Create the context the options ask for
+     *
+     * \param[in] options The context options
+     *
+     * \return The context, check isValid() before using it
+     */
+    static std::unique_ptr<RenderContext> create (const RenderOptions& options);
+
+    RenderContext (const RenderContext&) = delete;
+    RenderContext& operator= (const RenderContext&) = delete;
+
+    /*!
+     * RenderContext destructor
+     */
+    virtual ~RenderContext ();
+
+    /*!
+     * Check if the context was created
+     *
+     * \return True if the context is current
+     */
+    virtual bool isValid () const = 0;
+
+    /*!
+     * Check if the frame loop must stop
+     *
+     * \return True once the frame count is reached
+     */
+    virtual bool shouldClose ();
+
+    /*!
+     * Start a frame: poll the events and bind the framebuffer to draw to
+     *
+     * \return void
+     */
+    virtual void beginFrame () = 0;
+
+    /*!
+     * End a frame: present it, or capture it and wait for the GPU
+     *
+     * \return void
+     */
+    virtual void endFrame () = 0;
+
+    /*!
+     * Get the seconds elapsed since the context was created. Headless
+     * contexts advance it by a fixed 1/60 s per frame, so captured frames do
+     * not depend on the machine speed.
+     *
+     * \return The time, in seconds
+     */
+    virtual double getTime () = 0;
+
+    /*!
+     * Get the window, to install input callbacks
+     *
+     * \return The window, nullptr when headless
+     */
+    virtual GLFWwindow* getWindow ();
+
+    /*!
+     * Start a new frame loop on the same context: the frame count and the
+     * timings start over and the captured frames get a new prefix
+     *
+     * \param[in] name The prefix of the captured frame names, usually the
+     *                 scene name
+     *
+     * \return void
+     */
+    virtual void restart (const std::string& name);
+
+    /*!
+     * Get the framebuffer width
+     *
+     * \return The width
+     */
+    int getWidth () const;
+
+    /*!
+     * Get the framebuffer height
+     *
+     * \return The height
+     */
+    int getHeight () const;
+
+    /*!
+     * Get the number of frames ended
+     *
+     * \return The frame count
+     */
+    unsigned int getFrame () const;
+
+    /*!
+     * Get the arena of the current frame, emptied by beginFrame()
+     *
+     * \return The arena
+     */
+    FrameArena& getFrameArena ();
+
+    /*!
+     * Get the average frame time since the last restart
+     *
+     * \return The average frame time, in ms
+     */
+    double getAverageFrameTime () const;
+
+    /*!
+     * Get the longest frame time since the last restart
+     *
+     * \return The longest frame time, in ms
+     */
+    double getMaxFrameTime () const;
+
+    /*!
+     * Get the number of frames that failed the golden comparison
+     *
+     * \return The number of mismatches
+     */
+    unsigned int getMismatches () const;
+
+    /*!
+     * Print the frame timings and the capture counters, the readbacks in
+     * flight are collected first
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out);
+};
+
+#endif // __RENDER_CONTEXT_HPP
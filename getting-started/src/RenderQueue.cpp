@@ -0,0 +1,327 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+
+namespace {
+
+const std::size_t kInitialCapacity = 256;
+
+// the texture set every unit is left alone by
+const TextureSet kNoTextures = {{0, 0, 0, 0}};
+
+//! SortEntry
+/*!
+ * SortEntry is a key and the index of its command, moved together by the
+ * radix passes
+ */
+struct SortEntry
+{
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+} // namespace
+
+/*!
+ * RenderQueue constructor
+ *
+ * \param[in] arena The arena of the frame, reset once per frame
+ */
+RenderQueue::RenderQueue (FrameArena& arena)
+    : arena_(arena),
+      generation_(arena.getGeneration()),
+      commands_(nullptr),
+      size_(0),
+      capacity_(0),
+      texture_sets_(1, kNoTextures),
+      sorting_(true),
+      stats_({0, 0, 0, 0})
+{
+}
+
+/*!
+ * Build a sort key
+ *
+ * \param[in] program      The program rank
+ * \param[in] texture_set  The texture set id
+ * \param[in] vertex_array The vertex array rank
+ * \param[in] depth        The depth, in [0, 1], front to back
+ *
+ * \return The key
+ */
+std::uint64_t RenderQueue::makeKey (
+    std::uint16_t program, std::uint16_t texture_set,
+    std::uint16_t vertex_array, float depth
+) {
+    float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+    std::uint64_t quantized = static_cast<std::uint64_t>(clamped * 65535.0f + 0.5f);
+
+    return (static_cast<std::uint64_t>(program) << 48) |
+        (static_cast<std::uint64_t>(texture_set) << 32) |
+        (static_cast<std::uint64_t>(vertex_array) << 16) |
+        quantized;
+}
+
+/*!
+ * Sort commands by key, LSD radix sort on 8 bit digits skipping the
+ * digits all the keys share
+ *
+ * \param[in] arena    The arena the scratch buffers are allocated from
+ * \param[in] commands The commands
+ * \param[in] count    The number of commands
+ *
+ * \return The sorted command indices, valid until the arena is reset
+ */
+std::uint32_t* RenderQueue::sort (
+    FrameArena& arena, const DrawCommand* commands, std::size_t count
+) {
+    SortEntry* source = arena.allocate<SortEntry>(count);
+    SortEntry* target = arena.allocate<SortEntry>(count);
+    std::uint32_t* order = arena.allocate<std::uint32_t>(count);
+
+    // one pass over the keys fills the histograms of the 8 digits
+    std::size_t histograms[8][256];
+
+    std::memset(histograms, 0, sizeof(histograms));
+
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t key = commands[i].key;
+
+        source[i].key = key;
+        source[i].index = static_cast<std::uint32_t>(i);
+
+        for (unsigned int digit = 0; digit < 8; ++digit)
+            ++histograms[digit][(key >> (digit * 8)) & 0xff];
+    }
+
+    for (unsigned int digit = 0; digit < 8; ++digit) {
+        std::size_t* histogram = histograms[digit];
+        unsigned int shift = digit * 8;
+
+        // every key has the same digit, the pass would not move anything
+        if (histogram[(source[0].key >> shift) & 0xff] == count)
+            continue;
+
+        std::size_t offset = 0;
+
+        for (unsigned int bucket = 0; bucket < 256; ++bucket) {
+            std::size_t size = histogram[bucket];
+
+            histogram[bucket] = offset;
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            target[histogram[(source[i].key >> shift) & 0xff]++] = source[i];
+
+        std::swap(source, target);
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+        order[i] = source[i].index;
+
+    return order;
+}
+
+/*!
+ * Register a texture set, once, usually while loading
+ *
+ * \param[in] textures The textures
+ *
+ * \return The texture set id
+ */
+std::uint16_t RenderQueue::addTextureSet (const TextureSet& textures)
+{
+    texture_sets_.push_back(textures);
+
+    return static_cast<std::uint16_t>(texture_sets_.size() - 1);
+}
+
+/*!
+ * Record a draw
+ *
+ * \param[in] program      The program
+ * \param[in] texture_set  The texture set id, from addTextureSet(), 0 for none
+ * \param[in] vertex_array The vertex array object
+ * \param[in] count        The number of indices
+ * \param[in] type         The type of the indices
+ * \param[in] first        The offset of the first index, in bytes
+ * \param[in] depth        The depth, in [0, 1], front to back
+ *
+ * \return void
+ */
+void RenderQueue::push (
+    GLuint program, std::uint16_t texture_set, GLuint vertex_array,
+    GLsizei count, GLenum type, GLintptr first, float depth
+) {
+    sync();
+
+    // the previous array stays in the arena until the end of the frame
+    if (size_ == capacity_) {
+        std::size_t capacity = std::max(kInitialCapacity, capacity_ * 2);
+        DrawCommand* commands = arena_.allocate<DrawCommand>(capacity);
+
+        if (size_ > 0)
+            std::memcpy(commands, commands_, size_ * sizeof(DrawCommand));
+
+        commands_ = commands;
+        capacity_ = capacity;
+    }
+
+    DrawCommand& command = commands_[size_++];
+
+    command.key = makeKey(
+        getRank(program_ranks_, program),
+        texture_set,
+        getRank(vertex_array_ranks_, vertex_array),
+        depth
+    );
+    command.program = program;
+    command.texture_set = texture_set;
+    command.vertex_array = vertex_array;
+    command.count = count;
+    command.type = type;
+    command.first = first;
+}
+
+/*!
+ * Sort or not the commands in submit(), on by default
+ *
+ * \param[in] sorting Whether to sort
+ *
+ * \return void
+ */
+void RenderQueue::setSorting (bool sorting)
+{
+    sorting_ = sorting;
+}
+
+/*!
+ * Issue the commands recorded and empty the queue
+ *
+ * \return void
+ */
+void RenderQueue::submit ()
+{
+    sync();
+
+    stats_ = {size_, 0, 0, 0};
+
+    if (size_ == 0)
+        return;
+
+    std::uint32_t* order = nullptr;
+
+    if (sorting_) {
+        ProfileScope scope("sort");
+
+        order = sort(arena_, commands_, size_);
+    }
+
+    ProfileScope scope("submit", true);
+    GLState& state = GLState::getInstance();
+
+    // the first command always binds everything
+    const DrawCommand* previous = nullptr;
+
+    for (std::size_t i = 0; i < size_; ++i) {
+        const DrawCommand& command = commands_[(order != nullptr) ? order[i] : i];
+
+        if ((previous == nullptr) || (previous->program != command.program)) {
+            state.useProgram(command.program);
+            ++stats_.programs;
+        }
+
+        if ((previous == nullptr) || (previous->texture_set != command.texture_set)) {
+            const TextureSet& set = texture_sets_[command.texture_set];
+
+            for (unsigned int unit = 0; unit < TextureSet::kTextures; ++unit) {
+                if (set.textures[unit] != 0)
+                    state.bindTextureUnit(unit, GL_TEXTURE_2D, set.textures[unit]);
+            }
+
+            ++stats_.texture_sets;
+        }
+
+        if ((previous == nullptr) || (previous->vertex_array != command.vertex_array)) {
+            state.bindVertexArray(command.vertex_array);
+            ++stats_.vertex_arrays;
+        }
+
+        glDrawElements(
+            GL_TRIANGLES, command.count, command.type,
+            reinterpret_cast<const GLvoid*>(command.first)
+        );
+
+        previous = &command;
+    }
+
+    size_ = 0;
+}
+
+/*!
+ * Get the number of commands recorded
+ *
+ * \return The number of commands
+ */
+std::size_t RenderQueue::getSize ()
+{
+    sync();
+
+    return size_;
+}
+
+/*!
+ * Get the counters of the last submit()
+ *
+ * \return The counters
+ */
+RenderQueueStats RenderQueue::getStats () const
+{
+    return stats_;
+}
+
+/*!
+ * Get the rank of a GL object, assigning the next one the first time
+ *
+ * \param[in] ranks The ranks of the objects of the same kind
+ * \param[in] name  The object
+ *
+ * \return The rank
+ */
+std::uint16_t RenderQueue::getRank (
+    std::unordered_map<GLuint, std::uint16_t>& ranks, GLuint name
+) {
+    auto found = ranks.find(name);
+
+    if (found != ranks.end())
+        return found->second;
+
+    // past 65536 objects the ranks wrap, the draws are still correct but
+    // some stop being grouped
+    std::uint16_t rank = static_cast<std::uint16_t>(ranks.size());
+
+    ranks.emplace(name, rank);
+
+    return rank;
+}
+
+/*!
+ * Empty the queue if the arena was reset since the last push
+ *
+ * \return void
+ */
+void RenderQueue::sync ()
+{
+    if (generation_ == arena_.getGeneration())
+        return;
+
+    generation_ = arena_.getGeneration();
+    commands_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+}
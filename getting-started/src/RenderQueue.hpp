@@ -0,0 +1,285 @@
+/*!
+ * \file  RenderQueue.hpp
+ * \brief Class definitions to record the draws of a frame, sort them by
+ *        state and submit them
+ */
+
+#ifndef __RENDER_QUEUE_HPP
+#define __RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "FrameArena.hpp"
+
+//! TextureSet
+/*!
+ * TextureSet is the textures a draw binds, from GL_TEXTURE0 onwards
+ */
+struct TextureSet
+{
+    /*!
+     * The number of textures bound by RenderQueue
+     */
+    static const unsigned int kTextures = 4;
+
+    /*!
+     * The 2D textures, unit i gets textures[i], 0 leaves the unit alone
+     */
+    GLuint textures[kTextures];
+};
+
+//! DrawCommand
+/*!
+ * DrawCommand is an indexed draw recorded in a RenderQueue
+ */
+struct DrawCommand
+{
+    /*!
+     * The sort key, see RenderQueue::makeKey()
+     */
+    std::uint64_t key;
+
+    /*!
+     * The program
+     */
+    GLuint program;
+
+    /*!
+     * The texture set id, returned by RenderQueue::addTextureSet()
+     */
+    std::uint16_t texture_set;
+
+    /*!
+     * The vertex array object, with its element buffer
+     */
+    GLuint vertex_array;
+
+    /*!
+     * The number of indices
+     */
+    GLsizei count;
+
+    /*!
+     * The type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GLenum type;
+
+    /*!
+     * The offset of the first index in the element buffer, in bytes
+     */
+    GLintptr first;
+};
+
+//! RenderQueueStats
+/*!
+ * RenderQueueStats counts the work done by the last RenderQueue::submit()
+ */
+struct RenderQueueStats
+{
+    /*!
+     * The number of draws submitted
+     */
+    unsigned long draws;
+
+    /*!
+     * The number of program changes
+     */
+    unsigned long programs;
+
+    /*!
+     * The number of texture set changes
+     */
+    unsigned long texture_sets;
+
+    /*!
+     * The number of vertex array changes
+     */
+    unsigned long vertex_arrays;
+};
+
+//! RenderQueue
+/*!
+ * RenderQueue defers the draws of a frame. Each draw gets a 64 bit key
+ * holding, from the most significant bits down, its program, texture set,
+ * vertex array and quantized depth, 16 bits each. submit() radix sorts the
+ * keys so the draws sharing a program, then textures, then vertex array are
+ * adjacent, and issues them through GLState, changing each binding only
+ * where the key changes.
+ *
+ * The programs and vertex arrays are mapped to 16 bit ranks the first time
+ * they are seen; the ranks are kept from one frame to the next so the order
+ * is stable. The commands live in the FrameArena given to the constructor,
+ * the queue empties itself when the arena is reset.
+ */
+class RenderQueue
+{
+ private:
+    /*!
+     * The arena the commands are allocated from
+     */
+    FrameArena& arena_;
+
+    /*!
+     * The arena generation the commands were allocated in
+     */
+    unsigned long generation_;
+
+    /*!
+     * The commands recorded in the frame
+     */
+    DrawCommand* commands_;
+
+    /*!
+     * The number of commands recorded
+     */
+    std::size_t size_;
+
+    /*!
+     * The number of commands commands_ can hold
+     */
+    std::size_t capacity_;
+
+    /*!
+     * The texture sets, indexed by id
+     */
+    std::vector<TextureSet> texture_sets_;
+
+    /*!
+     * The rank of each program
+     */
+    std::unordered_map<GLuint, std::uint16_t> program_ranks_;
+
+    /*!
+     * The rank of each vertex array
+     */
+    std::unordered_map<GLuint, std::uint16_t> vertex_array_ranks_;
+
+    /*!
+     * Whether submit() sorts the commands
+     */
+    bool sorting_;
+
+    /*!
+     * The counters of the last submit()
+     */
+    RenderQueueStats stats_;
+
+    /*!
+     * Get the rank of a GL object, assigning the next one the first time
+     *
+     * \param[in] ranks The ranks of the objects of the same kind
+     * \param[in] name  The object
+     *
+     * \return The rank
+     */
+    static std::uint16_t getRank (
+        std::unordered_map<GLuint, std::uint16_t>& ranks, GLuint name
+    );
+
+    /*!
+     * Empty the queue if the arena was reset since the last push
+     *
+     * \return void
+     */
+    void sync ();
+
+ public:
+    /*!
+     * RenderQueue constructor
+     *
+     * \param[in] arena The arena of the frame, reset once per frame
+     */
+    explicit RenderQueue (FrameArena& arena);
+
+    /*!
+     * Build a sort key
+     *
+     * \param[in] program      The program rank
+     * \param[in] texture_set  The texture set id
+     * \param[in] vertex_array The vertex array rank
+     * \param[in] depth        The depth, in [0, 1], front to back
+     *
+     * \return The key
+     */
+    static std::uint64_t makeKey (
+        std::uint16_t program, std::uint16_t texture_set,
+        std::uint16_t vertex_array, float depth
+    );
+
+    /*!
+     * Sort commands by key, LSD radix sort on 8 bit digits skipping the
+     * digits all the keys share
+     *
+     * \param[in] arena    The arena the scratch buffers are allocated from
+     * \param[in] commands The commands
+     * \param[in] count    The number of commands
+     *
+     * \return The sorted command indices, valid until the arena is reset
+     */
+    static std::uint32_t* sort (
+        FrameArena& arena, const DrawCommand* commands, std::size_t count
+    );
+
+    /*!
+     * Register a texture set, once, usually while loading
+     *
+     * \param[in] textures The textures
+     *
+     * \return The texture set id
+     */
+    std::uint16_t addTextureSet (const TextureSet& textures);
+
+    /*!
+     * Record a draw
+     *
+     * \param[in] program      The program
+     * \param[in] texture_set  The texture set id, from addTextureSet(), 0 for none
+     * \param[in] vertex_array The vertex array object
+     * \param[in] count        The number of indices
+     * \param[in] type         The type of the indices
+     * \param[in] first        The offset of the first index, in bytes
+     * \param[in] depth        The depth, in [0, 1], front to back
+     *
+     * \return void
+     */
+    void push (
+        GLuint program, std::uint16_t texture_set, GLuint vertex_array,
+        GLsizei count, GLenum type, GLintptr first = 0, float depth = 0.0f
+    );
+
+    /*!
+     * Sort or not the commands in submit(), on by default
+     *
+     * \param[in] sorting Whether to sort
+     *
+     * \return void
+     */
+    void setSorting (bool sorting);
+
+    /*!
+     * Issue the commands recorded and empty the queue
+     *
+     * \return void
+     */
+    void submit ();
+
+    /*!
+     * Get the number of commands recorded
+     *
+     * \return The number of commands
+     */
+    std::size_t getSize ();
+
+    /*!
+     * Get the counters of the last submit()
+     *
+     * \return The counters
+     */
+    RenderQueueStats getStats () const;
+};
+
+#endif // __RENDER_QUEUE_HPP
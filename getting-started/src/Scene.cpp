@@ -0,0 +1,97 @@
+#include "Scene.hpp"
+
+/*!
+ * Scene destructor
+ */
+Scene::~Scene ()
+{
+}
+
+/*!
+ * Advance the scene by one update, does nothing by default. With a
+ * fixed update rate a frame runs any number of them, each advancing the
+ * scene by the same delta; the work due once per frame, uploads for
+ * instance, belongs in render().
+ *
+ * \param[in] time  The seconds elapsed since the scene started
+ * \param[in] delta The seconds the update advances the scene by
+ *
+ * \return void
+ */
+void Scene::update (double, double)
+{
+}
+
+/*!
+ * Blend the state drawn by the frame between the last two updates, after
+ * the updates of the frame and before it is drawn, does nothing by
+ * default. Without a fixed update rate alpha is always 1.
+ *
+ * \param[in] alpha 0 for the state of the previous update, 1 for the
+ *                  state of the last one
+ *
+ * \return void
+ */
+void Scene::interpolate (float)
+{
+}
+
+/*!
+ * Draw the frame into the bound framebuffer, scenes that are not
+ * pipelined draw here
+ *
+ * \return void
+ */
+void Scene::render ()
+{
+}
+
+/*!
+ * Check if the scene is pipelined, false by default
+ *
+ * \return True to run update() and record() on the job system
+ */
+bool Scene::isPipelined () const
+{
+    return false;
+}
+
+/*!
+ * Record the draws of a frame, on a job after update(), does nothing by
+ * default. The draws can be spread over more jobs, each recording into
+ * commands.getBuffer(); the scene waits for them before returning.
+ *
+ * \param[in] jobs     The job system
+ * \param[in] commands The commands of the frame, empty
+ *
+ * \return void
+ */
+void Scene::record (JobSystem&, FrameCommands&)
+{
+}
+
+/*!
+ * Draw a frame recorded by record() into the bound framebuffer, on the
+ * render thread, calls render() by default
+ *
+ * \param[in] commands The commands of the frame
+ *
+ * \return void
+ */
+void Scene::submit (const FrameCommands&)
+{
+    render();
+}
+
+/*!
+ * Handle a key the runner does not handle itself, before the update()
+ * of the next frame, does nothing by default
+ *
+ * \param[in] key    The GLFW key code
+ * \param[in] action GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+ *
+ * \return void
+ */
+void Scene::onKey (int, int)
+{
+}
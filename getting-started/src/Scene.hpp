@@ -0,0 +1,127 @@
+/*!
+ * \file  Scene.hpp
+ * \brief Class definition of the interface every exercise implements to be
+ *        run by SceneRunner
+ */
+
+#ifndef __SCENE_HPP
+#define __SCENE_HPP
+
+#include "CommandBuffer.hpp"
+#include "JobSystem.hpp"
+#include "RenderContext.hpp"
+
+//! Scene
+/*!
+ * Scene splits an exercise in the hooks SceneRunner calls: init() once the
+ * context is current, then update(), interpolate() and render() once per
+ * frame, and shutdown() before the next scene starts on the same context.
+ * A scene must release every GL object it created in shutdown(), the
+ * context outlives it.
+ *
+ * A pipelined scene runs one frame ahead of the render thread instead:
+ * onKey(), update(), interpolate() and record() run on a job while the
+ * render thread replays the previous frame's FrameCommands with submit().
+ * They must then not touch GL, and submit() must only read the commands
+ * and what init() created.
+ */
+class Scene
+{
+ public:
+    /*!
+     * Scene destructor
+     */
+    virtual ~Scene ();
+
+    /*!
+     * Create the GL objects of the scene, throws AssetError if a file can't
+     * be read
+     *
+     * \param[in] context The context the scene renders with
+     *
+     * \return True if the scene can be rendered
+     */
+    virtual bool init (RenderContext& context) = 0;
+
+    /*!
+     * Advance the scene by one update, does nothing by default. With a
+     * fixed update rate a frame runs any number of them, each advancing the
+     * scene by the same delta; the work due once per frame, uploads for
+     * instance, belongs in render().
+     *
+     * \param[in] time  The seconds elapsed since the scene started
+     * \param[in] delta The seconds the update advances the scene by
+     *
+     * \return void
+     */
+    virtual void update (double time, double delta);
+
+    /*!
+     * Blend the state drawn by the frame between the last two updates, after
+     * the updates of the frame and before it is drawn, does nothing by
+     * default. Without a fixed update rate alpha is always 1.
+     *
+     * \param[in] alpha 0 for the state of the previous update, 1 for the
+     *                  state of the last one
+     *
+     * \return void
+     */
+    virtual void interpolate (float alpha);
+
+    /*!
+     * Draw the frame into the bound framebuffer, scenes that are not
+     * pipelined draw here
+     *
+     * \return void
+     */
+    virtual void render ();
+
+    /*!
+     * Check if the scene is pipelined, false by default
+     *
+     * \return True to run update() and record() on the job system
+     */
+    virtual bool isPipelined () const;
+
+    /*!
+     * Record the draws of a frame, on a job after update(), does nothing by
+     * default. The draws can be spread over more jobs, each recording into
+     * commands.getBuffer(); the scene waits for them before returning.
+     *
+     * \param[in] jobs     The job system
+     * \param[in] commands The commands of the frame, empty
+     *
+     * \return void
+     */
+    virtual void record (JobSystem& jobs, FrameCommands& commands);
+
+    /*!
+     * Draw a frame recorded by record() into the bound framebuffer, on the
+     * render thread, calls render() by default
+     *
+     * \param[in] commands The commands of the frame
+     *
+     * \return void
+     */
+    virtual void submit (const FrameCommands& commands);
+
+    /*!
+     * Release the GL objects of the scene
+     *
+     * \return void
+     */
+    virtual void shutdown () = 0;
+
+    /*!
+     * Handle a key the runner does not handle itself, before the update()
+     * of the next frame, does nothing by default
+     *
+     * \param[in] key    The GLFW key code
+     * \param[in] action GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+     *
+     * \return void
+     */
+    virtual void onKey (int key, int action);
+};
+
+#endif // __SCENE_HPP
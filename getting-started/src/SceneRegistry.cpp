@@ -0,0 +1,94 @@
+#include "SceneRegistry.hpp"
+
+// prototypes
+std::unique_ptr<Scene> createHelloTriangle ();
+std::unique_ptr<Scene> createShaderExercise1 ();
+std::unique_ptr<Scene> createShaderExercise2 ();
+std::unique_ptr<Scene> createShaderExercise3 ();
+std::unique_ptr<Scene> createTextureExercise1 ();
+std::unique_ptr<Scene> createTextureExercise2 ();
+std::unique_ptr<Scene> createInstancingStress ();
+std::unique_ptr<Scene> createMultiDraw ();
+std::unique_ptr<Scene> createParticles ();
+std::unique_ptr<Scene> createThreadedDraws ();
+
+/*!
+ * SceneRegistry constructor, registers the exercises
+ */
+SceneRegistry::SceneRegistry ()
+{
+    add("hello_triangle", createHelloTriangle);
+    add("shader_exercise1", createShaderExercise1);
+    add("shader_exercise2", createShaderExercise2);
+    add("shader_exercise3", createShaderExercise3);
+    add("texture_exercise1", createTextureExercise1);
+    add("texture_exercise2", createTextureExercise2);
+    add("instancing_stress", createInstancingStress);
+    add("multi_draw", createMultiDraw);
+    add("particles", createParticles);
+    add("threaded_draws", createThreadedDraws);
+}
+
+/*!
+ * Get the registry
+ *
+ * \return The registry
+ */
+SceneRegistry& SceneRegistry::getInstance ()
+{
+    static SceneRegistry instance;
+
+    return instance;
+}
+
+/*!
+ * Register a scene, a scene registered twice replaces the first one
+ *
+ * \param[in] name    The scene name
+ * \param[in] factory The function creating the scene
+ *
+ * \return void
+ */
+void SceneRegistry::add (const std::string& name, SceneFactory factory)
+{
+    for (auto& scene : scenes_) {
+        if (scene.first == name) {
+            scene.second = factory;
+            return;
+        }
+    }
+
+    scenes_.emplace_back(name, factory);
+}
+
+/*!
+ * Create a scene
+ *
+ * \param[in] name The scene name
+ *
+ * \return The scene, nullptr if no scene has this name
+ */
+std::unique_ptr<Scene> SceneRegistry::create (const std::string& name) const
+{
+    for (const auto& scene : scenes_) {
+        if (scene.first == name)
+            return scene.second();
+    }
+
+    return nullptr;
+}
+
+/*!
+ * Get the names of the registered scenes
+ *
+ * \return The names, in registration order
+ */
+std::vector<std::string> SceneRegistry::getNames () const
+{
+    std::vector<std::string> names;
+
+    for (const auto& scene : scenes_)
+        names.push_back(scene.first);
+
+    return names;
+}
@@ -0,0 +1,78 @@
+/*!
+ * \file  SceneRegistry.hpp
+ * \brief Class definition of the list of scenes selectable by name
+ */
+
+#ifndef __SCENE_REGISTRY_HPP
+#define __SCENE_REGISTRY_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Scene.hpp"
+
+//! SceneFactory
+/*!
+ * SceneFactory creates a scene, its GL objects are created later by init()
+ */
+typedef std::unique_ptr<Scene> (*SceneFactory) ();
+
+//! SceneRegistry
+/*!
+ * SceneRegistry maps the scene names used on the command line to their
+ * factories. The exercises are registered when the instance is created, in
+ * the order they are run by SceneRunner::runAll(); they are listed
+ * explicitly because the linker drops the self registering objects of a
+ * static library nobody references.
+ */
+class SceneRegistry
+{
+ private:
+    /*!
+     * The scene names and factories, in registration order
+     */
+    std::vector<std::pair<std::string, SceneFactory>> scenes_;
+
+    /*!
+     * SceneRegistry constructor, registers the exercises
+     */
+    SceneRegistry ();
+
+ public:
+    /*!
+     * Get the registry
+     *
+     * \return The registry
+     */
+    static SceneRegistry& getInstance ();
+
+    /*!
+     * Register a scene, a scene registered twice replaces the first one
+     *
+     * \param[in] name    The scene name
+     * \param[in] factory The function creating the scene
+     *
+     * \return void
+     */
+    void add (const std::string& name, SceneFactory factory);
+
+    /*!
+     * Create a scene
+     *
+     * \param[in] name The scene name
+     *
+     * \return The scene, nullptr if no scene has this name
+     */
+    std::unique_ptr<Scene> create (const std::string& name) const;
+
+    /*!
+     * Get the names of the registered scenes
+     *
+     * \return The names, in registration order
+     */
+    std::vector<std::string> getNames () const;
+};
+
+#endif // __SCENE_REGISTRY_HPP
@@ -0,0 +1,418 @@
+#include "SceneRunner.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Profiler.hpp"
+#include "SceneRegistry.hpp"
+#include "Shader.hpp"
+
+namespace {
+
+// the actions the frame loop binds its keys to
+enum RunnerAction
+{
+    kQuit,
+    kWireframe,
+    kFill
+};
+
+double getPerFrame (unsigned long count, unsigned int frames)
+{
+    return (frames > 0) ? static_cast<double>(count) / frames : 0.0;
+}
+
+} // namespace
+
+/*!
+ * SceneRunner constructor, creates the context
+ *
+ * \param[in] options The context options
+ */
+SceneRunner::SceneRunner (const RenderOptions& options)
+    : context_(RenderContext::create(options)),
+      scene_(nullptr),
+      jobs_(new JobSystem()),
+      scheduler_(options.update_rate, options.max_fps)
+{
+    GLFWwindow* window = context_->getWindow();
+
+    input_.bind(GLFW_KEY_ESCAPE, kQuit);
+    input_.bind(GLFW_KEY_W, kWireframe);
+    input_.bind(GLFW_KEY_F, kFill);
+
+    // configure key event handler, there is no window when headless
+    if (window != nullptr) {
+        glfwSetWindowUserPointer(window, this);
+        glfwSetKeyCallback(window, onKey);
+    }
+}
+
+/*!
+ * SceneRunner destructor, destroys the context
+ */
+SceneRunner::~SceneRunner ()
+{
+    Profiler::getInstance().release();
+
+    GLFWwindow* window = context_->getWindow();
+
+    if (window != nullptr) {
+        glfwSetKeyCallback(window, nullptr);
+        glfwSetWindowUserPointer(window, nullptr);
+    }
+}
+
+/*!
+ * Check if the context was created
+ *
+ * \return True if scenes can be run
+ */
+bool SceneRunner::isValid () const
+{
+    return context_->isValid();
+}
+
+/*!
+ * Get the context the scenes render with
+ *
+ * \return The context
+ */
+RenderContext& SceneRunner::getContext ()
+{
+    return *context_;
+}
+
+/*!
+ * Run a scene until the context asks to close. A scene whose assets
+ * can't be loaded is shut down and reported as not completed.
+ *
+ * \param[in] name The scene name
+ *
+ * \return True if the scene was found, initialized and rendered
+ */
+bool SceneRunner::run (const std::string& name)
+{
+    std::unique_ptr<Scene> scene = SceneRegistry::getInstance().create(name);
+    Profiler& profiler = Profiler::getInstance();
+
+    if (scene == nullptr) {
+        LOG_ERROR("ERROR::SCENE::NOT_FOUND " << name);
+        return false;
+    }
+
+    SceneResult result = {name, false, 0.0, 0, 0.0, 0.0, 0, 0, 0, 0, 0.0, 0};
+
+    // the keys pressed during the previous scene are not for this one
+    input_.reset();
+
+    LOG_INFO("Running scene " << name);
+
+    context_->restart(name);
+    scene_ = scene.get();
+
+    try {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        bool initialized = scene->init(*context_);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        result.init_ms = elapsed.count();
+
+        if (initialized) {
+            double start_time = context_->getTime();
+            double last_time = 0.0;
+            bool pipelined = scene->isPipelined();
+
+            // pipelined scenes record one while the other is submitted
+            FrameCommands commands[2];
+            unsigned int current = 0;
+            JobCounter simulated;
+
+            // read by the simulation job, polled again once it's done
+            InputFrame input;
+            const std::vector<KeyEvent> no_keys;
+
+            GLState::getInstance().resetStats();
+
+            // the uploads of init() are not part of any frame
+            Shader::resetUniformStats();
+
+            // the first interval starts now, not before init()
+            scheduler_.reset();
+
+            // game loop
+            while (!context_->shouldClose()) {
+                profiler.beginFrame();
+
+                // poll the events and bind the framebuffer to draw to
+                context_->beginFrame();
+
+                double time = context_->getTime() - start_time;
+                double delta = time - last_time;
+
+                input_.poll(input);
+
+                // the keys only come from a window
+                if (input.isPressed(kQuit))
+                    glfwSetWindowShouldClose(context_->getWindow(), GL_TRUE);
+
+                if (input.isPressed(kWireframe)) {
+                    // enable wireframe mode
+                    GLState::getInstance().polygonMode(GL_LINE);
+                } else if (input.isPressed(kFill)) {
+                    // disable wireframe mode
+                    GLState::getInstance().polygonMode(GL_FILL);
+                }
+
+                if (!pipelined) {
+                    {
+                        ProfileScope scope("update");
+
+                        simulate(
+                            *scene, input.keys, nullptr, scheduler_.advance(time, delta)
+                        );
+                    }
+
+                    {
+                        ProfileScope scope("render", true);
+
+                        scene->render();
+                    }
+                } else {
+                    // the first frame has nothing recorded yet, it takes
+                    // the keys of the frame
+                    const std::vector<KeyEvent>* keys = &input.keys;
+
+                    if (context_->getFrame() == 0) {
+                        ProfileScope scope("update");
+
+                        simulate(
+                            *scene, input.keys, &commands[current],
+                            scheduler_.advance(time, delta)
+                        );
+                        keys = &no_keys;
+                    }
+
+                    // the next frame is due a frame interval from now
+                    FrameCommands* next = &commands[current ^ 1];
+                    Scene* target = scene.get();
+                    FrameStep step = scheduler_.advance(time + delta, delta);
+
+                    jobs_->submit([this, target, keys, next, step] {
+                        simulate(*target, *keys, next, step);
+                    }, simulated);
+
+                    {
+                        ProfileScope scope("render", true);
+
+                        scene->submit(commands[current]);
+                    }
+
+                    {
+                        ProfileScope scope("wait");
+
+                        jobs_->wait(simulated);
+                    }
+
+                    current ^= 1;
+                }
+
+                last_time = time;
+
+                UniformStats uniforms = Shader::resetUniformStats();
+
+                result.uniform_uploads += uniforms.uploads;
+                result.uniform_skipped += uniforms.skipped;
+
+                // swap the screen buffers, or capture the frame when headless
+                context_->endFrame();
+
+                {
+                    ProfileScope scope("frame_cap");
+
+                    scheduler_.wait();
+                }
+
+                profiler.endFrame();
+            }
+
+            GLStateStats stats = GLState::getInstance().resetStats();
+            FramePacingStats pacing = scheduler_.getStats();
+
+            result.completed = true;
+            result.state_issued = stats.issued;
+            result.state_filtered = stats.filtered;
+            result.jitter_ms = pacing.jitter_ms;
+            result.late = pacing.late;
+        } else {
+            LOG_ERROR("ERROR::SCENE::INIT_FAILED " << name);
+        }
+    } catch (const AssetError& e) {
+        LOG_ERROR(e.what());
+    }
+
+    scene->shutdown();
+    scene_ = nullptr;
+
+    // the scene's lines come before the profiler table
+    LogSink::getInstance().flush();
+
+    // the wireframe mode set by a key must not leak into the next scene
+    GLState::getInstance().polygonMode(GL_FILL);
+
+    result.frames = context_->getFrame();
+    result.average_ms = context_->getAverageFrameTime();
+    result.max_ms = context_->getMaxFrameTime();
+    results_.push_back(result);
+
+    // the GPU times of the last frames are read back before the table, the
+    // next scene starts with an empty history
+    if (profiler.isEnabled()) {
+        profiler.finish();
+        profiler.report(std::cout);
+        profiler.clearHistory();
+    }
+
+    return result.completed;
+}
+
+/*!
+ * Run every registered scene, in registration order
+ *
+ * \return The number of scenes that did not complete
+ */
+unsigned int SceneRunner::runAll ()
+{
+    unsigned int failures = 0;
+
+    for (const std::string& name : SceneRegistry::getInstance().getNames()) {
+        if (!run(name))
+            ++failures;
+    }
+
+    return failures;
+}
+
+/*!
+ * Print the timings of every scene run, then the input, pacing and
+ * context counters
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void SceneRunner::report (std::ostream& out)
+{
+    // the lines logged so far come before the table
+    LogSink::getInstance().flush();
+
+    out << std::left << std::setw(20) << "Scene" << std::right
+        << std::setw(8) << "Frames"
+        << std::setw(10) << "Init ms"
+        << std::setw(10) << "Avg ms"
+        << std::setw(10) << "Max ms"
+        << std::setw(10) << "Binds/f"
+        << std::setw(11) << "Dropped/f"
+        << std::setw(13) << "Uniforms/f"
+        << std::setw(11) << "Skipped/f"
+        << std::setw(11) << "Jitter ms"
+        << std::setw(6) << "Late" << std::endl;
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(3);
+
+    for (const SceneResult& result : results_) {
+        out << std::left << std::setw(20) << result.name << std::right
+            << std::setw(8) << result.frames
+            << std::setw(10) << result.init_ms
+            << std::setw(10) << result.average_ms
+            << std::setw(10) << result.max_ms
+            << std::setprecision(1)
+            << std::setw(10) << getPerFrame(result.state_issued, result.frames)
+            << std::setw(11) << getPerFrame(result.state_filtered, result.frames)
+            << std::setw(13) << getPerFrame(result.uniform_uploads, result.frames)
+            << std::setw(11) << getPerFrame(result.uniform_skipped, result.frames)
+            << std::setprecision(3)
+            << std::setw(11) << result.jitter_ms
+            << std::setw(6) << result.late;
+
+        if (!result.completed)
+            out << "  FAILED";
+
+        out << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+
+    LogSinkStats log = LogSink::getInstance().getStats();
+
+    input_.report(out);
+    scheduler_.report(out);
+    out << "Log lines: " << log.written << ", " << log.suppressed
+        << " suppressed, " << log.dropped << " dropped, " << log.flushes
+        << " writes" << std::endl;
+
+    context_->report(out);
+}
+
+/*!
+ * Give the frame's keys to the scene, then advance, interpolate and
+ * record it
+ *
+ * \param[in] scene    The scene
+ * \param[in] keys     The keys for the scene
+ * \param[in] commands The commands to record into, nullptr when the
+ *                     scene is not pipelined
+ * \param[in] step     The updates of the frame
+ *
+ * \return void
+ */
+void SceneRunner::simulate (
+    Scene& scene, const std::vector<KeyEvent>& keys, FrameCommands* commands,
+    const FrameStep& step
+) {
+    for (const KeyEvent& event : keys)
+        scene.onKey(event.key, event.action);
+
+    for (unsigned int i = 0; i < step.steps; ++i)
+        scene.update(step.time + i * step.delta, step.delta);
+
+    scene.interpolate(step.alpha);
+
+    if (commands != nullptr) {
+        commands->reset(jobs_->getThreadCount());
+        scene.record(*jobs_, *commands);
+    }
+}
+
+/*!
+ * The GLFW key callback, queues the keys for the frame loop
+ *
+ * \param[in] window   The window receiving the event
+ * \param[in] key      The GLFW key code
+ * \param[in] scancode The platform key code
+ * \param[in] action   GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+ * \param[in] mode     The modifier keys held down
+ *
+ * \return void
+ */
+void SceneRunner::onKey (
+    GLFWwindow* window, int key, int, int action, int mode
+) {
+    SceneRunner* runner = static_cast<SceneRunner*>(
+        glfwGetWindowUserPointer(window)
+    );
+
+    // a full queue drops the key, the frame loop counts it
+    if ((runner != nullptr) && (runner->scene_ != nullptr))
+        runner->input_.push(key, action, mode);
+}
@@ -0,0 +1,229 @@
+/*!
+ * \file  SceneRunner.hpp
+ * \brief Class definition of the frame loop running the registered scenes
+ */
+
+#ifndef __SCENE_RUNNER_HPP
+#define __SCENE_RUNNER_HPP
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CommandBuffer.hpp"
+#include "FrameScheduler.hpp"
+#include "InputSystem.hpp"
+#include "JobSystem.hpp"
+#include "RenderContext.hpp"
+#include "Scene.hpp"
+
+//! SceneResult
+/*!
+ * SceneResult holds the timings of a scene run by SceneRunner
+ */
+struct SceneResult
+{
+    /*!
+     * The scene name
+     */
+    std::string name;
+
+    /*!
+     * Whether the scene was initialized and rendered
+     */
+    bool completed;
+
+    /*!
+     * The time spent in init(), in ms
+     */
+    double init_ms;
+
+    /*!
+     * The number of frames rendered
+     */
+    unsigned int frames;
+
+    /*!
+     * The average frame time, in ms
+     */
+    double average_ms;
+
+    /*!
+     * The longest frame time, in ms
+     */
+    double max_ms;
+
+    /*!
+     * The state changes sent to the driver by the frame loop
+     */
+    unsigned long state_issued;
+
+    /*!
+     * The state changes dropped by GLState in the frame loop
+     */
+    unsigned long state_filtered;
+
+    /*!
+     * The uniform uploads issued by the scene's shaders in the frame loop
+     */
+    unsigned long uniform_uploads;
+
+    /*!
+     * The uniform uploads skipped because the value did not change
+     */
+    unsigned long uniform_skipped;
+
+    /*!
+     * The standard deviation of the interval between frames, in ms
+     */
+    double jitter_ms;
+
+    /*!
+     * The frames that missed the frame cap by 1 ms or more
+     */
+    unsigned int late;
+};
+
+//! SceneRunner
+/*!
+ * SceneRunner owns the context and the frame loop. It creates the scenes
+ * from SceneRegistry by name and runs them one after the other on the same
+ * context, so a sweep over every scene pays for the context creation and
+ * GLEW initialization once. Escape ends the current scene, W and F switch
+ * between wireframe and filled polygons, every other key goes to the scene.
+ *
+ * The key callback only queues the keys in an InputSystem. The frame loop
+ * polls it once per frame, applies Escape, W and F itself and gives the
+ * other keys to the scene before its update().
+ *
+ * A FrameScheduler decides how many update() calls a frame runs and holds
+ * each frame until the frame cap allows the next one. Pipelined scenes are
+ * simulated and recorded on the job system one frame ahead: while the
+ * render thread, the one owning the context, submits frame N, a job runs
+ * frame N + 1.
+ */
+class SceneRunner
+{
+ private:
+    /*!
+     * The context every scene renders with
+     */
+    std::unique_ptr<RenderContext> context_;
+
+    /*!
+     * The scene being run, nullptr between scenes
+     */
+    Scene* scene_;
+
+    /*!
+     * The timings of the scenes run so far
+     */
+    std::vector<SceneResult> results_;
+
+    /*!
+     * Runs the pipelined scenes, created with the runner
+     */
+    std::unique_ptr<JobSystem> jobs_;
+
+    /*!
+     * The keys from the callback, polled by the frame loop
+     */
+    InputSystem input_;
+
+    /*!
+     * Splits the frame time in updates and paces the frames
+     */
+    FrameScheduler scheduler_;
+
+    /*!
+     * Give the frame's keys to the scene, then advance, interpolate and
+     * record it
+     *
+     * \param[in] scene    The scene
+     * \param[in] keys     The keys for the scene
+     * \param[in] commands The commands to record into, nullptr when the
+     *                     scene is not pipelined
+     * \param[in] step     The updates of the frame
+     *
+     * \return void
+     */
+    void simulate (
+        Scene& scene, const std::vector<KeyEvent>& keys, FrameCommands* commands,
+        const FrameStep& step
+    );
+
+    /*!
+     * The GLFW key callback, queues the keys for the frame loop
+     *
+     * \param[in] window   The window receiving the event
+     * \param[in] key      The GLFW key code
+     * \param[in] scancode The platform key code
+     * \param[in] action   GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+     * \param[in] mode     The modifier keys held down
+     *
+     * \return void
+     */
+    static void onKey (
+        GLFWwindow* window, int key, int scancode, int action, int mode
+    );
+
+ public:
+    /*!
+     * SceneRunner constructor, creates the context
+     *
+     * \param[in] options The context options
+     */
+    explicit SceneRunner (const RenderOptions& options);
+
+    SceneRunner (const SceneRunner&) = delete;
+    SceneRunner& operator= (const SceneRunner&) = delete;
+
+    /*!
+     * SceneRunner destructor, destroys the context
+     */
+    ~SceneRunner ();
+
+    /*!
+     * Check if the context was created
+     *
+     * \return True if scenes can be run
+     */
+    bool isValid () const;
+
+    /*!
+     * Get the context the scenes render with
+     *
+     * \return The context
+     */
+    RenderContext& getContext ();
+
+    /*!
+     * Run a scene until the context asks to close. A scene whose assets
+     * can't be loaded is shut down and reported as not completed.
+     *
+     * \param[in] name The scene name
+     *
+     * \return True if the scene was found, initialized and rendered
+     */
+    bool run (const std::string& name);
+
+    /*!
+     * Run every registered scene, in registration order
+     *
+     * \return The number of scenes that did not complete
+     */
+    unsigned int runAll ();
+
+    /*!
+     * Print the timings of every scene run, then the input, pacing and
+     * context counters
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out);
+};
+
+#endif // __SCENE_RUNNER_HPP
@@ -1,5 +1,16 @@
 #include "Shader.hpp"
 
+#include <chrono>
+#include <algorithm>
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "ShaderCache.hpp"
+#include "UniformBuffer.hpp"
+
+UniformStats Shader::uniform_stats_ = {0, 0};
+
 /*!
  * Shader constructor
  *
@@ -8,28 +19,76 @@
  */
 Shader::Shader (const GLchar* vertex_path, const GLchar* fragment_path)
 {
-    std::string tmp;
+    ShaderCache& cache = ShaderCache::getInstance();
+    std::string key;
     GLuint vertex_shader;
     GLuint fragment_shader;
 
-    tmp = readShaderFile(vertex_path);
-    vertex_shader = compileVertexShader(tmp.c_str());
+    // the sources are handed to the driver straight from the page cache
+    AssetFile vertex_file(vertex_path);
+    AssetFile fragment_file(fragment_path);
+
+    key = cache.makeKey(
+        vertex_file.getData(), vertex_file.getSize(),
+        fragment_file.getData(), fragment_file.getSize()
+    );
+
+    program_ = glCreateProgram();
+
+    if (cache.load(key, program_)) {
+        queryUniforms();
+        bindUniformBlocks();
+        return;
+    }
+
+    // the cached binary is missing or was rejected, build it from source
+    glDeleteProgram(program_);
 
-    tmp = readShaderFile(fragment_path);
-    fragment_shader = compileFragmentShader(tmp.c_str());
+    auto start = std::chrono::steady_clock::now();
+
+    vertex_shader = compileVertexShader(
+        vertex_file.getData(), vertex_file.getSize()
+    );
+    fragment_shader = compileFragmentShader(
+        fragment_file.getData(), fragment_file.getSize()
+    );
 
     linkProgram(vertex_shader, fragment_shader);
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    cache.store(key, program_, elapsed.count());
+
+    queryUniforms();
+    bindUniformBlocks();
+}
+
+/*!
+ * Shader constructor
+ *
+ * \param[in] program A program that has already been linked, the shader
+ *                    deletes it
+ */
+Shader::Shader (GLuint program)
+    : program_(program)
+{
+    queryUniforms();
+    bindUniformBlocks();
 }
 
 /*!
- * Shader destructor
+ * Shader destructor, deletes the program
  */
 Shader::~Shader ()
 {
+    GLState::getInstance().forgetProgram(program_);
+
+    glDeleteProgram(program_);
 }
 
 /*!
- * Load the shader file
+ * Load the shader file, throws AssetError if it can't be read
  *
  * \param[in] filepath The path to the shader source code
  *
@@ -37,56 +96,28 @@ Shader::~Shader ()
  */
 std::string Shader::readShaderFile (const GLchar* filepath)
 {
-    std::string code;
-    std::ifstream file;
-
-    file.exceptions(std::ifstream::badbit);
-
-    try {
-        file.open(filepath);
-
-        file.seekg(0, std::ios::end);
-
-        code.reserve(file.tellg());
-
-        file.seekg(0, std::ios::beg);
-
-        code.assign(
-            (std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>()
-        );
-
-        file.close();
-    } catch (std::ifstream::failure e) {
-        std::cout << "ERROR::SHADER::FAILED_TO_READ_FILE" << std::endl;
-    }
+    AssetFile file(filepath);
 
-    return code;
+    return std::string(file.getData(), file.getSize());
 }
 
 /*!
  * Compile the vertex shader
  *
- * \param[in] code The vertex shader source code
+ * \param[in] code   The vertex shader source code
+ * \param[in] length The length of the source code, or -1 if it is NUL
+ *                   terminated
  *
  * \return Resource id
  */
-GLuint Shader::compileVertexShader (const GLchar* code)
+GLuint Shader::compileVertexShader (const GLchar* code, GLint length)
 {
-    GLint success;
-    GLchar log[512];
     GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
 
-    glShaderSource(vertex, 1, &code, NULL);
+    glShaderSource(vertex, 1, &code, &length);
     glCompileShader(vertex);
 
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-
-    if (!success) {
-        glGetShaderInfoLog(vertex, 512, NULL, log);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n";
-        std::cout << log << std::endl;
-    }
+    checkCompileStatus(vertex, "VERTEX");
 
     return vertex;
 }
@@ -94,26 +125,20 @@ GLuint Shader::compileVertexShader (const GLchar* code)
 /*!
  * Compile the fragment shader
  *
- * \param[in] code The fragment shader source code
+ * \param[in] code   The fragment shader source code
+ * \param[in] length The length of the source code, or -1 if it is NUL
+ *                   terminated
  *
  * \return Resource id
  */
-GLuint Shader::compileFragmentShader (const GLchar* code)
+GLuint Shader::compileFragmentShader (const GLchar* code, GLint length)
 {
-    GLint success;
-    GLchar log[512];
     GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
 
-    glShaderSource(fragment, 1, &code, NULL);
+    glShaderSource(fragment, 1, &code, &length);
     glCompileShader(fragment);
 
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, NULL, log);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n";
-        std::cout << log << std::endl;
-    }
+    checkCompileStatus(fragment, "FRAGMENT");
 
     return fragment;
 }
@@ -128,25 +153,80 @@ GLuint Shader::compileFragmentShader (const GLchar* code)
  */
 void Shader::linkProgram (GLuint vertex_shader, GLuint fragment_shader)
 {
-    GLint success;
-    GLchar log[512];
-
     program_ = glCreateProgram();
+
+    // allow the linked program to be saved by the shader cache
+    if (ShaderCache::getInstance().isSupported()) {
+        glProgramParameteri(
+            program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE
+        );
+    }
+
     glAttachShader(program_, vertex_shader);
     glAttachShader(program_, fragment_shader);
 
     glLinkProgram(program_);
 
-    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    checkLinkStatus(program_);
+
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+}
+
+/*!
+ * Check the compile status of a shader and print its log on failure
+ *
+ * \param[in] shader The shader resource id
+ * \param[in] stage  The stage name used in the error message
+ *
+ * \return True if the shader was compiled successfully
+ */
+bool Shader::checkCompileStatus (GLuint shader, const GLchar* stage)
+{
+    GLint success;
+    GLint length = 0;
+
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 
     if (!success) {
-        glGetProgramInfoLog(program_, 512, NULL, log);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n";
-        std::cout << log << std::endl;
+        // the length counts the terminating null, the whole log is kept
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+
+        std::vector<GLchar> log(std::max(length, 1), '\0');
+
+        glGetShaderInfoLog(shader, log.size(), NULL, log.data());
+        LOG_ERROR("ERROR::SHADER::" << stage << "::COMPILATION_FAILED");
+        LOG_ERROR(log.data());
     }
 
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
+    return success;
+}
+
+/*!
+ * Check the link status of a program and print its log on failure
+ *
+ * \param[in] program The program resource id
+ *
+ * \return True if the program was linked successfully
+ */
+bool Shader::checkLinkStatus (GLuint program)
+{
+    GLint success;
+    GLint length = 0;
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+        std::vector<GLchar> log(std::max(length, 1), '\0');
+
+        glGetProgramInfoLog(program, log.size(), NULL, log.data());
+        LOG_ERROR("ERROR::SHADER::PROGRAM::LINKING_FAILED");
+        LOG_ERROR(log.data());
+    }
+
+    return success;
 }
 
 /*!
@@ -166,5 +246,160 @@ GLuint Shader::getProgram ()
  */
 void Shader::use ()
 {
-    glUseProgram(program_);
+    GLState::getInstance().useProgram(program_);
+}
+
+/*!
+ * Get the location of an active uniform
+ *
+ * \param[in] id The uniform id
+ *
+ * \return The location, or -1 if the program does not use the uniform
+ */
+GLint Shader::getUniformLocation (UniformId id)
+{
+    UniformSlot* slot = findUniform(id);
+
+    return (slot != nullptr) ? slot->location : -1;
+}
+
+/*!
+ * Get the uniform uploads of every shader since the last reset
+ *
+ * \return The counters
+ */
+UniformStats Shader::getUniformStats ()
+{
+    return uniform_stats_;
+}
+
+/*!
+ * Reset the uniform counters, called once per frame
+ *
+ * \return The counters of the frame that just ended
+ */
+UniformStats Shader::resetUniformStats ()
+{
+    UniformStats stats = uniform_stats_;
+
+    uniform_stats_.uploads = 0;
+    uniform_stats_.skipped = 0;
+
+    return stats;
+}
+
+/*!
+ * List the active uniforms of the program
+ *
+ * \return void
+ */
+void Shader::queryUniforms ()
+{
+    GLint count = 0;
+    GLint max_length = 0;
+
+    uniforms_.clear();
+
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::vector<GLchar> name(max_length + 1);
+
+    for (GLint i = 0; i < count; ++i) {
+        UniformSlot slot;
+        GLint size;
+        GLsizei length;
+
+        glGetActiveUniform(
+            program_, i, name.size(), &length, &size, &slot.type, name.data()
+        );
+
+        // arrays are reported as "name[0]", look them up by "name"
+        if ((length > 3) && !std::strcmp(name.data() + length - 3, "[0]"))
+            name[length - 3] = '\0';
+
+        slot.location = glGetUniformLocation(program_, name.data());
+
+        // members of a uniform block have no location
+        if (slot.location < 0)
+            continue;
+
+        slot.hash = hashUniformName(name.data());
+        slot.cached = false;
+
+        uniforms_.push_back(slot);
+    }
+
+    std::sort(
+        uniforms_.begin(), uniforms_.end(),
+        [] (const UniformSlot& a, const UniformSlot& b) {
+            return a.hash < b.hash;
+        }
+    );
+
+    for (std::size_t i = 1; i < uniforms_.size(); ++i) {
+        if (uniforms_[i].hash == uniforms_[i - 1].hash)
+            LOG_ERROR("ERROR::SHADER::UNIFORM::NAME_HASH_COLLISION");
+    }
+}
+
+/*!
+ * Find an active uniform
+ *
+ * \param[in] id The uniform id
+ *
+ * \return The uniform, or nullptr if the program does not use it
+ */
+UniformSlot* Shader::findUniform (UniformId id)
+{
+    auto it = std::lower_bound(
+        uniforms_.begin(), uniforms_.end(), id.getHash(),
+        [] (const UniformSlot& slot, std::uint32_t hash) {
+            return slot.hash < hash;
+        }
+    );
+
+    if ((it == uniforms_.end()) || (it->hash != id.getHash()))
+        return nullptr;
+
+    return &(*it);
+}
+
+/*!
+ * Bind every uniform block of the program to the binding point the
+ * UniformBlockRegistry gave its name
+ *
+ * \return void
+ */
+void Shader::bindUniformBlocks ()
+{
+    GLint count = 0;
+    GLint max_length = 0;
+
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length);
+
+    std::vector<GLchar> name(max_length + 1);
+
+    for (GLint i = 0; i < count; ++i) {
+        GLint size = 0;
+
+        glGetActiveUniformBlockName(program_, i, name.size(), NULL, name.data());
+        glGetActiveUniformBlockiv(program_, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+        GLsizeiptr expected = UniformBlockRegistry::getSize(name.data());
+
+        // the struct may be padded further than the block, never less
+        if ((expected > 0) && (size > expected)) {
+            LOG_ERROR("ERROR::SHADER::UNIFORM_BLOCK::SIZE_MISMATCH");
+            LOG_ERROR(
+                name.data() << ": " << size << " bytes in GLSL, "
+                << expected << " bytes in C++"
+            );
+        }
+
+        glUniformBlockBinding(
+            program_, i, UniformBlockRegistry::getBinding(name.data())
+        );
+    }
 }
@@ -8,11 +8,65 @@
 #define __SHADER_HPP
 
 #include <string>
-#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 #include <GL/glew.h>
 
+#include "Uniform.hpp"
+
+//! UniformSlot
+/*!
+ * UniformSlot describes an active uniform of a program and keeps the last
+ * value uploaded to it
+ */
+struct UniformSlot
+{
+    /*!
+     * The hash of the uniform name
+     */
+    std::uint32_t hash;
+
+    /*!
+     * The uniform location
+     */
+    GLint location;
+
+    /*!
+     * The GLSL type of the uniform
+     */
+    GLenum type;
+
+    /*!
+     * Whether value holds the current value of the uniform
+     */
+    bool cached;
+
+    /*!
+     * The last value uploaded, large enough for a mat4
+     */
+    unsigned char value[16 * sizeof(GLfloat)];
+};
+
+//! UniformStats
+/*!
+ * UniformStats counts the uniform uploads issued and skipped
+ */
+struct UniformStats
+{
+    /*!
+     * Number of glUniform* calls issued
+     */
+    unsigned long uploads;
+
+    /*!
+     * Number of uploads skipped because the value did not change
+     */
+    unsigned long skipped;
+};
+
 //! Shader
 /*!
  * Shader is used to read shaders from file, compile them and create a program
@@ -26,6 +80,40 @@ class Shader
      */
     GLuint program_;
 
+    /*!
+     * The active uniforms of the program, sorted by name hash
+     */
+    std::vector<UniformSlot> uniforms_;
+
+    /*!
+     * Uniform uploads of every shader since the last reset
+     */
+    static UniformStats uniform_stats_;
+
+    /*!
+     * List the active uniforms of the program
+     *
+     * \return void
+     */
+    void queryUniforms ();
+
+    /*!
+     * Find an active uniform
+     *
+     * \param[in] id The uniform id
+     *
+     * \return The uniform, or nullptr if the program does not use it
+     */
+    UniformSlot* findUniform (UniformId id);
+
+    /*!
+     * Bind every uniform block of the program to the binding point the
+     * UniformBlockRegistry gave its name
+     *
+     * \return void
+     */
+    void bindUniformBlocks ();
+
  public:
     /*!
      * Shader constructor
@@ -36,36 +124,51 @@ class Shader
     Shader (const GLchar* vertex_path, const GLchar* fragment_path);
 
     /*!
-     * Shader destructor
+     * Shader constructor
+     *
+     * \param[in] program A program that has already been linked, the shader
+     *                    deletes it
+     */
+    explicit Shader (GLuint program);
+
+    Shader (const Shader&) = delete;
+    Shader& operator= (const Shader&) = delete;
+
+    /*!
+     * Shader destructor, deletes the program
      */
     ~Shader ();
 
     /*!
-     * Load the shader file
+     * Load the shader file, throws AssetError if it can't be read
      *
      * \param[in] filepath The path to the shader source code
      *
      * \return The shader source code
      */
-    std::string readShaderFile (const GLchar* filepath);
+    static std::string readShaderFile (const GLchar* filepath);
 
     /*!
      * Compile the vertex shader
      *
-     * \param[in] code The vertex shader source code
+     * \param[in] code   The vertex shader source code
+     * \param[in] length The length of the source code, or -1 if it is NUL
+     *                   terminated
      *
      * \return Resource id
      */
-    GLuint compileVertexShader (const GLchar* code);
+    GLuint compileVertexShader (const GLchar* code, GLint length = -1);
 
     /*!
      * Compile the fragment shader
      *
-     * \param[in] code The fragment shader source code
+     * \param[in] code   The fragment shader source code
+     * \param[in] length The length of the source code, or -1 if it is NUL
+     *                   terminated
      *
      * \return Resource id
      */
-    GLuint compileFragmentShader (const GLchar* code);
+    GLuint compileFragmentShader (const GLchar* code, GLint length = -1);
 
     /*!
      * Create a link between shaders and the program
@@ -77,6 +180,25 @@ class Shader
      */
     void linkProgram (GLuint vertex_shader, GLuint fragment_shader);
 
+    /*!
+     * Check the compile status of a shader and print its log on failure
+     *
+     * \param[in] shader The shader resource id
+     * \param[in] stage  The stage name used in the error message
+     *
+     * \return True if the shader was compiled successfully
+     */
+    static bool checkCompileStatus (GLuint shader, const GLchar* stage);
+
+    /*!
+     * Check the link status of a program and print its log on failure
+     *
+     * \param[in] program The program resource id
+     *
+     * \return True if the program was linked successfully
+     */
+    static bool checkLinkStatus (GLuint program);
+
     /*!
      * Get the program
      *
@@ -90,6 +212,65 @@ class Shader
      * \return void
      */
     void use ();
+
+    /*!
+     * Get the location of an active uniform
+     *
+     * \param[in] id The uniform id
+     *
+     * \return The location, or -1 if the program does not use the uniform
+     */
+    GLint getUniformLocation (UniformId id);
+
+    /*!
+     * Set a uniform of the program, which must be in use. The upload is
+     * skipped when the uniform already holds the value.
+     *
+     * \param[in] id    The uniform id
+     * \param[in] value The value, any type with a UniformTraits specialization
+     *
+     * \return False if the program does not use the uniform
+     */
+    template <typename T>
+    bool set (UniformId id, const T& value)
+    {
+        static_assert(
+            sizeof(T) <= sizeof(UniformSlot::value),
+            "uniform value too large"
+        );
+
+        UniformSlot* slot = findUniform(id);
+
+        if (slot == nullptr)
+            return false;
+
+        if (slot->cached && !std::memcmp(slot->value, &value, sizeof(T))) {
+            ++uniform_stats_.skipped;
+            return true;
+        }
+
+        std::memcpy(slot->value, &value, sizeof(T));
+        slot->cached = true;
+
+        UniformTraits<T>::upload(slot->location, value);
+        ++uniform_stats_.uploads;
+
+        return true;
+    }
+
+    /*!
+     * Get the uniform uploads of every shader since the last reset
+     *
+     * \return The counters
+     */
+    static UniformStats getUniformStats ();
+
+    /*!
+     * Reset the uniform counters, called once per frame
+     *
+     * \return The counters of the frame that just ended
+     */
+    static UniformStats resetUniformStats ();
 };
 
 #endif // __SHADER_HPP
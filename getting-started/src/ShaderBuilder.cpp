@@ -0,0 +1,274 @@
+#include "ShaderBuilder.hpp"
+
+#include "AssetFile.hpp"
+#include "ShaderCache.hpp"
+
+/*!
+ * PendingShader destructor, deletes the objects of a program whose
+ * status was never checked; once checked, the shader owns the program
+ */
+PendingShader::~PendingShader ()
+{
+    if (shader)
+        return;
+
+    if (vertex != 0) {
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+    }
+
+    glDeleteProgram(program);
+}
+
+/*!
+ * ShaderFuture constructor, the handle refers to no program
+ */
+ShaderFuture::ShaderFuture ()
+{
+}
+
+/*!
+ * ShaderFuture constructor
+ *
+ * \param[in] pending The program submitted to the builder
+ */
+ShaderFuture::ShaderFuture (std::shared_ptr<PendingShader> pending)
+    : pending_(pending)
+{
+}
+
+/*!
+ * Check if the handle refers to a program
+ *
+ * \return True if the handle was returned by ShaderBuilder::submit
+ */
+bool ShaderFuture::isValid ()
+{
+    return pending_ != nullptr;
+}
+
+/*!
+ * Check if the program can be used without blocking. Without
+ * GL_KHR_parallel_shader_compile the driver can't be asked, so the
+ * program is always reported as ready and get() may block.
+ *
+ * \return True if the program has finished compiling and linking
+ */
+bool ShaderFuture::isReady ()
+{
+    if (!pending_)
+        return false;
+
+    if (pending_->shader || !pending_->parallel || !pending_->vertex)
+        return true;
+
+    GLint done = GL_FALSE;
+
+    glGetProgramiv(pending_->program, GL_COMPLETION_STATUS_KHR, &done);
+
+    return done == GL_TRUE;
+}
+
+/*!
+ * Get the shader, blocking until the program is linked
+ *
+ * \return The shader
+ */
+std::shared_ptr<Shader> ShaderFuture::get ()
+{
+    if (!pending_)
+        return nullptr;
+
+    if (pending_->shader)
+        return pending_->shader;
+
+    // restored from the shader cache, nothing to check
+    if (!pending_->vertex) {
+        pending_->shader = std::make_shared<Shader>(pending_->program);
+
+        return pending_->shader;
+    }
+
+    Shader::checkCompileStatus(pending_->vertex, "VERTEX");
+    Shader::checkCompileStatus(pending_->fragment, "FRAGMENT");
+
+    bool linked = Shader::checkLinkStatus(pending_->program);
+
+    glDeleteShader(pending_->vertex);
+    glDeleteShader(pending_->fragment);
+
+    if (linked) {
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - pending_->start;
+
+        ShaderCache::getInstance().store(
+            pending_->key, pending_->program, elapsed.count()
+        );
+    }
+
+    pending_->shader = std::make_shared<Shader>(pending_->program);
+
+    return pending_->shader;
+}
+
+/*!
+ * ShaderBuilder constructor, must be called with a current context
+ */
+ShaderBuilder::ShaderBuilder ()
+    : parallel_(false)
+{
+    // let the driver pick how many compiler threads it wants
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallel_ = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallel_ = true;
+    }
+}
+
+/*!
+ * Check if the driver compiles the programs in background threads
+ *
+ * \return True if GL_KHR_parallel_shader_compile is used
+ */
+bool ShaderBuilder::isParallel ()
+{
+    return parallel_;
+}
+
+/*!
+ * Submit a program read from files, throws AssetError if a file can't
+ * be read
+ *
+ * \param[in] vertex_path   The path to the vertex shader source code
+ * \param[in] fragment_path The path to the fragment shader source code
+ *
+ * \return The handle of the program
+ */
+ShaderFuture ShaderBuilder::submit (
+    const GLchar* vertex_path, const GLchar* fragment_path
+) {
+    // glShaderSource copies the code, the files can be unmapped afterwards
+    AssetFile vertex_file(vertex_path);
+    AssetFile fragment_file(fragment_path);
+
+    return submitCode(
+        vertex_file.getData(), vertex_file.getSize(),
+        fragment_file.getData(), fragment_file.getSize()
+    );
+}
+
+/*!
+ * Submit a program from source code
+ *
+ * \param[in] vertex_code   The vertex shader source code
+ * \param[in] fragment_code The fragment shader source code
+ *
+ * \return The handle of the program
+ */
+ShaderFuture ShaderBuilder::submitSource (
+    const std::string& vertex_code,
+    const std::string& fragment_code
+) {
+    return submitCode(
+        vertex_code.c_str(), vertex_code.size(),
+        fragment_code.c_str(), fragment_code.size()
+    );
+}
+
+/*!
+ * Submit a program from source code that is not NUL terminated
+ *
+ * \param[in] vertex_code   The vertex shader source code
+ * \param[in] vertex_size   The vertex shader source length
+ * \param[in] fragment_code The fragment shader source code
+ * \param[in] fragment_size The fragment shader source length
+ *
+ * \return The handle of the program
+ */
+ShaderFuture ShaderBuilder::submitCode (
+    const GLchar* vertex_code, std::size_t vertex_size,
+    const GLchar* fragment_code, std::size_t fragment_size
+) {
+    ShaderCache& cache = ShaderCache::getInstance();
+    std::shared_ptr<PendingShader> pending = std::make_shared<PendingShader>();
+    GLint length;
+
+    pending->key = cache.makeKey(
+        vertex_code, vertex_size, fragment_code, fragment_size
+    );
+    pending->vertex = 0;
+    pending->fragment = 0;
+    pending->parallel = parallel_;
+    pending->start = std::chrono::steady_clock::now();
+    pending->program = glCreateProgram();
+
+    if (cache.load(pending->key, pending->program))
+        return ShaderFuture(pending);
+
+    glDeleteProgram(pending->program);
+
+    // queue every command, none of them waits for the compiler
+    pending->vertex = glCreateShader(GL_VERTEX_SHADER);
+    length = vertex_size;
+    glShaderSource(pending->vertex, 1, &vertex_code, &length);
+    glCompileShader(pending->vertex);
+
+    pending->fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    length = fragment_size;
+    glShaderSource(pending->fragment, 1, &fragment_code, &length);
+    glCompileShader(pending->fragment);
+
+    pending->program = glCreateProgram();
+
+    if (cache.isSupported()) {
+        glProgramParameteri(
+            pending->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE
+        );
+    }
+
+    glAttachShader(pending->program, pending->vertex);
+    glAttachShader(pending->program, pending->fragment);
+    glLinkProgram(pending->program);
+
+    ShaderFuture future(pending);
+
+    submitted_.push_back(future);
+
+    return future;
+}
+
+/*!
+ * Check the status of every submitted program that is ready
+ *
+ * \return The number of programs still pending
+ */
+unsigned int ShaderBuilder::poll ()
+{
+    std::vector<ShaderFuture> pending;
+
+    for (ShaderFuture& future : submitted_) {
+        if (future.isReady())
+            future.get();
+        else
+            pending.push_back(future);
+    }
+
+    submitted_.swap(pending);
+
+    return submitted_.size();
+}
+
+/*!
+ * Block until every submitted program is linked
+ *
+ * \return void
+ */
+void ShaderBuilder::wait ()
+{
+    for (ShaderFuture& future : submitted_)
+        future.get();
+
+    submitted_.clear();
+}
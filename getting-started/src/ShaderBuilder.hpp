@@ -0,0 +1,205 @@
+/*!
+ * \file  ShaderBuilder.hpp
+ * \brief Class definitions to compile many shader programs at once and query
+ *        their status only when the caller needs them
+ */
+
+#ifndef __SHADER_BUILDER_HPP
+#define __SHADER_BUILDER_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "Shader.hpp"
+
+//! PendingShader
+/*!
+ * PendingShader holds the objects of a program submitted to a ShaderBuilder
+ * until its status is checked
+ */
+struct PendingShader
+{
+    /*!
+     * The shader cache key of the program
+     */
+    std::string key;
+
+    /*!
+     * The vertex shader, 0 when the program came from the shader cache
+     */
+    GLuint vertex;
+
+    /*!
+     * The fragment shader, 0 when the program came from the shader cache
+     */
+    GLuint fragment;
+
+    /*!
+     * The program being linked
+     */
+    GLuint program;
+
+    /*!
+     * Whether GL_COMPLETION_STATUS_KHR can be queried
+     */
+    bool parallel;
+
+    /*!
+     * The time the program was submitted
+     */
+    std::chrono::steady_clock::time_point start;
+
+    /*!
+     * The shader created once the status has been checked
+     */
+    std::shared_ptr<Shader> shader;
+
+    /*!
+     * PendingShader destructor, deletes the objects of a program whose
+     * status was never checked; once checked, the shader owns the program
+     */
+    ~PendingShader ();
+};
+
+//! ShaderFuture
+/*!
+ * ShaderFuture is the handle returned by ShaderBuilder::submit. It can be
+ * polled from the render loop without blocking and turns into a Shader once
+ * the driver has finished compiling and linking the program.
+ */
+class ShaderFuture
+{
+ private:
+    /*!
+     * The program shared with the builder
+     */
+    std::shared_ptr<PendingShader> pending_;
+
+ public:
+    /*!
+     * ShaderFuture constructor, the handle refers to no program
+     */
+    ShaderFuture ();
+
+    /*!
+     * ShaderFuture constructor
+     *
+     * \param[in] pending The program submitted to the builder
+     */
+    explicit ShaderFuture (std::shared_ptr<PendingShader> pending);
+
+    /*!
+     * Check if the handle refers to a program
+     *
+     * \return True if the handle was returned by ShaderBuilder::submit
+     */
+    bool isValid ();
+
+    /*!
+     * Check if the program can be used without blocking. Without
+     * GL_KHR_parallel_shader_compile the driver can't be asked, so the
+     * program is always reported as ready and get() may block.
+     *
+     * \return True if the program has finished compiling and linking
+     */
+    bool isReady ();
+
+    /*!
+     * Get the shader, blocking until the program is linked
+     *
+     * \return The shader
+     */
+    std::shared_ptr<Shader> get ();
+};
+
+//! ShaderBuilder
+/*!
+ * ShaderBuilder submits the compile and link commands of every program first
+ * and checks their status later, so the driver can work on all of them in
+ * parallel when GL_KHR_parallel_shader_compile is available
+ */
+class ShaderBuilder
+{
+ private:
+    /*!
+     * Whether GL_KHR_parallel_shader_compile (or the ARB variant) is used
+     */
+    bool parallel_;
+
+    /*!
+     * The programs that have not been checked yet
+     */
+    std::vector<ShaderFuture> submitted_;
+
+    /*!
+     * Submit a program from source code that is not NUL terminated
+     *
+     * \param[in] vertex_code   The vertex shader source code
+     * \param[in] vertex_size   The vertex shader source length
+     * \param[in] fragment_code The fragment shader source code
+     * \param[in] fragment_size The fragment shader source length
+     *
+     * \return The handle of the program
+     */
+    ShaderFuture submitCode (
+        const GLchar* vertex_code, std::size_t vertex_size,
+        const GLchar* fragment_code, std::size_t fragment_size
+    );
+
+ public:
+    /*!
+     * ShaderBuilder constructor, must be called with a current context
+     */
+    ShaderBuilder ();
+
+    /*!
+     * Check if the driver compiles the programs in background threads
+     *
+     * \return True if GL_KHR_parallel_shader_compile is used
+     */
+    bool isParallel ();
+
+    /*!
+     * Submit a program read from files, throws AssetError if a file can't
+     * be read
+     *
+     * \param[in] vertex_path   The path to the vertex shader source code
+     * \param[in] fragment_path The path to the fragment shader source code
+     *
+     * \return The handle of the program
+     */
+    ShaderFuture submit (const GLchar* vertex_path, const GLchar* fragment_path);
+
+    /*!
+     * Submit a program from source code
+     *
+     * \param[in] vertex_code   The vertex shader source code
+     * \param[in] fragment_code The fragment shader source code
+     *
+     * \return The handle of the program
+     */
+    ShaderFuture submitSource (
+        const std::string& vertex_code,
+        const std::string& fragment_code
+    );
+
+    /*!
+     * Check the status of every submitted program that is ready
+     *
+     * \return The number of programs still pending
+     */
+    unsigned int poll ();
+
+    /*!
+     * Block until every submitted program is linked
+     *
+     * \return void
+     */
+    void wait ();
+};
+
+#endif // __SHADER_BUILDER_HPP
@@ -0,0 +1,401 @@
+#include "ShaderCache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <errno.h>
+
+#include "Log.hpp"
+
+namespace {
+
+// identifies the entries written by this class
+const char kEntryMagic[4] = {'L', 'G', 'L', 'B'};
+const std::uint32_t kEntryVersion = 1;
+
+// header stored in front of every program binary
+struct EntryHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint32_t size;
+    double compile_ms;
+};
+
+// 64-bit FNV-1a
+std::uint64_t hashBytes (std::uint64_t hash, const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+void appendString (std::string& driver, const GLubyte* str)
+{
+    const char* tmp = reinterpret_cast<const char*>(str);
+
+    if (tmp == nullptr)
+        tmp = "";
+
+    // keep the terminator too, so "ab" + "c" differs from "a" + "bc"
+    driver.append(tmp, std::strlen(tmp) + 1);
+}
+
+} // namespace
+
+/*!
+ * ShaderCache constructor
+ *
+ * \param[in] directory The directory where the binaries are stored
+ */
+ShaderCache::ShaderCache (const std::string& directory)
+    : directory_(directory),
+      supported_(false),
+      probed_(false),
+      enabled_(true),
+      hits_(0),
+      misses_(0),
+      rejected_(0),
+      hit_compile_ms_(0.0),
+      hit_load_ms_(0.0)
+{
+}
+
+/*!
+ * Get the cache shared by every Shader
+ *
+ * \return The default cache, stored under ./cache/shader
+ */
+ShaderCache& ShaderCache::getInstance ()
+{
+    static ShaderCache instance("./cache/shader");
+
+    return instance;
+}
+
+/*!
+ * Check if the current context can save and restore program binaries
+ *
+ * \return True if program binaries are supported
+ */
+bool ShaderCache::isSupported ()
+{
+    if (!enabled_)
+        return false;
+
+    if (!probed_) {
+        GLint formats = 0;
+
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        // llvmpipe reports the extension with zero formats on some releases
+        supported_ = formats > 0;
+        probed_ = true;
+    }
+
+    return supported_;
+}
+
+/*!
+ * Enable or disable the cache, a disabled cache never hits nor stores
+ *
+ * \param[in] enabled Whether the cache must be used
+ *
+ * \return void
+ */
+void ShaderCache::setEnabled (bool enabled)
+{
+    enabled_ = enabled;
+}
+
+/*!
+ * Build the key of a program
+ *
+ * \param[in] vertex_code     The vertex shader source code
+ * \param[in] vertex_size     The vertex shader source length
+ * \param[in] fragment_code   The fragment shader source code
+ * \param[in] fragment_size   The fragment shader source length
+ *
+ * \return The hexadecimal key
+ */
+std::string ShaderCache::makeKey (
+    const GLchar* vertex_code, std::size_t vertex_size,
+    const GLchar* fragment_code, std::size_t fragment_size
+) {
+    std::string driver;
+
+    appendString(driver, glGetString(GL_VENDOR));
+    appendString(driver, glGetString(GL_RENDERER));
+    appendString(driver, glGetString(GL_VERSION));
+
+    return makeKey(vertex_code, vertex_size, fragment_code, fragment_size, driver);
+}
+
+/*!
+ * Build the key of a program for a driver
+ *
+ * \param[in] vertex_code     The vertex shader source code
+ * \param[in] vertex_size     The vertex shader source length
+ * \param[in] fragment_code   The fragment shader source code
+ * \param[in] fragment_size   The fragment shader source length
+ * \param[in] driver          The vendor, renderer and version strings of
+ *                            the driver, each followed by a '\0'
+ *
+ * \return The hexadecimal key
+ */
+std::string ShaderCache::makeKey (
+    const GLchar* vertex_code, std::size_t vertex_size,
+    const GLchar* fragment_code, std::size_t fragment_size,
+    const std::string& driver
+) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    char key[17];
+
+    hash = hashBytes(hash, &vertex_size, sizeof(vertex_size));
+    hash = hashBytes(hash, vertex_code, vertex_size);
+    hash = hashBytes(hash, &fragment_size, sizeof(fragment_size));
+    hash = hashBytes(hash, fragment_code, fragment_size);
+    hash = hashBytes(hash, driver.data(), driver.size());
+
+    std::snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+
+    return key;
+}
+
+/*!
+ * Restore a program from the cache
+ *
+ * \param[in] key     The entry key
+ * \param[in] program A program object without any attached shader
+ *
+ * \return True if the program was restored and linked successfully
+ */
+bool ShaderCache::load (const std::string& key, GLuint program)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (!isSupported()) {
+        ++misses_;
+        return false;
+    }
+
+    std::string path = getEntryPath(key);
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open()) {
+        ++misses_;
+        return false;
+    }
+
+    EntryHeader header;
+    std::vector<char> binary;
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (
+        !file ||
+        std::memcmp(header.magic, kEntryMagic, sizeof(kEntryMagic)) ||
+        (header.version != kEntryVersion)
+    ) {
+        ++misses_;
+        ++rejected_;
+        std::remove(path.c_str());
+
+        return false;
+    }
+
+    binary.resize(header.size);
+    file.read(binary.data(), header.size);
+
+    if (!file) {
+        ++misses_;
+        ++rejected_;
+        std::remove(path.c_str());
+
+        return false;
+    }
+
+    GLint success;
+
+    glProgramBinary(program, header.format, binary.data(), header.size);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        // the driver changed the binary format, the entry is useless now
+        ++misses_;
+        ++rejected_;
+        std::remove(path.c_str());
+
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    ++hits_;
+    hit_compile_ms_ += header.compile_ms;
+    hit_load_ms_ += elapsed.count();
+
+    return true;
+}
+
+/*!
+ * Store a linked program in the cache
+ *
+ * \param[in] key        The entry key
+ * \param[in] program    A linked program
+ * \param[in] compile_ms The time spent compiling and linking the program
+ *
+ * \return True if the entry was written
+ */
+bool ShaderCache::store (
+    const std::string& key, GLuint program, double compile_ms
+) {
+    if (!isSupported())
+        return false;
+
+    GLint length = 0;
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+        return false;
+
+    EntryHeader header;
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+
+    if (written <= 0)
+        return false;
+
+    if (!createDirectory()) {
+        LOG_ERROR("ERROR::SHADER_CACHE::FAILED_TO_CREATE_DIRECTORY");
+        LOG_ERROR(directory_);
+
+        return false;
+    }
+
+    std::memcpy(header.magic, kEntryMagic, sizeof(kEntryMagic));
+    header.version = kEntryVersion;
+    header.format = format;
+    header.size = written;
+    header.compile_ms = compile_ms;
+
+    // write to a temporary file first, so a crash never leaves half an entry
+    std::string path = getEntryPath(key);
+    std::string tmp_path = path + ".tmp";
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), written);
+    file.close();
+
+    if (!file || std::rename(tmp_path.c_str(), path.c_str())) {
+        std::remove(tmp_path.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * Get the number of programs restored from the cache
+ *
+ * \return The number of hits
+ */
+unsigned int ShaderCache::getHits ()
+{
+    return hits_;
+}
+
+/*!
+ * Get the number of programs that had to be compiled
+ *
+ * \return The number of misses
+ */
+unsigned int ShaderCache::getMisses ()
+{
+    return misses_;
+}
+
+/*!
+ * Get the number of binaries rejected by the driver
+ *
+ * \return The number of rejected binaries
+ */
+unsigned int ShaderCache::getRejected ()
+{
+    return rejected_;
+}
+
+/*!
+ * Get the compile time avoided by the cache hits
+ *
+ * \return The time saved, in milliseconds
+ */
+double ShaderCache::getSavedMilliseconds ()
+{
+    return hit_compile_ms_ - hit_load_ms_;
+}
+
+/*!
+ * Print the cache counters
+ *
+ * \param[in] out The output stream
+ *
+ * \return void
+ */
+void ShaderCache::report (std::ostream& out)
+{
+    out << "Shader cache: " << hits_ << " hits, " << misses_ << " misses, "
+        << rejected_ << " rejected, " << getSavedMilliseconds()
+        << " ms saved" << std::endl;
+}
+
+/*!
+ * Create the cache directory and its parents
+ *
+ * \return True if the directory exists after the call
+ */
+bool ShaderCache::createDirectory ()
+{
+    std::string path;
+    std::size_t pos = 0;
+
+    while (pos != std::string::npos) {
+        pos = directory_.find('/', pos + 1);
+        path = directory_.substr(0, pos);
+
+        if (mkdir(path.c_str(), 0755) && (errno != EEXIST))
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ * Get the path of the file that holds an entry
+ *
+ * \param[in] key The entry key
+ *
+ * \return The file path
+ */
+std::string ShaderCache::getEntryPath (const std::string& key)
+{
+    return directory_ + "/" + key + ".bin";
+}
@@ -0,0 +1,211 @@
+/*!
+ * \file  ShaderCache.hpp
+ * \brief Class definition to store linked program binaries on disk and
+ *        restore them instead of compiling the shaders again
+ */
+
+#ifndef __SHADER_CACHE_HPP
+#define __SHADER_CACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#include <GL/glew.h>
+
+//! ShaderCache
+/*!
+ * ShaderCache keeps the binaries returned by glGetProgramBinary in a
+ * directory. Each entry is keyed by a hash of the vertex and fragment source
+ * code plus the GL vendor, renderer and version strings, so a driver update
+ * never sees a binary produced by another driver. When an entry is missing or
+ * rejected by glProgramBinary the caller must compile the program normally.
+ */
+class ShaderCache
+{
+ private:
+    /*!
+     * The directory where the binaries are stored
+     */
+    std::string directory_;
+
+    /*!
+     * Whether the driver exposes at least one program binary format
+     */
+    bool supported_;
+
+    /*!
+     * Whether supported_ has already been queried
+     */
+    bool probed_;
+
+    /*!
+     * Whether the cache is used at all
+     */
+    bool enabled_;
+
+    /*!
+     * Number of programs restored from the cache
+     */
+    unsigned int hits_;
+
+    /*!
+     * Number of programs that had to be compiled
+     */
+    unsigned int misses_;
+
+    /*!
+     * Number of stored binaries rejected by the driver
+     */
+    unsigned int rejected_;
+
+    /*!
+     * Compile time recorded for the binaries restored, in milliseconds
+     */
+    double hit_compile_ms_;
+
+    /*!
+     * Time spent restoring binaries, in milliseconds
+     */
+    double hit_load_ms_;
+
+    /*!
+     * Create the cache directory and its parents
+     *
+     * \return True if the directory exists after the call
+     */
+    bool createDirectory ();
+
+    /*!
+     * Get the path of the file that holds an entry
+     *
+     * \param[in] key The entry key
+     *
+     * \return The file path
+     */
+    std::string getEntryPath (const std::string& key);
+
+ public:
+    /*!
+     * ShaderCache constructor
+     *
+     * \param[in] directory The directory where the binaries are stored
+     */
+    explicit ShaderCache (const std::string& directory);
+
+    /*!
+     * Get the cache shared by every Shader
+     *
+     * \return The default cache, stored under ./cache/shader
+     */
+    static ShaderCache& getInstance ();
+
+    /*!
+     * Check if the current context can save and restore program binaries
+     *
+     * \return True if program binaries are supported
+     */
+    bool isSupported ();
+
+    /*!
+     * Enable or disable the cache, a disabled cache never hits nor stores
+     *
+     * \param[in] enabled Whether the cache must be used
+     *
+     * \return void
+     */
+    void setEnabled (bool enabled);
+
+    /*!
+     * Build the key of a program
+     *
+     * \param[in] vertex_code     The vertex shader source code
+     * \param[in] vertex_size     The vertex shader source length
+     * \param[in] fragment_code   The fragment shader source code
+     * \param[in] fragment_size   The fragment shader source length
+     *
+     * \return The hexadecimal key
+     */
+    std::string makeKey (
+        const GLchar* vertex_code, std::size_t vertex_size,
+        const GLchar* fragment_code, std::size_t fragment_size
+    );
+
+    /*!
+     * Build the key of a program for a driver
+     *
+     * \param[in] vertex_code     The vertex shader source code
+     * \param[in] vertex_size     The vertex shader source length
+     * \param[in] fragment_code   The fragment shader source code
+     * \param[in] fragment_size   The fragment shader source length
+     * \param[in] driver          The vendor, renderer and version strings of
+     *                            the driver, each followed by a '\0'
+     *
+     * \return The hexadecimal key
+     */
+    static std::string makeKey (
+        const GLchar* vertex_code, std::size_t vertex_size,
+        const GLchar* fragment_code, std::size_t fragment_size,
+        const std::string& driver
+    );
+
+    /*!
+     * Restore a program from the cache
+     *
+     * \param[in] key     The entry key
+     * \param[in] program A program object without any attached shader
+     *
+     * \return True if the program was restored and linked successfully
+     */
+    bool load (const std::string& key, GLuint program);
+
+    /*!
+     * Store a linked program in the cache
+     *
+     * \param[in] key        The entry key
+     * \param[in] program    A linked program
+     * \param[in] compile_ms The time spent compiling and linking the program
+     *
+     * \return True if the entry was written
+     */
+    bool store (const std::string& key, GLuint program, double compile_ms);
+
+    /*!
+     * Get the number of programs restored from the cache
+     *
+     * \return The number of hits
+     */
+    unsigned int getHits ();
+
+    /*!
+     * Get the number of programs that had to be compiled
+     *
+     * \return The number of misses
+     */
+    unsigned int getMisses ();
+
+    /*!
+     * Get the number of binaries rejected by the driver
+     *
+     * \return The number of rejected binaries
+     */
+    unsigned int getRejected ();
+
+    /*!
+     * Get the compile time avoided by the cache hits
+     *
+     * \return The time saved, in milliseconds
+     */
+    double getSavedMilliseconds ();
+
+    /*!
+     * Print the cache counters
+     *
+     * \param[in] out The output stream
+     *
+     * \return void
+     */
+    void report (std::ostream& out);
+};
+
+#endif // __SHADER_CACHE_HPP
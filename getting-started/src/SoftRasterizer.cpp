@@ -0,0 +1,742 @@
+#include "SoftRasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <SOIL/SOIL.h>
+
+#include "AssetFile.hpp"
+#include "ImageKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SOFT_RASTERIZER_X86
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const int kTileSize = 64;
+const int kSubpixels = 16;
+
+// the largest window coordinate, in pixels: the edge functions of a tile
+// crossed by an edge then fit in 32 bits
+const float kGuardBand = 8192.0f;
+
+/*
+ * Vertex fetch
+ */
+
+const VertexAttribute* findAttribute (const SoftDraw& draw, std::size_t location)
+{
+    return (location < draw.attributes.size()) ? &draw.attributes[location] : nullptr;
+}
+
+GLuint readIndex (const SoftDraw& draw, GLsizei i)
+{
+    switch (draw.index_type) {
+        case GL_UNSIGNED_BYTE:
+            return static_cast<const GLubyte*>(draw.indices)[i];
+        case GL_UNSIGNED_SHORT:
+            return static_cast<const GLushort*>(draw.indices)[i];
+        default:
+            return static_cast<const GLuint*>(draw.indices)[i];
+    }
+}
+
+// sign extend a field of a GL_INT_2_10_10_10_REV, normalized like GL 4.2
+float unpackSigned (GLuint bits, int shift, int width)
+{
+    int value = static_cast<int>(bits << (32 - shift - width)) >> (32 - width);
+    float scale = static_cast<float>((1 << (width - 1)) - 1);
+
+    return std::max(value / scale, -1.0f);
+}
+
+// missing components read as (0, 0, 0, 1), like glVertexAttribPointer
+Vec4 readAttribute (const unsigned char* vertex, const VertexAttribute* attribute)
+{
+    Vec4 value = {0.0f, 0.0f, 0.0f, 1.0f};
+    float* components = &value.x;
+
+    if (attribute == nullptr)
+        return value;
+
+    const unsigned char* data = vertex + attribute->offset;
+
+    if (attribute->type == GL_INT_2_10_10_10_REV) {
+        GLuint bits;
+
+        std::memcpy(&bits, data, sizeof(bits));
+
+        return {
+            unpackSigned(bits, 0, 10), unpackSigned(bits, 10, 10),
+            unpackSigned(bits, 20, 10), unpackSigned(bits, 30, 2)
+        };
+    }
+
+    for (GLint i = 0; i < std::min(attribute->size, 4); ++i) {
+        switch (attribute->type) {
+            case GL_FLOAT:
+                std::memcpy(&components[i], data + i * sizeof(GLfloat), sizeof(GLfloat));
+                break;
+            case GL_HALF_FLOAT: {
+                GLhalf half;
+
+                std::memcpy(&half, data + i * sizeof(GLhalf), sizeof(GLhalf));
+                components[i] = unpackHalf(half);
+                break;
+            }
+            case GL_UNSIGNED_BYTE:
+                components[i] = attribute->normalized ? data[i] / 255.0f : data[i];
+                break;
+            default:
+                components[i] = 0.0f;
+        }
+    }
+
+    return value;
+}
+
+/*
+ * Fragment stage
+ */
+
+int wrapTexel (int i, int size, GLenum wrap)
+{
+    if (wrap == GL_REPEAT) {
+        i %= size;
+
+        return (i < 0) ? i + size : i;
+    }
+
+    return std::min(std::max(i, 0), size - 1);
+}
+
+// the texel after a wrapped one
+int wrapNext (int i, int size, GLenum wrap)
+{
+    if (i + 1 < size)
+        return i + 1;
+
+    return (wrap == GL_REPEAT) ? 0 : i;
+}
+
+// the texel in 0 to 255, sample() normalizes once after filtering
+Vec4 fetchTexel (const SoftTexture& texture, int i, int j)
+{
+    const unsigned char* texel = &texture.pixels[(j * texture.width + i) * 4];
+
+    return {
+        static_cast<float>(texel[0]), static_cast<float>(texel[1]),
+        static_cast<float>(texel[2]), static_cast<float>(texel[3])
+    };
+}
+
+// the texel the coordinate falls in, scaled by the size; large values are
+// clamped so the floor fits an int
+int getTexel (float coordinate)
+{
+    return static_cast<int>(std::floor(std::min(std::max(coordinate, -1e7f), 1e7f)));
+}
+
+Vec4 sample (const SoftTexture* texture, float s, float t)
+{
+    const float normalize = 1.0f / 255.0f;
+
+    if ((texture == nullptr) || texture->pixels.empty())
+        return {0.0f, 0.0f, 0.0f, 1.0f};
+
+    float u = s * texture->width;
+    float v = t * texture->height;
+
+    if (texture->filter != GL_LINEAR) {
+        return fetchTexel(
+            *texture,
+            wrapTexel(getTexel(u), texture->width, texture->wrap_s),
+            wrapTexel(getTexel(v), texture->height, texture->wrap_t)
+        ) * normalize;
+    }
+
+    // the 4 texels around the sample, centers at half texels
+    int i = getTexel(u - 0.5f);
+    int j = getTexel(v - 0.5f);
+    float fu = (u - 0.5f) - i;
+    float fv = (v - 0.5f) - j;
+    int i0 = wrapTexel(i, texture->width, texture->wrap_s);
+    int i1 = wrapNext(i0, texture->width, texture->wrap_s);
+    int j0 = wrapTexel(j, texture->height, texture->wrap_t);
+    int j1 = wrapNext(j0, texture->height, texture->wrap_t);
+
+    Vec4 bottom = fetchTexel(*texture, i0, j0) * (1.0f - fu) + fetchTexel(*texture, i1, j0) * fu;
+    Vec4 top = fetchTexel(*texture, i0, j1) * (1.0f - fu) + fetchTexel(*texture, i1, j1) * fu;
+
+    return (bottom * (1.0f - fv) + top * fv) * normalize;
+}
+
+// round to the nearest 8 bit unorm, NaN is 0
+std::uint32_t toUnorm (float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+
+    return static_cast<std::uint32_t>(std::min(value, 1.0f) * 255.0f + 0.5f);
+}
+
+std::uint32_t packPixel (const Vec4& color)
+{
+    return toUnorm(color.x) | (toUnorm(color.y) << 8) | (toUnorm(color.z) << 16) |
+        (toUnorm(color.w) << 24);
+}
+
+// run the fragment shader at a pixel of the triangle
+std::uint32_t shade (const SoftDraw& draw, const SoftTriangle& triangle, int x, int y)
+{
+    if (draw.effect == SoftEffect::UniformColor) {
+        const GLfloat* color = draw.uniforms.dynamic_color.data;
+
+        return packPixel({color[0], color[1], color[2], color[3]});
+    }
+
+    float fx = static_cast<float>(x - triangle.min_x);
+    float fy = static_cast<float>(y - triangle.min_y);
+    const float* w1 = triangle.weights[0];
+    const float* w2 = triangle.weights[1];
+    float l1 = w1[0] * fx + w1[1] * fy + w1[2];
+    float l2 = w2[0] * fx + w2[1] * fy + w2[2];
+
+    // perspective correct, the attributes are divided by w at the vertices
+    const float* iw = triangle.inverse_w;
+    float w = 1.0f / (iw[0] + l1 * iw[1] + l2 * iw[2]);
+
+    if (draw.effect == SoftEffect::VertexColor) {
+        const float (*c)[4] = triangle.colors;
+
+        return packPixel({
+            (c[0][0] + l1 * c[1][0] + l2 * c[2][0]) * w,
+            (c[0][1] + l1 * c[1][1] + l2 * c[2][1]) * w,
+            (c[0][2] + l1 * c[1][2] + l2 * c[2][2]) * w,
+            (c[0][3] + l1 * c[1][3] + l2 * c[2][3]) * w
+        });
+    }
+
+    const float (*t)[2] = triangle.coords;
+    float s = (t[0][0] + l1 * t[1][0] + l2 * t[2][0]) * w;
+    float u = (t[0][1] + l1 * t[1][1] + l2 * t[2][1]) * w;
+    float ratio = draw.uniforms.mix_ratio;
+
+    // mix(a, b, r) = a * (1 - r) + b * r
+    return packPixel(
+        sample(draw.textures[0], s, u) * (1.0f - ratio) + sample(draw.textures[1], s, u) * ratio
+    );
+}
+
+//! EdgeRow
+/*!
+ * An edge function over a rectangle, in 32 bits: the value at the first
+ * pixel and the steps to the next column and row. An edge the whole
+ * rectangle is inside of has all three at 0.
+ */
+struct EdgeRow
+{
+    std::int32_t origin;
+    std::int32_t step_x;
+    std::int32_t step_y;
+};
+
+} // namespace
+
+/*!
+ * SoftRasterizer constructor
+ *
+ * \param[in] width   The framebuffer width, at most 8192
+ * \param[in] height  The framebuffer height, at most 8192
+ * \param[in] threads The number of threads, 0 to leave one core to the
+ *                    calling thread
+ */
+SoftRasterizer::SoftRasterizer (int width, int height, unsigned int threads)
+    : width_(std::min(width, static_cast<int>(kGuardBand))),
+      height_(std::min(height, static_cast<int>(kGuardBand))),
+      tiles_x_((width_ + kTileSize - 1) / kTileSize),
+      tiles_y_((height_ + kTileSize - 1) / kTileSize),
+      pixels_(width_ * height_, 0),
+      bins_(tiles_x_ * tiles_y_),
+      tile_fragments_(tiles_x_ * tiles_y_, 0),
+      pool_(new ThreadPool(threads)),
+      stats_()
+{
+}
+
+/*!
+ * Load a texture, throws AssetError if the file can't be read or decoded
+ *
+ * \param[in] path     The path to the image
+ * \param[in] channels SOIL_LOAD_RGB or SOIL_LOAD_RGBA, an RGB image samples
+ *                     an alpha of 1
+ * \param[in] wrap     The wrap mode of both axes
+ * \param[in] filter   The filter
+ *
+ * \return The texture
+ */
+SoftTexture SoftRasterizer::loadTexture (
+    const std::string& path, int channels, GLenum wrap, GLenum filter
+) {
+    AssetFile file(path);
+    SoftTexture texture = {0, 0, {}, wrap, wrap, filter};
+    int rgba = (channels == SOIL_LOAD_RGBA);
+
+    unsigned char* pixels = SOIL_load_image_from_memory(
+        file.getBytes(), file.getSize(), &texture.width, &texture.height, 0,
+        rgba ? SOIL_LOAD_RGBA : SOIL_LOAD_RGB
+    );
+
+    if (pixels == nullptr)
+        throw AssetError(path, SOIL_last_result());
+
+    std::size_t count = static_cast<std::size_t>(texture.width) * texture.height;
+
+    texture.pixels.resize(count * 4);
+
+    if (rgba)
+        std::memcpy(texture.pixels.data(), pixels, count * 4);
+    else
+        ImageKernels::expandRgbToRgba(pixels, texture.pixels.data(), count);
+
+    SOIL_free_image_data(pixels);
+
+    // decoders give the top row first, GL the bottom one
+    ImageKernels::flipVertical(texture.pixels.data(), texture.width * 4, texture.height);
+
+    return texture;
+}
+
+/*!
+ * Fill the framebuffer, glClear; draws queued before are finished first
+ *
+ * \param[in] r The red component
+ * \param[in] g The green component
+ * \param[in] b The blue component
+ * \param[in] a The alpha component
+ *
+ * \return void
+ */
+void SoftRasterizer::clear (GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    finish();
+
+    std::fill(pixels_.begin(), pixels_.end(), packPixel({r, g, b, a}));
+}
+
+/*!
+ * Queue the triangles of a draw
+ *
+ * \param[in] draw The draw
+ *
+ * \return void
+ */
+void SoftRasterizer::draw (const SoftDraw& draw)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(draws_.size());
+    const VertexAttribute* position = findAttribute(draw, 0);
+    const VertexAttribute* color = findAttribute(draw, 1);
+    const VertexAttribute* coords = findAttribute(draw, 2);
+    const unsigned char* vertices = static_cast<const unsigned char*>(draw.vertices);
+
+    draws_.push_back(draw);
+
+    // the vertex stage runs per corner, there is no post-transform cache
+    for (GLsizei i = 0; i + 3 <= draw.count; i += 3) {
+        Vec4 positions[3];
+        Vec4 colors[3];
+        Vec4 coordinates[3];
+
+        for (int k = 0; k < 3; ++k) {
+            const unsigned char* vertex = vertices + readIndex(draw, i + k) * draw.stride;
+
+            positions[k] = draw.transform * readAttribute(vertex, position);
+            colors[k] = readAttribute(vertex, color);
+            coordinates[k] = readAttribute(vertex, coords);
+        }
+
+        setupTriangle(positions, colors, coordinates, index);
+    }
+}
+
+/*!
+ * Rasterize the queued draws
+ *
+ * \return void
+ */
+void SoftRasterizer::finish ()
+{
+    if (!triangles_.empty()) {
+        for (std::size_t tile = 0; tile < bins_.size(); ++tile) {
+            if (bins_[tile].empty())
+                continue;
+
+            pool_->submit([this, tile] {
+                rasterizeTile(static_cast<int>(tile));
+            });
+        }
+
+        pool_->wait();
+
+        for (std::size_t tile = 0; tile < bins_.size(); ++tile) {
+            stats_.fragments += tile_fragments_[tile];
+            tile_fragments_[tile] = 0;
+
+            // the bins keep their capacity for the next frame
+            bins_[tile].clear();
+        }
+    }
+
+    triangles_.clear();
+    draws_.clear();
+}
+
+/*!
+ * Read the framebuffer, finishing the queued draws
+ *
+ * \return The pixels, RGB rows top first like FrameCapture writes them
+ */
+std::vector<unsigned char> SoftRasterizer::readPixels ()
+{
+    std::vector<unsigned char> pixels(width_ * height_ * 3);
+
+    finish();
+
+    for (int y = 0; y < height_; ++y) {
+        const std::uint32_t* source = &pixels_[(height_ - 1 - y) * width_];
+        unsigned char* target = &pixels[y * width_ * 3];
+
+        for (int x = 0; x < width_; ++x) {
+            target[x * 3 + 0] = source[x] & 0xff;
+            target[x * 3 + 1] = (source[x] >> 8) & 0xff;
+            target[x * 3 + 2] = (source[x] >> 16) & 0xff;
+        }
+    }
+
+    return pixels;
+}
+
+/*!
+ * Get the framebuffer width
+ *
+ * \return The width, in pixels
+ */
+int SoftRasterizer::getWidth () const
+{
+    return width_;
+}
+
+/*!
+ * Get the framebuffer height
+ *
+ * \return The height, in pixels
+ */
+int SoftRasterizer::getHeight () const
+{
+    return height_;
+}
+
+/*!
+ * Get the work counters
+ *
+ * \return The counters since the last resetStats()
+ */
+const SoftStats& SoftRasterizer::getStats () const
+{
+    return stats_;
+}
+
+/*!
+ * Reset the work counters
+ *
+ * \return void
+ */
+void SoftRasterizer::resetStats ()
+{
+    stats_ = SoftStats();
+}
+
+/*!
+ * Set up a triangle and bin it
+ *
+ * \param[in] positions The clip space positions
+ * \param[in] colors    The colors
+ * \param[in] coords    The texture coordinates
+ * \param[in] draw      The index of the draw
+ *
+ * \return void
+ */
+void SoftRasterizer::setupTriangle (
+    const Vec4 positions[3], const Vec4 colors[3], const Vec4 coords[3],
+    std::uint32_t draw
+) {
+    std::int64_t x[3];
+    std::int64_t y[3];
+    float inverse_w[3];
+    int order[3] = {0, 1, 2};
+
+    ++stats_.triangles;
+
+    // the viewport transform, snapped to 1/16 pixel
+    for (int k = 0; k < 3; ++k) {
+        const Vec4& p = positions[k];
+
+        if (!(p.w > 0.0f)) {
+            ++stats_.culled;
+            return;
+        }
+
+        inverse_w[k] = 1.0f / p.w;
+
+        float wx = (p.x * inverse_w[k] + 1.0f) * 0.5f * width_;
+        float wy = (p.y * inverse_w[k] + 1.0f) * 0.5f * height_;
+
+        if (!(std::fabs(wx) < kGuardBand) || !(std::fabs(wy) < kGuardBand)) {
+            ++stats_.culled;
+            return;
+        }
+
+        x[k] = std::lround(wx * kSubpixels);
+        y[k] = std::lround(wy * kSubpixels);
+    }
+
+    std::int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+
+    if (area == 0) {
+        ++stats_.culled;
+        return;
+    }
+
+    // both windings are drawn, there is no face culling; clockwise
+    // triangles are turned counterclockwise
+    if (area < 0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    SoftTriangle triangle;
+
+    triangle.draw = draw;
+
+    triangle.min_x = static_cast<int>(std::max<std::int64_t>(
+        0, std::min({x[0], x[1], x[2]}) / kSubpixels - 1
+    ));
+    triangle.min_y = static_cast<int>(std::max<std::int64_t>(
+        0, std::min({y[0], y[1], y[2]}) / kSubpixels - 1
+    ));
+    triangle.max_x = static_cast<int>(std::min<std::int64_t>(
+        width_, std::max({x[0], x[1], x[2]}) / kSubpixels + 1
+    ));
+    triangle.max_y = static_cast<int>(std::min<std::int64_t>(
+        height_, std::max({y[0], y[1], y[2]}) / kSubpixels + 1
+    ));
+
+    if ((triangle.min_x >= triangle.max_x) || (triangle.min_y >= triangle.max_y))
+        return;
+
+    // edge k goes from vertex k to the next one; it is 0 on the edge and
+    // area at the vertex opposite to it
+    for (int k = 0; k < 3; ++k) {
+        int next = (k + 1) % 3;
+        std::int64_t dx = x[next] - x[k];
+        std::int64_t dy = y[next] - y[k];
+
+        // the samples are at the pixel centers
+        triangle.a[k] = -dy * kSubpixels;
+        triangle.b[k] = dx * kSubpixels;
+        triangle.c[k] = dy * x[k] - dx * y[k] + (triangle.a[k] + triangle.b[k]) / 2;
+    }
+
+    // the weight of vertex 1 is edge 2 over the area, of vertex 2 edge 0
+    for (int k = 0; k < 2; ++k) {
+        int edge = (k == 0) ? 2 : 0;
+        double scale = 1.0 / static_cast<double>(area);
+        double origin = static_cast<double>(
+            triangle.a[edge] * triangle.min_x + triangle.b[edge] * triangle.min_y +
+            triangle.c[edge]
+        );
+
+        triangle.weights[k][0] = static_cast<float>(triangle.a[edge] * scale);
+        triangle.weights[k][1] = static_cast<float>(triangle.b[edge] * scale);
+        triangle.weights[k][2] = static_cast<float>(origin * scale);
+    }
+
+    // a pixel center on an edge belongs to the triangle on its left or top:
+    // counterclockwise with y up, left edges go down and top edges go left
+    for (int k = 0; k < 3; ++k) {
+        bool left = triangle.a[k] > 0;
+        bool top = (triangle.a[k] == 0) && (triangle.b[k] < 0);
+
+        if (!left && !top)
+            triangle.c[k] -= 1;
+    }
+
+    // the first vertex, then the differences
+    for (int k = 0; k < 3; ++k) {
+        int vertex = order[k];
+        const float* color = &colors[vertex].x;
+        const float* coord = &coords[vertex].x;
+        float iw = inverse_w[vertex];
+
+        triangle.inverse_w[k] = iw;
+
+        for (int i = 0; i < 4; ++i)
+            triangle.colors[k][i] = color[i] * iw;
+
+        for (int i = 0; i < 2; ++i)
+            triangle.coords[k][i] = coord[i] * iw;
+    }
+
+    for (int k = 2; k > 0; --k) {
+        triangle.inverse_w[k] -= triangle.inverse_w[0];
+
+        for (int i = 0; i < 4; ++i)
+            triangle.colors[k][i] -= triangle.colors[0][i];
+
+        for (int i = 0; i < 2; ++i)
+            triangle.coords[k][i] -= triangle.coords[0][i];
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(triangles_.size());
+
+    triangles_.push_back(triangle);
+
+    for (int ty = triangle.min_y / kTileSize; ty <= (triangle.max_y - 1) / kTileSize; ++ty) {
+        for (int tx = triangle.min_x / kTileSize; tx <= (triangle.max_x - 1) / kTileSize; ++tx)
+            bins_[ty * tiles_x_ + tx].push_back(index);
+    }
+}
+
+/*!
+ * Draw the triangles binned in a tile, runs on the pool
+ *
+ * \param[in] tile The tile index
+ *
+ * \return void
+ */
+void SoftRasterizer::rasterizeTile (int tile)
+{
+    int x0 = (tile % tiles_x_) * kTileSize;
+    int y0 = (tile / tiles_x_) * kTileSize;
+    int x1 = std::min(x0 + kTileSize, width_);
+    int y1 = std::min(y0 + kTileSize, height_);
+    std::uint64_t fragments = 0;
+
+    for (std::uint32_t index : bins_[tile]) {
+        const SoftTriangle& triangle = triangles_[index];
+
+        fragments += rasterizeTriangle(
+            triangle,
+            std::max(x0, triangle.min_x), std::max(y0, triangle.min_y),
+            std::min(x1, triangle.max_x), std::min(y1, triangle.max_y)
+        );
+    }
+
+    tile_fragments_[tile] = fragments;
+}
+
+/*!
+ * Draw the pixels of a triangle in a rectangle of a tile
+ *
+ * \param[in] triangle The triangle
+ * \param[in] x0       The first column
+ * \param[in] y0       The first row
+ * \param[in] x1       The column after the last
+ * \param[in] y1       The row after the last
+ *
+ * \return The number of pixels written
+ */
+std::uint64_t SoftRasterizer::rasterizeTriangle (
+    const SoftTriangle& triangle, int x0, int y0, int x1, int y1
+) {
+    const SoftDraw& draw = draws_[triangle.draw];
+    EdgeRow edges[3];
+    std::uint64_t fragments = 0;
+
+    // an edge function is linear, its extremes over the rectangle are at
+    // the corners: outside at every corner rejects the triangle, inside at
+    // every corner drops the edge. The others cross the rectangle, their
+    // values stay within a tile's worth of steps and fit in 32 bits.
+    for (int k = 0; k < 3; ++k) {
+        std::int64_t origin = triangle.a[k] * x0 + triangle.b[k] * y0 + triangle.c[k];
+        std::int64_t across = triangle.a[k] * (x1 - 1 - x0);
+        std::int64_t down = triangle.b[k] * (y1 - 1 - y0);
+        std::int64_t low =
+            origin + std::min<std::int64_t>(across, 0) + std::min<std::int64_t>(down, 0);
+        std::int64_t high =
+            origin + std::max<std::int64_t>(across, 0) + std::max<std::int64_t>(down, 0);
+
+        if (high < 0)
+            return 0;
+
+        if (low >= 0) {
+            edges[k] = {0, 0, 0};
+        } else {
+            edges[k] = {
+                static_cast<std::int32_t>(origin),
+                static_cast<std::int32_t>(triangle.a[k]),
+                static_cast<std::int32_t>(triangle.b[k])
+            };
+        }
+    }
+
+    for (int y = y0; y < y1; ++y) {
+        std::uint32_t* row = &pixels_[y * width_];
+        std::int32_t e[3];
+
+        for (int k = 0; k < 3; ++k)
+            e[k] = edges[k].origin + (y - y0) * edges[k].step_y;
+
+#ifdef SOFT_RASTERIZER_X86
+        // 4 pixels per step, a lane is outside when an edge is negative
+        __m128i values[3];
+        __m128i steps[3];
+
+        for (int k = 0; k < 3; ++k) {
+            std::int32_t step = edges[k].step_x;
+
+            values[k] = _mm_add_epi32(
+                _mm_set1_epi32(e[k]), _mm_setr_epi32(0, step, step * 2, step * 3)
+            );
+            steps[k] = _mm_set1_epi32(step * 4);
+        }
+
+        for (int x = x0; x < x1; x += 4) {
+            __m128i outside = _mm_or_si128(values[0], _mm_or_si128(values[1], values[2]));
+            int mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf;
+
+            // the lanes past the rectangle
+            if (x + 4 > x1)
+                mask &= (1 << (x1 - x)) - 1;
+
+            while (mask) {
+                int lane = __builtin_ctz(mask);
+
+                row[x + lane] = shade(draw, triangle, x + lane, y);
+                ++fragments;
+                mask &= mask - 1;
+            }
+
+            for (int k = 0; k < 3; ++k)
+                values[k] = _mm_add_epi32(values[k], steps[k]);
+        }
+#else
+        for (int x = x0; x < x1; ++x) {
+            if ((e[0] | e[1] | e[2]) >= 0) {
+                row[x] = shade(draw, triangle, x, y);
+                ++fragments;
+            }
+
+            for (int k = 0; k < 3; ++k)
+                e[k] += edges[k].step_x;
+        }
+#endif
+    }
+
+    return fragments;
+}
@@ -0,0 +1,361 @@
+/*!
+ * \file  SoftRasterizer.hpp
+ * \brief Class definition of a CPU rasterizer drawing the exercises' meshes
+ *        without a GL context, for golden images and driver independent
+ *        benchmarks
+ */
+
+#ifndef __SOFT_RASTERIZER_HPP
+#define __SOFT_RASTERIZER_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "FrameData.hpp"
+#include "MathTypes.hpp"
+#include "ThreadPool.hpp"
+#include "VertexFormat.hpp"
+
+//! SoftEffect
+/*!
+ * SoftEffect is the fragment shader of a draw, one per effect of the
+ * fragment shaders in shader/
+ */
+enum class SoftEffect
+{
+    // the interpolated color at location 1, fshader.frag and
+    // instance_color.frag
+    VertexColor,
+
+    // FrameData::dynamic_color, fshader1.frag
+    UniformColor,
+
+    // mix(texture0, texture1, FrameData::mix_ratio), texture.frag
+    TextureMix
+};
+
+//! SoftTexture
+/*!
+ * SoftTexture is an RGBA image with its sampler state, rows bottom first
+ * like glTexImage2D
+ */
+struct SoftTexture
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+
+    /*!
+     * GL_REPEAT or GL_CLAMP_TO_EDGE
+     */
+    GLenum wrap_s;
+    GLenum wrap_t;
+
+    /*!
+     * GL_NEAREST or GL_LINEAR, there are no mipmaps
+     */
+    GLenum filter;
+};
+
+//! SoftDraw
+/*!
+ * SoftDraw is a glDrawElements call: the vertex and index data a Mesh
+ * uploads, the vertex stage as a matrix and the fragment stage as an
+ * effect. Location 0 is the position, 1 the color and 2 the texture
+ * coordinates; a location can alias another one, position_as_color.vs is
+ * the position given as location 1 too. The data must stay valid until
+ * SoftRasterizer::finish() returns.
+ */
+struct SoftDraw
+{
+    const void* vertices;
+    GLsizei stride;
+    std::vector<VertexAttribute> attributes;
+
+    const void* indices;
+    GLsizei count;
+    GLenum index_type;
+
+    /*!
+     * Applied to the position, w is 1 in the vertex data
+     */
+    Mat4 transform;
+
+    SoftEffect effect;
+
+    /*!
+     * The uniform block of the fragment shaders
+     */
+    FrameData uniforms;
+
+    /*!
+     * Sampled by TextureMix, nullptr samples black like an incomplete
+     * texture
+     */
+    const SoftTexture* textures[2];
+};
+
+//! SoftTriangle
+/*!
+ * SoftTriangle is a triangle after setup, in window coordinates with 4
+ * bits of subpixel precision. Coverage uses exact integer edge functions,
+ * so shared edges are drawn once; the attributes use float plane
+ * equations evaluated at each pixel, so the result doesn't depend on the
+ * tiling nor on the threads.
+ */
+struct SoftTriangle
+{
+    /*!
+     * The edge functions at the center of pixel (x, y), in 1/256 square
+     * pixels: E = a * x + b * y + c, the top-left bias folded into c. A
+     * pixel is inside when the three are positive or zero.
+     */
+    std::int64_t a[3];
+    std::int64_t b[3];
+    std::int64_t c[3];
+
+    /*!
+     * The pixel bounds, clipped to the framebuffer, max excluded
+     */
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+
+    /*!
+     * The barycentric weights of the second and third vertex, as planes
+     * relative to the first pixel of the bounds: weight = weights[0] * x +
+     * weights[1] * y + weights[2] at pixel (min_x + x, min_y + y)
+     */
+    float weights[2][3];
+
+    /*!
+     * 1 / w and color / w of the first vertex, then the differences of the
+     * second and third one to the first
+     */
+    float inverse_w[3];
+    float colors[3][4];
+    float coords[3][2];
+
+    /*!
+     * The index of the draw in SoftRasterizer::draws_
+     */
+    std::uint32_t draw;
+};
+
+//! SoftStats
+/*!
+ * SoftStats counts the work since the last resetStats()
+ */
+struct SoftStats
+{
+    std::uint64_t triangles;
+
+    /*!
+     * Triangles behind the eye, degenerate or outside the guard band
+     */
+    std::uint64_t culled;
+
+    /*!
+     * Pixels written by triangles
+     */
+    std::uint64_t fragments;
+};
+
+//! SoftRasterizer
+/*!
+ * SoftRasterizer draws triangles into an RGBA8 framebuffer on the CPU.
+ * draw() runs the vertex stage and bins the triangles into 64x64 tiles,
+ * finish() rasterizes the tiles in parallel on a ThreadPool, each tile
+ * drawing its triangles in submission order. The edge functions are
+ * evaluated 4 pixels at a time with SSE2.
+ *
+ * There is no clipping: triangles with a vertex behind the eye or out of
+ * the guard band, 8192 pixels around the origin, are dropped. There is no
+ * depth test nor blending, which the exercises don't enable either.
+ */
+class SoftRasterizer
+{
+ private:
+    /*!
+     * The framebuffer size, in pixels
+     */
+    int width_;
+    int height_;
+
+    /*!
+     * The number of tiles in a row and in a column
+     */
+    int tiles_x_;
+    int tiles_y_;
+
+    /*!
+     * The pixels, RGBA packed in 32 bits, rows bottom first
+     */
+    std::vector<std::uint32_t> pixels_;
+
+    /*!
+     * The draws since the last finish()
+     */
+    std::vector<SoftDraw> draws_;
+
+    /*!
+     * The triangles since the last finish()
+     */
+    std::vector<SoftTriangle> triangles_;
+
+    /*!
+     * The triangles touching each tile, in submission order
+     */
+    std::vector<std::vector<std::uint32_t>> bins_;
+
+    /*!
+     * The fragments written in each tile by the last finish()
+     */
+    std::vector<std::uint64_t> tile_fragments_;
+
+    /*!
+     * Runs the tiles
+     */
+    std::unique_ptr<ThreadPool> pool_;
+
+    SoftStats stats_;
+
+    /*!
+     * Set up a triangle and bin it
+     *
+     * \param[in] positions The clip space positions
+     * \param[in] colors    The colors
+     * \param[in] coords    The texture coordinates
+     * \param[in] draw      The index of the draw
+     *
+     * \return void
+     */
+    void setupTriangle (
+        const Vec4 positions[3], const Vec4 colors[3], const Vec4 coords[3],
+        std::uint32_t draw
+    );
+
+    /*!
+     * Draw the triangles binned in a tile, runs on the pool
+     *
+     * \param[in] tile The tile index
+     *
+     * \return void
+     */
+    void rasterizeTile (int tile);
+
+    /*!
+     * Draw the pixels of a triangle in a rectangle of a tile
+     *
+     * \param[in] triangle The triangle
+     * \param[in] x0       The first column
+     * \param[in] y0       The first row
+     * \param[in] x1       The column after the last
+     * \param[in] y1       The row after the last
+     *
+     * \return The number of pixels written
+     */
+    std::uint64_t rasterizeTriangle (
+        const SoftTriangle& triangle, int x0, int y0, int x1, int y1
+    );
+
+ public:
+    /*!
+     * SoftRasterizer constructor
+     *
+     * \param[in] width   The framebuffer width, at most 8192
+     * \param[in] height  The framebuffer height, at most 8192
+     * \param[in] threads The number of threads, 0 to leave one core to the
+     *                    calling thread
+     */
+    SoftRasterizer (int width, int height, unsigned int threads = 0);
+
+    SoftRasterizer (const SoftRasterizer&) = delete;
+    SoftRasterizer& operator= (const SoftRasterizer&) = delete;
+
+    /*!
+     * Load a texture, throws AssetError if the file can't be read or decoded
+     *
+     * \param[in] path     The path to the image
+     * \param[in] channels SOIL_LOAD_RGB or SOIL_LOAD_RGBA, an RGB image
+     *                     samples an alpha of 1
+     * \param[in] wrap     The wrap mode of both axes
+     * \param[in] filter   The filter
+     *
+     * \return The texture
+     */
+    static SoftTexture loadTexture (
+        const std::string& path, int channels, GLenum wrap, GLenum filter
+    );
+
+    /*!
+     * Fill the framebuffer, glClear; draws queued before are finished first
+     *
+     * \param[in] r The red component
+     * \param[in] g The green component
+     * \param[in] b The blue component
+     * \param[in] a The alpha component
+     *
+     * \return void
+     */
+    void clear (GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    /*!
+     * Queue the triangles of a draw
+     *
+     * \param[in] draw The draw
+     *
+     * \return void
+     */
+    void draw (const SoftDraw& draw);
+
+    /*!
+     * Rasterize the queued draws
+     *
+     * \return void
+     */
+    void finish ();
+
+    /*!
+     * Read the framebuffer, finishing the queued draws
+     *
+     * \return The pixels, RGB rows top first like FrameCapture writes them
+     */
+    std::vector<unsigned char> readPixels ();
+
+    /*!
+     * Get the framebuffer width
+     *
+     * \return The width, in pixels
+     */
+    int getWidth () const;
+
+    /*!
+     * Get the framebuffer height
+     *
+     * \return The height, in pixels
+     */
+    int getHeight () const;
+
+    /*!
+     * Get the work counters
+     *
+     * \return The counters since the last resetStats()
+     */
+    const SoftStats& getStats () const;
+
+    /*!
+     * Reset the work counters
+     *
+     * \return void
+     */
+    void resetStats ();
+};
+
+#endif // __SOFT_RASTERIZER_HPP
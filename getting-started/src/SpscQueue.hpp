@@ -0,0 +1,124 @@
+/*!
+ * \file  SpscQueue.hpp
+ * \brief Class definition of a lock-free ring handing values from one thread
+ *        to another
+ */
+
+#ifndef __SPSC_QUEUE_HPP
+#define __SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+//! SpscQueue
+/*!
+ * SpscQueue is a fixed size ring with a single producer and a single
+ * consumer. push() and pop() never block nor allocate: the producer only
+ * writes tail_ and the consumer only writes head_, each publishing its slot
+ * with a release store the other side reads with acquire. The consumer may
+ * move to another thread between two pops as long as something orders them,
+ * a job wait does.
+ *
+ * The two indices are padded apart so the threads don't bounce one cache
+ * line between them. Capacity must be a power of two, one slot is kept
+ * free to tell a full ring from an empty one.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(
+        (Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0),
+        "SpscQueue capacity must be a power of two"
+    );
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "SpscQueue copies the values without constructing them"
+    );
+
+ private:
+    static const std::size_t kMask = Capacity - 1;
+
+    /*!
+     * The next slot to read, written by the consumer
+     */
+    std::atomic<std::size_t> head_;
+
+    char head_padding_[64];
+
+    /*!
+     * The next slot to write, written by the producer
+     */
+    std::atomic<std::size_t> tail_;
+
+    char tail_padding_[64];
+
+    T slots_[Capacity];
+
+ public:
+    /*!
+     * SpscQueue constructor
+     */
+    SpscQueue ()
+        : head_(0),
+          tail_(0)
+    {
+    }
+
+    SpscQueue (const SpscQueue&) = delete;
+    SpscQueue& operator= (const SpscQueue&) = delete;
+
+    /*!
+     * Append a value, from the producer thread
+     *
+     * \param[in] value The value
+     *
+     * \return False if the ring is full, the value is dropped
+     */
+    bool push (const T& value)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t next = (tail + 1) & kMask;
+
+        if (next == head_.load(std::memory_order_acquire))
+            return false;
+
+        slots_[tail] = value;
+        tail_.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+    /*!
+     * Remove the oldest value, from the consumer thread
+     *
+     * \param[out] value The value
+     *
+     * \return False if the ring is empty
+     */
+    bool pop (T& value)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+
+        value = slots_[head];
+        head_.store((head + 1) & kMask, std::memory_order_release);
+
+        return true;
+    }
+
+    /*!
+     * Check if the ring is empty, exact from the consumer thread only
+     *
+     * \return True if there is nothing to pop
+     */
+    bool isEmpty () const
+    {
+        return head_.load(std::memory_order_acquire) ==
+            tail_.load(std::memory_order_acquire);
+    }
+};
+
+#endif // __SPSC_QUEUE_HPP
@@ -0,0 +1,76 @@
+/*!
+ * \file  Std140.hpp
+ * \brief Types and checks to declare C++ structs matching GLSL uniform blocks
+ *        with the std140 layout
+ */
+
+#ifndef __STD140_HPP
+#define __STD140_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#include <GL/glew.h>
+
+/*
+ * Scalars (float, int, uint, bool as GLint) are plain GL types, their std140
+ * alignment is their size. The types below carry the alignment of the vector
+ * and matrix types. There is no vec3: std140 packs a scalar in the padding of
+ * a vec3, which a C++ struct can't express, so blocks use vec4 instead.
+ */
+
+//! Std140Vec2
+struct alignas(8) Std140Vec2
+{
+    GLfloat data[2];
+};
+
+//! Std140Vec4
+struct alignas(16) Std140Vec4
+{
+    GLfloat data[4];
+};
+
+//! Std140Mat4
+/*!
+ * A column-major mat4, four vec4 columns
+ */
+struct alignas(16) Std140Mat4
+{
+    GLfloat data[16];
+};
+
+//! Std140Check
+/*!
+ * Std140Check fails to compile when T can't be copied as is into a std140
+ * uniform block
+ */
+template <typename T>
+struct Std140Check
+{
+    static_assert(
+        std::is_standard_layout<T>::value,
+        "std140 blocks must be standard layout"
+    );
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "std140 blocks are copied with memcpy"
+    );
+    static_assert(
+        (sizeof(T) % 16) == 0,
+        "std140 block size must be a multiple of 16 bytes"
+    );
+
+    static const bool value = true;
+};
+
+/*!
+ * Check at compile time that a member sits at its std140 offset
+ */
+#define STD140_ASSERT_OFFSET(type, member, offset) \
+    static_assert( \
+        offsetof(type, member) == (offset), \
+        #type "::" #member " is not at std140 offset " #offset \
+    )
+
+#endif // __STD140_HPP
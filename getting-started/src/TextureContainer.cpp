@@ -0,0 +1,129 @@
+#include "TextureContainer.hpp"
+
+#include <cstring>
+
+#include "GLState.hpp"
+#include "Log.hpp"
+
+/*!
+ * TextureContainer constructor, throws AssetError if the file can't be
+ * mapped or is not a valid container
+ *
+ * \param[in] path The path to the container
+ */
+TextureContainer::TextureContainer (const std::string& path)
+    : file_(path),
+      header_(nullptr),
+      levels_(nullptr)
+{
+    std::size_t size = file_.getSize();
+
+    if (size < sizeof(TextureContainerHeader))
+        throw AssetError(path, "truncated header");
+
+    header_ = reinterpret_cast<const TextureContainerHeader*>(file_.getData());
+
+    if (std::memcmp(header_->magic, kTextureContainerMagic, 4))
+        throw AssetError(path, "not a texture container");
+
+    if (header_->version != kTextureContainerVersion)
+        throw AssetError(path, "unsupported container version");
+
+    std::size_t table_end = sizeof(TextureContainerHeader) +
+        header_->levels * sizeof(TextureContainerLevel);
+
+    if ((header_->levels == 0) || (size < table_end))
+        throw AssetError(path, "truncated level table");
+
+    levels_ = reinterpret_cast<const TextureContainerLevel*>(
+        file_.getData() + sizeof(TextureContainerHeader)
+    );
+
+    for (std::uint32_t i = 0; i < header_->levels; ++i) {
+        if (
+            (levels_[i].offset < table_end) ||
+            (levels_[i].offset + levels_[i].size > size)
+        ) {
+            throw AssetError(path, "level data out of bounds");
+        }
+    }
+}
+
+/*!
+ * Check if the data is compressed
+ *
+ * \return True if the levels hold a compressed format
+ */
+bool TextureContainer::isCompressed () const
+{
+    return header_->format == 0;
+}
+
+/*!
+ * Get the header
+ *
+ * \return The header
+ */
+const TextureContainerHeader& TextureContainer::getHeader () const
+{
+    return *header_;
+}
+
+/*!
+ * Create a texture holding every level
+ *
+ * \param[in] params The sampling state, the channels and mipmaps fields
+ *                   are ignored
+ *
+ * \return The texture resource id, 0 if the GL can't use the format
+ */
+GLuint TextureContainer::upload (const TextureParams& params) const
+{
+    bool s3tc =
+        (header_->internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ||
+        (header_->internal_format == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT);
+
+    if (isCompressed() && s3tc && !GLEW_EXT_texture_compression_s3tc) {
+        LOG_ERROR("ERROR::TEXTURE::UNSUPPORTED_FORMAT " << file_.getPath());
+
+        return 0;
+    }
+
+    GLuint texture;
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.mag_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header_->levels - 1);
+
+    // rows are tightly packed, whatever their width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (std::uint32_t i = 0; i < header_->levels; ++i) {
+        const TextureContainerLevel& level = levels_[i];
+        const GLvoid* data = file_.getData() + level.offset;
+
+        if (isCompressed()) {
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D, i, header_->internal_format,
+                level.width, level.height, 0, level.size, data
+            );
+        } else {
+            glTexImage2D(
+                GL_TEXTURE_2D, i, header_->internal_format,
+                level.width, level.height, 0,
+                header_->format, header_->type, data
+            );
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+    return texture;
+}
@@ -0,0 +1,158 @@
+/*!
+ * \file  TextureContainer.hpp
+ * \brief Binary texture container holding a precomputed mipmap chain, written
+ *        by texbake and uploaded without any decoding
+ */
+
+#ifndef __TEXTURE_CONTAINER_HPP
+#define __TEXTURE_CONTAINER_HPP
+
+#include <string>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "AssetFile.hpp"
+#include "TextureManager.hpp"
+
+/*
+ * File layout, little endian:
+ *
+ *     TextureContainerHeader
+ *     TextureContainerLevel[levels], level 0 first
+ *     level data, each level starting on a 16 byte boundary
+ *
+ * Uncompressed levels are RGBA, rows stored bottom first as glTexImage2D
+ * expects. Version 1 stored the rows top first.
+ */
+
+//! TextureContainerHeader
+struct TextureContainerHeader
+{
+    /*!
+     * "LTEX"
+     */
+    char magic[4];
+
+    /*!
+     * The format version, kTextureContainerVersion
+     */
+    std::uint32_t version;
+
+    /*!
+     * The width of level 0
+     */
+    std::uint32_t width;
+
+    /*!
+     * The height of level 0
+     */
+    std::uint32_t height;
+
+    /*!
+     * The number of levels stored
+     */
+    std::uint32_t levels;
+
+    /*!
+     * The GL internal format, GL_RGB8, GL_RGBA8, their sRGB variants or a
+     * compressed format
+     */
+    std::uint32_t internal_format;
+
+    /*!
+     * The GL pixel format of uncompressed data, 0 for compressed data
+     */
+    std::uint32_t format;
+
+    /*!
+     * The GL pixel type of uncompressed data, 0 for compressed data
+     */
+    std::uint32_t type;
+};
+
+//! TextureContainerLevel
+struct TextureContainerLevel
+{
+    /*!
+     * The level width
+     */
+    std::uint32_t width;
+
+    /*!
+     * The level height
+     */
+    std::uint32_t height;
+
+    /*!
+     * The offset of the level data from the start of the file
+     */
+    std::uint64_t offset;
+
+    /*!
+     * The size of the level data
+     */
+    std::uint64_t size;
+};
+
+const char kTextureContainerMagic[4] = {'L', 'T', 'E', 'X'};
+const std::uint32_t kTextureContainerVersion = 2;
+
+//! TextureContainer
+/*!
+ * TextureContainer maps a container with a single mmap and uploads each level
+ * straight from the mapping
+ */
+class TextureContainer
+{
+ private:
+    /*!
+     * The mapped file
+     */
+    AssetFile file_;
+
+    /*!
+     * The header, inside the mapping
+     */
+    const TextureContainerHeader* header_;
+
+    /*!
+     * The level table, inside the mapping
+     */
+    const TextureContainerLevel* levels_;
+
+ public:
+    /*!
+     * TextureContainer constructor, throws AssetError if the file can't be
+     * mapped or is not a valid container
+     *
+     * \param[in] path The path to the container
+     */
+    explicit TextureContainer (const std::string& path);
+
+    /*!
+     * Check if the data is compressed
+     *
+     * \return True if the levels hold a compressed format
+     */
+    bool isCompressed () const;
+
+    /*!
+     * Get the header
+     *
+     * \return The header
+     */
+    const TextureContainerHeader& getHeader () const;
+
+    /*!
+     * Create a texture holding every level
+     *
+     * \param[in] params The sampling state, the channels and mipmaps fields
+     *                   are ignored
+     *
+     * \return The texture resource id, 0 if the GL can't use the format
+     */
+    GLuint upload (const TextureParams& params) const;
+};
+
+#endif // __TEXTURE_CONTAINER_HPP
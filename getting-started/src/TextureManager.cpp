@@ -0,0 +1,283 @@
+#include "TextureManager.hpp"
+
+#include <vector>
+#include <cstring>
+#include <utility>
+
+#include <SOIL/SOIL.h>
+
+#include "AssetFile.hpp"
+#include "GLState.hpp"
+#include "ImageKernels.hpp"
+#include "Log.hpp"
+#include "TextureContainer.hpp"
+
+namespace {
+
+// expand the decoded pixels to RGBA, flip them for GL and append the chain
+void prepareLevels (const unsigned char* decoded, DecodedImage& image)
+{
+    std::size_t size = 0;
+
+    for (int level = 0; level < image.levels; ++level) {
+        size += ImageKernels::getLevelSize(image.width, level) *
+            ImageKernels::getLevelSize(image.height, level) * 4;
+    }
+
+    image.pixels.resize(size);
+
+    unsigned char* pixels = image.pixels.data();
+    std::size_t count = image.width * image.height;
+
+    if (image.channels == 4)
+        std::memcpy(pixels, decoded, count * 4);
+    else
+        ImageKernels::expandRgbToRgba(decoded, pixels, count);
+
+    ImageKernels::flipVertical(pixels, image.width * 4, image.height);
+
+    for (int level = 1; level < image.levels; ++level) {
+        int width = ImageKernels::getLevelSize(image.width, level - 1);
+        int height = ImageKernels::getLevelSize(image.height, level - 1);
+        unsigned char* next = pixels + width * height * 4;
+
+        ImageKernels::downsampleBox(pixels, width, height, next);
+        pixels = next;
+    }
+}
+
+} // namespace
+
+/*!
+ * TextureManager constructor, must be called with a current context
+ *
+ * \param[in] budget  The number of bytes staged per frame
+ * \param[in] threads The number of decoding threads, 0 for the default
+ */
+TextureManager::TextureManager (GLsizeiptr budget, unsigned int threads)
+    : pool_(new ThreadPool(threads)),
+      staging_(GL_PIXEL_UNPACK_BUFFER, budget),
+      pending_(0)
+{
+}
+
+/*!
+ * TextureManager destructor, the textures are not deleted
+ */
+TextureManager::~TextureManager ()
+{
+    // join the workers first, nothing can be queued after this
+    pool_.reset();
+}
+
+/*!
+ * Create a texture and queue its image for decoding. Containers baked by
+ * texbake (.tex) are uploaded right away and throw AssetError when invalid.
+ *
+ * \param[in] path   The path to the image
+ * \param[in] params The sampling state and pixel format
+ *
+ * \return The texture resource id, usable immediately
+ */
+GLuint TextureManager::load (const std::string& path, const TextureParams& params)
+{
+    const std::string extension = ".tex";
+
+    // baked containers need no decoding, their levels are uploaded now
+    if (
+        (path.size() > extension.size()) &&
+        !path.compare(path.size() - extension.size(), extension.size(), extension)
+    ) {
+        TextureContainer container(path);
+
+        return container.upload(params);
+    }
+
+    // mid gray until the image is resident
+    const unsigned char placeholder[4] = {128, 128, 128, 255};
+    GLuint texture;
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.mag_filter);
+
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, placeholder
+    );
+
+    if (params.mipmaps)
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+    ++pending_;
+
+    pool_->submit([this, path, params, texture] {
+        DecodedImage image = {texture, 0, 0, params.channels, 1, {}};
+
+        try {
+            AssetFile file(path);
+
+            unsigned char* pixels = SOIL_load_image_from_memory(
+                file.getBytes(),
+                file.getSize(),
+                &image.width,
+                &image.height,
+                0,
+                params.channels
+            );
+
+            if (pixels == nullptr) {
+                LOG_ERROR(
+                    "ERROR::TEXTURE::FAILED_TO_DECODE " << path
+                    << ": " << SOIL_last_result()
+                );
+            } else {
+                if (params.mipmaps) {
+                    image.levels = ImageKernels::getLevelCount(
+                        image.width, image.height
+                    );
+                }
+
+                prepareLevels(pixels, image);
+                SOIL_free_image_data(pixels);
+            }
+        } catch (const AssetError& e) {
+            LOG_ERROR(e.what());
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded_.push_back(std::move(image));
+    });
+
+    return texture;
+}
+
+/*!
+ * Upload the images decoded since the last call, within the budget
+ *
+ * \return The number of textures uploaded
+ */
+unsigned int TextureManager::update ()
+{
+    std::vector<DecodedImage> staged;
+    std::vector<GLintptr> offsets;
+    std::vector<DecodedImage> direct;
+    GLsizeiptr used = 0;
+    unsigned int uploaded = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        while (!decoded_.empty()) {
+            DecodedImage& image = decoded_.front();
+            GLsizeiptr size = image.pixels.size();
+
+            if (image.pixels.empty()) {
+                // keeps the placeholder for good
+                --pending_;
+            } else if (size > staging_.getSectionSize()) {
+                // too large for the staging ring, uploaded from client memory
+                direct.push_back(std::move(image));
+            } else if (used + size <= staging_.getSectionSize()) {
+                offsets.push_back(used);
+                staged.push_back(std::move(image));
+                used += size;
+            } else {
+                break;
+            }
+
+            decoded_.pop_front();
+        }
+    }
+
+    if (!staged.empty()) {
+        char* section = static_cast<char*>(staging_.acquire());
+
+        for (std::size_t i = 0; i < staged.size(); ++i) {
+            const DecodedImage& image = staged[i];
+
+            std::memcpy(
+                section + offsets[i], image.pixels.data(), image.pixels.size()
+            );
+        }
+
+        staging_.release();
+
+        // pixel sources are now offsets in the bound unpack buffer
+        GLState::getInstance().bindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_.getBuffer());
+
+        for (std::size_t i = 0; i < staged.size(); ++i) {
+            upload(
+                staged[i],
+                reinterpret_cast<const GLvoid*>(staging_.getOffset() + offsets[i])
+            );
+        }
+
+        GLState::getInstance().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        staging_.fence();
+    }
+
+    for (const DecodedImage& image : direct)
+        upload(image, image.pixels.data());
+
+    uploaded = staged.size() + direct.size();
+    pending_ -= uploaded;
+
+    return uploaded;
+}
+
+/*!
+ * Get the number of textures still waiting for their image
+ *
+ * \return The number of pending textures
+ */
+unsigned int TextureManager::getPendingCount ()
+{
+    return pending_;
+}
+
+/*!
+ * Upload every level of an image
+ *
+ * \param[in] image  The decoded image
+ * \param[in] pixels The pixels source, a pointer or an offset in the
+ *                   bound pixel unpack buffer
+ *
+ * \return void
+ */
+void TextureManager::upload (const DecodedImage& image, const GLvoid* pixels)
+{
+    GLenum format = (image.channels == 4) ? GL_RGBA : GL_RGB;
+    const GLubyte* level_pixels = static_cast<const GLubyte*>(pixels);
+
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, image.texture);
+
+    // RGBA rows are always 4 byte aligned, the default unpack alignment
+    for (int level = 0; level < image.levels; ++level) {
+        int width = ImageKernels::getLevelSize(image.width, level);
+        int height = ImageKernels::getLevelSize(image.height, level);
+
+        glTexImage2D(
+            GL_TEXTURE_2D,      // texture target
+            level,              // the mipmap level to create a texture
+            format,             // the format to store the texture
+            width,              // width of the texture
+            height,             // height of the texture
+            0,                  // always 0 (legacy stuff)
+            GL_RGBA,            // format of the source image
+            GL_UNSIGNED_BYTE,   // data type of the source image
+            level_pixels        // the image data
+        );
+
+        level_pixels += width * height * 4;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels - 1);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+}
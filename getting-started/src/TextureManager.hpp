@@ -0,0 +1,192 @@
+/*!
+ * \file  TextureManager.hpp
+ * \brief Class definition to decode textures on worker threads and stream
+ *        them to the GPU through pixel unpack buffers
+ */
+
+#ifndef __TEXTURE_MANAGER_HPP
+#define __TEXTURE_MANAGER_HPP
+
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "BufferRing.hpp"
+#include "ThreadPool.hpp"
+
+//! TextureParams
+/*!
+ * TextureParams holds the sampling state and the pixel format of a texture
+ */
+struct TextureParams
+{
+    /*!
+     * The wrapping along s, GL_REPEAT, GL_CLAMP_TO_EDGE, ...
+     */
+    GLint wrap_s;
+
+    /*!
+     * The wrapping along t
+     */
+    GLint wrap_t;
+
+    /*!
+     * The minifying filter
+     */
+    GLint min_filter;
+
+    /*!
+     * The magnifying filter
+     */
+    GLint mag_filter;
+
+    /*!
+     * The number of channels to decode, 3 for RGB or 4 for RGBA. The pixels
+     * are expanded to RGBA before the upload in both cases.
+     */
+    int channels;
+
+    /*!
+     * Whether the mipmap chain is built by the decoder and uploaded with
+     * the image
+     */
+    bool mipmaps;
+};
+
+//! DecodedImage
+/*!
+ * DecodedImage is an image decoded by a worker and waiting to be uploaded
+ */
+struct DecodedImage
+{
+    /*!
+     * The texture the image belongs to
+     */
+    GLuint texture;
+
+    /*!
+     * The image width
+     */
+    int width;
+
+    /*!
+     * The image height
+     */
+    int height;
+
+    /*!
+     * The number of channels the texture stores, 3 for RGB or 4 for RGBA
+     */
+    int channels;
+
+    /*!
+     * The number of levels in pixels
+     */
+    int levels;
+
+    /*!
+     * The RGBA pixels of every level, level 0 first, each one with its
+     * bottom row first as glTexImage2D expects. Empty if the image failed
+     * to load.
+     */
+    std::vector<unsigned char> pixels;
+};
+
+//! TextureManager
+/*!
+ * TextureManager returns texture names right away, holding a 1x1 placeholder
+ * texel, and decodes the images on a ThreadPool, where ImageKernels also
+ * flips them and builds their mipmap chain. update() runs on the GL
+ * thread once per frame: it copies the decoded images into a ring of pixel
+ * unpack buffers and respecifies each texture from there, so the render loop
+ * never waits on the disk or on the decoder.
+ */
+class TextureManager
+{
+ private:
+    /*!
+     * The workers decoding the images
+     */
+    std::unique_ptr<ThreadPool> pool_;
+
+    /*!
+     * The pixel unpack buffer sections, one per frame in flight
+     */
+    BufferRing staging_;
+
+    /*!
+     * Images decoded and waiting for update()
+     */
+    std::deque<DecodedImage> decoded_;
+
+    /*!
+     * Protects decoded_
+     */
+    std::mutex mutex_;
+
+    /*!
+     * The number of textures still holding their placeholder
+     */
+    unsigned int pending_;
+
+    /*!
+     * Upload every level of an image
+     *
+     * \param[in] image  The decoded image
+     * \param[in] pixels The pixels source, a pointer or an offset in the
+     *                   bound pixel unpack buffer
+     *
+     * \return void
+     */
+    void upload (const DecodedImage& image, const GLvoid* pixels);
+
+ public:
+    /*!
+     * TextureManager constructor, must be called with a current context
+     *
+     * \param[in] budget  The number of bytes staged per frame
+     * \param[in] threads The number of decoding threads, 0 for the default
+     */
+    explicit TextureManager (
+        GLsizeiptr budget = 16 * 1024 * 1024, unsigned int threads = 0
+    );
+
+    TextureManager (const TextureManager&) = delete;
+    TextureManager& operator= (const TextureManager&) = delete;
+
+    /*!
+     * TextureManager destructor, the textures are not deleted
+     */
+    ~TextureManager ();
+
+    /*!
+     * Create a texture and queue its image for decoding. Containers baked by
+     * texbake (.tex) are uploaded right away and throw AssetError when invalid.
+     *
+     * \param[in] path   The path to the image
+     * \param[in] params The sampling state and pixel format
+     *
+     * \return The texture resource id, usable immediately
+     */
+    GLuint load (const std::string& path, const TextureParams& params);
+
+    /*!
+     * Upload the images decoded since the last call, within the budget
+     *
+     * \return The number of textures uploaded
+     */
+    unsigned int update ();
+
+    /*!
+     * Get the number of textures still waiting for their image
+     *
+     * \return The number of pending textures
+     */
+    unsigned int getPendingCount ();
+};
+
+#endif // __TEXTURE_MANAGER_HPP
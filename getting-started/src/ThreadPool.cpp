@@ -0,0 +1,109 @@
+#include "ThreadPool.hpp"
+
+/*!
+ * ThreadPool constructor
+ *
+ * \param[in] threads The number of workers, 0 to leave one core to the
+ *                    render thread
+ */
+ThreadPool::ThreadPool (unsigned int threads)
+    : active_(0),
+      stopping_(false)
+{
+    if (threads == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+
+        threads = (cores > 1) ? cores - 1 : 1;
+    }
+
+    for (unsigned int i = 0; i < threads; ++i)
+        workers_.emplace_back(&ThreadPool::work, this);
+}
+
+/*!
+ * ThreadPool destructor, finishes the queued jobs and joins the workers
+ */
+ThreadPool::~ThreadPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    job_available_.notify_all();
+
+    for (std::thread& worker : workers_)
+        worker.join();
+}
+
+/*!
+ * Queue a job
+ *
+ * \param[in] job The job
+ *
+ * \return void
+ */
+void ThreadPool::submit (std::function<void ()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push(std::move(job));
+    }
+
+    job_available_.notify_one();
+}
+
+/*!
+ * Block until every queued job has run
+ *
+ * \return void
+ */
+void ThreadPool::wait ()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    idle_.wait(lock, [this] { return jobs_.empty() && (active_ == 0); });
+}
+
+/*!
+ * Get the number of workers
+ *
+ * \return The number of threads
+ */
+unsigned int ThreadPool::getThreadCount ()
+{
+    return workers_.size();
+}
+
+/*!
+ * The loop run by each worker
+ *
+ * \return void
+ */
+void ThreadPool::work ()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        job_available_.wait(lock, [this] {
+            return stopping_ || !jobs_.empty();
+        });
+
+        if (jobs_.empty())
+            return;
+
+        std::function<void ()> job = std::move(jobs_.front());
+
+        jobs_.pop();
+        ++active_;
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        --active_;
+
+        if (jobs_.empty() && (active_ == 0))
+            idle_.notify_all();
+    }
+}
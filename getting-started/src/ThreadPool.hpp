@@ -0,0 +1,109 @@
+/*!
+ * \file  ThreadPool.hpp
+ * \brief Class definition of a fixed set of worker threads running queued
+ *        jobs
+ */
+
+#ifndef __THREAD_POOL_HPP
+#define __THREAD_POOL_HPP
+
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+//! ThreadPool
+/*!
+ * ThreadPool runs jobs on worker threads in the order they were submitted.
+ * Jobs must not touch the OpenGL context, which stays current on the thread
+ * that created it.
+ */
+class ThreadPool
+{
+ private:
+    /*!
+     * The worker threads
+     */
+    std::vector<std::thread> workers_;
+
+    /*!
+     * The jobs waiting for a worker
+     */
+    std::queue<std::function<void ()> > jobs_;
+
+    /*!
+     * Protects jobs_, active_ and stopping_
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Signalled when a job is queued or the pool stops
+     */
+    std::condition_variable job_available_;
+
+    /*!
+     * Signalled when a worker runs out of jobs
+     */
+    std::condition_variable idle_;
+
+    /*!
+     * The number of jobs running
+     */
+    unsigned int active_;
+
+    /*!
+     * Whether the workers must exit
+     */
+    bool stopping_;
+
+    /*!
+     * The loop run by each worker
+     *
+     * \return void
+     */
+    void work ();
+
+ public:
+    /*!
+     * ThreadPool constructor
+     *
+     * \param[in] threads The number of workers, 0 to leave one core to the
+     *                    render thread
+     */
+    explicit ThreadPool (unsigned int threads = 0);
+
+    ThreadPool (const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    /*!
+     * ThreadPool destructor, finishes the queued jobs and joins the workers
+     */
+    ~ThreadPool ();
+
+    /*!
+     * Queue a job
+     *
+     * \param[in] job The job
+     *
+     * \return void
+     */
+    void submit (std::function<void ()> job);
+
+    /*!
+     * Block until every queued job has run
+     *
+     * \return void
+     */
+    void wait ();
+
+    /*!
+     * Get the number of workers
+     *
+     * \return The number of threads
+     */
+    unsigned int getThreadCount ();
+};
+
+#endif // __THREAD_POOL_HPP
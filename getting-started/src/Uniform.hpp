@@ -0,0 +1,165 @@
+/*!
+ * \file  Uniform.hpp
+ * \brief Compile-time uniform names and the upload function of every type a
+ *        Shader can set
+ */
+
+#ifndef __UNIFORM_HPP
+#define __UNIFORM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "MathTypes.hpp"
+
+/*!
+ * Hash a uniform name with 32-bit FNV-1a
+ *
+ * \param[in] name The uniform name
+ *
+ * \return The hash of the name
+ */
+constexpr std::uint32_t hashUniformName (const char* name)
+{
+    std::uint32_t hash = 2166136261u;
+
+    while (*name) {
+        hash ^= static_cast<unsigned char>(*name++);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+//! UniformId
+/*!
+ * UniformId identifies a uniform by the hash of its name. Declared constexpr,
+ * the name is hashed by the compiler and the render loop never touches the
+ * string.
+ */
+class UniformId
+{
+ private:
+    /*!
+     * The hash of the uniform name
+     */
+    std::uint32_t hash_;
+
+ public:
+    /*!
+     * UniformId constructor
+     *
+     * \param[in] name The uniform name, as declared in GLSL
+     */
+    constexpr explicit UniformId (const char* name)
+        : hash_(hashUniformName(name))
+    {
+    }
+
+    /*!
+     * Get the hash of the uniform name
+     *
+     * \return The hash
+     */
+    constexpr std::uint32_t getHash () const
+    {
+        return hash_;
+    }
+};
+
+/*!
+ * Build a UniformId from a string literal, "mix_ratio"_uniform
+ *
+ * \param[in] name The uniform name
+ *
+ * \return The uniform id
+ */
+constexpr UniformId operator"" _uniform (const char* name, std::size_t)
+{
+    return UniformId(name);
+}
+
+//! UniformTraits
+/*!
+ * UniformTraits uploads a C++ value to the uniform at a location of the
+ * program in use. Only the specializations below are defined.
+ */
+template <typename T>
+struct UniformTraits;
+
+template <>
+struct UniformTraits<GLint>
+{
+    static void upload (GLint location, const GLint& value)
+    {
+        glUniform1i(location, value);
+    }
+};
+
+template <>
+struct UniformTraits<GLuint>
+{
+    static void upload (GLint location, const GLuint& value)
+    {
+        glUniform1ui(location, value);
+    }
+};
+
+template <>
+struct UniformTraits<GLfloat>
+{
+    static void upload (GLint location, const GLfloat& value)
+    {
+        glUniform1f(location, value);
+    }
+};
+
+template <>
+struct UniformTraits<std::array<GLfloat, 2> >
+{
+    static void upload (GLint location, const std::array<GLfloat, 2>& value)
+    {
+        glUniform2fv(location, 1, value.data());
+    }
+};
+
+template <>
+struct UniformTraits<std::array<GLfloat, 3> >
+{
+    static void upload (GLint location, const std::array<GLfloat, 3>& value)
+    {
+        glUniform3fv(location, 1, value.data());
+    }
+};
+
+template <>
+struct UniformTraits<std::array<GLfloat, 4> >
+{
+    static void upload (GLint location, const std::array<GLfloat, 4>& value)
+    {
+        glUniform4fv(location, 1, value.data());
+    }
+};
+
+template <>
+struct UniformTraits<std::array<GLfloat, 16> >
+{
+    static void upload (GLint location, const std::array<GLfloat, 16>& value)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value.data());
+    }
+};
+
+template <>
+struct UniformTraits<Mat4>
+{
+    static void upload (GLint location, const Mat4& value)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value.data);
+    }
+};
+
+#endif // __UNIFORM_HPP
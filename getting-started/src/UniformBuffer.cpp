@@ -0,0 +1,71 @@
+#include "UniformBuffer.hpp"
+
+#include <map>
+
+namespace {
+
+struct BlockInfo
+{
+    GLuint binding;
+    GLsizeiptr size;
+};
+
+std::map<std::string, BlockInfo>& getBlocks ()
+{
+    static std::map<std::string, BlockInfo> blocks;
+
+    return blocks;
+}
+
+BlockInfo& getBlock (const std::string& name)
+{
+    std::map<std::string, BlockInfo>& blocks = getBlocks();
+    auto it = blocks.find(name);
+
+    if (it == blocks.end()) {
+        BlockInfo info = {static_cast<GLuint>(blocks.size()), 0};
+
+        it = blocks.insert(std::make_pair(name, info)).first;
+    }
+
+    return it->second;
+}
+
+} // namespace
+
+/*!
+ * Get the binding point of a block, allocating one on first use
+ *
+ * \param[in] name The block name, as declared in GLSL
+ *
+ * \return The binding point
+ */
+GLuint UniformBlockRegistry::getBinding (const std::string& name)
+{
+    return getBlock(name).binding;
+}
+
+/*!
+ * Record the size of the C++ struct backing a block
+ *
+ * \param[in] name The block name, as declared in GLSL
+ * \param[in] size The size of the struct, in bytes
+ *
+ * \return void
+ */
+void UniformBlockRegistry::setSize (const std::string& name, GLsizeiptr size)
+{
+    getBlock(name).size = size;
+}
+
+/*!
+ * Get the size of the C++ struct backing a block
+ *
+ * \param[in] name The block name, as declared in GLSL
+ *
+ * \return The size in bytes, 0 if no UniformBuffer has been created
+ */
+GLsizeiptr UniformBlockRegistry::getSize (const std::string& name)
+{
+    return getBlock(name).size;
+}
@@ -0,0 +1,148 @@
+/*!
+ * \file  UniformBuffer.hpp
+ * \brief Class definitions to share per-frame data with every program through
+ *        uniform buffer objects
+ */
+
+#ifndef __UNIFORM_BUFFER_HPP
+#define __UNIFORM_BUFFER_HPP
+
+#include <string>
+#include <cstring>
+
+#include <GL/glew.h>
+
+#include "BufferRing.hpp"
+#include "GLState.hpp"
+#include "Std140.hpp"
+
+//! UniformBlockRegistry
+/*!
+ * UniformBlockRegistry gives every uniform block name its own binding point.
+ * Shader binds its blocks through it when the program is linked and
+ * UniformBuffer binds its buffer to the same point, in whatever order the two
+ * are created.
+ */
+class UniformBlockRegistry
+{
+ public:
+    /*!
+     * Get the binding point of a block, allocating one on first use
+     *
+     * \param[in] name The block name, as declared in GLSL
+     *
+     * \return The binding point
+     */
+    static GLuint getBinding (const std::string& name);
+
+    /*!
+     * Record the size of the C++ struct backing a block
+     *
+     * \param[in] name The block name, as declared in GLSL
+     * \param[in] size The size of the struct, in bytes
+     *
+     * \return void
+     */
+    static void setSize (const std::string& name, GLsizeiptr size);
+
+    /*!
+     * Get the size of the C++ struct backing a block
+     *
+     * \param[in] name The block name, as declared in GLSL
+     *
+     * \return The size in bytes, 0 if no UniformBuffer has been created
+     */
+    static GLsizeiptr getSize (const std::string& name);
+};
+
+//! UniformBuffer
+/*!
+ * UniformBuffer holds the data of a std140 uniform block in a ring of
+ * buffer sections. update() writes the whole struct once per frame and binds
+ * it for every program declaring the block, replacing one glUniform* call per
+ * value and per program.
+ */
+template <typename T>
+class UniformBuffer
+{
+ private:
+    static_assert(Std140Check<T>::value, "T must follow the std140 layout");
+
+    /*!
+     * The binding point of the block
+     */
+    GLuint binding_;
+
+    /*!
+     * The sections written in turn
+     */
+    BufferRing ring_;
+
+    /*!
+     * Get the alignment required for uniform buffer offsets
+     *
+     * \return The alignment, in bytes
+     */
+    static GLint getOffsetAlignment ()
+    {
+        GLint alignment = 256;
+
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+        return alignment;
+    }
+
+ public:
+    /*!
+     * UniformBuffer constructor
+     *
+     * \param[in] name     The block name, as declared in GLSL
+     * \param[in] sections The number of frames in flight
+     */
+    explicit UniformBuffer (const std::string& name, unsigned int sections = 3)
+        : binding_(UniformBlockRegistry::getBinding(name)),
+          ring_(GL_UNIFORM_BUFFER, sizeof(T), sections, getOffsetAlignment())
+    {
+        UniformBlockRegistry::setSize(name, sizeof(T));
+    }
+
+    /*!
+     * Write the data of the frame and bind it to the block binding point
+     *
+     * \param[in] value The block data
+     *
+     * \return void
+     */
+    void update (const T& value)
+    {
+        std::memcpy(ring_.acquire(), &value, sizeof(T));
+        ring_.release();
+
+        GLState::getInstance().bindBufferRange(
+            GL_UNIFORM_BUFFER, binding_,
+            ring_.getBuffer(), ring_.getOffset(), sizeof(T)
+        );
+    }
+
+    /*!
+     * Fence the data of the frame, called after its last draw
+     *
+     * \return void
+     */
+    void fence ()
+    {
+        ring_.fence();
+    }
+
+    /*!
+     * Get the binding point of the block
+     *
+     * \return The binding point
+     */
+    GLuint getBinding ()
+    {
+        return binding_;
+    }
+};
+
+#endif // __UNIFORM_BUFFER_HPP
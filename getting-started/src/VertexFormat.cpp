@@ -0,0 +1,189 @@
+#include "VertexFormat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// round a value in [-1, 1] or [0, 1] to a normalized integer
+GLint quantize (GLfloat value, GLfloat low, GLint scale)
+{
+    return static_cast<GLint>(std::lround(std::min(std::max(value, low), 1.0f) * scale));
+}
+
+} // namespace
+
+/*!
+ * Convert a float to an IEEE half float, rounded to nearest even
+ *
+ * \param[in] value The float
+ *
+ * \return The half float
+ */
+GLhalf packHalf (GLfloat value)
+{
+    std::uint32_t bits;
+
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t magnitude = bits & 0x7fffffff;
+
+    // NaN stays a NaN, 65536 and above become infinity
+    if (magnitude >= 0x47800000)
+        return static_cast<GLhalf>(sign | ((magnitude > 0x7f800000) ? 0x7e00 : 0x7c00));
+
+    // below the smallest normal half the value is denormalized by adding
+    // 0.5, the FPU does the rounding
+    if (magnitude < 0x38800000) {
+        float denormal;
+
+        std::memcpy(&denormal, &magnitude, sizeof(denormal));
+        denormal += 0.5f;
+        std::memcpy(&bits, &denormal, sizeof(bits));
+
+        return static_cast<GLhalf>(sign | (bits - 0x3f000000));
+    }
+
+    // rebias the exponent, then round the 13 dropped bits to nearest even
+    std::uint32_t odd = (magnitude >> 13) & 1;
+
+    magnitude += 0xc8000fff + odd;
+
+    return static_cast<GLhalf>(sign | (magnitude >> 13));
+}
+
+/*!
+ * Convert an IEEE half float to a float, exact
+ *
+ * \param[in] value The half float
+ *
+ * \return The float
+ */
+GLfloat unpackHalf (GLhalf value)
+{
+    std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000) << 16;
+    std::uint32_t exponent = (value >> 10) & 0x1f;
+    std::uint32_t mantissa = value & 0x3ff;
+    std::uint32_t bits;
+    GLfloat result;
+
+    if (exponent == 0x1f) {
+        // infinity or NaN
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else {
+        // zero or denormal, mantissa * 2^-24 is exact in a float
+        result = std::ldexp(static_cast<GLfloat>(mantissa), -24);
+
+        return sign ? -result : result;
+    }
+
+    std::memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+/*!
+ * Build texture coordinates
+ *
+ * \param[in] u The first coordinate
+ * \param[in] v The second coordinate
+ *
+ * \return The coordinates as half floats
+ */
+Half2 packHalf2 (GLfloat u, GLfloat v)
+{
+    return {{packHalf(u), packHalf(v)}};
+}
+
+/*!
+ * Build a normal, each component in [-1, 1]
+ *
+ * \param[in] x The x component
+ * \param[in] y The y component
+ * \param[in] z The z component
+ * \param[in] w The w component, -1, 0 or 1
+ *
+ * \return The normal in 10, 10, 10 and 2 bits
+ */
+PackedNormal packNormal (GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    // two's complement fields, x in the low bits
+    GLuint bits =
+        (static_cast<GLuint>(quantize(x, -1.0f, 511)) & 0x3ff) |
+        ((static_cast<GLuint>(quantize(y, -1.0f, 511)) & 0x3ff) << 10) |
+        ((static_cast<GLuint>(quantize(z, -1.0f, 511)) & 0x3ff) << 20) |
+        ((static_cast<GLuint>(quantize(w, -1.0f, 1)) & 0x3) << 30);
+
+    return {bits};
+}
+
+/*!
+ * Build a color, each component in [0, 1]
+ *
+ * \param[in] r The red component
+ * \param[in] g The green component
+ * \param[in] b The blue component
+ * \param[in] a The alpha component
+ *
+ * \return The color in 8 bits per component
+ */
+Color4ub packColor (GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    return {{
+        static_cast<GLubyte>(quantize(r, 0.0f, 255)),
+        static_cast<GLubyte>(quantize(g, 0.0f, 255)),
+        static_cast<GLubyte>(quantize(b, 0.0f, 255)),
+        static_cast<GLubyte>(quantize(a, 0.0f, 255))
+    }};
+}
+
+/*!
+ * Get the layout of interleaved float attributes
+ *
+ * \param[in] sizes The number of components of each attribute
+ *
+ * \return The layout
+ */
+std::vector<VertexAttribute> getFloatAttributes (const std::vector<GLint>& sizes)
+{
+    std::vector<VertexAttribute> attributes;
+    GLsizei offset = 0;
+
+    for (GLint size : sizes) {
+        attributes.push_back({size, GL_FLOAT, GL_FALSE, offset});
+        offset += size * sizeof(GLfloat);
+    }
+
+    return attributes;
+}
+
+/*!
+ * Record attributes of the buffer bound to GL_ARRAY_BUFFER in the vertex
+ * array bound, from location 0
+ *
+ * \param[in] attributes The layout
+ * \param[in] stride     The size of a vertex, in bytes
+ *
+ * \return void
+ */
+void setVertexAttributes (const std::vector<VertexAttribute>& attributes, GLsizei stride)
+{
+    for (GLuint location = 0; location < attributes.size(); ++location) {
+        const VertexAttribute& attribute = attributes[location];
+
+        glVertexAttribPointer(
+            location,
+            attribute.size,
+            attribute.type,
+            attribute.normalized,
+            stride,
+            reinterpret_cast<GLvoid*>(static_cast<std::uintptr_t>(attribute.offset))
+        );
+        glEnableVertexAttribArray(location);
+    }
+}
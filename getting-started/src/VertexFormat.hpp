@@ -0,0 +1,342 @@
+/*!
+ * \file  VertexFormat.hpp
+ * \brief Types declaring a vertex struct and its attribute layout together,
+ *        with packed and quantized attribute types
+ */
+
+#ifndef __VERTEX_FORMAT_HPP
+#define __VERTEX_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+//! VertexAttribute
+/*!
+ * VertexAttribute is what glVertexAttribPointer needs for one attribute
+ */
+struct VertexAttribute
+{
+    /*!
+     * The number of components
+     */
+    GLint size;
+
+    /*!
+     * The component type, GL_FLOAT, GL_HALF_FLOAT, ...
+     */
+    GLenum type;
+
+    /*!
+     * Whether integers are mapped to [0, 1] or [-1, 1]
+     */
+    GLboolean normalized;
+
+    /*!
+     * The offset in the vertex, in bytes
+     */
+    GLsizei offset;
+};
+
+/*
+ * The attribute types. Floats are std::array<GLfloat, N>, like uniforms;
+ * the packed types below hold the bits the GPU reads, use the pack*()
+ * functions to fill them.
+ */
+
+typedef std::array<GLfloat, 2> Float2;
+typedef std::array<GLfloat, 3> Float3;
+typedef std::array<GLfloat, 4> Float4;
+
+//! Half2
+/*!
+ * Two IEEE half floats, a vec2 in 4 bytes, for texture coordinates
+ */
+struct Half2
+{
+    GLhalf data[2];
+};
+
+//! PackedNormal
+/*!
+ * A signed normalized vec4 in 10, 10, 10 and 2 bits, a normal or a
+ * tangent with its handedness in 4 bytes
+ */
+struct PackedNormal
+{
+    GLuint bits;
+};
+
+//! Color4ub
+/*!
+ * An unsigned normalized vec4 in 4 bytes, a color
+ */
+struct Color4ub
+{
+    GLubyte data[4];
+};
+
+//! VertexAttributeTraits
+/*!
+ * VertexAttributeTraits describes how the GPU reads an attribute type.
+ * Only the specializations below are defined.
+ */
+template <typename T>
+struct VertexAttributeTraits;
+
+template <std::size_t N>
+struct VertexAttributeTraits<std::array<GLfloat, N> >
+{
+    static constexpr GLint kSize = N;
+    static constexpr GLenum kType = GL_FLOAT;
+    static constexpr GLboolean kNormalized = GL_FALSE;
+};
+
+template <>
+struct VertexAttributeTraits<Half2>
+{
+    static constexpr GLint kSize = 2;
+    static constexpr GLenum kType = GL_HALF_FLOAT;
+    static constexpr GLboolean kNormalized = GL_FALSE;
+};
+
+template <>
+struct VertexAttributeTraits<PackedNormal>
+{
+    static constexpr GLint kSize = 4;
+    static constexpr GLenum kType = GL_INT_2_10_10_10_REV;
+    static constexpr GLboolean kNormalized = GL_TRUE;
+};
+
+template <>
+struct VertexAttributeTraits<Color4ub>
+{
+    static constexpr GLint kSize = 4;
+    static constexpr GLenum kType = GL_UNSIGNED_BYTE;
+    static constexpr GLboolean kNormalized = GL_TRUE;
+};
+
+//! PackedVertex
+/*!
+ * PackedVertex is a vertex struct built from its attribute types, in
+ * location order: PackedVertex<Float3, Color4ub, Half2> is a position at
+ * location 0, a color at location 1 and texture coordinates at location 2,
+ * 20 bytes where the same vertex in floats takes 32. The attribute layout
+ * given to glVertexAttribPointer comes from the struct itself, the stride
+ * is sizeof and the offsets are offsetof, so they can't disagree.
+ *
+ *     typedef PackedVertex<Float3, Color4ub, Half2> Vertex;
+ *
+ *     Vertex vertex = Vertex::make({0.5f, 0.5f, 0.0f}, packColor(1.0f, 0.0f, 0.0f), packHalf2(1.0f, 1.0f));
+ *     vertex.get<2>() = packHalf2(0.0f, 1.0f);
+ */
+template <typename First, typename... Rest>
+struct PackedVertex
+{
+    First first;
+    PackedVertex<Rest...> rest;
+
+    /*!
+     * Build a vertex
+     *
+     * \param[in] first The first attribute
+     * \param[in] rest  The other attributes
+     *
+     * \return The vertex
+     */
+    static PackedVertex make (const First& first, const Rest&... rest)
+    {
+        PackedVertex vertex;
+
+        vertex.first = first;
+        vertex.rest = PackedVertex<Rest...>::make(rest...);
+
+        return vertex;
+    }
+
+    /*!
+     * Get an attribute
+     *
+     * \return The attribute at location I
+     */
+    template <std::size_t I>
+    auto& get ()
+    {
+        return at(std::integral_constant<std::size_t, I>());
+    }
+
+    First& at (std::integral_constant<std::size_t, 0>)
+    {
+        return first;
+    }
+
+    template <std::size_t I>
+    auto& at (std::integral_constant<std::size_t, I>)
+    {
+        return rest.at(std::integral_constant<std::size_t, I - 1>());
+    }
+
+    /*!
+     * Append the layout of the attributes from a location
+     *
+     * \param[in] attributes The layout
+     * \param[in] offset     The offset of this struct in the vertex
+     *
+     * \return void
+     */
+    static void appendAttributes (std::vector<VertexAttribute>& attributes, GLsizei offset)
+    {
+        static_assert(
+            std::is_standard_layout<PackedVertex>::value,
+            "vertex attributes must be standard layout"
+        );
+
+        attributes.push_back({
+            VertexAttributeTraits<First>::kSize,
+            VertexAttributeTraits<First>::kType,
+            VertexAttributeTraits<First>::kNormalized,
+            static_cast<GLsizei>(offset + offsetof(PackedVertex, first))
+        });
+
+        PackedVertex<Rest...>::appendAttributes(
+            attributes, static_cast<GLsizei>(offset + offsetof(PackedVertex, rest))
+        );
+    }
+
+    /*!
+     * Get the layout of the vertex, one attribute per location
+     *
+     * \return The layout
+     */
+    static std::vector<VertexAttribute> getAttributes ()
+    {
+        std::vector<VertexAttribute> attributes;
+
+        appendAttributes(attributes, 0);
+
+        return attributes;
+    }
+};
+
+template <typename Last>
+struct PackedVertex<Last>
+{
+    Last first;
+
+    static PackedVertex make (const Last& first)
+    {
+        PackedVertex vertex;
+
+        vertex.first = first;
+
+        return vertex;
+    }
+
+    template <std::size_t I>
+    auto& get ()
+    {
+        return at(std::integral_constant<std::size_t, I>());
+    }
+
+    Last& at (std::integral_constant<std::size_t, 0>)
+    {
+        return first;
+    }
+
+    static void appendAttributes (std::vector<VertexAttribute>& attributes, GLsizei offset)
+    {
+        attributes.push_back({
+            VertexAttributeTraits<Last>::kSize,
+            VertexAttributeTraits<Last>::kType,
+            VertexAttributeTraits<Last>::kNormalized,
+            offset
+        });
+    }
+
+    static std::vector<VertexAttribute> getAttributes ()
+    {
+        std::vector<VertexAttribute> attributes;
+
+        appendAttributes(attributes, 0);
+
+        return attributes;
+    }
+};
+
+/*!
+ * Convert a float to an IEEE half float, rounded to nearest even
+ *
+ * \param[in] value The float
+ *
+ * \return The half float
+ */
+GLhalf packHalf (GLfloat value);
+
+/*!
+ * Convert an IEEE half float to a float, exact
+ *
+ * \param[in] value The half float
+ *
+ * \return The float
+ */
+GLfloat unpackHalf (GLhalf value);
+
+/*!
+ * Build texture coordinates
+ *
+ * \param[in] u The first coordinate
+ * \param[in] v The second coordinate
+ *
+ * \return The coordinates as half floats
+ */
+Half2 packHalf2 (GLfloat u, GLfloat v);
+
+/*!
+ * Build a normal, each component in [-1, 1]
+ *
+ * \param[in] x The x component
+ * \param[in] y The y component
+ * \param[in] z The z component
+ * \param[in] w The w component, -1, 0 or 1
+ *
+ * \return The normal in 10, 10, 10 and 2 bits
+ */
+PackedNormal packNormal (GLfloat x, GLfloat y, GLfloat z, GLfloat w = 0.0f);
+
+/*!
+ * Build a color, each component in [0, 1]
+ *
+ * \param[in] r The red component
+ * \param[in] g The green component
+ * \param[in] b The blue component
+ * \param[in] a The alpha component
+ *
+ * \return The color in 8 bits per component
+ */
+Color4ub packColor (GLfloat r, GLfloat g, GLfloat b, GLfloat a = 1.0f);
+
+/*!
+ * Get the layout of interleaved float attributes
+ *
+ * \param[in] sizes The number of components of each attribute
+ *
+ * \return The layout
+ */
+std::vector<VertexAttribute> getFloatAttributes (const std::vector<GLint>& sizes);
+
+/*!
+ * Record attributes of the buffer bound to GL_ARRAY_BUFFER in the vertex
+ * array bound, from location 0
+ *
+ * \param[in] attributes The layout
+ * \param[in] stride     The size of a vertex, in bytes
+ *
+ * \return void
+ */
+void setVertexAttributes (const std::vector<VertexAttribute>& attributes, GLsizei stride);
+
+#endif // __VERTEX_FORMAT_HPP
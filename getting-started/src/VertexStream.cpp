@@ -0,0 +1,171 @@
+#include "VertexStream.hpp"
+
+#include <numeric>
+
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "VertexFormat.hpp"
+
+namespace {
+
+GLsizei getStride (const std::vector<GLint>& attributes)
+{
+    return std::accumulate(attributes.begin(), attributes.end(), 0) * sizeof(GLfloat);
+}
+
+} // namespace
+
+/*!
+ * VertexStream constructor, must be called with a current context
+ *
+ * \param[in] attributes The number of components of each attribute
+ * \param[in] capacity   The number of vertices written per frame at most
+ * \param[in] sections   The number of frames in flight, 3 for triple
+ *                       buffering
+ */
+VertexStream::VertexStream (
+    const std::vector<GLint>& attributes,
+    GLsizei capacity,
+    unsigned int sections
+)
+    // aligned on the stride, every section starts on a whole vertex
+    : ring_(
+          GL_ARRAY_BUFFER, capacity * getStride(attributes),
+          sections, getStride(attributes)
+      ),
+      vao_(0),
+      stride_(getStride(attributes)),
+      capacity_(capacity),
+      section_(nullptr),
+      base_(0),
+      used_(0)
+{
+    GLState& state = GLState::getInstance();
+
+    glGenVertexArrays(1, &vao_);
+
+    state.bindVertexArray(vao_);
+    state.bindBuffer(GL_ARRAY_BUFFER, ring_.getBuffer());
+
+    setVertexAttributes(getFloatAttributes(attributes), stride_);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, 0);
+    state.bindVertexArray(0);
+}
+
+/*!
+ * VertexStream destructor
+ */
+VertexStream::~VertexStream ()
+{
+    GLState::getInstance().forgetVertexArray(vao_);
+
+    glDeleteVertexArrays(1, &vao_);
+}
+
+/*!
+ * Start writing the next section, waits if the GPU still reads it
+ *
+ * \return void
+ */
+void VertexStream::begin ()
+{
+    ProfileScope scope("stream_wait");
+
+    section_ = static_cast<GLfloat*>(ring_.acquire());
+    base_ = static_cast<GLint>(ring_.getOffset() / stride_);
+    used_ = 0;
+}
+
+/*!
+ * Get room for vertices in the current section
+ *
+ * \param[in]  count The number of vertices
+ * \param[out] first The index to draw them from
+ *
+ * \return The vertices to write, nullptr if the section is full
+ */
+GLfloat* VertexStream::allocate (GLsizei count, GLint* first)
+{
+    if ((section_ == nullptr) || (used_ + count > capacity_))
+        return nullptr;
+
+    GLfloat* vertices = reinterpret_cast<GLfloat*>(
+        reinterpret_cast<char*>(section_) + used_ * stride_
+    );
+
+    *first = base_ + used_;
+    used_ += count;
+
+    return vertices;
+}
+
+/*!
+ * Finish writing the current section
+ *
+ * \return void
+ */
+void VertexStream::end ()
+{
+    ring_.release();
+
+    section_ = nullptr;
+}
+
+/*!
+ * Draw vertices of the current section with the current program
+ *
+ * \param[in] mode  The primitive, GL_TRIANGLES, GL_LINES, ...
+ * \param[in] first The index returned by allocate()
+ * \param[in] count The number of vertices
+ *
+ * \return void
+ */
+void VertexStream::draw (GLenum mode, GLint first, GLsizei count)
+{
+    ProfileScope scope("draw", true);
+
+    GLState::getInstance().bindVertexArray(vao_);
+    glDrawArrays(mode, first, count);
+}
+
+/*!
+ * Mark the current section as read by the commands submitted so far,
+ * called once per frame after the last draw
+ *
+ * \return void
+ */
+void VertexStream::fence ()
+{
+    ring_.fence();
+}
+
+/*!
+ * Get the number of vertices a frame can write
+ *
+ * \return The capacity
+ */
+GLsizei VertexStream::getCapacity () const
+{
+    return capacity_;
+}
+
+/*!
+ * Get the number of vertices allocated since begin()
+ *
+ * \return The number of vertices
+ */
+GLsizei VertexStream::getUsed () const
+{
+    return used_;
+}
+
+/*!
+ * Check if the ring is mapped persistently
+ *
+ * \return True if GL_ARB_buffer_storage is used
+ */
+bool VertexStream::isPersistent ()
+{
+    return ring_.isPersistent();
+}
@@ -0,0 +1,158 @@
+/*!
+ * \file  VertexStream.hpp
+ * \brief Class definition of a vertex buffer rewritten by the CPU every frame
+ */
+
+#ifndef __VERTEX_STREAM_HPP
+#define __VERTEX_STREAM_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "BufferRing.hpp"
+
+//! VertexStream
+/*!
+ * VertexStream is a vertex array reading a BufferRing, for geometry the CPU
+ * generates every frame: particles, UI, debug lines. Each frame writes
+ * its vertices straight into the section of the ring the GPU is done
+ * with, persistently mapped when GL_ARB_buffer_storage is available, so
+ * there is neither a driver copy nor an orphaned allocation, and the CPU
+ * only waits if it gets a whole ring ahead of the GPU.
+ *
+ * The attributes are given as for Mesh. A frame goes:
+ *
+ *     stream.begin();
+ *     GLfloat* vertices = stream.allocate(count, &first);  // any number of times
+ *     stream.end();
+ *     stream.draw(GL_TRIANGLES, first, count);             // after end()
+ *     stream.fence();                                      // once submitted
+ */
+class VertexStream
+{
+ private:
+    /*!
+     * The sections written in turn
+     */
+    BufferRing ring_;
+
+    /*!
+     * The vertex array object
+     */
+    GLuint vao_;
+
+    /*!
+     * The size of a vertex, in bytes
+     */
+    GLsizei stride_;
+
+    /*!
+     * The number of vertices a section holds
+     */
+    GLsizei capacity_;
+
+    /*!
+     * The section being written, nullptr outside begin() and end()
+     */
+    GLfloat* section_;
+
+    /*!
+     * The index of the first vertex of the section in the buffer
+     */
+    GLint base_;
+
+    /*!
+     * The number of vertices allocated in the section
+     */
+    GLsizei used_;
+
+ public:
+    /*!
+     * VertexStream constructor, must be called with a current context
+     *
+     * \param[in] attributes The number of components of each attribute
+     * \param[in] capacity   The number of vertices written per frame at most
+     * \param[in] sections   The number of frames in flight, 3 for triple
+     *                       buffering
+     */
+    VertexStream (
+        const std::vector<GLint>& attributes,
+        GLsizei capacity,
+        unsigned int sections = 3
+    );
+
+    VertexStream (const VertexStream&) = delete;
+    VertexStream& operator= (const VertexStream&) = delete;
+
+    /*!
+     * VertexStream destructor
+     */
+    ~VertexStream ();
+
+    /*!
+     * Start writing the next section, waits if the GPU still reads it
+     *
+     * \return void
+     */
+    void begin ();
+
+    /*!
+     * Get room for vertices in the current section
+     *
+     * \param[in]  count The number of vertices
+     * \param[out] first The index to draw them from
+     *
+     * \return The vertices to write, nullptr if the section is full
+     */
+    GLfloat* allocate (GLsizei count, GLint* first);
+
+    /*!
+     * Finish writing the current section
+     *
+     * \return void
+     */
+    void end ();
+
+    /*!
+     * Draw vertices of the current section with the current program
+     *
+     * \param[in] mode  The primitive, GL_TRIANGLES, GL_LINES, ...
+     * \param[in] first The index returned by allocate()
+     * \param[in] count The number of vertices
+     *
+     * \return void
+     */
+    void draw (GLenum mode, GLint first, GLsizei count);
+
+    /*!
+     * Mark the current section as read by the commands submitted so far,
+     * called once per frame after the last draw
+     *
+     * \return void
+     */
+    void fence ();
+
+    /*!
+     * Get the number of vertices a frame can write
+     *
+     * \return The capacity
+     */
+    GLsizei getCapacity () const;
+
+    /*!
+     * Get the number of vertices allocated since begin()
+     *
+     * \return The number of vertices
+     */
+    GLsizei getUsed () const;
+
+    /*!
+     * Check if the ring is mapped persistently
+     *
+     * \return True if GL_ARB_buffer_storage is used
+     */
+    bool isPersistent ();
+};
+
+#endif // __VERTEX_STREAM_HPP
@@ -0,0 +1,173 @@
+#include "WindowContext.hpp"
+
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+/*!
+ * WindowContext constructor
+ *
+ * \param[in] options The context options
+ */
+WindowContext::WindowContext (const RenderOptions& options)
+    : RenderContext(options),
+      window_(nullptr)
+{
+    LOG_DEBUG("Starting GLFW context, OpenGL 3.3");
+
+    // init GLFW
+    glfwInit();
+
+    // set required options for GLFW
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+    //  create a GLFWwindow object
+    window_ = glfwCreateWindow(
+        options_.width,
+        options_.height,
+        "Learning OpenGL",
+        nullptr,
+        nullptr
+    );
+
+    if (window_ == nullptr) {
+        LOG_ERROR("ERROR::GLFW::FAILED_TO_CREATE_WINDOW");
+        return;
+    }
+
+    glfwMakeContextCurrent(window_);
+
+    if (options_.swap_interval >= 0)
+        glfwSwapInterval(options_.swap_interval);
+
+    // use a modern approach to retrieving function pointers and extensions
+    glewExperimental = GL_TRUE;
+
+    // initialize GLEW to setup OpenGL function pointers
+    if (glewInit() != GLEW_OK) {
+        LOG_ERROR("ERROR::GLEW::FAILED_TO_INITIALIZE");
+
+        glfwDestroyWindow(window_);
+        window_ = nullptr;
+
+        return;
+    }
+
+    // define viewport dimensions
+    glViewport(0, 0, options_.width, options_.height);
+
+    // the shadowed bindings belong to the previous context, if any
+    GLState::getInstance().invalidate();
+
+    LOG_INFO(
+        "Renderer: " << glGetString(GL_RENDERER) << " ("
+        << glGetString(GL_VERSION) << ")"
+    );
+
+    initCapture();
+}
+
+/*!
+ * WindowContext destructor, terminates GLFW
+ */
+WindowContext::~WindowContext ()
+{
+    // the readbacks need the context
+    capture_.reset();
+
+    // terminate GLFW, clearing any resources allocated by GLFW
+    glfwTerminate();
+}
+
+/*!
+ * Check if the context was created
+ *
+ * \return True if the context is current
+ */
+bool WindowContext::isValid () const
+{
+    return window_ != nullptr;
+}
+
+/*!
+ * Check if the frame loop must stop
+ *
+ * \return True once the window is closed or the frame count reached
+ */
+bool WindowContext::shouldClose ()
+{
+    return glfwWindowShouldClose(window_) || RenderContext::shouldClose();
+}
+
+/*!
+ * Start a new frame loop, a window closed by the previous loop is
+ * opened again
+ *
+ * \param[in] name The prefix of the captured frame names
+ *
+ * \return void
+ */
+void WindowContext::restart (const std::string& name)
+{
+    glfwSetWindowShouldClose(window_, GL_FALSE);
+
+    RenderContext::restart(name);
+}
+
+/*!
+ * Start a frame: poll the events and bind the window framebuffer
+ *
+ * \return void
+ */
+void WindowContext::beginFrame ()
+{
+    startFrame();
+
+    // check if any events have been fired (key press/release, mouse moved,
+    // etc) and call corresponding response functions
+    {
+        ProfileScope scope("poll_events");
+
+        glfwPollEvents();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/*!
+ * End a frame: capture it if due and swap the buffers
+ *
+ * \return void
+ */
+void WindowContext::endFrame ()
+{
+    finishFrame();
+
+    // swap the screen buffers
+    ProfileScope scope("swap_buffers", true);
+
+    glfwSwapBuffers(window_);
+}
+
+/*!
+ * Get the seconds elapsed since GLFW was initialized
+ *
+ * \return The time, in seconds
+ */
+double WindowContext::getTime ()
+{
+    return glfwGetTime();
+}
+
+/*!
+ * Get the window, to install input callbacks
+ *
+ * \return The window
+ */
+GLFWwindow* WindowContext::getWindow ()
+{
+    return window_;
+}
@@ -0,0 +1,91 @@
+/*!
+ * \file  WindowContext.hpp
+ * \brief Class definition of a RenderContext drawing in a GLFW window
+ */
+
+#ifndef __WINDOW_CONTEXT_HPP
+#define __WINDOW_CONTEXT_HPP
+
+#include "RenderContext.hpp"
+
+//! WindowContext
+/*!
+ * WindowContext opens a fixed size window with an OpenGL 3.3 core context.
+ * The frame loop runs until the window is closed or the frame count is
+ * reached, frames are captured from the back buffer before each swap.
+ */
+class WindowContext : public RenderContext
+{
+ private:
+    /*!
+     * The window owning the context
+     */
+    GLFWwindow* window_;
+
+ public:
+    /*!
+     * WindowContext constructor
+     *
+     * \param[in] options The context options
+     */
+    explicit WindowContext (const RenderOptions& options);
+
+    /*!
+     * WindowContext destructor, terminates GLFW
+     */
+    ~WindowContext ();
+
+    /*!
+     * Check if the context was created
+     *
+     * \return True if the context is current
+     */
+    bool isValid () const override;
+
+    /*!
+     * Check if the frame loop must stop
+     *
+     * \return True once the window is closed or the frame count reached
+     */
+    bool shouldClose () override;
+
+    /*!
+     * Start a new frame loop, a window closed by the previous loop is
+     * opened again
+     *
+     * \param[in] name The prefix of the captured frame names
+     *
+     * \return void
+     */
+    void restart (const std::string& name) override;
+
+    /*!
+     * Start a frame: poll the events and bind the window framebuffer
+     *
+     * \return void
+     */
+    void beginFrame () override;
+
+    /*!
+     * End a frame: capture it if due and swap the buffers
+     *
+     * \return void
+     */
+    void endFrame () override;
+
+    /*!
+     * Get the seconds elapsed since GLFW was initialized
+     *
+     * \return The time, in seconds
+     */
+    double getTime () override;
+
+    /*!
+     * Get the window, to install input callbacks
+     *
+     * \return The window
+     */
+    GLFWwindow* getWindow () override;
+};
+
+#endif // __WINDOW_CONTEXT_HPP
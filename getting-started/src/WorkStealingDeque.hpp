@@ -0,0 +1,179 @@
+/*!
+ * \file  WorkStealingDeque.hpp
+ * \brief Class definition of the lock-free deque a JobSystem thread keeps
+ *        its jobs in
+ */
+
+#ifndef __WORK_STEALING_DEQUE_HPP
+#define __WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+//! WorkStealingDeque
+/*!
+ * WorkStealingDeque is the Chase-Lev deque, with the memory orders of Le et
+ * al., "Correct and Efficient Work-Stealing for Weak Memory Models". Its
+ * owner pushes and pops at the bottom, last in first out, so the jobs it
+ * spawns run while their data is still in its cache; any other thread
+ * steals from the top, the oldest and usually largest jobs. The owner only
+ * synchronizes with the thieves when they race for the last item.
+ *
+ * The capacity is fixed, a power of two: push() fails on a full deque and
+ * the caller runs the item itself, which bounds the memory of a job burst.
+ * T must be trivially copyable, a pointer in practice.
+ */
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "WorkStealingDeque slots are read while they may be overwritten"
+    );
+
+ private:
+    /*!
+     * The next item to steal, advanced by the thieves and by the owner
+     * taking the last item
+     */
+    std::atomic<std::int64_t> top_;
+
+    /*!
+     * Keeps the thieves' line apart from the owner's, without over-aligning
+     * the class, which C++14 can't new
+     */
+    char padding_[64];
+
+    /*!
+     * The slot after the last item, written by the owner only
+     */
+    std::atomic<std::int64_t> bottom_;
+
+    /*!
+     * The items, indexed modulo the capacity
+     */
+    std::unique_ptr<std::atomic<T>[]> slots_;
+
+    std::int64_t mask_;
+
+ public:
+    /*!
+     * WorkStealingDeque constructor
+     *
+     * \param[in] capacity The number of items, a power of two
+     */
+    explicit WorkStealingDeque (std::size_t capacity)
+        : top_(0),
+          bottom_(0),
+          slots_(new std::atomic<T>[capacity]),
+          mask_(static_cast<std::int64_t>(capacity) - 1)
+    {
+    }
+
+    WorkStealingDeque (const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator= (const WorkStealingDeque&) = delete;
+
+    /*!
+     * Add an item at the bottom, from the owner thread
+     *
+     * \param[in] item The item
+     *
+     * \return False if the deque is full
+     */
+    bool push (T item)
+    {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+
+        // a stale top only makes the deque look fuller than it is
+        if (bottom - top > mask_)
+            return false;
+
+        slots_[bottom & mask_].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /*!
+     * Take the item at the bottom, from the owner thread
+     *
+     * \param[out] item The item
+     *
+     * \return False if the deque is empty or a thief took the last item
+     */
+    bool pop (T& item)
+    {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+
+        // claim the slot before looking at top, the fence orders the two
+        // against a thief doing the opposite
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = slots_[bottom & mask_].load(std::memory_order_relaxed);
+
+        if (top < bottom)
+            return true;
+
+        // the last item, the thieves may want it too
+        bool won = top_.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        );
+
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+
+        return won;
+    }
+
+    /*!
+     * Take the item at the top, from any thread
+     *
+     * \param[out] item The item
+     *
+     * \return False if the deque is empty or another thread won the item
+     */
+    bool steal (T& item)
+    {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return false;
+
+        item = slots_[top & mask_].load(std::memory_order_relaxed);
+
+        return top_.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        );
+    }
+
+    /*!
+     * Get the number of items, a hint when other threads use the deque
+     *
+     * \return The number of items
+     */
+    std::size_t getSize () const
+    {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        return (bottom > top) ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+};
+
+#endif // __WORK_STEALING_DEQUE_HPP
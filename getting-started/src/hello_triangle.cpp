@@ -1,215 +1,167 @@
-#include <iostream>
 #include <cmath>
+#include <memory>
 
 // GLEW
 #define GLEW_STATIC
 #include <GL/glew.h>
 
-// GLFW
-#include <GLFW/glfw3.h>
-
+#include "FrameData.hpp"
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Mesh.hpp"
+#include "Profiler.hpp"
+#include "RenderQueue.hpp"
+#include "Scene.hpp"
 #include "Shader.hpp"
+#include "ShaderBuilder.hpp"
+#include "UniformBuffer.hpp"
 
-// window dimension
-const GLuint kWidth  = 800;
-const GLuint kHeight = 600;
-
-// prototypes
-void event_handler (GLFWwindow*, int, int, int, int);
+namespace {
 
-int hello_triangle () {
-    std::cout << "Starting GLFW context, OpenGL 3.3" << std::endl;
+class HelloTriangle : public Scene
+{
+ private:
+    ShaderFuture shader1_;
+    ShaderFuture shader2_;
 
-    // init GLFW
-    glfwInit();
+    // per-frame values shared with every program declaring FrameData
+    std::unique_ptr<UniformBuffer<FrameData>> frame_data_;
+    FrameData frame_;
 
-    // set required options for GLFW
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+    // the green of the last two updates, blended by interpolate()
+    GLfloat previous_green_;
+    GLfloat green_;
 
-    //  create a GLFWwindow object
-    GLFWwindow* window = glfwCreateWindow(
-        kWidth,
-        kHeight,
-        "Learning OpenGL",
-        nullptr,
-        nullptr
-    );
+    std::unique_ptr<Mesh> first_triangle_;
+    std::unique_ptr<Mesh> second_triangle_;
 
-    if (window == nullptr) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
+    // the draws are sorted by program before being issued
+    std::unique_ptr<RenderQueue> queue_;
 
-        return -1;
+ public:
+    HelloTriangle ()
+        : frame_(),
+          previous_green_(0.5f),
+          green_(0.5f)
+    {
     }
 
-    glfwMakeContextCurrent(window);
-
-    // configure key event handler
-    glfwSetKeyCallback(window, event_handler);
+    bool init (RenderContext& context) override
+    {
+        // both programs are compiled while the buffers are created and the
+        // first frames are drawn
+        ShaderBuilder builder;
+
+        shader1_ = builder.submit("./shader/vshader.vs", "./shader/fshader.frag");
+        shader2_ = builder.submit("./shader/vshader.vs", "./shader/fshader1.frag");
+
+        frame_data_.reset(new UniformBuffer<FrameData>("FrameData"));
+
+        LOG_DEBUG("Managing VAO, VBO AND EBO");
+
+        // initialize triangle vertices in normalized device coordinates (NDC)
+        first_triangle_.reset(new Mesh(
+            {
+                 0.5f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f, // Blue Top Right
+                 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, // Red Bottom Right
+                -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, // Blue Bottom Left
+                -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 0.0f, // Green Top Left
+            },
+            {
+                0, 1, 3, // First Triangle
+                1, 2, 3  // Second Triangle
+            },
+            {3, 3} // position, color
+        ));
+
+        // initialize triangle vertices in normalized device coordinates (NDC)
+        second_triangle_.reset(new Mesh(
+            {
+                 0.6f,  0.0f, 0.0f, // Left point
+                 0.75f,  0.4f, 0.0f, // Top point
+                 0.9f,  0.0f, 0.0f, // Right point
+                 0.75f, -0.4f, 0.0f  // Bottom Point
+            },
+            {
+                0, 1, 3, // First Triangle
+                1, 2, 3  // Second Triangle
+            },
+            {3} // position
+        ));
+
+        queue_.reset(new RenderQueue(context.getFrameArena()));
+
+        return true;
+    }
 
-    // use a modern approach to retrieving function pointers and extensions
-    glewExperimental = GL_TRUE;
+    void update (double time, double) override
+    {
+        previous_green_ = green_;
+        green_ = (sin(time) / 2) + 0.5;
+    }
 
-    // initialize GLEW to setup OpenGL function pointers
-    if (glewInit() != GLEW_OK) {
-        std::cout << "Failed to initialize GLEW" << std::endl;
+    void interpolate (float alpha) override
+    {
+        GLfloat green_value = previous_green_ * (1.0f - alpha) + green_ * alpha;
 
-        return -1;
+        frame_.dynamic_color = {{0.0f, green_value, 0.0f, 1.0f}};
     }
 
-    // define viewport dimensions
-    glViewport(0, 0, kWidth, kHeight);
-
-    Shader *shader1 = new Shader("./shader/vshader.vs", "./shader/fshader.frag");
-    Shader *shader2 = new Shader("./shader/vshader.vs", "./shader/fshader1.frag");
-
-    // initialize triangle vertices in normalized device coordinates (NDC)
-    GLfloat first_triangle[] = {
-         0.5f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f, // Blue Top Right
-         0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, // Red Bottom Right
-        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, // Blue Bottom Left
-        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 0.0f, // Green Top Left
-    };
-
-    // initialize triangle vertices in normalized device coordinates (NDC)
-    GLfloat second_triangle[] = {
-         0.6f,  0.0f, 0.0f, // Left point
-         0.75f,  0.4f, 0.0f, // Top point
-         0.9f,  0.0f, 0.0f, // Right point
-         0.75f, -0.4f, 0.0f  // Bottom Point
-    };
-
-    GLuint indices[] = {
-        0, 1, 3, // First Triangle
-        1, 2, 3  // Second Triangle
-    };
-
-    // vertex array object
-    GLuint VAO[2];
-    // vertex buffer object
-    GLuint VBO[2];
-    // element buffer object
-    GLuint EBO;
-
-    glGenVertexArrays(2, VAO);
-    glGenBuffers(2, VBO);
-    glGenBuffers(1, &EBO);
-
-    std::cout << "Managing VAO, VBO AND EBO" << std::endl;
-
-    // First triangle
-    glBindVertexArray(VAO[0]);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        sizeof(first_triangle),
-        first_triangle,
-        GL_STATIC_DRAW
-    );
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        sizeof(indices),
-        indices,
-        GL_STATIC_DRAW
-    );
-    // vertex_shader position
-    glVertexAttribPointer(
-        0, // which vertex we want to configure
-        3, // the size of the vertex attribute
-        GL_FLOAT, // the type of the data (a vec* in GLSL consists of floating point values)
-        GL_FALSE, // if we want the data to be normalized
-        6 * sizeof(GLfloat), // the space between consecutive vextex attribute sets
-        (GLvoid*)0 // the offset of where the position data begins in the buffer
-    );
-    glEnableVertexAttribArray(0);
-    // vertex_shader color
-    glVertexAttribPointer(
-        1, // which vertex we want to configure
-        3, // the size of the vertex attribute
-        GL_FLOAT, // the type of the data (a vec* in GLSL consists of floating point values)
-        GL_FALSE, // if we want the data to be normalized
-        6 * sizeof(GLfloat), // the space between consecutive vextex attribute sets
-        (GLvoid*) (3 * sizeof(GLfloat)) // the offset of where the position data begins in the buffer
-    );
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // Second triangle
-    glBindVertexArray(VAO[1]);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        sizeof(second_triangle),
-        second_triangle,
-        GL_STATIC_DRAW
-    );
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        sizeof(indices),
-        indices,
-        GL_STATIC_DRAW
-    );
-    glVertexAttribPointer(
-        0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0
-    );
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // game loop
-    while (!glfwWindowShouldClose(window)) {
-        // check if any events have been fired (key press/release, mouse moved,
-        // etc) and call corresponding response functions
-        glfwPollEvents();
-
-        // render
+    void render () override
+    {
         // clear the color buffer
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        frame_data_->update(frame_);
 
         // ..:: Drawing code (in Game Loop) ::..
-        shader1->use();
-        glBindVertexArray(VAO[0]);
-        glDrawElements(
-            GL_TRIANGLES, // the mode we want to draw
-            6, // count or number of elements we'd like to draw
-            GL_UNSIGNED_INT, // the type of the indices
-            0 // offset of the EBO
-        );
-
-        shader2->use();
-        GLfloat time = glfwGetTime();
-        GLfloat green_value = (sin(time) / 2) + 0.5;
-        GLint location = glGetUniformLocation(
-            shader2->getProgram(), "dynamic_color"
-        );
-
-        glUniform4f(location, 0.0f, green_value, 0.0f, 1.0f);
-
-        glBindVertexArray(VAO[1]);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // unbind Vertex Array Object
-        glBindVertexArray(0);
-
-        // swap the screen buffers
-        glfwSwapBuffers(window);
+        if (shader1_.isReady()) {
+            queue_->push(
+                shader1_.get()->getProgram(), 0,
+                first_triangle_->getVertexArray(), first_triangle_->getCount(),
+                first_triangle_->getIndexType()
+            );
+        }
+
+        if (shader2_.isReady()) {
+            queue_->push(
+                shader2_.get()->getProgram(), 0,
+                second_triangle_->getVertexArray(), second_triangle_->getCount(),
+                second_triangle_->getIndexType()
+            );
+        }
+
+        queue_->submit();
+
+        // the GPU reads this frame's data until the fence signals
+        frame_data_->fence();
     }
 
-    // Properly de-allocate all resources once they've outlived their purpose
-    glDeleteVertexArrays(2, VAO);
-    glDeleteBuffers(2, VBO);
-    glDeleteBuffers(1, &EBO);
+    void shutdown () override
+    {
+        // Properly de-allocate all resources once they've outlived their purpose
+        queue_.reset();
+        first_triangle_.reset();
+        second_triangle_.reset();
+        frame_data_.reset();
+
+        // a program still compiling is resolved so its objects are deleted
+        // with the shader
+        shader1_.get();
+        shader2_.get();
+        shader1_ = ShaderFuture();
+        shader2_ = ShaderFuture();
+    }
+};
 
-    // terminate GLFW, clearing any resources allocated by GLFW
-    glfwTerminate();
+} // namespace
 
-    return 0;
+std::unique_ptr<Scene> createHelloTriangle ()
+{
+    return std::unique_ptr<Scene>(new HelloTriangle());
 }
-
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// GLEW
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include "GLState.hpp"
+#include "InstanceBuffer.hpp"
+#include "Log.hpp"
+#include "Mesh.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
+#include "Shader.hpp"
+
+namespace {
+
+// a 1000 x 1000 grid covering the viewport
+const int kGrid = 1000;
+const GLsizei kQuads = kGrid * kGrid;
+
+// the quads whose model matrices are composed at once
+const GLsizei kBatch = static_cast<GLsizei>(InstanceTransforms::kCapacity);
+
+const GLsizei kLayers = 4;
+const GLsizei kLayerSize = 8;
+
+constexpr UniformId kModel("model");
+constexpr UniformId kTint("tint");
+constexpr UniformId kLayer("layer");
+constexpr UniformId kTextureLayers("layers");
+
+// a checkerboard per layer, each in its own color
+GLuint createLayers ()
+{
+    const unsigned char colors[kLayers][3] = {
+        {255, 96, 96}, {96, 255, 96}, {96, 96, 255}, {255, 255, 96}
+    };
+
+    std::vector<unsigned char> pixels;
+
+    for (GLsizei layer = 0; layer < kLayers; ++layer) {
+        for (GLsizei y = 0; y < kLayerSize; ++y) {
+            for (GLsizei x = 0; x < kLayerSize; ++x) {
+                bool dark = ((x + y) % 2) != 0;
+
+                for (int c = 0; c < 3; ++c)
+                    pixels.push_back(dark ? colors[layer][c] / 2 : colors[layer][c]);
+
+                pixels.push_back(255);
+            }
+        }
+    }
+
+    GLuint texture;
+
+    glGenTextures(1, &texture);
+    GLState::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+    glTexImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, kLayerSize, kLayerSize, kLayers, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()
+    );
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    return texture;
+}
+
+class InstancingStress : public Scene
+{
+ private:
+    enum Mode
+    {
+        // alternate the two paths, one frame each
+        kCompare,
+        kPerDraw,
+        kInstanced
+    };
+
+    // the same quads, drawn one call each or in a single instanced call
+    std::unique_ptr<Shader> per_draw_shader_;
+    std::unique_ptr<Shader> instanced_shader_;
+
+    std::unique_ptr<Mesh> quad_;
+    std::unique_ptr<InstanceBuffer> instance_buffer_;
+    std::vector<InstanceData> instances_;
+
+    GLuint layers_;
+
+    // changed with the P key
+    Mode mode_;
+    unsigned int frame_;
+
+    // CPU time spent issuing each path
+    double per_draw_ms_;
+    unsigned int per_draw_frames_;
+    double instanced_ms_;
+    unsigned int instanced_frames_;
+
+    void renderPerDraw ()
+    {
+        ProfileScope scope("per_draw", true);
+
+        per_draw_shader_->use();
+        per_draw_shader_->set(kTextureLayers, 0);
+
+        GLState::getInstance().bindVertexArray(quad_->getVertexArray());
+
+        // what the exercises do for each object: set its uniforms, draw
+        for (const InstanceData& instance : instances_) {
+            per_draw_shader_->set(kModel, instance.model);
+            per_draw_shader_->set(kTint, std::array<GLfloat, 4>{{
+                instance.color[0], instance.color[1],
+                instance.color[2], instance.color[3]
+            }});
+            per_draw_shader_->set(kLayer, instance.layer);
+
+            glDrawElements(
+                GL_TRIANGLES, quad_->getCount(), quad_->getIndexType(), 0
+            );
+        }
+    }
+
+    void renderInstanced ()
+    {
+        instanced_shader_->use();
+        instanced_shader_->set(kTextureLayers, 0);
+
+        instance_buffer_->draw(*quad_);
+    }
+
+ public:
+    InstancingStress ()
+        : layers_(0),
+          mode_(kCompare),
+          frame_(0),
+          per_draw_ms_(0.0),
+          per_draw_frames_(0),
+          instanced_ms_(0.0),
+          instanced_frames_(0)
+    {
+    }
+
+    bool init (RenderContext&) override
+    {
+        LOG_DEBUG("Creating shader programs");
+
+        per_draw_shader_.reset(new Shader(
+            "./shader/quad.vs",
+            "./shader/quad.frag"
+        ));
+
+        instanced_shader_.reset(new Shader(
+            "./shader/quad_instanced.vs",
+            "./shader/quad.frag"
+        ));
+
+        quad_.reset(new Mesh(
+            {
+                // positions        // texture coords
+                 0.5f,  0.5f, 0.0f, 1.0f, 1.0f, // top right
+                 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, // bottom right
+                -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, // bottom left
+                -0.5f,  0.5f, 0.0f, 0.0f, 1.0f  // top left
+            },
+            {
+                0, 1, 3, // First Triangle
+                1, 2, 3  // Second Triangle
+            },
+            {3, 2} // position, texture coords
+        ));
+
+        LOG_DEBUG("Generating " << kQuads << " quads");
+
+        const GLfloat cell = 2.0f / kGrid;
+        const Vec3 axis = {0.0f, 0.0f, 1.0f};
+        InstanceTransforms transforms;
+
+        instances_.resize(kQuads);
+
+        // the model matrices are composed a batch of quads at a time
+        for (GLsizei first = 0; first < kQuads; first += kBatch) {
+            GLsizei count = std::min(kQuads - first, kBatch);
+
+            transforms.clear();
+
+            for (GLsizei i = first; i < first + count; ++i) {
+                int x = i % kGrid;
+                int y = i / kGrid;
+
+                transforms.add(
+                    {-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell, 0.0f},
+                    makeRotation(axis, (x + y) * 0.01f),
+                    {cell * 0.9f, cell * 0.9f, 1.0f}
+                );
+            }
+
+            transforms.compose();
+
+            for (GLsizei i = 0; i < count; ++i)
+                instances_[first + i].model = transforms.getModel(i);
+        }
+
+        for (int y = 0; y < kGrid; ++y) {
+            for (int x = 0; x < kGrid; ++x) {
+                InstanceData& instance = instances_[y * kGrid + x];
+
+                instance.color[0] = 0.5f + 0.5f * x / kGrid;
+                instance.color[1] = 0.5f + 0.5f * y / kGrid;
+                instance.color[2] = 1.0f;
+                instance.color[3] = 1.0f;
+
+                instance.layer = static_cast<GLfloat>((x / 50 + y / 50) % kLayers);
+            }
+        }
+
+        // the quads do not move, they are uploaded once
+        instance_buffer_.reset(new InstanceBuffer(kQuads));
+        instance_buffer_->attach(*quad_);
+        instance_buffer_->update(instances_.data(), kQuads);
+
+        layers_ = createLayers();
+
+        return true;
+    }
+
+    void render () override
+    {
+        // clear the color buffer
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        GLState::getInstance().bindTextureUnit(0, GL_TEXTURE_2D_ARRAY, layers_);
+
+        bool per_draw = (mode_ == kPerDraw) || ((mode_ == kCompare) && (frame_ % 2 == 0));
+        auto start = std::chrono::steady_clock::now();
+
+        if (per_draw)
+            renderPerDraw();
+        else
+            renderInstanced();
+
+        double elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+
+        if (per_draw) {
+            per_draw_ms_ += elapsed;
+            ++per_draw_frames_;
+        } else {
+            instanced_ms_ += elapsed;
+            ++instanced_frames_;
+        }
+
+        ++frame_;
+    }
+
+    void shutdown () override
+    {
+        if (per_draw_frames_ > 0) {
+            LOG_INFO(
+                "Per-draw path: " << per_draw_frames_ << " frames, "
+                << per_draw_ms_ / per_draw_frames_ << " ms CPU, "
+                << kQuads << " draws per frame"
+            );
+        }
+
+        if (instanced_frames_ > 0) {
+            LOG_INFO(
+                "Instanced path: " << instanced_frames_ << " frames, "
+                << instanced_ms_ / instanced_frames_ << " ms CPU, "
+                << "1 draw per frame"
+            );
+        }
+
+        GLState::getInstance().forgetTexture(layers_);
+        glDeleteTextures(1, &layers_);
+
+        // Properly de-allocate all resources once they've outlived their purpose
+        instance_buffer_.reset();
+        quad_.reset();
+        instanced_shader_.reset();
+        per_draw_shader_.reset();
+    }
+
+    void onKey (int key, int) override
+    {
+        if (key == GLFW_KEY_P)
+            mode_ = static_cast<Mode>((mode_ + 1) % 3);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Scene> createInstancingStress ()
+{
+    return std::unique_ptr<Scene>(new InstancingStress());
+}
@@ -1,63 +1,185 @@
 #include <iostream>
-#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 // GLEW
 #define GLEW_STATIC
 #include <GL/glew.h>
 
-// GLFW
-#include <GLFW/glfw3.h>
-
-#include "Shader.hpp"
-
-// used in texture exercise
-GLfloat mix_ratio = 0.5f;
-
-// prototypes
-void event_handler (GLFWwindow*, int, int, int, int);
-void hello_triangle ();
-void shader_exercise1 ();
-void shader_exercise2 ();
-void shader_exercise3 ();
-void texture_exercise1 (GLfloat &mix_ratio);
-void texture_exercise2 (GLfloat &mix_ratio);
-
-int main () {
-    //hello_triangle();
-    //shader_exercise1();
-    //shader_exercise2();
-    //shader_exercise3();
-    //texture_exercise1(mix_ratio);
-    texture_exercise2(mix_ratio);
-    return 0;
+#include "Profiler.hpp"
+#include "RenderContext.hpp"
+#include "SceneRegistry.hpp"
+#include "SceneRunner.hpp"
+#include "ShaderCache.hpp"
+
+namespace {
+
+//! LaunchOptions
+/*!
+ * LaunchOptions holds the command line: the scenes to run and the context
+ * they run with
+ */
+struct LaunchOptions
+{
+    /*!
+     * The context options
+     */
+    RenderOptions render;
+
+    /*!
+     * The scene to run
+     */
+    std::string scene = "texture_exercise2";
+
+    /*!
+     * Run every scene back to back instead
+     */
+    bool all = false;
+
+    /*!
+     * Print the scene names and exit
+     */
+    bool list = false;
+
+    /*!
+     * Print the scope timings of each scene
+     */
+    bool profile = false;
+
+    /*!
+     * The Chrome trace file to write, empty to skip it
+     */
+    std::string trace;
+};
+
+int usage ()
+{
+    std::cout << "usage: game [options]\n"
+              << "    --scene NAME        run a single scene, texture_exercise2 by default\n"
+              << "    --all               run every scene back to back on one context\n"
+              << "    --list              print the scene names\n"
+              << "    --profile           print the CPU and GPU scope timings of each scene\n"
+              << "    --trace FILE        write the scope timings as a Chrome trace\n"
+              << "    --headless          render offscreen through EGL\n"
+              << "    --frames N          stop after N frames (100 when headless)\n"
+              << "    --size WxH          framebuffer size, 800x600 by default\n"
+              << "    --capture DIR       write the captured frames to DIR\n"
+              << "    --golden DIR        compare the captured frames against DIR\n"
+              << "    --capture-every N   capture every Nth frame, not only the last\n"
+              << "    --tolerance N       largest channel difference against a golden\n"
+              << "    --fps N             cap the frame rate at N frames per second\n"
+              << "    --update-rate HZ    update the scenes HZ times per second and\n"
+              << "                        interpolate the frames in between\n"
+              << "    --swap-interval N   wait for N vertical syncs per buffer swap\n"
+              << std::flush;
+
+    return -1;
 }
 
-// key event handler
-void event_handler (
-    GLFWwindow* window, int key, int scancode, int action, int mode
-) {
-    std::cout << "Key: " << key << std::endl;
-    std::cout << "Action: " << action << std::endl;
-
-    if ((key == GLFW_KEY_ESCAPE) && (action == GLFW_PRESS)) {
-        glfwSetWindowShouldClose(window, GL_TRUE);
-    } else if ((key == GLFW_KEY_W) && (action == GLFW_PRESS)) {
-        // enable wireframe mode
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    } else if ((key == GLFW_KEY_F) && (action == GLFW_PRESS)) {
-        // enable wireframe mode
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    } else if (key == GLFW_KEY_UP) {
-        mix_ratio += 0.1f;
-
-        if (mix_ratio > 1.0f)
-            mix_ratio = 1.0f;
-    } else if (key == GLFW_KEY_DOWN) {
-        mix_ratio -= 0.1f;
-
-        if (mix_ratio < 0.0f)
-            mix_ratio = 0.0f;
+bool parseOptions (int argc, char** argv, LaunchOptions& launch)
+{
+    RenderOptions& options = launch.render;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!std::strcmp(argv[i], "--headless")) {
+            options.headless = true;
+            continue;
+        } else if (!std::strcmp(argv[i], "--all")) {
+            launch.all = true;
+            continue;
+        } else if (!std::strcmp(argv[i], "--list")) {
+            launch.list = true;
+            continue;
+        } else if (!std::strcmp(argv[i], "--profile")) {
+            launch.profile = true;
+            continue;
+        }
+
+        // every other switch takes a value
+        if (value == nullptr)
+            return false;
+
+        if (!std::strcmp(argv[i], "--scene")) {
+            launch.scene = value;
+        } else if (!std::strcmp(argv[i], "--trace")) {
+            launch.trace = value;
+        } else if (!std::strcmp(argv[i], "--frames")) {
+            options.frames = std::strtoul(value, nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--size")) {
+            if (
+                (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2) ||
+                (options.width <= 0) || (options.height <= 0)
+            ) {
+                return false;
+            }
+        } else if (!std::strcmp(argv[i], "--capture")) {
+            options.capture_directory = value;
+        } else if (!std::strcmp(argv[i], "--golden")) {
+            options.golden_directory = value;
+        } else if (!std::strcmp(argv[i], "--capture-every")) {
+            options.capture_interval = std::strtoul(value, nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--tolerance")) {
+            options.tolerance = std::atoi(value);
+        } else if (!std::strcmp(argv[i], "--fps")) {
+            options.max_fps = std::strtod(value, nullptr);
+        } else if (!std::strcmp(argv[i], "--update-rate")) {
+            options.update_rate = std::strtod(value, nullptr);
+        } else if (!std::strcmp(argv[i], "--swap-interval")) {
+            options.swap_interval = std::atoi(value);
+        } else {
+            return false;
+        }
+
+        ++i;
     }
+
+    return true;
 }
 
+} // namespace
 
+int main (int argc, char** argv) {
+    LaunchOptions launch;
+
+    if (!parseOptions(argc, argv, launch))
+        return usage();
+
+    if (launch.list) {
+        for (const std::string& name : SceneRegistry::getInstance().getNames())
+            std::cout << name << std::endl;
+
+        return 0;
+    }
+
+    SceneRunner runner(launch.render);
+
+    if (!runner.isValid())
+        return -1;
+
+    if (launch.profile || !launch.trace.empty())
+        Profiler::getInstance().enable(!launch.trace.empty());
+
+    unsigned int failures = 0;
+
+    if (launch.all)
+        failures = runner.runAll();
+    else if (!runner.run(launch.scene))
+        failures = 1;
+
+    runner.report(std::cout);
+    ShaderCache::getInstance().report(std::cout);
+
+    if (!launch.trace.empty() && !Profiler::getInstance().writeTrace(launch.trace))
+        failures++;
+
+    // a scene that failed or a frame that differs from its golden frame fails
+    // the run
+    if (failures > 0)
+        return -1;
+
+    return (runner.getContext().getMismatches() > 0) ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// GLEW
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include "GLState.hpp"
+#include "InstanceBuffer.hpp"
+#include "Log.hpp"
+#include "MeshPool.hpp"
+#include "MultiDrawBatch.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
+#include "Shader.hpp"
+
+namespace {
+
+// a 64 x 64 grid of objects, each one of the meshes
+const int kGrid = 64;
+const int kObjects = kGrid * kGrid;
+const int kMeshes = 16;
+
+// the objects whose model matrices are composed at once
+const int kBatch = static_cast<int>(InstanceTransforms::kCapacity);
+
+const char* getPathName (MultiDrawPath path)
+{
+    switch (path) {
+        case MultiDrawPath::kIndirect:
+            return "glMultiDrawElementsIndirect";
+        case MultiDrawPath::kBaseInstance:
+            return "base instance draws";
+        case MultiDrawPath::kAttributes:
+            return "attribute offset draws";
+    }
+
+    return "";
+}
+
+// a regular polygon as a triangle fan around its center
+void makePolygon (int sides, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    const GLfloat kPi = 3.14159265f;
+
+    // position, texture coords
+    vertices = {0.0f, 0.0f, 0.0f, 0.5f, 0.5f};
+    indices.clear();
+
+    for (int i = 0; i < sides; ++i) {
+        GLfloat angle = 2.0f * kPi * i / sides;
+        GLfloat x = 0.5f * std::cos(angle);
+        GLfloat y = 0.5f * std::sin(angle);
+
+        vertices.insert(vertices.end(), {x, y, 0.0f, x + 0.5f, y + 0.5f});
+
+        indices.push_back(0);
+        indices.push_back(1 + i);
+        indices.push_back(1 + (i + 1) % sides);
+    }
+}
+
+class MultiDraw : public Scene
+{
+ private:
+    std::unique_ptr<Shader> shader_;
+
+    // every mesh in the same buffers, drawn by one call
+    std::unique_ptr<MeshPool> pool_;
+    std::vector<MeshRange> meshes_;
+    std::unique_ptr<MultiDrawBatch> batch_;
+
+    // the supported path, M steps down to the fallbacks
+    MultiDrawPath supported_;
+
+ public:
+    MultiDraw ()
+        : supported_(MultiDrawPath::kIndirect)
+    {
+    }
+
+    bool init (RenderContext&) override
+    {
+        shader_.reset(new Shader(
+            "./shader/quad_instanced.vs",
+            "./shader/instance_color.frag"
+        ));
+
+        pool_.reset(new MeshPool({3, 2})); // position, texture coords
+
+        std::vector<GLfloat> vertices;
+        std::vector<GLuint> indices;
+
+        for (int i = 0; i < kMeshes; ++i) {
+            makePolygon(3 + i, vertices, indices);
+            meshes_.push_back(pool_->add(vertices, indices));
+        }
+
+        batch_.reset(new MultiDrawBatch(*pool_));
+        supported_ = batch_->getPath();
+
+        const GLfloat cell = 2.0f / kGrid;
+        const Vec3 axis = {0.0f, 0.0f, 1.0f};
+        InstanceTransforms transforms;
+
+        // the model matrices are composed a batch of objects at a time
+        for (int first = 0; first < kObjects; first += kBatch) {
+            int count = std::min(kObjects - first, kBatch);
+
+            transforms.clear();
+
+            for (int i = first; i < first + count; ++i) {
+                int x = i % kGrid;
+                int y = i / kGrid;
+
+                transforms.add(
+                    {-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell, 0.0f},
+                    makeRotation(axis, (x * 7 + y * 3) * 0.05f),
+                    {cell * 0.9f, cell * 0.9f, 1.0f}
+                );
+            }
+
+            transforms.compose();
+
+            for (int i = first; i < first + count; ++i) {
+                int x = i % kGrid;
+                int y = i / kGrid;
+
+                InstanceData data = {
+                    transforms.getModel(i - first),
+                    {
+                        static_cast<GLfloat>(x) / kGrid,
+                        static_cast<GLfloat>(y) / kGrid,
+                        0.5f + 0.5f * ((x + y) % 2),
+                        1.0f
+                    },
+                    0.0f
+                };
+
+                batch_->push(meshes_[(x * 5 + y * 11) % kMeshes], data);
+            }
+        }
+
+        // the objects do not move, the commands are uploaded once
+        batch_->upload();
+
+        LOG_INFO(
+            pool_->getVertexCount() << " vertices and "
+            << pool_->getIndexCount() << " indices in the pool, "
+            << batch_->getSize() << " draws through "
+            << getPathName(batch_->getPath())
+        );
+
+        return true;
+    }
+
+    void render () override
+    {
+        // clear the color buffer
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        shader_->use();
+
+        batch_->draw();
+    }
+
+    void shutdown () override
+    {
+        // Properly de-allocate all resources once they've outlived their purpose
+        batch_.reset();
+        pool_.reset();
+        shader_.reset();
+    }
+
+    void onKey (int key, int) override
+    {
+        if (key != GLFW_KEY_M)
+            return;
+
+        // every path the driver supports gives the same frame
+        int next = (static_cast<int>(batch_->getPath()) + 1) %
+            (static_cast<int>(MultiDrawPath::kAttributes) + 1);
+
+        if (next < static_cast<int>(supported_))
+            next = static_cast<int>(supported_);
+
+        batch_->setPath(static_cast<MultiDrawPath>(next));
+
+        LOG_INFO("Drawing through " << getPathName(batch_->getPath()));
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Scene> createMultiDraw ()
+{
+    return std::unique_ptr<Scene>(new MultiDraw());
+}
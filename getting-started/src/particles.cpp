@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+
+// GLEW
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
+#include "Shader.hpp"
+#include "VertexStream.hpp"
+
+namespace {
+
+const int kParticles = 20000;
+
+// each particle is a streak from where it was to where it is
+const int kVerticesPerParticle = 2;
+
+// seconds from launch to respawn
+const float kLifetime = 2.0f;
+
+const float kGravity = -1.2f;
+
+class Particles : public Scene
+{
+ private:
+    std::unique_ptr<Shader> shader_;
+
+    // rewritten by the CPU every frame
+    std::unique_ptr<VertexStream> stream_;
+
+    // the time of the last two updates, and the one drawn between them
+    float previous_time_;
+    float update_time_;
+    float time_;
+
+    // write one particle, its motion only depends on the time
+    void writeParticle (int index, GLfloat* vertices) const
+    {
+        const float kPi = 3.14159265f;
+
+        // spread the launches and the directions with the golden ratio
+        float phase = std::fmod(index * 0.618034f, 1.0f);
+        float age = std::fmod(time_ + phase * kLifetime, kLifetime);
+        float angle = kPi * (0.3f + 0.4f * std::fmod(index * 0.754878f, 1.0f));
+        float speed = 1.0f + 0.6f * std::fmod(index * 0.569840f, 1.0f);
+
+        float vx = speed * std::cos(angle);
+        float vy = speed * std::sin(angle);
+
+        float x = vx * age;
+        float y = -0.9f + vy * age + 0.5f * kGravity * age * age;
+
+        // the tail is where the particle was 1/60 s ago
+        float tail = std::max(age - 1.0f / 60.0f, 0.0f);
+        float tail_x = vx * tail;
+        float tail_y = -0.9f + vy * tail + 0.5f * kGravity * tail * tail;
+
+        float fade = 1.0f - age / kLifetime;
+
+        GLfloat particle[] = {
+            // position       // color
+            x, y, 0.0f,       1.0f, 0.8f * fade + 0.2f, 0.3f * fade,
+            tail_x, tail_y, 0.0f, 0.5f * fade, 0.2f * fade, 0.1f * fade
+        };
+
+        std::copy(std::begin(particle), std::end(particle), vertices);
+    }
+
+ public:
+    Particles ()
+        : previous_time_(0.0f),
+          update_time_(0.0f),
+          time_(0.0f)
+    {
+    }
+
+    bool init (RenderContext&) override
+    {
+        shader_.reset(new Shader(
+            "./shader/vshader.vs",
+            "./shader/fshader.frag"
+        ));
+
+        stream_.reset(new VertexStream(
+            {3, 3}, // position, color
+            kParticles * kVerticesPerParticle
+        ));
+
+        LOG_INFO(
+            "Streaming " << kParticles << " particles, "
+            << (stream_->isPersistent() ? "persistent" : "unsynchronized")
+            << " mapping"
+        );
+
+        return true;
+    }
+
+    void update (double time, double) override
+    {
+        previous_time_ = update_time_;
+        update_time_ = static_cast<float>(time);
+    }
+
+    void interpolate (float alpha) override
+    {
+        time_ = previous_time_ * (1.0f - alpha) + update_time_ * alpha;
+    }
+
+    void render () override
+    {
+        // clear the color buffer
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.1f, 0.1f, 0.15f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        GLint first = 0;
+        GLsizei count = kParticles * kVerticesPerParticle;
+
+        stream_->begin();
+
+        {
+            ProfileScope scope("simulate");
+
+            GLfloat* vertices = stream_->allocate(count, &first);
+
+            for (int i = 0; i < kParticles; ++i)
+                writeParticle(i, vertices + i * kVerticesPerParticle * 6);
+        }
+
+        stream_->end();
+
+        shader_->use();
+        stream_->draw(GL_LINES, first, count);
+
+        // the GPU reads this frame's section until the fence signals
+        stream_->fence();
+    }
+
+    void shutdown () override
+    {
+        // Properly de-allocate all resources once they've outlived their purpose
+        stream_.reset();
+        shader_.reset();
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Scene> createParticles ()
+{
+    return std::unique_ptr<Scene>(new Particles());
+}
@@ -0,0 +1,200 @@
+#include <memory>
+
+// GLEW
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include <SOIL/SOIL.h>
+
+#include "FrameData.hpp"
+#include "GLState.hpp"
+#include "Log.hpp"
+#include "Mesh.hpp"
+#include "Profiler.hpp"
+#include "RenderQueue.hpp"
+#include "Scene.hpp"
+#include "Shader.hpp"
+#include "TextureManager.hpp"
+#include "UniformBuffer.hpp"
+#include "VertexFormat.hpp"
+
+namespace {
+
+// uniforms hashed at compile time
+constexpr UniformId kTexture0("texture0");
+constexpr UniformId kTexture1("texture1");
+
+// position, color, texture coords
+typedef PackedVertex<Float3, Color4ub, Half2> Vertex;
+
+// the two exercises draw the same quad, the second one repeats the
+// texture coordinates over [0, 2] and clamps the container to its edge
+class TextureExercise : public Scene
+{
+ private:
+    // the texture coordinates of the top right corner
+    GLfloat coords_;
+
+    // the wrap mode of the container texture
+    GLint wrap_;
+
+    std::unique_ptr<Shader> shader_;
+
+    // per-frame values shared with every program declaring FrameData
+    std::unique_ptr<UniformBuffer<FrameData>> frame_data_;
+    FrameData frame_;
+
+    std::unique_ptr<Mesh> quad_;
+
+    // decoded on worker threads, the textures show a placeholder until
+    // their image is uploaded
+    std::unique_ptr<TextureManager> textures_;
+    GLuint texture0_;
+    GLuint texture1_;
+
+    // the draws bind the two textures through their texture set
+    std::unique_ptr<RenderQueue> queue_;
+    std::uint16_t texture_set_;
+
+    // changed with the up and down keys
+    GLfloat mix_ratio_;
+
+ public:
+    TextureExercise (GLfloat coords, GLint wrap)
+        : coords_(coords),
+          wrap_(wrap),
+          frame_(),
+          texture0_(0),
+          texture1_(0),
+          texture_set_(0),
+          mix_ratio_(0.5f)
+    {
+    }
+
+    bool init (RenderContext& context) override
+    {
+        LOG_DEBUG("Creating shader programs");
+
+        shader_.reset(new Shader(
+            "./shader/texture.vs",
+            "./shader/texture.frag"
+        ));
+
+        frame_data_.reset(new UniformBuffer<FrameData>("FrameData"));
+
+        LOG_DEBUG("Managing VAO, VBO AND EBO");
+
+        // initialize triangle vertices in normalized device coordinates (NDC)
+        // 20 bytes per vertex, a float vec3, 4 normalized bytes and 2 halfs
+        quad_.reset(new Mesh(
+            std::vector<Vertex>{
+                Vertex::make({ 0.5f,  0.5f, 0.0f}, packColor(1.0f, 0.0f, 0.0f), packHalf2(coords_, coords_)), // top right
+                Vertex::make({ 0.5f, -0.5f, 0.0f}, packColor(0.0f, 1.0f, 0.0f), packHalf2(coords_, 0.0f)), // bottom right
+                Vertex::make({-0.5f, -0.5f, 0.0f}, packColor(0.0f, 0.0f, 1.0f), packHalf2(0.0f, 0.0f)), // bottom left
+                Vertex::make({-0.5f,  0.5f, 0.0f}, packColor(1.0f, 1.0f, 0.0f), packHalf2(0.0f, coords_))  // top left
+            },
+            {
+                0, 1, 3, // First Triangle
+                1, 2, 3  // Second Triangle
+            }
+        ));
+
+        LOG_DEBUG("Loading textures");
+
+        textures_.reset(new TextureManager());
+
+        TextureParams params = {
+            wrap_, wrap_, GL_NEAREST, GL_NEAREST, SOIL_LOAD_RGB, true
+        };
+
+        texture0_ = textures_->load("res/img/container.jpg", params);
+
+        params.wrap_s = GL_REPEAT;
+        params.wrap_t = GL_REPEAT;
+
+        texture1_ = textures_->load("res/img/awesomeface.png", params);
+
+        queue_.reset(new RenderQueue(context.getFrameArena()));
+        texture_set_ = queue_->addTextureSet({{texture0_, texture1_, 0, 0}});
+
+        return true;
+    }
+
+    void update (double, double) override
+    {
+        frame_.mix_ratio = mix_ratio_;
+    }
+
+    void render () override
+    {
+        // upload the images decoded since the last frame, once per frame
+        // whatever the number of updates it ran
+        textures_->update();
+
+        // clear the color buffer
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        // ..:: Drawing code (in Game Loop) ::..
+        shader_->use();
+
+        shader_->set(kTexture0, 0);
+        shader_->set(kTexture1, 1);
+
+        frame_data_->update(frame_);
+
+        queue_->push(
+            shader_->getProgram(), texture_set_,
+            quad_->getVertexArray(), quad_->getCount(),
+            quad_->getIndexType()
+        );
+        queue_->submit();
+
+        // the GPU reads this frame's data until the fence signals
+        frame_data_->fence();
+    }
+
+    void shutdown () override
+    {
+        // Properly de-allocate all resources once they've outlived their purpose
+        queue_.reset();
+        quad_.reset();
+        frame_data_.reset();
+        textures_.reset();
+        shader_.reset();
+    }
+
+    void onKey (int key, int) override
+    {
+        if (key == GLFW_KEY_UP) {
+            mix_ratio_ += 0.1f;
+
+            if (mix_ratio_ > 1.0f)
+                mix_ratio_ = 1.0f;
+        } else if (key == GLFW_KEY_DOWN) {
+            mix_ratio_ -= 0.1f;
+
+            if (mix_ratio_ < 0.0f)
+                mix_ratio_ = 0.0f;
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Scene> createTextureExercise1 ()
+{
+    return std::unique_ptr<Scene>(new TextureExercise(1.0f, GL_REPEAT));
+}
+
+std::unique_ptr<Scene> createTextureExercise2 ()
+{
+    return std::unique_ptr<Scene>(new TextureExercise(2.0f, GL_CLAMP_TO_EDGE));
+}
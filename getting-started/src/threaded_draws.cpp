@@ -0,0 +1,271 @@
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// GLEW
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include "GLState.hpp"
+#include "InstanceBuffer.hpp"
+#include "Log.hpp"
+#include "MeshPool.hpp"
+#include "MultiDrawBatch.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
+#include "Shader.hpp"
+
+namespace {
+
+// a 128 x 128 grid of objects, each one of the meshes
+const int kGrid = 128;
+const int kObjects = kGrid * kGrid;
+const int kMeshes = 16;
+
+// the objects a job records, 32 jobs per frame
+const std::size_t kGrain = 512;
+
+// an object pulsing below this scale is not drawn
+const float kCullScale = 0.15f;
+
+// a regular polygon as a triangle fan around its center
+void makePolygon (int sides, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    const GLfloat kPi = 3.14159265f;
+
+    // position, texture coords
+    vertices = {0.0f, 0.0f, 0.0f, 0.5f, 0.5f};
+    indices.clear();
+
+    for (int i = 0; i < sides; ++i) {
+        GLfloat angle = 2.0f * kPi * i / sides;
+        GLfloat x = 0.5f * std::cos(angle);
+        GLfloat y = 0.5f * std::sin(angle);
+
+        vertices.insert(vertices.end(), {x, y, 0.0f, x + 0.5f, y + 0.5f});
+
+        indices.push_back(0);
+        indices.push_back(1 + i);
+        indices.push_back(1 + (i + 1) % sides);
+    }
+}
+
+// every object is animated and culled on the job threads, the render
+// thread only replays the draws they recorded into a MultiDrawBatch
+class ThreadedDraws : public Scene
+{
+ private:
+    std::unique_ptr<Shader> shader_;
+
+    std::unique_ptr<MeshPool> pool_;
+    std::vector<MeshRange> meshes_;
+    std::unique_ptr<MultiDrawBatch> batch_;
+
+    // written by update() and interpolate() on a job, time_ is read by the
+    // recording jobs
+    float previous_time_;
+    float update_time_;
+    float time_;
+
+    // changed with the J key, record on one thread to compare
+    bool threaded_;
+
+    // CPU time spent recording, written by record() only
+    double record_ms_;
+    unsigned int recorded_frames_;
+    std::size_t recorded_draws_;
+
+    // record the objects [begin, end), the model matrices of the objects
+    // kept are composed a batch at a time
+    void recordRange (FrameCommands& commands, std::size_t begin, std::size_t end) const
+    {
+        CommandBuffer& buffer = commands.getBuffer();
+        const GLfloat cell = 2.0f / kGrid;
+        const Vec3 axis = {0.0f, 0.0f, 1.0f};
+
+        InstanceTransforms transforms;
+        InstanceData pending[InstanceTransforms::kCapacity];
+        const MeshRange* ranges[InstanceTransforms::kCapacity];
+
+        auto flush = [&] {
+            transforms.compose();
+
+            for (std::size_t k = 0; k < transforms.getSize(); ++k) {
+                pending[k].model = transforms.getModel(k);
+                buffer.push(*ranges[k], pending[k]);
+            }
+
+            transforms.clear();
+        };
+
+        buffer.begin(static_cast<std::uint32_t>(begin));
+
+        for (std::size_t i = begin; i < end; ++i) {
+            int x = static_cast<int>(i % kGrid);
+            int y = static_cast<int>(i / kGrid);
+
+            // a wave crossing the grid diagonally
+            float phase = (x + y) * 0.1f;
+            float scale = 0.5f + 0.5f * std::sin(time_ * 2.0f + phase);
+
+            if (scale < kCullScale)
+                continue;
+
+            std::size_t k = transforms.add(
+                {-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell, 0.0f},
+                makeRotation(
+                    axis, (x * 7 + y * 3) * 0.05f + time_ * (1.0f + (i % 5) * 0.25f)
+                ),
+                {cell * 0.9f * scale, cell * 0.9f * scale, 1.0f}
+            );
+
+            pending[k].color[0] = static_cast<GLfloat>(x) / kGrid;
+            pending[k].color[1] = static_cast<GLfloat>(y) / kGrid;
+            pending[k].color[2] = scale;
+            pending[k].color[3] = 1.0f;
+            pending[k].layer = 0.0f;
+
+            ranges[k] = &meshes_[(x * 5 + y * 11) % kMeshes];
+
+            if (transforms.isFull())
+                flush();
+        }
+
+        flush();
+    }
+
+ public:
+    ThreadedDraws ()
+        : previous_time_(0.0f),
+          update_time_(0.0f),
+          time_(0.0f),
+          threaded_(true),
+          record_ms_(0.0),
+          recorded_frames_(0),
+          recorded_draws_(0)
+    {
+    }
+
+    bool init (RenderContext&) override
+    {
+        shader_.reset(new Shader(
+            "./shader/quad_instanced.vs",
+            "./shader/instance_color.frag"
+        ));
+
+        pool_.reset(new MeshPool({3, 2})); // position, texture coords
+
+        std::vector<GLfloat> vertices;
+        std::vector<GLuint> indices;
+
+        for (int i = 0; i < kMeshes; ++i) {
+            makePolygon(3 + i, vertices, indices);
+            meshes_.push_back(pool_->add(vertices, indices));
+        }
+
+        batch_.reset(new MultiDrawBatch(*pool_));
+
+        LOG_INFO("Recording " << kObjects << " objects in jobs of " << kGrain);
+
+        return true;
+    }
+
+    bool isPipelined () const override
+    {
+        return true;
+    }
+
+    void update (double time, double) override
+    {
+        previous_time_ = update_time_;
+        update_time_ = static_cast<float>(time);
+    }
+
+    void interpolate (float alpha) override
+    {
+        time_ = previous_time_ * (1.0f - alpha) + update_time_ * alpha;
+    }
+
+    void record (JobSystem& jobs, FrameCommands& commands) override
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        if (threaded_) {
+            JobCounter recorded;
+
+            jobs.parallelFor(kObjects, kGrain, [this, &commands] (std::size_t begin, std::size_t end) {
+                recordRange(commands, begin, end);
+            }, recorded);
+
+            jobs.wait(recorded);
+        } else {
+            recordRange(commands, 0, kObjects);
+        }
+
+        record_ms_ += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        ++recorded_frames_;
+        recorded_draws_ = commands.getSize();
+    }
+
+    void submit (const FrameCommands& commands) override
+    {
+        // clear the color buffer
+        {
+            ProfileScope scope("clear", true);
+
+            GLState::getInstance().clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        shader_->use();
+
+        {
+            ProfileScope scope("replay");
+
+            commands.replay(*batch_);
+        }
+
+        batch_->submit();
+    }
+
+    void shutdown () override
+    {
+        if (recorded_frames_ > 0) {
+            LOG_INFO(
+                "Recorded " << recorded_draws_ << " draws in the last frame, "
+                << record_ms_ / recorded_frames_ << " ms per frame on "
+                << (threaded_ ? "the job threads" : "one thread")
+            );
+        }
+
+        // Properly de-allocate all resources once they've outlived their purpose
+        batch_.reset();
+        pool_.reset();
+        shader_.reset();
+    }
+
+    void onKey (int key, int action) override
+    {
+        if ((key != GLFW_KEY_J) || (action != GLFW_PRESS))
+            return;
+
+        threaded_ = !threaded_;
+        record_ms_ = 0.0;
+        recorded_frames_ = 0;
+
+        LOG_INFO("Recording on " << (threaded_ ? "the job threads" : "one thread"));
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Scene> createThreadedDraws ()
+{
+    return std::unique_ptr<Scene>(new ThreadedDraws());
+}
@@ -0,0 +1,339 @@
+/*!
+ * \file  math_kernels_test.cpp
+ * \brief Check every MathKernels version against naive scalar code, and the
+ *        quaternion functions against the matrices built from them
+ */
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "MathKernels.hpp"
+
+namespace {
+
+// not a multiple of any vector width, so the kernels run their tails too
+const std::size_t kCount = 1003;
+
+// relative to the magnitude of the expected value, at least 1
+const float kTolerance = 1e-5f;
+
+const float kPi = 3.14159265358979323846f;
+
+//! Vec3Buffer
+/*!
+ * Vec3Buffer holds the arrays a Vec3Arrays points to
+ */
+struct Vec3Buffer
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    explicit Vec3Buffer (std::size_t count)
+        : x(count), y(count), z(count)
+    {
+    }
+
+    Vec3Arrays getArrays ()
+    {
+        return {x.data(), y.data(), z.data()};
+    }
+
+    Vec3 get (std::size_t i) const
+    {
+        return {x[i], y[i], z[i]};
+    }
+};
+
+float random (std::mt19937& generator, float low, float high)
+{
+    return std::uniform_real_distribution<float>(low, high)(generator);
+}
+
+Vec3 randomVec3 (std::mt19937& generator, float low, float high)
+{
+    return {
+        random(generator, low, high), random(generator, low, high),
+        random(generator, low, high)
+    };
+}
+
+Quat randomRotation (std::mt19937& generator)
+{
+    return normalize({
+        random(generator, -1.0f, 1.0f), random(generator, -1.0f, 1.0f),
+        random(generator, -1.0f, 1.0f), random(generator, 0.1f, 1.0f)
+    });
+}
+
+/*
+ * Naive scalar code, the same as the math kernels benchmark
+ */
+
+Mat4 multiplyNaive (const Mat4& a, const Mat4& b)
+{
+    Mat4 result;
+
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+
+            for (int k = 0; k < 4; ++k)
+                sum += a.data[k * 4 + row] * b.data[column * 4 + k];
+
+            result.data[column * 4 + row] = sum;
+        }
+    }
+
+    return result;
+}
+
+Vec3 transformNaive (const Mat4& m, const Vec3& p)
+{
+    const float in[4] = {p.x, p.y, p.z, 1.0f};
+    float out[3];
+
+    for (int row = 0; row < 3; ++row) {
+        float sum = 0.0f;
+
+        for (int k = 0; k < 4; ++k)
+            sum += m.data[k * 4 + row] * in[k];
+
+        out[row] = sum;
+    }
+
+    return {out[0], out[1], out[2]};
+}
+
+Mat4 composeNaive (const Vec3& t, const Quat& r, const Vec3& s)
+{
+    Mat4 translation = makeIdentity();
+    Mat4 rotation = makeTransform({0.0f, 0.0f, 0.0f}, r, {1.0f, 1.0f, 1.0f});
+    Mat4 scale = makeIdentity();
+
+    translation.data[12] = t.x;
+    translation.data[13] = t.y;
+    translation.data[14] = t.z;
+    scale.data[0] = s.x;
+    scale.data[5] = s.y;
+    scale.data[10] = s.z;
+
+    return multiplyNaive(multiplyNaive(translation, rotation), scale);
+}
+
+Mat4 makeRotationMatrix (const Quat& q)
+{
+    return makeTransform({0.0f, 0.0f, 0.0f}, q, {1.0f, 1.0f, 1.0f});
+}
+
+::testing::AssertionResult isNear (float value, float expected)
+{
+    float error = std::fabs(value - expected) / std::max(1.0f, std::fabs(expected));
+
+    if (error <= kTolerance)
+        return ::testing::AssertionSuccess();
+
+    return ::testing::AssertionFailure()
+        << value << " differs from " << expected << " by " << error;
+}
+
+void expectNear (const Vec3& value, const Vec3& expected)
+{
+    EXPECT_TRUE(isNear(value.x, expected.x));
+    EXPECT_TRUE(isNear(value.y, expected.y));
+    EXPECT_TRUE(isNear(value.z, expected.z));
+}
+
+void expectNear (const Mat4& value, const Mat4& expected)
+{
+    for (int k = 0; k < 16; ++k)
+        EXPECT_TRUE(isNear(value.data[k], expected.data[k])) << "element " << k;
+}
+
+//! MathKernelsTest
+/*!
+ * MathKernelsTest runs the kernels at one level, the levels the CPU doesn't
+ * support are skipped
+ */
+class MathKernelsTest : public ::testing::TestWithParam<SimdLevel>
+{
+ protected:
+    std::mt19937 generator_;
+
+    void SetUp () override
+    {
+        if (MathKernels::setLevel(GetParam()) != GetParam())
+            GTEST_SKIP() << ImageKernels::getLevelName(GetParam()) << " not supported";
+    }
+
+    void TearDown () override
+    {
+        MathKernels::setLevel(ImageKernels::getSupportedLevel());
+    }
+};
+
+TEST_P (MathKernelsTest, TransformPointsMatchesNaive)
+{
+    Mat4 matrix = composeNaive(
+        randomVec3(generator_, -10.0f, 10.0f), randomRotation(generator_),
+        randomVec3(generator_, 0.5f, 2.0f)
+    );
+    Vec3Buffer points(kCount);
+    Vec3Buffer target(kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i) {
+        Vec3 point = randomVec3(generator_, -100.0f, 100.0f);
+
+        points.x[i] = point.x;
+        points.y[i] = point.y;
+        points.z[i] = point.z;
+    }
+
+    MathKernels::transformPoints(matrix, points.getArrays(), target.getArrays(), kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i)
+        expectNear(target.get(i), transformNaive(matrix, points.get(i)));
+}
+
+TEST_P (MathKernelsTest, ComposeTransformsMatchesNaive)
+{
+    Vec3Buffer translations(kCount);
+    Vec3Buffer scales(kCount);
+    std::vector<float> rotations[4];
+    std::vector<Mat4> target(kCount);
+
+    for (std::vector<float>& component : rotations)
+        component.resize(kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i) {
+        Vec3 translation = randomVec3(generator_, -10.0f, 10.0f);
+        Vec3 scale = randomVec3(generator_, 0.5f, 2.0f);
+        Quat rotation = randomRotation(generator_);
+
+        translations.x[i] = translation.x;
+        translations.y[i] = translation.y;
+        translations.z[i] = translation.z;
+        scales.x[i] = scale.x;
+        scales.y[i] = scale.y;
+        scales.z[i] = scale.z;
+        rotations[0][i] = rotation.x;
+        rotations[1][i] = rotation.y;
+        rotations[2][i] = rotation.z;
+        rotations[3][i] = rotation.w;
+    }
+
+    QuatArrays quats = {
+        rotations[0].data(), rotations[1].data(), rotations[2].data(),
+        rotations[3].data()
+    };
+
+    MathKernels::composeTransforms(
+        translations.getArrays(), quats, scales.getArrays(), target.data(), kCount
+    );
+
+    for (std::size_t i = 0; i < kCount; ++i) {
+        Quat rotation = {
+            rotations[0][i], rotations[1][i], rotations[2][i], rotations[3][i]
+        };
+
+        expectNear(
+            target[i], composeNaive(translations.get(i), rotation, scales.get(i))
+        );
+    }
+}
+
+TEST_P (MathKernelsTest, MultiplyMatricesMatchesNaive)
+{
+    Mat4 left = multiplyNaive(
+        makePerspective(kPi / 4.0f, 4.0f / 3.0f, 0.1f, 100.0f),
+        composeNaive(
+            randomVec3(generator_, -10.0f, 10.0f), randomRotation(generator_),
+            {1.0f, 1.0f, 1.0f}
+        )
+    );
+    std::vector<Mat4> right(kCount);
+    std::vector<Mat4> target(kCount);
+
+    for (Mat4& matrix : right) {
+        matrix = composeNaive(
+            randomVec3(generator_, -10.0f, 10.0f), randomRotation(generator_),
+            randomVec3(generator_, 0.5f, 2.0f)
+        );
+    }
+
+    MathKernels::multiplyMatrices(left, right.data(), target.data(), kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i)
+        expectNear(target[i], multiplyNaive(left, right[i]));
+}
+
+INSTANTIATE_TEST_SUITE_P (
+    Levels, MathKernelsTest,
+    ::testing::Values(SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2),
+    [] (const ::testing::TestParamInfo<SimdLevel>& info) {
+        return std::string(ImageKernels::getLevelName(info.param));
+    }
+);
+
+/*
+ * Quaternions against matrices
+ */
+
+TEST (QuatTest, RotateMatchesMatrix)
+{
+    std::mt19937 generator;
+
+    for (int i = 0; i < 100; ++i) {
+        Quat rotation = randomRotation(generator);
+        Vec3 point = randomVec3(generator, -10.0f, 10.0f);
+
+        expectNear(
+            rotate(rotation, point),
+            transformNaive(makeRotationMatrix(rotation), point)
+        );
+    }
+}
+
+TEST (QuatTest, ProductMatchesMatrixProduct)
+{
+    std::mt19937 generator;
+
+    for (int i = 0; i < 100; ++i) {
+        Quat a = randomRotation(generator);
+        Quat b = randomRotation(generator);
+
+        expectNear(
+            makeRotationMatrix(a * b),
+            multiplyNaive(makeRotationMatrix(a), makeRotationMatrix(b))
+        );
+    }
+}
+
+TEST (QuatTest, MakeRotationIsCounterclockwise)
+{
+    Quat rotation = makeRotation({0.0f, 0.0f, 1.0f}, kPi / 2.0f);
+    Vec3 expected = {0.0f, 1.0f, 0.0f};
+
+    expectNear(rotate(rotation, {1.0f, 0.0f, 0.0f}), expected);
+    expectNear(
+        transformNaive(makeRotationMatrix(rotation), {1.0f, 0.0f, 0.0f}), expected
+    );
+}
+
+TEST (QuatTest, NlerpEndsAtItsRotations)
+{
+    std::mt19937 generator;
+    Quat a = randomRotation(generator);
+    Quat b = randomRotation(generator);
+    Vec3 point = randomVec3(generator, -10.0f, 10.0f);
+
+    expectNear(rotate(nlerp(a, b, 0.0f), point), rotate(a, point));
+    expectNear(rotate(nlerp(a, b, 1.0f), point), rotate(b, point));
+}
+
+} // namespace
@@ -0,0 +1,89 @@
+/*!
+ * \file  shader_cache_test.cpp
+ * \brief Check that the ShaderCache key changes with anything that changes
+ *        the program binary
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "ShaderCache.hpp"
+
+namespace {
+
+const std::string kVertex = "#version 330 core\nvoid main () {}\n";
+const std::string kFragment = "#version 330 core\nout vec4 color;\n";
+const std::string kDriver = std::string("Mesa\0llvmpipe\0" "4.5 Mesa 22.3.6\0", 30);
+
+std::string makeKey (
+    const std::string& vertex, const std::string& fragment,
+    const std::string& driver = kDriver
+) {
+    return ShaderCache::makeKey(
+        vertex.data(), vertex.size(), fragment.data(), fragment.size(), driver
+    );
+}
+
+TEST (ShaderCacheTest, KeyIsStable)
+{
+    std::string key = makeKey(kVertex, kFragment);
+
+    EXPECT_EQ(key.size(), 16u);
+    EXPECT_EQ(key.find_first_not_of("0123456789abcdef"), std::string::npos);
+    EXPECT_EQ(key, makeKey(kVertex, kFragment));
+}
+
+TEST (ShaderCacheTest, KeyChangesWithTheSources)
+{
+    std::string key = makeKey(kVertex, kFragment);
+    std::string vertex = kVertex;
+    std::string fragment = kFragment;
+
+    vertex[vertex.size() - 2] = ' ';
+    fragment[0] = ' ';
+
+    EXPECT_NE(key, makeKey(vertex, kFragment));
+    EXPECT_NE(key, makeKey(kVertex, fragment));
+    EXPECT_NE(key, makeKey(kFragment, kVertex));
+}
+
+TEST (ShaderCacheTest, KeyChangesWithTheSourceSizes)
+{
+    std::string key = makeKey(kVertex, kFragment);
+
+    // the same bytes, split at another place
+    EXPECT_NE(key, makeKey(kVertex + kFragment[0], kFragment.substr(1)));
+    EXPECT_NE(
+        makeKey(kVertex, ""),
+        ShaderCache::makeKey(kVertex.data(), kVertex.size() - 1, "", 0, kDriver)
+    );
+    EXPECT_NE(
+        key,
+        ShaderCache::makeKey(
+            kVertex.data(), kVertex.size(), kFragment.data(), kFragment.size() - 1,
+            kDriver
+        )
+    );
+}
+
+TEST (ShaderCacheTest, KeyChangesWithTheDriver)
+{
+    std::string key = makeKey(kVertex, kFragment);
+    std::string vendor = std::string("Intel\0llvmpipe\0" "4.5 Mesa 22.3.6\0", 31);
+    std::string renderer = std::string("Mesa\0softpipe\0" "4.5 Mesa 22.3.6\0", 30);
+    std::string version = std::string("Mesa\0llvmpipe\0" "4.5 Mesa 23.0.0\0", 30);
+
+    EXPECT_NE(key, makeKey(kVertex, kFragment, vendor));
+    EXPECT_NE(key, makeKey(kVertex, kFragment, renderer));
+    EXPECT_NE(key, makeKey(kVertex, kFragment, version));
+    EXPECT_NE(key, makeKey(kVertex, kFragment, ""));
+
+    // the strings are terminated, moving a character between them matters
+    EXPECT_NE(
+        makeKey(kVertex, kFragment, std::string("ab\0c\0", 5)),
+        makeKey(kVertex, kFragment, std::string("a\0bc\0", 5))
+    );
+}
+
+} // namespace
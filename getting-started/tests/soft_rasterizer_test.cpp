@@ -0,0 +1,277 @@
+/*!
+ * \file  soft_rasterizer_test.cpp
+ * \brief Compare the frames of SoftRasterizer against the golden frames in
+ *        tests/golden, bit for bit
+ *
+ * The scenes only use textures built here, so the frames don't depend on
+ * the image decoder. A frame that differs from its golden, or has none, is
+ * written to build/<name>.ppm: check it, then copy it to tests/golden.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "SoftRasterizer.hpp"
+#include "VertexFormat.hpp"
+
+namespace {
+
+const int kWidth = 128;
+const int kHeight = 96;
+
+// the quad of hello_triangle.cpp, a position and a color per vertex
+const std::vector<GLfloat> kQuad = {
+     0.5f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f,
+     0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f,
+    -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 0.0f
+};
+
+const std::vector<GLfloat> kDiamond = {
+    0.6f,   0.0f, 0.0f,
+    0.75f,  0.4f, 0.0f,
+    0.9f,   0.0f, 0.0f,
+    0.75f, -0.4f, 0.0f
+};
+
+// the triangle of the shader exercises
+const std::vector<GLfloat> kTriangle = {
+     0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
+     0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f
+};
+
+// a position, a color and texture coords, repeated twice across the quad
+const std::vector<GLfloat> kTexturedQuad = {
+     0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 2.0f, 2.0f,
+     0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 2.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -0.5f,  0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 2.0f
+};
+
+const std::vector<GLuint> kQuadIndices = {0, 1, 3, 1, 2, 3};
+const std::vector<GLuint> kTriangleIndices = {0, 1, 2};
+
+// interleaved floats, like the Mesh constructor taking attribute sizes
+SoftDraw makeDraw (
+    const std::vector<GLfloat>& vertices, const std::vector<GLint>& sizes,
+    const std::vector<GLuint>& indices, SoftEffect effect
+) {
+    SoftDraw draw;
+    GLsizei stride = 0;
+
+    for (GLint size : sizes)
+        stride += size * sizeof(GLfloat);
+
+    draw.vertices = vertices.data();
+    draw.stride = stride;
+    draw.attributes = getFloatAttributes(sizes);
+    draw.indices = indices.data();
+    draw.count = static_cast<GLsizei>(indices.size());
+    draw.index_type = GL_UNSIGNED_INT;
+    draw.transform = makeIdentity();
+    draw.effect = effect;
+    draw.uniforms = FrameData();
+    draw.textures[0] = nullptr;
+    draw.textures[1] = nullptr;
+
+    return draw;
+}
+
+// 8x8 texels, squares of 2x2 texels alternating between two colors
+SoftTexture makeChecker (GLenum wrap, GLenum filter)
+{
+    SoftTexture texture = {8, 8, std::vector<unsigned char>(8 * 8 * 4), wrap, wrap, filter};
+
+    for (int y = 0; y < texture.height; ++y) {
+        for (int x = 0; x < texture.width; ++x) {
+            unsigned char* texel = &texture.pixels[(y * texture.width + x) * 4];
+            bool odd = ((x / 2) + (y / 2)) % 2;
+
+            texel[0] = odd ? 230 : 40;
+            texel[1] = odd ? 180 : 60;
+            texel[2] = odd ? 30 : 120;
+            texel[3] = 255;
+        }
+    }
+
+    return texture;
+}
+
+// 16x4 texels, red grows along x and green along y
+SoftTexture makeGradient (GLenum wrap, GLenum filter)
+{
+    SoftTexture texture = {16, 4, std::vector<unsigned char>(16 * 4 * 4), wrap, wrap, filter};
+
+    for (int y = 0; y < texture.height; ++y) {
+        for (int x = 0; x < texture.width; ++x) {
+            unsigned char* texel = &texture.pixels[(y * texture.width + x) * 4];
+
+            texel[0] = x * 255 / (texture.width - 1);
+            texel[1] = y * 255 / (texture.height - 1);
+            texel[2] = 128;
+            texel[3] = 255;
+        }
+    }
+
+    return texture;
+}
+
+std::string makePpm (const std::vector<unsigned char>& pixels)
+{
+    std::string header =
+        "P6\n" + std::to_string(kWidth) + " " + std::to_string(kHeight) + "\n255\n";
+
+    return header + std::string(pixels.begin(), pixels.end());
+}
+
+// the frame against tests/golden/<name>.ppm, written to build/<name>.ppm
+// when it differs
+::testing::AssertionResult matchesGolden (
+    const std::string& name, const std::vector<unsigned char>& pixels
+) {
+    std::string expected = makePpm(pixels);
+    std::ifstream file("tests/golden/" + name + ".ppm", std::ios::binary);
+    std::string golden(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+    );
+
+    if (golden == expected)
+        return ::testing::AssertionSuccess();
+
+    std::ofstream("build/" + name + ".ppm", std::ios::binary) << expected;
+
+    if (!file)
+        return ::testing::AssertionFailure() << "no golden frame for " << name;
+
+    if (golden.size() != expected.size())
+        return ::testing::AssertionFailure() << "the golden " << name << " has another size";
+
+    unsigned int different = 0;
+
+    for (std::size_t i = 0; i < expected.size(); i += 3)
+        different += golden.compare(i, 3, expected, i, 3) != 0;
+
+    return ::testing::AssertionFailure()
+        << different << " pixels of " << name << " differ from the golden frame";
+}
+
+/*
+ * The scenes
+ */
+
+void renderHelloTriangle (SoftRasterizer& rasterizer)
+{
+    SoftDraw quad = makeDraw(kQuad, {3, 3}, kQuadIndices, SoftEffect::VertexColor);
+    SoftDraw diamond = makeDraw(kDiamond, {3}, kQuadIndices, SoftEffect::UniformColor);
+
+    diamond.uniforms.dynamic_color = {{0.0f, 0.5f, 0.0f, 1.0f}};
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(quad);
+    rasterizer.draw(diamond);
+}
+
+void renderTransformedTriangle (SoftRasterizer& rasterizer)
+{
+    SoftDraw triangle = makeDraw(kTriangle, {3, 3}, kTriangleIndices, SoftEffect::VertexColor);
+
+    // upside down and moved to the right, the pixel centers are not on
+    // the edges
+    triangle.transform.data[5] = -1.0f;
+    triangle.transform.data[12] = 0.3f;
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(triangle);
+}
+
+// the draws are rasterized by finish(), the textures must outlive it
+void renderTextureMix (
+    SoftRasterizer& rasterizer, const SoftTexture& checker, const SoftTexture& gradient
+) {
+    SoftDraw quad = makeDraw(kTexturedQuad, {3, 3, 2}, kQuadIndices, SoftEffect::TextureMix);
+
+    quad.uniforms.mix_ratio = 0.25f;
+    quad.textures[0] = &checker;
+    quad.textures[1] = &gradient;
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(quad);
+}
+
+TEST (SoftRasterizerTest, HelloTriangleMatchesGolden)
+{
+    SoftRasterizer rasterizer(kWidth, kHeight);
+
+    renderHelloTriangle(rasterizer);
+
+    EXPECT_TRUE(matchesGolden("hello_triangle_soft", rasterizer.readPixels()));
+}
+
+TEST (SoftRasterizerTest, TransformedTriangleMatchesGolden)
+{
+    SoftRasterizer rasterizer(kWidth, kHeight);
+
+    renderTransformedTriangle(rasterizer);
+
+    EXPECT_TRUE(matchesGolden("transformed_triangle_soft", rasterizer.readPixels()));
+}
+
+TEST (SoftRasterizerTest, TextureMixNearestMatchesGolden)
+{
+    SoftRasterizer rasterizer(kWidth, kHeight);
+    SoftTexture checker = makeChecker(GL_CLAMP_TO_EDGE, GL_NEAREST);
+    SoftTexture gradient = makeGradient(GL_REPEAT, GL_NEAREST);
+
+    renderTextureMix(rasterizer, checker, gradient);
+
+    EXPECT_TRUE(matchesGolden("texture_mix_nearest_soft", rasterizer.readPixels()));
+}
+
+TEST (SoftRasterizerTest, TextureMixLinearMatchesGolden)
+{
+    SoftRasterizer rasterizer(kWidth, kHeight);
+    SoftTexture checker = makeChecker(GL_CLAMP_TO_EDGE, GL_LINEAR);
+    SoftTexture gradient = makeGradient(GL_REPEAT, GL_LINEAR);
+
+    renderTextureMix(rasterizer, checker, gradient);
+
+    EXPECT_TRUE(matchesGolden("texture_mix_linear_soft", rasterizer.readPixels()));
+}
+
+// the tiles are shared between the threads, the frame must not depend on
+// how many there are
+TEST (SoftRasterizerTest, FrameDoesNotDependOnTheThreads)
+{
+    SoftRasterizer single(kWidth, kHeight, 1);
+    SoftRasterizer several(kWidth, kHeight, 4);
+    SoftTexture checker = makeChecker(GL_CLAMP_TO_EDGE, GL_LINEAR);
+    SoftTexture gradient = makeGradient(GL_REPEAT, GL_LINEAR);
+
+    renderHelloTriangle(single);
+    renderHelloTriangle(several);
+
+    EXPECT_EQ(single.readPixels(), several.readPixels());
+
+    renderTextureMix(single, checker, gradient);
+    renderTextureMix(several, checker, gradient);
+
+    EXPECT_EQ(single.readPixels(), several.readPixels());
+}
+
+TEST (SoftRasterizerTest, CountsTheTriangles)
+{
+    SoftRasterizer rasterizer(kWidth, kHeight);
+
+    renderHelloTriangle(rasterizer);
+    rasterizer.finish();
+
+    EXPECT_EQ(rasterizer.getStats().triangles, 4u);
+    EXPECT_GT(rasterizer.getStats().fragments, 0u);
+}
+
+} // namespace
@@ -0,0 +1,93 @@
+/*!
+ * \file  meshbake.cpp
+ * \brief Convert an OBJ mesh into a mesh container holding its welded and
+ *        reordered vertex and index streams
+ *
+ * usage: meshbake [--cache-size n] [--no-overdraw] input output
+ *
+ *     --cache-size   the post-transform cache size to optimize for, 16 by
+ *                    default
+ *     --no-overdraw  keep the Tipsify order, for meshes drawn without depth
+ *                    test or with few overlapping layers
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "AssetFile.hpp"
+#include "MeshContainer.hpp"
+#include "MeshLoader.hpp"
+
+namespace {
+
+int usage ()
+{
+    std::cout << "usage: meshbake [--cache-size n] [--no-overdraw] "
+              << "input output" << std::endl;
+
+    return 1;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    unsigned int cache_size = MeshLoader::kCacheSize;
+    bool overdraw = true;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--cache-size") && (i + 1 < argc))
+            cache_size = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--no-overdraw"))
+            overdraw = false;
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if ((paths.size() != 2) || (cache_size < 3))
+        return usage();
+
+    MeshData mesh;
+
+    try {
+        AssetFile file(paths[0]);
+
+        mesh = MeshLoader::parseObj(file);
+    } catch (const AssetError& e) {
+        std::cout << e.what() << std::endl;
+
+        return 1;
+    }
+
+    std::size_t corners = mesh.vertices.size();
+    VertexCacheStats before;
+
+    MeshLoader::weld(mesh);
+    before = MeshLoader::measureVertexCache(mesh.indices, mesh.vertices.size(), cache_size);
+
+    MeshLoader::optimizeVertexCache(mesh, cache_size);
+
+    if (overdraw)
+        MeshLoader::optimizeOverdraw(mesh, cache_size);
+
+    MeshLoader::optimizeVertexFetch(mesh);
+
+    VertexCacheStats after =
+        MeshLoader::measureVertexCache(mesh.indices, mesh.vertices.size(), cache_size);
+
+    if (!MeshContainer::write(paths[1], mesh, cache_size)) {
+        std::cout << "ERROR::MESHBAKE::FAILED_TO_WRITE " << paths[1] << std::endl;
+
+        return 1;
+    }
+
+    std::cout << paths[0] << " -> " << paths[1] << ": "
+              << mesh.indices.size() / 3 << " triangles, " << corners
+              << " corners welded to " << mesh.vertices.size() << " vertices, ACMR "
+              << before.acmr << " -> " << after.acmr << std::endl;
+
+    return 0;
+}
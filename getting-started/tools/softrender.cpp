@@ -0,0 +1,298 @@
+/*!
+ * \file  softrender.cpp
+ * \brief Draw the exercises with SoftRasterizer, no GPU nor display needed,
+ *        and compare the frames against golden images bit for bit
+ *
+ * usage: softrender [--scene NAME] [--size WxH] [--threads n]
+ *                   [--capture DIR] [--golden DIR] [--list]
+ *
+ *     --scene    draw a single scene, every scene by default
+ *     --size     framebuffer size, 800x600 by default
+ *     --threads  rasterizer threads, one less than the cores by default
+ *     --capture  write the frames to DIR, as <scene>_soft.ppm
+ *     --golden   compare the frames against DIR, any difference fails
+ *     --list     print the scene names
+ *
+ * The frames match the GL ones up to rounding, not bit for bit: keep the
+ * software goldens in their own directory.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <SOIL/SOIL.h>
+
+#include "AssetFile.hpp"
+#include "FrameCapture.hpp"
+#include "SoftRasterizer.hpp"
+#include "VertexFormat.hpp"
+
+namespace {
+
+// position, color, texture coords
+typedef PackedVertex<Float3, Color4ub, Half2> TexturedVertex;
+
+//! SoftAssets
+/*!
+ * SoftAssets holds what the scenes share
+ */
+struct SoftAssets
+{
+    SoftTexture container;
+    SoftTexture face;
+};
+
+//! SoftScene
+struct SoftScene
+{
+    const char* name;
+    void (*render)(SoftRasterizer&, const SoftAssets&);
+};
+
+// the quad of hello_triangle.cpp, a position and a color per vertex
+const std::vector<GLfloat> kQuad = {
+     0.5f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f,
+     0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f,
+    -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 0.0f
+};
+
+const std::vector<GLfloat> kDiamond = {
+    0.6f,   0.0f, 0.0f,
+    0.75f,  0.4f, 0.0f,
+    0.9f,   0.0f, 0.0f,
+    0.75f, -0.4f, 0.0f
+};
+
+// the triangle of the shader exercises
+const std::vector<GLfloat> kTriangle = {
+     0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
+     0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f
+};
+
+const std::vector<GLuint> kQuadIndices = {0, 1, 3, 1, 2, 3};
+const std::vector<GLuint> kTriangleIndices = {0, 1, 2};
+
+SoftDraw makeDraw (
+    const void* vertices, GLsizei stride, const std::vector<VertexAttribute>& attributes,
+    const std::vector<GLuint>& indices, SoftEffect effect
+) {
+    SoftDraw draw;
+
+    draw.vertices = vertices;
+    draw.stride = stride;
+    draw.attributes = attributes;
+    draw.indices = indices.data();
+    draw.count = static_cast<GLsizei>(indices.size());
+    draw.index_type = GL_UNSIGNED_INT;
+    draw.transform = makeIdentity();
+    draw.effect = effect;
+    draw.uniforms = FrameData();
+    draw.textures[0] = nullptr;
+    draw.textures[1] = nullptr;
+
+    return draw;
+}
+
+// interleaved floats, like the Mesh constructor taking attribute sizes
+SoftDraw makeDraw (
+    const std::vector<GLfloat>& vertices, const std::vector<GLint>& sizes,
+    const std::vector<GLuint>& indices, SoftEffect effect
+) {
+    GLsizei stride = 0;
+
+    for (GLint size : sizes)
+        stride += size * sizeof(GLfloat);
+
+    return makeDraw(vertices.data(), stride, getFloatAttributes(sizes), indices, effect);
+}
+
+/*
+ * The scenes, at their first frame
+ */
+
+void renderHelloTriangle (SoftRasterizer& rasterizer, const SoftAssets&)
+{
+    SoftDraw quad = makeDraw(kQuad, {3, 3}, kQuadIndices, SoftEffect::VertexColor);
+    SoftDraw diamond = makeDraw(kDiamond, {3}, kQuadIndices, SoftEffect::UniformColor);
+
+    // fshader1.frag at time 0
+    diamond.uniforms.dynamic_color = {{0.0f, 0.5f, 0.0f, 1.0f}};
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(quad);
+    rasterizer.draw(diamond);
+}
+
+void renderShaderExercise1 (SoftRasterizer& rasterizer, const SoftAssets&)
+{
+    SoftDraw triangle = makeDraw(kTriangle, {3, 3}, kTriangleIndices, SoftEffect::VertexColor);
+
+    // triangle_shader.vs draws it upside down
+    triangle.transform.data[5] = -1.0f;
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(triangle);
+}
+
+void renderShaderExercise2 (SoftRasterizer& rasterizer, const SoftAssets&)
+{
+    SoftDraw triangle = makeDraw(kTriangle, {3, 3}, kTriangleIndices, SoftEffect::VertexColor);
+
+    // move_x.vs adds FrameData::offset_x
+    triangle.uniforms.offset_x = 0.5f;
+    triangle.transform.data[12] = triangle.uniforms.offset_x;
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(triangle);
+}
+
+void renderShaderExercise3 (SoftRasterizer& rasterizer, const SoftAssets&)
+{
+    SoftDraw triangle = makeDraw(kTriangle, {3, 3}, kTriangleIndices, SoftEffect::VertexColor);
+
+    // position_as_color.vs, the color is the position
+    triangle.attributes[1] = triangle.attributes[0];
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(triangle);
+}
+
+void renderTextureExercise2 (SoftRasterizer& rasterizer, const SoftAssets& assets)
+{
+    static const std::vector<TexturedVertex> vertices = {
+        TexturedVertex::make({ 0.5f,  0.5f, 0.0f}, packColor(1.0f, 0.0f, 0.0f), packHalf2(2.0f, 2.0f)),
+        TexturedVertex::make({ 0.5f, -0.5f, 0.0f}, packColor(0.0f, 1.0f, 0.0f), packHalf2(2.0f, 0.0f)),
+        TexturedVertex::make({-0.5f, -0.5f, 0.0f}, packColor(0.0f, 0.0f, 1.0f), packHalf2(0.0f, 0.0f)),
+        TexturedVertex::make({-0.5f,  0.5f, 0.0f}, packColor(1.0f, 1.0f, 0.0f), packHalf2(0.0f, 2.0f))
+    };
+
+    SoftDraw quad = makeDraw(
+        vertices.data(), sizeof(TexturedVertex), TexturedVertex::getAttributes(),
+        kQuadIndices, SoftEffect::TextureMix
+    );
+
+    quad.uniforms.mix_ratio = 0.5f;
+    quad.textures[0] = &assets.container;
+    quad.textures[1] = &assets.face;
+
+    rasterizer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    rasterizer.draw(quad);
+}
+
+const SoftScene kScenes[] = {
+    {"hello_triangle", renderHelloTriangle},
+    {"shader_exercise1", renderShaderExercise1},
+    {"shader_exercise2", renderShaderExercise2},
+    {"shader_exercise3", renderShaderExercise3},
+    {"texture_exercise2", renderTextureExercise2}
+};
+
+// like texture_exercise.cpp; a texture that failed to load samples black
+// and the golden comparison fails
+SoftTexture loadTexture (const std::string& path, GLenum wrap)
+{
+    try {
+        return SoftRasterizer::loadTexture(path, SOIL_LOAD_RGB, wrap, GL_NEAREST);
+    } catch (const AssetError& e) {
+        std::cout << e.what() << std::endl;
+    }
+
+    return {0, 0, {}, wrap, wrap, GL_NEAREST};
+}
+
+int usage ()
+{
+    std::cout << "usage: softrender [--scene NAME] [--size WxH] [--threads n] "
+              << "[--capture DIR] [--golden DIR] [--list]" << std::endl;
+
+    return 1;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    std::string scene;
+    std::string capture;
+    std::string golden;
+    int width = 800;
+    int height = 600;
+    unsigned int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!std::strcmp(argv[i], "--list")) {
+            for (const SoftScene& entry : kScenes)
+                std::cout << entry.name << std::endl;
+
+            return 0;
+        }
+
+        if (value == nullptr)
+            return usage();
+
+        if (!std::strcmp(argv[i], "--scene")) {
+            scene = value;
+        } else if (!std::strcmp(argv[i], "--size")) {
+            if (
+                (std::sscanf(value, "%dx%d", &width, &height) != 2) ||
+                (width <= 0) || (height <= 0)
+            ) {
+                return usage();
+            }
+        } else if (!std::strcmp(argv[i], "--threads")) {
+            threads = std::strtoul(value, nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--capture")) {
+            capture = value;
+        } else if (!std::strcmp(argv[i], "--golden")) {
+            golden = value;
+        } else {
+            return usage();
+        }
+
+        ++i;
+    }
+
+    SoftAssets assets = {
+        loadTexture("res/img/container.jpg", GL_CLAMP_TO_EDGE),
+        loadTexture("res/img/awesomeface.png", GL_REPEAT)
+    };
+
+    SoftRasterizer rasterizer(width, height, threads);
+
+    // no readback buffers, the frames come from the CPU
+    FrameCapture frames(
+        rasterizer.getWidth(), rasterizer.getHeight(), capture, golden, 0, 0
+    );
+    unsigned int drawn = 0;
+
+    for (const SoftScene& entry : kScenes) {
+        if (!scene.empty() && (scene != entry.name))
+            continue;
+
+        entry.render(rasterizer, assets);
+        frames.submit(std::string(entry.name) + "_soft", rasterizer.readPixels());
+        ++drawn;
+    }
+
+    if (drawn == 0) {
+        std::cout << "ERROR::SOFTRENDER::UNKNOWN_SCENE " << scene << std::endl;
+
+        return 1;
+    }
+
+    const SoftStats& stats = rasterizer.getStats();
+
+    std::cout << "Software: " << drawn << " scenes, " << stats.triangles << " triangles, "
+              << stats.fragments << " fragments" << std::endl;
+    frames.report(std::cout);
+
+    return (frames.getMismatches() > 0) ? 1 : 0;
+}
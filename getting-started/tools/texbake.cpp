@@ -0,0 +1,377 @@
+/*!
+ * \file  texbake.cpp
+ * \brief Convert an image into a texture container holding its whole mipmap
+ *        chain, optionally compressed to BC1
+ *
+ * usage: texbake [--rgba] [--bc1] [--srgb] [--kaiser] input output
+ *
+ *     --rgba    keep the alpha channel
+ *     --bc1     compress every level to BC1
+ *     --srgb    filter the chain in linear light and store an sRGB format
+ *     --kaiser  filter with a Kaiser windowed sinc instead of a 2x2 box
+ */
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include <SOIL/SOIL.h>
+
+#include "AssetFile.hpp"
+#include "ImageKernels.hpp"
+#include "TextureContainer.hpp"
+
+namespace {
+
+//! Image
+/*!
+ * Image holds RGBA pixels, bottom row first
+ */
+struct Image
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+// the chain filtered on bytes, fast but gamma unaware
+std::vector<Image> buildChain (const Image& image)
+{
+    std::vector<Image> chain(1, image);
+
+    while ((chain.back().width > 1) || (chain.back().height > 1)) {
+        const Image& source = chain.back();
+        Image target;
+
+        target.width = ImageKernels::getLevelSize(source.width, 1);
+        target.height = ImageKernels::getLevelSize(source.height, 1);
+        target.pixels.resize(target.width * target.height * 4);
+
+        ImageKernels::downsampleBox(
+            source.pixels.data(), source.width, source.height,
+            target.pixels.data()
+        );
+
+        chain.push_back(std::move(target));
+    }
+
+    return chain;
+}
+
+// the chain filtered on floats, in linear light when the image is sRGB
+std::vector<Image> buildChain (const Image& image, bool srgb, bool kaiser)
+{
+    std::vector<Image> chain(1, image);
+    int width = image.width;
+    int height = image.height;
+    std::vector<float> level(width * height * 4);
+
+    if (srgb)
+        ImageKernels::srgbToLinear(image.pixels.data(), level.data(), width * height);
+    else
+        ImageKernels::unormToFloat(image.pixels.data(), level.data(), width * height);
+
+    while ((width > 1) || (height > 1)) {
+        Image target;
+
+        target.width = ImageKernels::getLevelSize(width, 1);
+        target.height = ImageKernels::getLevelSize(height, 1);
+        target.pixels.resize(target.width * target.height * 4);
+
+        std::vector<float> next(target.width * target.height * 4);
+
+        if (kaiser)
+            ImageKernels::downsampleKaiser(level.data(), width, height, next.data());
+        else
+            ImageKernels::downsampleBox(level.data(), width, height, next.data());
+
+        std::size_t pixels = target.width * target.height;
+
+        if (srgb)
+            ImageKernels::linearToSrgb(next.data(), target.pixels.data(), pixels);
+        else
+            ImageKernels::floatToUnorm(next.data(), target.pixels.data(), pixels);
+
+        width = target.width;
+        height = target.height;
+        level.swap(next);
+        chain.push_back(std::move(target));
+    }
+
+    return chain;
+}
+
+std::uint16_t packRgb565 (const int* color)
+{
+    return ((color[0] * 31 + 127) / 255) << 11 |
+        ((color[1] * 63 + 127) / 255) << 5 |
+        ((color[2] * 31 + 127) / 255);
+}
+
+void unpackRgb565 (std::uint16_t packed, int* color)
+{
+    color[0] = ((packed >> 11) & 31) * 255 / 31;
+    color[1] = ((packed >> 5) & 63) * 255 / 63;
+    color[2] = (packed & 31) * 255 / 31;
+}
+
+// BC1 with the endpoints taken from the bounding box of the block colors
+void compressBlock (const int block[16][3], unsigned char* output)
+{
+    int low[3] = {255, 255, 255};
+    int high[3] = {0, 0, 0};
+
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            low[c] = std::min(low[c], block[i][c]);
+            high[c] = std::max(high[c], block[i][c]);
+        }
+    }
+
+    // pull the endpoints in by 1/16 of the range, it lowers the average error
+    for (int c = 0; c < 3; ++c) {
+        int inset = (high[c] - low[c]) / 16;
+
+        low[c] += inset;
+        high[c] -= inset;
+    }
+
+    std::uint16_t color0 = packRgb565(high);
+    std::uint16_t color1 = packRgb565(low);
+    std::uint32_t indices = 0;
+
+    // color0 > color1 selects the four color mode
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    if (color0 != color1) {
+        int palette[4][3];
+
+        unpackRgb565(color0, palette[0]);
+        unpackRgb565(color1, palette[1]);
+
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int best_distance = 1 << 30;
+
+            for (int p = 0; p < 4; ++p) {
+                int distance = 0;
+
+                for (int c = 0; c < 3; ++c) {
+                    int delta = block[i][c] - palette[p][c];
+                    distance += delta * delta;
+                }
+
+                if (distance < best_distance) {
+                    best = p;
+                    best_distance = distance;
+                }
+            }
+
+            indices |= best << (i * 2);
+        }
+    }
+
+    output[0] = color0 & 0xFF;
+    output[1] = color0 >> 8;
+    output[2] = color1 & 0xFF;
+    output[3] = color1 >> 8;
+    output[4] = indices & 0xFF;
+    output[5] = (indices >> 8) & 0xFF;
+    output[6] = (indices >> 16) & 0xFF;
+    output[7] = indices >> 24;
+}
+
+std::vector<unsigned char> compressBc1 (const Image& image)
+{
+    int blocks_x = (image.width + 3) / 4;
+    int blocks_y = (image.height + 3) / 4;
+    std::vector<unsigned char> output(blocks_x * blocks_y * 8);
+
+    for (int by = 0; by < blocks_y; ++by) {
+        for (int bx = 0; bx < blocks_x; ++bx) {
+            int block[16][3];
+
+            // blocks past the edge repeat the last row and column
+            for (int i = 0; i < 16; ++i) {
+                int x = std::min(bx * 4 + (i % 4), image.width - 1);
+                int y = std::min(by * 4 + (i / 4), image.height - 1);
+                const unsigned char* pixel =
+                    &image.pixels[(y * image.width + x) * 4];
+
+                for (int c = 0; c < 3; ++c)
+                    block[i][c] = pixel[c];
+            }
+
+            compressBlock(block, &output[(by * blocks_x + bx) * 8]);
+        }
+    }
+
+    return output;
+}
+
+std::uint64_t alignOffset (std::uint64_t offset)
+{
+    return (offset + 15) & ~static_cast<std::uint64_t>(15);
+}
+
+int usage ()
+{
+    std::cout << "usage: texbake [--rgba] [--bc1] [--srgb] [--kaiser] "
+              << "input output" << std::endl;
+
+    return 1;
+}
+
+} // namespace
+
+int main (int argc, char** argv) {
+    bool bc1 = false;
+    bool srgb = false;
+    bool kaiser = false;
+    int channels = SOIL_LOAD_RGB;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--bc1"))
+            bc1 = true;
+        else if (!std::strcmp(argv[i], "--rgba"))
+            channels = SOIL_LOAD_RGBA;
+        else if (!std::strcmp(argv[i], "--srgb"))
+            srgb = true;
+        else if (!std::strcmp(argv[i], "--kaiser"))
+            kaiser = true;
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.size() != 2)
+        return usage();
+
+    Image image;
+
+    try {
+        AssetFile file(paths[0]);
+        unsigned char* pixels = SOIL_load_image_from_memory(
+            file.getBytes(), file.getSize(),
+            &image.width, &image.height, 0, channels
+        );
+
+        if (pixels == nullptr) {
+            std::cout << "ERROR::TEXBAKE::FAILED_TO_DECODE " << paths[0]
+                      << ": " << SOIL_last_result() << std::endl;
+
+            return 1;
+        }
+
+        std::size_t count = image.width * image.height;
+
+        image.pixels.resize(count * 4);
+
+        if (channels == SOIL_LOAD_RGBA)
+            std::memcpy(image.pixels.data(), pixels, count * 4);
+        else
+            ImageKernels::expandRgbToRgba(pixels, image.pixels.data(), count);
+
+        // GL expects the bottom row first
+        ImageKernels::flipVertical(image.pixels.data(), image.width * 4, image.height);
+
+        SOIL_free_image_data(pixels);
+    } catch (const AssetError& e) {
+        std::cout << e.what() << std::endl;
+
+        return 1;
+    }
+
+    // build the whole chain down to 1x1
+    std::vector<Image> chain = (srgb || kaiser) ?
+        buildChain(image, srgb, kaiser) : buildChain(image);
+
+    std::vector<std::vector<unsigned char> > payloads;
+
+    for (const Image& level : chain)
+        payloads.push_back(bc1 ? compressBc1(level) : level.pixels);
+
+    TextureContainerHeader header;
+
+    std::memcpy(header.magic, kTextureContainerMagic, 4);
+    header.version = kTextureContainerVersion;
+    header.width = image.width;
+    header.height = image.height;
+    header.levels = chain.size();
+
+    if (bc1) {
+        header.internal_format = srgb ?
+            GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        header.format = 0;
+        header.type = 0;
+    } else if (channels == SOIL_LOAD_RGBA) {
+        header.internal_format = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        header.format = GL_RGBA;
+        header.type = GL_UNSIGNED_BYTE;
+    } else {
+        // the levels are stored as RGBA either way, the alpha is dropped
+        header.internal_format = srgb ? GL_SRGB8 : GL_RGB8;
+        header.format = GL_RGBA;
+        header.type = GL_UNSIGNED_BYTE;
+    }
+
+    std::vector<TextureContainerLevel> levels(chain.size());
+    std::uint64_t offset = sizeof(header) +
+        levels.size() * sizeof(TextureContainerLevel);
+
+    for (std::size_t i = 0; i < chain.size(); ++i) {
+        offset = alignOffset(offset);
+
+        levels[i].width = chain[i].width;
+        levels[i].height = chain[i].height;
+        levels[i].offset = offset;
+        levels[i].size = payloads[i].size();
+
+        offset += payloads[i].size();
+    }
+
+    std::ofstream file(paths[1], std::ios::binary | std::ios::trunc);
+    const char padding[16] = {0};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(levels.data()),
+        levels.size() * sizeof(TextureContainerLevel)
+    );
+
+    for (std::size_t i = 0; i < chain.size(); ++i) {
+        std::uint64_t position = file.tellp();
+
+        file.write(padding, levels[i].offset - position);
+        file.write(
+            reinterpret_cast<const char*>(payloads[i].data()),
+            payloads[i].size()
+        );
+    }
+
+    file.close();
+
+    if (!file) {
+        std::cout << "ERROR::TEXBAKE::FAILED_TO_WRITE " << paths[1] << std::endl;
+
+        return 1;
+    }
+
+    std::cout << paths[0] << " -> " << paths[1] << ": " << image.width << "x"
+              << image.height << ", " << chain.size() << " levels, "
+              << offset << " bytes" << std::endl;
+
+    return 0;
+}